@@ -78,7 +78,7 @@ namespace OpenMS
 
     /// checks if an adduct (e.g.a 'M+2K-H;1+') is valid, i.e if the losses (==negative amounts) can actually be lost by the compound given in @p db_entry.
     /// If the negative parts are present in @p db_entry, true is returned.
-    bool isCompatible(EmpiricalFormula db_entry) const;
+    bool isCompatible(const EmpiricalFormula& db_entry) const;
 
     /// get charge of adduct
     int getCharge() const;
@@ -271,6 +271,18 @@ public:
     void queryByFeature(const Feature& feature, const Size& feature_index, const String& ion_mode, std::vector<AccurateMassSearchResult>& results) const;
     void queryByConsensusFeature(const ConsensusFeature& cfeat, const Size& cf_index, const Size& number_of_maps, const String& ion_mode, std::vector<AccurateMassSearchResult>& results) const;
 
+    /**
+      @brief Batched variant of queryByMZ()
+
+      @p results[i] receives the same hits as queryByMZ(@p observed_mzs[i], @p observed_charges[i], ...).
+      Instead of one binary search per query and adduct, the neutral mass windows
+      of all (query, adduct) pairs are sorted and matched against the database
+      in a single merge pass. Queries are processed in chunks, in parallel.
+
+      @exception Exception::InvalidSize if @p observed_mzs and @p observed_charges differ in size
+    */
+    void queryByMZ(const std::vector<double>& observed_mzs, const std::vector<Int>& observed_charges, const String& ion_mode, std::vector<std::vector<AccurateMassSearchResult> >& results) const;
+
     /// main method of AccurateMassSearchEngine
     /// input map is not const, since it will get annotated with results
     void run(FeatureMap&, MzTab&) const;
@@ -338,6 +350,24 @@ private:
     void parseAdductsFile_(const String& filename, std::vector<AdductInfo>& result);
     void searchMass_(double neutral_query_mass, double diff_mass, std::pair<Size, Size>& hit_indices) const;
 
+    /// adducts to use for @p ion_mode ('positive' or 'negative'); @throw InvalidParameter otherwise
+    const std::vector<AdductInfo>& getAdducts_(const String& ion_mode) const;
+
+    /// neutral mass of @p observed_mz assuming @p adduct, and the mass deviation allowed by the m/z tolerance
+    void getNeutralMassWindow_(double observed_mz, const AdductInfo& adduct, double& neutral_mass, double& diff_mass) const;
+
+    /// append a result for each DB entry in [@p hit_indices.first, @p hit_indices.second) which is compatible with @p adduct
+    void appendHits_(double observed_mz, double neutral_mass, const AdductInfo& adduct, const std::pair<Size, Size>& hit_indices, std::vector<AccurateMassSearchResult>& results) const;
+
+    /// append a 'not-found' indicator if @p results is empty and unidentified masses should be kept
+    void appendNotFound_(double observed_mz, Int observed_charge, std::vector<AccurateMassSearchResult>& results) const;
+
+    /// add RT, feature index, intensity and (optionally) mass trace intensities of @p feature to @p results
+    void setFeatureInfo_(const Feature& feature, Size feature_index, std::vector<AccurateMassSearchResult>& results) const;
+
+    /// add RT, feature index and per-map intensities of @p cfeat to @p results
+    void setConsensusFeatureInfo_(const ConsensusFeature& cfeat, Size cf_index, Size number_of_maps, std::vector<AccurateMassSearchResult>& results) const;
+
     /// add search results to a Consensus/Feature
     void annotate_(const std::vector<AccurateMassSearchResult>&, BaseFeature&) const;
 
@@ -360,6 +390,7 @@ private:
       double mass;
       std::vector<String> massIDs;
       String formula;
+      EmpiricalFormula parsed_formula; ///< @p formula, parsed once when loading the DB (used for adduct compatibility checks)
     };
     std::vector<MappingEntry_> mass_mappings_;
 
@@ -0,0 +1,152 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/KERNEL/StandardTypes.h>
+#include <OpenMS/CONCEPT/Types.h>
+
+#include <vector>
+#include <utility>
+
+namespace OpenMS
+{
+  /**
+      @brief Fragment ion index for fast candidate pre-selection in database searches
+
+      Theoretical fragment m/z values of all candidates (e.g., modified peptides
+      of a database chunk) are stored in one array sorted by m/z, each fragment
+      referring back to the candidate it was generated from (i.e., the posting
+      lists of all fragment m/z are concatenated). Internally, candidates are
+      numbered by increasing precursor mass, so a precursor mass window
+      translates into a contiguous range of candidate ids.
+
+      An experimental spectrum is queried by looking up each of its peaks in the
+      fragment array and counting, for every candidate in the precursor window,
+      the number of shared peaks. Candidates passing a minimum number of shared
+      peaks can then be scored with a more expensive scoring function.
+
+      Usage:
+      -# add all candidates with addCandidate()
+      -# call build()
+      -# call query() for each spectrum (const and thread-safe)
+
+      Fragment m/z are stored in single precision to keep the index compact
+      (about 8 bytes per fragment).
+
+      @ingroup ID
+  */
+  class OPENMS_DLLAPI FragmentIndex
+  {
+  public:
+
+    /// a single fragment: m/z and id of the candidate it belongs to
+    struct Fragment
+    {
+      float mz;
+      UInt32 candidate;
+    };
+
+    /// Constructor
+    FragmentIndex(double fragment_mass_tolerance = 10.0, bool fragment_mass_tolerance_unit_ppm = true);
+
+    /**
+      @brief Add a candidate to the index
+
+      @param precursor_mass The (neutral) precursor mass of the candidate
+      @param theo_spectrum The theoretical spectrum of the candidate (only peak positions are used)
+
+      @return The index of the candidate (consecutive, in order of insertion)
+
+      @exception Exception::Precondition is thrown if the index was already built
+    */
+    Size addCandidate(double precursor_mass, const PeakSpectrum& theo_spectrum);
+
+    /// Sort candidates by precursor mass and fragments by m/z. Must be called before query().
+    void build();
+
+    /// Returns true if build() was called after the last change
+    bool isBuilt() const;
+
+    /// Remove all candidates and fragments
+    void clear();
+
+    /// Returns the number of candidates
+    Size size() const;
+
+    /// Returns the number of fragments in the index
+    Size getNumberOfFragments() const;
+
+    /**
+      @brief Count the peaks shared between a spectrum and all candidates in a precursor mass window
+
+      Each peak of @p spectrum is matched to all indexed fragments within the
+      fragment mass tolerance (ppm tolerances are relative to the peak m/z).
+
+      @param spectrum The experimental spectrum
+      @param precursor_mass_low Lower bound of the precursor mass window (inclusive)
+      @param precursor_mass_high Upper bound of the precursor mass window (inclusive)
+      @param min_shared_peaks Minimum number of shared peaks for a candidate to be reported
+      @param hits Output: pairs of (candidate index as returned by addCandidate(), number of shared peaks)
+
+      @exception Exception::Precondition is thrown if the index was not built
+    */
+    void query(const PeakSpectrum& spectrum,
+               double precursor_mass_low,
+               double precursor_mass_high,
+               Size min_shared_peaks,
+               std::vector<std::pair<Size, Size> >& hits) const;
+
+  protected:
+    /// fragment tolerance
+    double fragment_mass_tolerance_;
+
+    /// fragment tolerance unit
+    bool fragment_mass_tolerance_unit_ppm_;
+
+    /// all fragments, sorted by m/z after build()
+    std::vector<Fragment> fragments_;
+
+    /// precursor masses of the candidates (sorted after build())
+    std::vector<double> precursor_masses_;
+
+    /// maps internal (mass sorted) candidate ids to insertion order
+    std::vector<Size> candidate_order_;
+
+    /// index state
+    bool built_;
+  };
+
+} // namespace OpenMS
+
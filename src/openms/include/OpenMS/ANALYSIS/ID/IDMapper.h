@@ -302,6 +302,18 @@ public:
                                                                      double rt_tol = 0.001)
     {
       SpectraIdentificationState ret;
+
+      // (RT, m/z) of all non-empty identifications, sorted by RT for fast lookup
+      // (do not count empty ids as identification of a spectrum)
+      std::vector<std::pair<double, double> > id_positions;
+      id_positions.reserve(ids.size());
+      for (Size i_id = 0; i_id != ids.size(); ++i_id)
+      {
+        if (ids[i_id].getHits().empty()) continue;
+        id_positions.push_back(std::make_pair(ids[i_id].getRT(), ids[i_id].getMZ()));
+      }
+      std::sort(id_positions.begin(), id_positions.end());
+
       for (Size spectrum_index = 0; spectrum_index < spectra.size(); ++spectrum_index)
       {
         const MSSpectrum& spectrum = spectra[spectrum_index];
@@ -311,23 +323,18 @@ public:
           const std::vector<Precursor>& precursors = spectrum.getPrecursors();
 
           // check if precursor has been identified
-          for (Size i_p = 0; i_p < precursors.size(); ++i_p)
+          for (Size i_p = 0; i_p < precursors.size() && !identified; ++i_p)
           {
             // check by precursor mass and spectrum RT
             double mz_p = precursors[i_p].getMZ();
             double rt_s = spectrum.getRT();
-          
-            for (Size i_id = 0; i_id != ids.size(); ++i_id)
-            {
-              const PeptideIdentification& pid = ids[i_id];
-
-              // do not count empty ids as identification of a spectrum
-              if (pid.getHits().empty()) continue;
-
-              double mz_id = pid.getMZ();
-              double rt_id = pid.getRT();
 
-              if ( fabs(mz_id - mz_p) < mz_tol && fabs(rt_s - rt_id) < rt_tol )
+            // (the search window is generous, the exact check follows below)
+            std::vector<std::pair<double, double> >::const_iterator it = std::lower_bound(id_positions.begin(), id_positions.end(),
+              std::make_pair(rt_s - 2 * rt_tol, -std::numeric_limits<double>::max()));
+            for (; it != id_positions.end() && it->first <= rt_s + 2 * rt_tol; ++it)
+            {
+              if (fabs(it->second - mz_p) < mz_tol && fabs(rt_s - it->first) < rt_tol)
               {
                 identified = true;
                 break; 
@@ -381,12 +388,47 @@ protected:
     void getIDDetails_(const PeptideIdentification& id, double& rt_pep, DoubleList& mz_values, IntList& charges, bool use_avg_mass = false) const;
 
     /// increase a bounding box by the given RT and m/z tolerances
-    void increaseBoundingBox_(DBoundingBox<2>& box);
+    void increaseBoundingBox_(DBoundingBox<2>& box) const;
 
     /// try to determine the type of m/z value reported for features, return
     /// whether average peptide masses should be used for matching
     bool checkMassType_(const std::vector<DataProcessing>& processing) const;
 
+    /**
+      @brief Index of (RT, m/z) boxes for fast overlap queries
+
+      RT is partitioned into bins of a fixed width; every box is stored in all
+      bins it overlaps, sorted by its lower m/z bound. Queries are answered
+      with a binary search per RT bin.
+    */
+    class OPENMS_DLLAPI BoxIndex
+    {
+public:
+      /// Builds the index over @p boxes (x: RT, y: m/z); boxes with min > max in any dimension are never reported
+      explicit BoxIndex(const std::vector<DBoundingBox<2> >& boxes, double rt_bin_width = 1.0);
+
+      /// Stores the indices (ascending) of all boxes intersecting [@p rt_min, @p rt_max] x [@p mz_min, @p mz_max] in @p result
+      void query(double rt_min, double rt_max, double mz_min, double mz_max, std::vector<Size>& result) const;
+
+      /// Number of indexed boxes
+      Size size() const;
+
+private:
+      double rt_bin_width_;
+      SignedSize bin_offset_;
+      /// per RT bin: (lower m/z bound, box index), sorted
+      std::vector<std::vector<std::pair<double, Size> > > bins_;
+      /// per RT bin: maximal m/z width of its boxes
+      std::vector<double> bin_max_mz_width_;
+      std::vector<double> rt_min_, rt_max_, mz_max_;
+    };
+
+    /// check whether @p id_pos lies within the (tolerance-increased) bounding box of any mass trace of @p feat
+    bool enclosedByMassTrace_(const Feature& feat, const DPosition<2>& id_pos, bool use_centroid_rt) const;
+
+    /// indices (ascending, unique) of the elements with a position in @p index within RT/m/z tolerance of (@p rt, any of @p mz_values); @p position_to_element maps index positions to elements
+    std::vector<Size> findCandidates_(const BoxIndex& index, const std::vector<Size>& position_to_element, double rt, const DoubleList& mz_values) const;
+
   };
 
 } // namespace OpenMS
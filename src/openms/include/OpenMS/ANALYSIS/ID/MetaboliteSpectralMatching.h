@@ -34,6 +34,7 @@
 
 #pragma once
 
+#include <OpenMS/ANALYSIS/ID/SpectralLibraryIndex.h>
 #include <OpenMS/KERNEL/MassTrace.h>
 #include <OpenMS/KERNEL/Feature.h>
 #include <OpenMS/KERNEL/FeatureMap.h>
@@ -161,9 +162,19 @@ namespace OpenMS
     /// hyperscore computation
     double computeHyperScore(MSSpectrum, MSSpectrum, const double&, const double&);
 
-    /// main method of MetaboliteSpectralMatching
+    /// main method of MetaboliteSpectralMatching (sorts @p spec_db by precursor m/z and indexes it on the fly)
     void run(PeakMap &, PeakMap &, MzTab &);
 
+    /**
+      @brief Searches @p msexp against the spectral library @p spec_db, using a pre-built @p index of it
+
+      Spectra of @p msexp are searched in parallel. @p spec_db is not modified.
+
+      @exception Exception::IllegalArgument if @p index was not built from @p spec_db
+      @exception Exception::ConversionError if a matching library spectrum lacks one of the meta values reported in @p mztab_out
+    */
+    void run(PeakMap & msexp, const PeakMap & spec_db, const SpectralLibraryIndex & index, MzTab & mztab_out);
+
   protected:
     void updateMembers_() override;
 
@@ -171,6 +182,11 @@ namespace OpenMS
     /// private member functions
     void exportMzTab_(const std::vector<SpectralMatch>&, MzTab&);
 
+    /// hyperscore of two peak lists (sorted by m/z), see computeHyperScore()
+    double computeHyperScore_(const std::vector<double>& exp_mz, const std::vector<float>& exp_intensity,
+                              const double* db_mz, const float* db_intensity, Size db_size,
+                              double fragment_mass_error, double mz_lower_bound) const;
+
     double precursor_mz_error_;
     double fragment_mz_error_;
     String mz_error_unit_;
@@ -0,0 +1,187 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/DATASTRUCTURES/ListUtils.h>
+
+#include <vector>
+#include <utility>
+
+namespace OpenMS
+{
+  /**
+      @brief Index of (isotope corrected) precursor masses for database search tools
+
+      Search engines look up all spectra whose precursor mass matches a
+      candidate peptide mass. This index stores all precursor masses in one
+      contiguous array sorted by mass. Lookups use a second copy of the masses
+      in Eytzinger (breadth-first) layout, which keeps the first levels of the
+      binary search in a few cache lines.
+
+      Each entry refers to a spectrum (or any other index provided by the
+      caller) and the isotope error used to correct the precursor mass.
+
+      Usage:
+      -# add all precursor masses with add() or addPrecursor()
+      -# call build()
+      -# look up mass windows with find() (const and thread-safe)
+
+      @ingroup ID
+  */
+  class OPENMS_DLLAPI PrecursorMassIndex
+  {
+  public:
+
+    /// an indexed precursor mass
+    struct Entry
+    {
+      double mass; ///< (corrected) neutral precursor mass
+      Size spectrum_index; ///< index of the spectrum (as provided in add())
+      int isotope_error; ///< isotope error used to correct the mass
+    };
+
+    typedef std::vector<Entry>::const_iterator ConstIterator;
+
+    /// range of entries [first, second) sorted by mass
+    typedef std::pair<ConstIterator, ConstIterator> Range;
+
+    /// Constructor
+    PrecursorMassIndex();
+
+    /**
+      @brief Add a precursor mass
+
+      @param mass The (corrected) neutral precursor mass
+      @param spectrum_index Index of the spectrum
+      @param isotope_error Isotope error used to correct the mass
+    */
+    void add(double mass, Size spectrum_index, int isotope_error = 0);
+
+    /**
+      @brief Add a precursor mass corrected for monoisotopic peak misassignments
+
+      For each isotope error i, the mass @p precursor_mass - i * (C13 - C12 mass difference) is added.
+    */
+    void addPrecursor(double precursor_mass, Size spectrum_index, const IntList& isotope_errors);
+
+    /// Sort all entries by mass and build the search layout. Must be called before find().
+    void build();
+
+    /// Returns true if build() was called after the last change
+    bool isBuilt() const;
+
+    /// Remove all entries
+    void clear();
+
+    /// Returns the number of entries
+    Size size() const;
+
+    /// Returns true if there are no entries
+    bool empty() const;
+
+    /// Iterator to the first entry (sorted by mass after build())
+    ConstIterator begin() const;
+
+    /// Iterator past the last entry
+    ConstIterator end() const;
+
+    /// Returns the entry at position @p index (sorted by mass after build())
+    const Entry& operator[](Size index) const;
+
+    /**
+      @brief Find all entries with @p mass_low <= mass <= @p mass_high
+
+      @exception Exception::Precondition is thrown if the index was not built
+    */
+    Range findByMass(double mass_low, double mass_high) const;
+
+    /**
+      @brief Find all entries within @p tolerance of @p mass
+
+      @param mass The query mass
+      @param tolerance The tolerance (the window is @p mass +/- tolerance)
+      @param tolerance_unit_ppm If true, @p tolerance is given in ppm of @p mass, otherwise in Da
+
+      @exception Exception::Precondition is thrown if the index was not built
+    */
+    Range find(double mass, double tolerance, bool tolerance_unit_ppm) const;
+
+    /**
+      @brief Batched version of find()
+
+      If @p masses are sorted in ascending order, the search for each window
+      starts at the previous one (galloping search), so a single mass costs
+      O(log n) and close masses are found in few steps.
+
+      @exception Exception::Precondition is thrown if the index was not built
+    */
+    void find(const std::vector<double>& masses, double tolerance, bool tolerance_unit_ppm, std::vector<Range>& ranges) const;
+
+  protected:
+
+    /// position of the first entry with mass >= @p mass
+    Size lowerBound_(double mass) const;
+
+    /// position of the first entry with mass > @p mass
+    Size upperBound_(double mass) const;
+
+    /// position of the first entry at or after @p from with mass >= @p mass (galloping search)
+    Size gallopLowerBound_(Size from, double mass) const;
+
+    /// position of the first entry at or after @p from with mass > @p mass (galloping search)
+    Size gallopUpperBound_(Size from, double mass) const;
+
+    /// recursively fill the Eytzinger layout (in-order traversal of the implicit tree)
+    void fillEytzinger_(Size& sorted_index, Size node);
+
+    /// throws Exception::Precondition if not built
+    void checkBuilt_(const char* function) const;
+
+    /// entries sorted by mass
+    std::vector<Entry> entries_;
+
+    /// masses in Eytzinger layout (1-based, position 0 unused)
+    std::vector<double> eytzinger_;
+
+    /// position in entries_ for each node of the Eytzinger layout
+    std::vector<Size> eytzinger_rank_;
+
+    /// index state
+    bool built_;
+  };
+
+} // namespace OpenMS
+
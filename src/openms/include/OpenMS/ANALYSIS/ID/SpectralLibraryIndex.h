@@ -0,0 +1,145 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/KERNEL/StandardTypes.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+
+#include <vector>
+#include <utility>
+
+namespace OpenMS
+{
+  /**
+    @brief Precursor-binned index of a spectral library
+
+    Stores the precursors and fragment peaks of all library spectra in
+    contiguous arrays, ordered by precursor m/z and bucketed into bins of
+    fixed width, so that candidate lookup and scoring do not need to touch
+    the (heavyweight) MSSpectrum objects.
+    Entries refer back to the position of their spectrum in the library
+    they were built from, which is still needed for the meta data of a hit.
+
+    The index can be stored to and loaded from a binary file, to avoid
+    rebuilding it for every search against a large library. The file
+    contains a format version and a checksum over the precursors and
+    fragment peaks of the library, which matches() uses to make sure that a
+    loaded index belongs to a given library.
+
+    @note Fragment peaks of the library spectra are expected to be sorted by m/z.
+
+    @ingroup ID
+  */
+  class OPENMS_DLLAPI SpectralLibraryIndex
+  {
+  public:
+    /// Default constructor (empty index)
+    SpectralLibraryIndex();
+
+    /**
+      @brief Builds the index from the spectra of @p spec_db
+
+      @exception Exception::MissingInformation if a library spectrum has no precursor
+    */
+    void build(const PeakMap& spec_db, double bin_width = 1.0);
+
+    /// store the index to a binary file; @throw Exception::UnableToCreateFile
+    void store(const String& filename) const;
+
+    /**
+      @brief load an index from a binary file
+
+      The file is rejected if it was written in another format version, or if
+      the checksum or the offsets stored in it are inconsistent.
+
+      @exception Exception::FileNotFound if the file cannot be opened
+      @exception Exception::ParseError if the file is not a (valid) index file
+    */
+    void load(const String& filename);
+
+    /// number of library spectra
+    Size size() const;
+
+    /// returns true if the index was built from (a library with identical precursors and fragment peaks to) @p spec_db
+    bool matches(const PeakMap& spec_db) const;
+
+    /// checksum over the precursors and fragment peaks of the indexed library
+    UInt64 getChecksum() const;
+
+    /// range [first, second) of entries with precursor m/z in [@p mz_lower, @p mz_upper]
+    std::pair<Size, Size> findPrecursorRange(double mz_lower, double mz_upper) const;
+
+    /// precursor m/z of entry @p i
+    double getPrecursorMZ(Size i) const;
+
+    /// precursor charge of entry @p i
+    Int getPrecursorCharge(Size i) const;
+
+    /// position of the spectrum of entry @p i in the library the index was built from
+    Size getLibraryIndex(Size i) const;
+
+    /// number of fragment peaks of entry @p i
+    Size getPeakCount(Size i) const;
+
+    /// fragment m/z values of entry @p i (getPeakCount(i) values)
+    const double* getPeakMZ(Size i) const;
+
+    /// fragment intensities of entry @p i (getPeakCount(i) values)
+    const float* getPeakIntensity(Size i) const;
+
+  private:
+    /// checksum over the precursor and fragment peak arrays (see matches())
+    UInt64 computeChecksum_() const;
+
+    /// returns true if the offsets and library indices are within bounds and ordered
+    bool isConsistent_() const;
+
+    UInt64 checksum_;
+    double bin_width_;
+    double min_mz_;
+    /// first entry of each precursor bin (plus end marker)
+    std::vector<Size> bin_offsets_;
+
+    std::vector<double> precursor_mz_;
+    std::vector<Int> precursor_charge_;
+    std::vector<Size> library_index_;
+
+    /// first peak of each entry (plus end marker)
+    std::vector<Size> peak_offsets_;
+    std::vector<double> peak_mz_;
+    std::vector<float> peak_intensity_;
+  };
+}
+
@@ -16,6 +16,7 @@ ConsensusIDAlgorithmRanks.h
 ConsensusIDAlgorithmSimilarity.h
 ConsensusIDAlgorithmWorst.h
 FalseDiscoveryRate.h
+FragmentIndex.h
 HiddenMarkovModel.h
 IDDecoyProbability.h
 IDConflictResolverAlgorithm.h
@@ -23,12 +24,14 @@ IDMapper.h
 IDRipper.h
 MetaboliteSpectralMatching.h
 PeptideProteinResolution.h
+PrecursorMassIndex.h
 PrecursorPurity.h
 ProtonDistributionModel.h
 PeptideIndexing.h
 PercolatorFeatureSetHelper.h
 SiriusAdapterAlgorithm.h
 SiriusMSConverter.h
+SpectralLibraryIndex.h
 )
 
 ### add path to the filenames
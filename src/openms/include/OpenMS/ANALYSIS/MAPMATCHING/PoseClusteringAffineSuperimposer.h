@@ -100,6 +100,15 @@ public:
     /// Perform alignment on vector of 1D peaks
     virtual void run(const std::vector<Peak2D> & map_model, const std::vector<Peak2D> & map_scene, TransformationDescription & transformation);
 
+    /**
+      @brief Reduces @p map to its @p num_used_points most intense points.
+
+      If @p stride is larger than one, only every stride-th point of these
+      (ranked by decreasing intensity) is kept. Points of equal intensity are
+      ranked in input order, so the selection is deterministic.
+    */
+    static void selectByIntensityRank(std::vector<Peak2D> & map, const Size num_used_points, const Size stride);
+
     /// Returns an instance of this class
     static BaseSuperimposer * create()
     {
@@ -44,8 +44,8 @@
 #include <boost/unordered_map.hpp>
 
 #include <list>
+#include <queue>
 #include <vector>
-#include <set>
 #include <utility> // for pair<>
 
 namespace OpenMS
@@ -91,7 +91,10 @@ namespace OpenMS
    This algorithm includes a number of optimizations to reduce run-time:
    @li two-dimensional hashing of features,
    @li a look-up table for feature distances,
-   @li a variant of QT clustering that requires only one round of clustering.
+   @li a variant of QT clustering that requires only one round of clustering,
+   @li parallel (OpenMP) computation of the initial clusters,
+   @li a priority queue of cluster qualities that is only updated for
+       clusters affected by the extraction of the best cluster.
 
    @see FeatureGroupingAlgorithmQT
 
@@ -110,9 +113,28 @@ private:
               std::pair<OpenMS::GridFeature*, OpenMS::GridFeature*>,
               double> PairDistances;
 
-    /// Map to store which grid features are next to which clusters
-    typedef OpenMSBoost::unordered_map<
-              OpenMS::GridFeature*, std::vector<QTCluster*> > ElementMapping;
+    /// Stores which clusters each grid feature is next to (indexed by feature index, contains cluster indices)
+    typedef std::vector<std::vector<Size> > ElementMapping;
+
+    /// Quality of a cluster and its index in the clustering
+    typedef std::pair<double, Size> ClusterQuality;
+
+    /// Orders clusters by quality; for equal quality the cluster with lower index is preferred
+    struct ClusterQualityLess
+    {
+      bool operator()(const ClusterQuality& a, const ClusterQuality& b) const
+      {
+        return a.first < b.first || (a.first == b.first && a.second > b.second);
+      }
+    };
+
+    /**
+       @brief Priority queue of cluster qualities (best cluster on top)
+
+       Entries become outdated when a cluster is updated or invalidated; they
+       are skipped when they reach the top (see makeConsensusFeature_).
+    */
+    typedef std::priority_queue<ClusterQuality, std::vector<ClusterQuality>, ClusterQualityLess> ClusterQueue;
 
     typedef HashGrid<OpenMS::GridFeature*> Grid;
 
@@ -134,25 +156,35 @@ private:
     /// Feature distance functor
     FeatureDistance feature_distance_;
 
-    /// Set of features already used
-    std::set<OpenMS::GridFeature*> already_used_;
+    /// Features already used (indexed by feature index)
+    std::vector<bool> already_used_;
+
+    /// Offset of each input map in the feature index
+    std::vector<Size> map_offsets_;
+
+    /// Returns the index of a grid feature (offset of its map plus index in the map)
+    Size featureIndex_(const OpenMS::GridFeature* feature) const;
 
     /**
        @brief Calculates the distance between two grid features.
+
+       @p feature_distance is passed explicitly as it is not thread-safe
+       (each thread uses its own copy).
     */
-    double getDistance_(const OpenMS::GridFeature* left, const
-        OpenMS::GridFeature* right);
+    double getDistance_(FeatureDistance& feature_distance,
+        const OpenMS::GridFeature* left, const OpenMS::GridFeature* right) const;
 
     /// Sets algorithm parameters
     void setParameters_(double max_intensity, double max_mz);
 
     /// Generates a consensus feature from the best cluster and updates the clustering
-    void makeConsensusFeature_(std::list<QTCluster>& clustering,
+    void makeConsensusFeature_(std::vector<QTCluster>& clustering,
+                               ClusterQueue& cluster_queue,
                                ConsensusFeature& feature,
                                ElementMapping& element_mapping, Grid&);
 
-    /// Computes an initial QT clustering of the points in the hash grid
-    void computeClustering_(Grid& grid, std::list<QTCluster>& clustering);
+    /// Computes an initial QT clustering of the points in the hash grid (in parallel)
+    void computeClustering_(Grid& grid, std::vector<QTCluster>& clustering);
 
     /// Runs the algorithm on feature maps or consensus maps
     template <typename MapType>
@@ -165,7 +197,7 @@ private:
 
     /// Adds elements to the cluster based on the elements hashed in the grid
     void addClusterElements_(int x, int y, const Grid& grid, QTCluster& cluster,
-      const OpenMS::GridFeature* center_feature);
+      const OpenMS::GridFeature* center_feature, FeatureDistance& feature_distance) const;
 
 protected:
 
@@ -39,6 +39,7 @@
 #include <boost/numeric/conversion/cast.hpp>
 
 #include <OpenMS/KERNEL/MSSpectrum.h>
+#include <OpenMS/KERNEL/ColumnarSpectrum.h>
 #include <OpenMS/KERNEL/MSChromatogram.h>
 #include <OpenMS/ANALYSIS/TARGETED/TargetedExperiment.h>
 #include <OpenMS/OPENSWATHALGO/DATAACCESS/TransitionExperiment.h>
@@ -59,6 +60,23 @@ public:
     /// Convert an OpenMS Spectrum to an SpectrumPtr
     static OpenSwath::SpectrumPtr convertToSpectrumPtr(const OpenMS::MSSpectrum & spectrum);
 
+    /// Convert a SpectrumPtr to a ColumnarSpectrum (copies the data arrays)
+    static void convertToColumnarSpectrum(const OpenSwath::SpectrumPtr sptr, ColumnarSpectrum<double, double> & spectrum);
+
+    /// Convert a ColumnarSpectrum to a SpectrumPtr without copying (the data arrays are moved, @p spectrum is empty afterwards)
+    static OpenSwath::SpectrumPtr convertToSpectrumPtr(ColumnarSpectrum<double, double> && spectrum);
+
+    /**
+      @brief Exchange the data arrays of a SpectrumPtr and a ColumnarSpectrum without copying
+
+      Allows to use the search and sort functions of ColumnarSpectrum on the
+      data of a SpectrumPtr, calling the function a second time restores the
+      original state.
+
+      @exception Exception::IllegalArgument is thrown if the m/z and intensity arrays of @p sptr differ in length
+    */
+    static void swapArrays(OpenSwath::SpectrumPtr sptr, ColumnarSpectrum<double, double> & spectrum);
+
     /// Convert a ChromatogramPtr to an OpenMS Chromatogram
     static void convertToOpenMSChromatogram(const OpenSwath::ChromatogramPtr cptr, OpenMS::MSChromatogram & chromatogram);
 
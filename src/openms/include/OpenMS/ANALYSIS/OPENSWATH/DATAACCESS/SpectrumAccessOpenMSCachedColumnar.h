@@ -0,0 +1,110 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/FORMAT/HANDLERS/ColumnarCachedMzMLHandler.h>
+
+#include <OpenMS/OPENSWATHALGO/DATAACCESS/ISpectrumAccess.h>
+
+namespace OpenMS
+{
+
+  /**
+    @brief An implementation of the Spectrum Access interface using a memory-mapped columnar cache
+
+    This class implements the OpenSWATH Spectrum Access interface
+    (ISpectrumAccess) on top of a file written by
+    Internal::ColumnarCachedMzMLHandler. Spectra and chromatograms are read
+    directly from the memory-mapped data columns and RT / MS level / native
+    ids are taken from the offset table of the file, no separate meta data
+    file and no in-memory index creation is required.
+
+    In contrast to SpectrumAccessOpenMSCached, this implementation is
+    thread-safe and lightClone() is cheap since all copies share the same
+    mapping. Consumers that can work on the raw data columns may use
+    getHandler() to obtain zero-copy views.
+  */
+  class OPENMS_DLLAPI SpectrumAccessOpenMSCachedColumnar :
+    public OpenSwath::ISpectrumAccess
+  {
+
+public:
+
+    /**
+      @brief Constructor, maps the columnar cache file
+
+      @param filename The filename of the columnar cache
+
+      @throws Exception::FileNotFound is thrown if the file is not found
+      @throws Exception::ParseError is thrown if the file cannot be parsed
+    */
+    explicit SpectrumAccessOpenMSCachedColumnar(const String& filename);
+
+    /// Constructor from an already opened handler (shares the mapping)
+    explicit SpectrumAccessOpenMSCachedColumnar(const Internal::ColumnarCachedMzMLHandler& handler);
+
+    /// Destructor
+    ~SpectrumAccessOpenMSCachedColumnar() override;
+
+    /// Copy constructor
+    SpectrumAccessOpenMSCachedColumnar(const SpectrumAccessOpenMSCachedColumnar& rhs);
+
+    /// Light clone operator (actual data will not get copied)
+    boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const override;
+
+    OpenSwath::SpectrumPtr getSpectrumById(int id) override;
+
+    OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const override;
+
+    std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const override;
+
+    size_t getNrSpectra() const override;
+
+    OpenSwath::ChromatogramPtr getChromatogramById(int id) override;
+
+    size_t getNrChromatograms() const override;
+
+    std::string getChromatogramNativeID(int id) const override;
+
+    /// Access to the underlying handler (e.g. for zero-copy access to the data columns)
+    const Internal::ColumnarCachedMzMLHandler& getHandler() const;
+
+protected:
+
+    Internal::ColumnarCachedMzMLHandler handler_;
+  };
+
+} //end namespace
+
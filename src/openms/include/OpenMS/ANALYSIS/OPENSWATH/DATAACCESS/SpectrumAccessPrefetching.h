@@ -0,0 +1,146 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessTransforming.h>
+#include <OpenMS/CONCEPT/Types.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace OpenMS
+{
+  /**
+   * @brief A wrapper around spectrum access that reads ahead on a background thread.
+   *
+   * Chromatogram extraction iterates over all spectra of a map in order and
+   * processes each spectrum after it has been read. For on-disk data (e.g.
+   * cached mzML or sqMass), this means that extraction stalls on disk I/O and
+   * decoding for each spectrum.
+   *
+   * This wrapper reads the spectra following the last requested one on a
+   * background thread (using a light clone of the wrapped spectrum access,
+   * so that the wrapped object itself is never accessed concurrently). Spectra
+   * already read ahead are returned immediately. At most @p prefetch_size
+   * spectra are kept and, if @p memory_budget is non-zero, reading ahead
+   * pauses once the buffered spectra use more than @p memory_budget bytes.
+   *
+   * Any request outside of the read-ahead window (e.g. random access)
+   * discards the window, is served directly from the wrapped spectrum access
+   * and restarts reading ahead after the requested spectrum. Errors during
+   * reading ahead are not reported on the background thread; the affected
+   * spectrum is read again when it is requested, so that the error surfaces
+   * in the caller.
+   *
+   * @note As every object of this class owns a thread, use it for sequential
+   * access (such as chromatogram extraction) and not for random access.
+   *
+   */
+  class OPENMS_DLLAPI SpectrumAccessPrefetching :
+    public SpectrumAccessTransforming
+  {
+public:
+
+    /** @brief Constructor
+     *
+     * @param sptr The spectrum access to read from
+     * @param prefetch_size Maximal number of spectra read ahead (needs to be at least 1)
+     * @param memory_budget Maximal amount of memory (in bytes) used by the spectra read ahead (0 for no limit)
+     *
+     * @exception Exception::IllegalArgument is thrown if @p prefetch_size is zero
+    */
+    explicit SpectrumAccessPrefetching(OpenSwath::SpectrumAccessPtr sptr,
+        Size prefetch_size = 16, Size memory_budget = 0);
+
+    /// Destructor (waits for the background thread to finish its current read)
+    ~SpectrumAccessPrefetching() override;
+
+    boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const override;
+
+    OpenSwath::SpectrumPtr getSpectrumById(int id) override;
+
+    /// Maximal number of spectra read ahead
+    Size getPrefetchSize() const;
+
+    /// Maximal amount of memory (in bytes) used by the spectra read ahead (0 for no limit)
+    Size getMemoryBudget() const;
+
+private:
+
+    /// Not implemented (owns a thread)
+    SpectrumAccessPrefetching(const SpectrumAccessPrefetching&);
+    SpectrumAccessPrefetching& operator=(const SpectrumAccessPrefetching&);
+
+    /// Main loop of the background thread
+    void run_();
+
+    /// Whether the background thread should read the next spectrum (call with mutex_ locked)
+    bool canPrefetch_() const;
+
+    /// Approximate memory used by the data arrays of @p spectrum
+    static Size estimateSize_(const OpenSwath::SpectrumPtr& spectrum);
+
+    Size prefetch_size_;
+    Size memory_budget_;
+    int nr_spectra_;
+
+    /// Spectrum access used exclusively by the background thread
+    OpenSwath::SpectrumAccessPtr prefetch_sptr_;
+
+    /**@name State shared with the background thread (guarded by mutex_) */
+    //@{
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    /// Spectra read ahead (consecutive ids, in ascending order)
+    std::deque<std::pair<int, OpenSwath::SpectrumPtr> > buffer_;
+    /// Memory used by the spectra in buffer_
+    Size buffered_bytes_;
+    /// Id of the next spectrum to read ahead (-1 if reading ahead has not started yet)
+    int next_id_;
+    /// Incremented whenever the read-ahead window is discarded
+    Size generation_;
+    /// Set if reading ahead failed (no further spectra are read ahead until the window is discarded)
+    bool failed_;
+    /// Set to stop the background thread
+    bool stop_;
+    //@}
+
+    /// The background thread (started last, stopped first)
+    std::thread thread_;
+
+  };
+}
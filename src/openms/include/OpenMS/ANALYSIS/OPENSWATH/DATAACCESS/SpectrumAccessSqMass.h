@@ -52,12 +52,12 @@ namespace OpenMS
    * @brief An implementation of the Spectrum Access interface using SQL files
    *
    * The interface takes an MzMLSqliteHandler object to access spectra and
-   * chromatograms from a sqlite file (sqMass). Currently access to individual
-   * spectra and chromatograms are not supported due to large overhead of
-   * opening a DB connection and performing a single query.
-   *
-   * Instead, the users should use getAllSpectra which returns all available
-   * spectra together.
+   * chromatograms from a sqlite file (sqMass). Upon construction, the
+   * spectrum index (retention time, MS level and native id of each spectrum)
+   * is read into memory so that meta data access and retention time queries
+   * (getSpectraByRT) do not require any database access. Individual spectra
+   * are read through pre-compiled statements of the handler, while
+   * getAllSpectra reads all selected spectra in a single batch.
    *
    * The interface allows to be constructed in a way as to only provide access
    * to a subset of spectra / chromatograms by supplying a set of indices which
@@ -68,7 +68,8 @@ namespace OpenMS
    *
    * Parallel access is supported through this interface as it is read-only and
    * sqlite3 supports multiple parallel read threads as long as they use a
-   * different db connection.
+   * different db connection. Each copy (see lightClone) uses its own
+   * connection, so each thread should work on its own copy.
    *
    * Sample usage:
    *
@@ -126,10 +127,20 @@ public:
 
 private:
 
+    /// Reads the spectrum index for all spectra in sidx_ (or all spectra if sidx_ is empty)
+    void readIndex_();
+
+    /// Creates the retention time lookup table from meta_
+    void createRTIndex_();
+
     /// Access to underlying sqMass file
     OpenMS::Internal::MzMLSqliteHandler handler_;
     /// Optional subset of spectral indices
     std::vector<int> sidx_;
+    /// Spectrum index (one entry per accessible spectrum)
+    std::vector<OpenMS::Internal::MzMLSqliteHandler::SpectrumIndexEntry> meta_;
+    /// Retention time of each accessible spectrum together with its position, sorted by retention time
+    std::vector<std::pair<double, std::size_t> > rt_index_;
   };
 } //end namespace OpenMS
 
@@ -8,7 +8,9 @@ MRMFeatureAccessOpenMS.h
 SimpleOpenMSSpectraAccessFactory.h
 SpectrumAccessOpenMS.h
 SpectrumAccessOpenMSCached.h
+SpectrumAccessOpenMSCachedColumnar.h
 SpectrumAccessOpenMSInMemory.h
+SpectrumAccessPrefetching.h
 SpectrumAccessSqMass.h
 SpectrumAccessTransforming.h
 SpectrumAccessQuadMZTransforming.h
@@ -47,6 +47,7 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMS.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessTransforming.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSInMemory.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessPrefetching.h>
 #include <OpenMS/OPENSWATHALGO/DATAACCESS/SwathMap.h>
 
 // Helpers
@@ -101,6 +102,24 @@ namespace OpenMS
     public ProgressLogger
   {
 
+public:
+
+    /** @brief Read spectra ahead in the background during chromatogram extraction
+     *
+     *  If non-zero, chromatograms are extracted from SWATH maps that are not
+     *  loaded into memory through a SpectrumAccessPrefetching wrapper that
+     *  reads up to @p prefetch_size spectra ahead. This is useful for on-disk
+     *  data (e.g. cached mzML), where extraction would otherwise wait for disk
+     *  access for every spectrum.
+     *
+     *  @param prefetch_size Number of spectra to read ahead (0 disables reading ahead, which is the default)
+     *
+     **/
+    void setPrefetchSize(Size prefetch_size)
+    {
+      prefetch_size_ = prefetch_size;
+    }
+
 protected:
 
     /** @brief Default constructor
@@ -111,26 +130,23 @@ protected:
     OpenSwathWorkflowBase() :
       use_ms1_traces_(false),
       use_ms1_ion_mobility_(false),
-      threads_outer_loop_(-1)
+      threads_outer_loop_(-1),
+      prefetch_size_(0)
     {
     }
 
     /** @brief Constructor
      *
      *  @param use_ms1_traces Whether to use MS1 data
-     *  @param threads_outer_loop How many threads should be used for the outer
-     *  loop (-1 will use all threads in the outer loop)
-     *
-     *  @note The total number of threads should be divisible by this number
-     *  (e.g. use 8 in outer loop if you have 24 threads in total and 3 will be
-     *  used for the inner loop).
-     *
+     *  @param threads_outer_loop How many SWATH windows should be processed
+     *  (and held in memory) at once (-1 will not limit the number of windows)
      *
      **/
     OpenSwathWorkflowBase(bool use_ms1_traces, bool use_ms1_ion_mobility, int threads_outer_loop) :
       use_ms1_traces_(use_ms1_traces),
       use_ms1_ion_mobility_(use_ms1_ion_mobility),
-      threads_outer_loop_(threads_outer_loop)
+      threads_outer_loop_(threads_outer_loop),
+      prefetch_size_(0)
     {
     }
 
@@ -198,17 +214,23 @@ protected:
     /// Whether to use ion mobility extraction on MS1 traces
     bool use_ms1_ion_mobility_;
 
-    /** @brief How many threads should be used for the outer loop
+    /** @brief How many SWATH windows should be processed at once
      *
-     *  @note A value of -1 will use all threads in the outer loop
+     *  All threads work on batches of the currently open SWATH windows; this
+     *  limits how many windows are open (and, if loaded into memory, held in
+     *  memory) at the same time.
      *
-     *  @note The total number of threads should be divisible by this number
-     *  (e.g. use 8 in outer loop if you have 24 threads in total and 3 will be
-     *  used for the inner loop).
+     *  @note A value of -1 (or 0) will not limit the number of open windows
      *
      **/
     int threads_outer_loop_;
 
+    /// Number of spectra to read ahead during chromatogram extraction (0 to disable)
+    Size prefetch_size_;
+
+    /// Returns the spectrum access to extract chromatograms from @p swath_map (reading ahead if prefetch_size_ is set)
+    OpenSwath::SpectrumAccessPtr getExtractionAccess_(const OpenSwath::SpectrumAccessPtr& swath_map) const;
+
 };
 
   /**
@@ -388,13 +410,8 @@ protected:
     /** @brief Constructor
      *
      *  @param use_ms1_traces Whether to use MS1 data
-     *  @param threads_outer_loop How many threads should be used for the outer
-     *  loop (-1 will use all threads in the outer loop)
-     *
-     *  @note The total number of threads should be divisible by this number
-     *  (e.g. use 8 in outer loop if you have 24 threads in total and 3 will be
-     *  used for the inner loop).
-     *
+     *  @param threads_outer_loop How many SWATH windows should be processed
+     *  (and held in memory) at once (-1 will not limit the number of windows)
      *
      **/
     OpenSwathWorkflow(bool use_ms1_traces, bool use_ms1_ion_mobility, int threads_outer_loop) :
@@ -426,6 +443,12 @@ protected:
      * potentially decrease the utility of parallelization while loading data
      * into memory will increase memory usage but decrease execution time.
      *
+     * @note Each batch of each SWATH window is an independent task; idle
+     * threads pick up the next pending batch of any open window. Results are
+     * written out in (window, batch) order, independent of the number of
+     * threads. The time spent on each task is available through
+     * getTaskTimings() afterwards.
+     *
     */
     void performExtraction(const std::vector< OpenSwath::SwathMap > & swath_maps,
                            const TransformationDescription trafo,
@@ -442,8 +465,29 @@ protected:
                            int ms1_isotopes,
                            bool load_into_memory);
 
+    /// Wall clock timing of a single extraction and scoring task (all times in seconds since the start of the task loop)
+    struct TaskTiming
+    {
+      Size swath_map_idx; ///< Index of the SWATH map
+      Size batch_idx; ///< Index of the batch within the SWATH map
+      Size nr_compounds; ///< Number of compounds in the batch
+      int thread; ///< Thread that executed the task
+      double start; ///< Start of the task
+      double extraction_end; ///< End of the chromatogram extraction
+      double end; ///< End of the scoring (and end of the task)
+    };
+
+    /// Returns the timings of all tasks of the last call to performExtraction() (in order of completion)
+    const std::vector<TaskTiming>& getTaskTimings() const
+    {
+      return task_timings_;
+    }
+
   protected:
 
+    /// Print a summary of task_timings_ (slowest tasks and idle time at the end of the run) to LOG_DEBUG
+    void reportTaskTimings_(int nr_threads) const;
+
 
     /** @brief Write output features and chromatograms
      *
@@ -515,6 +559,30 @@ protected:
         int nr_ms1_isotopes = 0,
         bool ms1only = false) const;
 
+    /** @brief Perform scoring on a set of chromatograms, but only prepare the output lines
+     *
+     *  Same as above, but instead of writing to @p tsv_writer and @p
+     *  osw_writer, the lines prepared by them are appended to @p
+     *  to_tsv_output and @p to_osw_output, respectively. They can then be written using
+     *  OpenSwathTSVWriter::writeLines and OpenSwathOSWWriter::writeLines.
+     *
+    */
+    void scoreAllChromatograms_(
+        const std::vector< OpenMS::MSChromatogram > & ms2_chromatograms,
+        const std::vector< OpenMS::MSChromatogram > & ms1_chromatograms,
+        const std::vector< OpenSwath::SwathMap >& swath_maps,
+        const OpenSwath::LightTargetedExperiment& transition_exp,
+        const Param& feature_finder_param,
+        TransformationDescription trafo,
+        const double rt_extraction_window,
+        FeatureMap& output,
+        OpenSwathTSVWriter & tsv_writer,
+        OpenSwathOSWWriter & osw_writer,
+        std::vector<String> & to_tsv_output,
+        std::vector<String> & to_osw_output,
+        int nr_ms1_isotopes = 0,
+        bool ms1only = false) const;
+
     /** @brief Select which compounds to analyze in the next batch (and copy to output)
      *
      * This function will select which compounds or peptides should be analyzed
@@ -547,6 +615,9 @@ protected:
       const std::vector<OpenSwath::LightTransition>& all_transitions,
       std::vector<OpenSwath::LightTransition>& output);
 
+    /// Timings of the tasks of the last call to performExtraction()
+    std::vector<TaskTiming> task_timings_;
+
   };
 
   /**
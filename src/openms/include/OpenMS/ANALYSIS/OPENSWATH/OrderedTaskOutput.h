@@ -0,0 +1,175 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CONCEPT/Types.h>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace OpenMS
+{
+
+  /**
+    @brief Writes out task results in (SWATH map, batch) order
+
+    Results that arrive out of order are kept until all previous results
+    are written. Only one thread writes at a time; threads that deliver a
+    result while another thread is writing return immediately and the
+    writing thread also writes their result (if it is next in order).
+
+    At most @p max_pending results are kept (no limit if max_pending <= 0):
+    push() blocks until the result can be kept or written. The result that
+    is next in order is never blocked (it may exceed the limit by one until
+    it is written), so the output always progresses as long as tasks are
+    handed out in order (see SwathTaskQueue).
+
+    @tparam ResultT Result type, needs to be default constructible and swappable
+
+    @see SwathTaskQueue, OpenSwathWorkflow
+  */
+  template <typename ResultT>
+  class OrderedTaskOutput
+  {
+  public:
+    /// Constructor for @p nr_maps maps, @p write is called for each result in order
+    OrderedTaskOutput(Size nr_maps, int max_pending, const std::function<void (ResultT&)>& write) :
+      write_(write),
+      nr_batches_(nr_maps, -1),
+      results_(nr_maps),
+      ready_(nr_maps),
+      current_map_(0),
+      current_batch_(0),
+      nr_pending_(0),
+      max_pending_(max_pending),
+      writing_(false)
+    {
+    }
+
+    /// Sets the number of batches of map @p map_idx (needs to be called before results of that map are pushed)
+    void setNrBatches(Size map_idx, Size nr_batches)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nr_batches_[map_idx] = nr_batches;
+        results_[map_idx].resize(nr_batches);
+        ready_[map_idx].resize(nr_batches, false);
+      }
+      write_pending_();
+    }
+
+    /// Hands over the result of batch @p batch_idx of map @p map_idx (@p result is empty afterwards)
+    void push(Size map_idx, Size batch_idx, ResultT& result)
+    {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // wait until the result is next in order or there is room to keep it
+        while (max_pending_ > 0 && nr_pending_ >= (Size)max_pending_)
+        {
+          advance_();
+          if (map_idx == current_map_ && batch_idx == current_batch_) break;
+          cv_.wait(lock);
+        }
+        std::swap(results_[map_idx][batch_idx], result);
+        ready_[map_idx][batch_idx] = true;
+        ++nr_pending_;
+      }
+      write_pending_();
+    }
+
+    /// Returns the number of results that were pushed but not written yet
+    Size getNrPending()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return nr_pending_;
+    }
+
+  private:
+    /// Moves the write position past all maps that are completely written (needs to hold mutex_)
+    void advance_()
+    {
+      while (current_map_ < nr_batches_.size() && nr_batches_[current_map_] == (SignedSize)current_batch_)
+      {
+        ++current_map_;
+        current_batch_ = 0;
+      }
+    }
+
+    void write_pending_()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (writing_) return;
+        writing_ = true;
+      }
+      while (true)
+      {
+        ResultT result;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          advance_();
+          if (current_map_ == nr_batches_.size() || nr_batches_[current_map_] < 0 || !ready_[current_map_][current_batch_])
+          {
+            writing_ = false;
+            cv_.notify_all();
+            return;
+          }
+          std::swap(result, results_[current_map_][current_batch_]);
+          ++current_batch_;
+          --nr_pending_;
+          cv_.notify_all();
+        }
+        write_(result);
+      }
+    }
+
+    std::function<void (ResultT&)> write_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<SignedSize> nr_batches_;
+    std::vector< std::vector<ResultT> > results_;
+    std::vector< std::vector<bool> > ready_;
+    Size current_map_;
+    Size current_batch_;
+    Size nr_pending_;
+    int max_pending_;
+    bool writing_;
+  };
+
+}
+
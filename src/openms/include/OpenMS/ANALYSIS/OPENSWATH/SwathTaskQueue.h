@@ -0,0 +1,111 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CONCEPT/Types.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace OpenMS
+{
+
+  /**
+    @brief Hands out (SWATH map, batch) tasks to a set of worker threads
+
+    Maps are opened (transitions selected, data loaded) in order by the
+    thread that requests the next task when no open map has pending
+    batches left. Idle threads always take the next pending batch of the
+    earliest open map, independent of which thread opened the map. At most
+    max_open maps are open at any time (no limit if max_open <= 0); threads
+    wait if this limit is reached and no batch is pending.
+
+    Batches are handed out in (map, batch) order, except that batches of a
+    later map may be handed out while an earlier map is still being opened.
+
+    All member functions are thread-safe.
+
+    @see OrderedTaskOutput, OpenSwathWorkflow
+  */
+  class OPENMS_DLLAPI SwathTaskQueue
+  {
+  public:
+    /// The action a thread should perform next
+    enum Action {OPEN_MAP, BATCH, DONE};
+
+    /// Constructor for @p nr_maps maps of which at most @p max_open are open at the same time
+    SwathTaskQueue(Size nr_maps, int max_open);
+
+    /**
+      @brief Returns the next action for the calling thread
+
+      OPEN_MAP: open map @p map_idx and report the number of batches with opened().
+      BATCH: process batch @p batch_idx of map @p map_idx and report it with finished().
+      DONE: all maps are opened and all batches are handed out.
+
+      Blocks while no action is available but other threads may still make one available.
+    */
+    Action next(Size& map_idx, Size& batch_idx);
+
+    /// Reports that map @p map_idx was opened and has @p nr_batches batches; returns true if the map is finished (no batches)
+    bool opened(Size map_idx, Size nr_batches);
+
+    /// Reports that a batch of map @p map_idx was processed; returns true if this was the last batch of the map
+    bool finished(Size map_idx);
+
+    /// Returns the number of batches of an opened map
+    Size getNrBatches(Size map_idx);
+
+  private:
+    enum State {UNOPENED, OPENING, OPEN, FINISHED};
+
+    void close_(Size map_idx);
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<State> state_;
+    std::vector<Size> nr_batches_;
+    std::vector<Size> next_batch_;
+    std::vector<Size> remaining_;
+    Size first_open_;
+    Size next_map_;
+    Size nr_open_;
+    Size nr_opening_;
+    int max_open_;
+  };
+
+}
+
@@ -25,12 +25,14 @@ set(sources_list_h
   OpenSwathTSVWriter.h
   OpenSwathOSWWriter.h
   OpenSwathWorkflow.h
+  OrderedTaskOutput.h
   PeakIntegrator.h
   PeakPickerMRM.h
   SONARScoring.h
   SwathMapMassCorrection.h
   SwathWindowLoader.h
   SwathQC.h
+  SwathTaskQueue.h
   SpectrumAddition.h
   TargetedSpectraExtractor.h
   TransitionTSVFile.h
@@ -39,21 +39,25 @@
 #include <OpenMS/KERNEL/Feature.h>
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 #include <OpenMS/ANALYSIS/MAPMATCHING/TransformationModelLowess.h>
-#include <OpenMS/DATASTRUCTURES/KDTree.h>
+#include <OpenMS/DATASTRUCTURES/StaticKDTree2D.h>
 #include <OpenMS/ANALYSIS/QUANTITATION/KDTreeFeatureNode.h>
 
 namespace OpenMS
 {
 
-/// Stores a set of features, together with a 2D tree for fast search
+/**
+  @brief Stores a set of features, together with a 2D tree for fast search
+
+  The 2D tree (on RT and m/z) is bulk-loaded by optimizeTree() (called by
+  addMaps()). Features added later on (or all features, after
+  applyTransformations()) are searched linearly until the tree is rebuilt.
+  Queries are const and can be issued from several threads at once.
+*/
 class OPENMS_DLLAPI KDTreeFeatureMaps : public DefaultParamHandler
 {
 
 public:
 
-  /// 2D tree on features
-  typedef KDTree::KDTree<2,KDTreeFeatureNode> FeatureKDTree;
-
   /// Default constructor
   KDTreeFeatureMaps() :
     DefaultParamHandler("KDTreeFeatureMaps")
@@ -117,7 +121,7 @@ public:
   /// Number of features stored
   Size size() const;
 
-  /// Number of points in the tree
+  /// Number of points that can be found by queries (i.e. all features)
   Size treeSize() const;
 
   /// Number of maps
@@ -126,13 +130,13 @@ public:
   /// Clear all data
   void clear();
 
-  /// Optimize the kD tree
+  /// (Re)build the kD tree from all features
   void optimizeTree();
 
   /// Fill @p result with indices of all features compatible (wrt. RT, m/z, map index) to the feature with @p index
   void getNeighborhood(Size index, std::vector<Size>& result_indices, double rt_tol, double mz_tol, bool mz_ppm, bool include_features_from_same_map = false, double max_pairwise_log_fc = -1.0) const;
 
-  /// Fill @p result with indices of all features within the specified boundaries
+  /// Fill @p result with indices (in ascending order) of all features within the specified boundaries
   void queryRegion(double rt_low, double rt_high, double mz_low, double mz_high, std::vector<Size>& result_indices, Size ignored_map_index = std::numeric_limits<Size>::max()) const;
 
   /// Apply RT transformations
@@ -154,8 +158,8 @@ protected:
   /// Number of maps
   Size num_maps_;
 
-  /// 2D tree on features from all input maps.
-  FeatureKDTree kd_tree_;
+  /// 2D tree (RT, m/z) on features from all input maps (built by optimizeTree())
+  StaticKDTree2D kd_tree_;
 
 };
 }
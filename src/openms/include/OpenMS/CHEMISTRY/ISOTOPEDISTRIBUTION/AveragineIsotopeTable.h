@@ -0,0 +1,144 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/IsotopeDistribution.h>
+#include <OpenMS/CONCEPT/Types.h>
+
+#include <atomic>
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Precomputed averagine isotope distributions for a range of masses
+
+    Provides the same isotope distributions as
+    CoarseIsotopePatternGenerator::estimateFromPeptideWeight, but without
+    recomputing them for every call. The averagine model estimates an
+    (integer) sum formula from the weight, so the isotope distribution only
+    changes at discrete masses. The mass range is divided into small bins;
+    for each bin the sum formula is determined at both borders and if it is
+    identical, the stored distribution is returned for any weight inside the
+    bin. For the few bins where the formula changes (and for weights outside
+    of the table), the distribution is computed directly. The results are
+    thus identical to the ones of CoarseIsotopePatternGenerator.
+
+    The table is filled lazily in blocks of bins. Once a block is computed,
+    it is never modified again, so that lookups are lock-free and the table
+    can be shared between threads (see getInstance()).
+
+    @ingroup Chemistry
+  */
+  class OPENMS_DLLAPI AveragineIsotopeTable
+  {
+public:
+
+    /// Largest number of isotopes for which getInstance() provides a shared table
+    static const Size MAX_SHARED_ISOTOPES = 100;
+
+    /**
+      @brief Constructor
+
+      @param max_isotope Number of isotopes per distribution (see CoarseIsotopePatternGenerator::setMaxIsotope)
+      @param max_mass Largest weight covered by the table (larger weights are computed directly)
+      @param bin_width Width of a bin in Da (should be well below 1 Da)
+    */
+    explicit AveragineIsotopeTable(Size max_isotope, double max_mass = 10000.0, double bin_width = 0.02);
+
+    /// Destructor
+    ~AveragineIsotopeTable();
+
+    /**
+      @brief Returns the shared table for @p max_isotope isotopes (created on first use)
+
+      Thread-safe; the returned table is valid until the end of the program.
+
+      @exception Exception::InvalidValue is thrown if @p max_isotope is larger than MAX_SHARED_ISOTOPES
+    */
+    static const AveragineIsotopeTable& getInstance(Size max_isotope);
+
+    /**
+      @brief Shortcut for getInstance(max_isotope).estimateFromPeptideWeight(average_weight)
+
+      Falls back to CoarseIsotopePatternGenerator for more than MAX_SHARED_ISOTOPES isotopes.
+    */
+    static IsotopeDistribution estimateFromPeptideWeight(double average_weight, Size max_isotope);
+
+    /// Returns the averagine isotope distribution for @p average_weight (identical to CoarseIsotopePatternGenerator(max_isotope).estimateFromPeptideWeight(average_weight))
+    IsotopeDistribution estimateFromPeptideWeight(double average_weight) const;
+
+    /// Returns the number of isotopes per distribution
+    Size getMaxIsotope() const;
+
+    /// Returns the largest weight covered by the table
+    double getMaxMass() const;
+
+    /// Returns the bin width in Da
+    double getBinWidth() const;
+
+private:
+
+    /// Distributions of a block of consecutive bins
+    struct Block
+    {
+      /// Index into distributions for each bin (-1 if the sum formula changes inside the bin)
+      std::vector<Int> distribution_index;
+      /// Distinct distributions of this block
+      std::vector<IsotopeDistribution> distributions;
+    };
+
+    /// Computes the distribution directly
+    IsotopeDistribution compute_(double average_weight) const;
+
+    /// Returns block @p block_idx (computing it if necessary)
+    const Block& getBlock_(Size block_idx) const;
+
+    /// Number of bins per block
+    static const Size BLOCK_SIZE = 64;
+
+    Size max_isotope_;
+    double max_mass_;
+    double bin_width_;
+    Size nr_bins_;
+
+    /// Lazily computed blocks (nullptr if not yet computed)
+    mutable std::vector<std::atomic<const Block*> > blocks_;
+
+    /// not implemented
+    AveragineIsotopeTable(const AveragineIsotopeTable&);
+    AveragineIsotopeTable& operator=(const AveragineIsotopeTable&);
+  };
+}
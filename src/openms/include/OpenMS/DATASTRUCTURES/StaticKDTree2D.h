@@ -0,0 +1,123 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CONCEPT/Types.h>
+
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+      @brief Static, array-backed 2D tree for rectangular range queries
+
+      The tree is bulk-loaded once from a set of points (e.g. RT and m/z of
+      features) and cannot be modified afterwards (except by rebuilding it).
+      It has an implicit layout: the points are permuted such that the median
+      (in the splitting dimension) of every subrange is stored in its middle,
+      so no nodes or pointers are needed. Small subranges are stored as
+      buckets that are scanned linearly. The coordinates are stored in two
+      separate contiguous arrays.
+
+      All queries are const and can be issued from several threads at once.
+      Query regions are closed intervals in both dimensions.
+
+      @ingroup Datastructures
+  */
+  class OPENMS_DLLAPI StaticKDTree2D
+  {
+  public:
+
+    /// an axis-parallel query region (closed intervals)
+    struct Region
+    {
+      double x_low;
+      double x_high;
+      double y_low;
+      double y_high;
+    };
+
+    /// Default constructor (empty tree)
+    StaticKDTree2D();
+
+    /**
+      @brief Builds the tree from the points (@p x[i], @p y[i])
+
+      Replaces any previous content. Queries report the position @p i of the
+      points in the input vectors.
+
+      @exception Exception::InvalidSize is thrown if @p x and @p y differ in size
+    */
+    void build(const std::vector<double>& x, const std::vector<double>& y);
+
+    /// Removes all points
+    void clear();
+
+    /// Number of points
+    Size size() const;
+
+    /// Returns true if the tree contains no points
+    bool empty() const;
+
+    /// Appends the indices of all points within the given region to @p result (in no particular order)
+    void queryRegion(double x_low, double x_high, double y_low, double y_high, std::vector<Size>& result) const;
+
+    /**
+      @brief Queries several regions at once (in parallel if OpenMP is enabled)
+
+      @p results is resized to the number of regions and results[i] holds
+      the indices of all points within regions[i] (in no particular order).
+    */
+    void queryRegions(const std::vector<Region>& regions, std::vector<std::vector<Size> >& results) const;
+
+  protected:
+
+    /// Recursively arranges the points of [begin, end) (split at the median in dimension @p dim)
+    void build_(std::vector<Size>& order, Size begin, Size end, Size dim, const std::vector<double>& x, const std::vector<double>& y);
+
+    /// Maximal number of points that are stored in a bucket (and scanned linearly)
+    static const Size bucket_size_;
+
+    /// x coordinates (in tree order)
+    std::vector<double> x_;
+
+    /// y coordinates (in tree order)
+    std::vector<double> y_;
+
+    /// original index of each point (in tree order)
+    std::vector<Size> index_;
+  };
+
+} // namespace OpenMS
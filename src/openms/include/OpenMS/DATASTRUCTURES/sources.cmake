@@ -36,6 +36,7 @@ Matrix.h
 Param.h
 QTCluster.h
 SeqanIncludeWrapper.h
+StaticKDTree2D.h
 String.h
 StringUtils.h
 StringListUtils.h
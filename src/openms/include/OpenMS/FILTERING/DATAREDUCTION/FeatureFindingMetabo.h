@@ -76,6 +76,9 @@ public:
 
     std::vector<String> getLabels() const;
 
+    /// mass traces of the isotopic pattern (monoisotopic trace first)
+    const std::vector<const MassTrace*>& getMassTraces() const;
+
     double getScore() const;
 
     void setScore(const double& score);
@@ -263,6 +266,8 @@ e conditions are fulfilled. Mainly the
      * is assumed that candidates[0] is the monoisotopic trace.
      *
      * The resulting possible groupings are appended to output_hypotheses.
+     * Access to output_hypotheses is not synchronized, so each thread has to
+     * pass its own vector.
     */
     void findLocalFeatures_(const std::vector<const MassTrace*>& candidates, const double total_intensity, std::vector<FeatureHypothesis>& output_hypotheses) const;
 
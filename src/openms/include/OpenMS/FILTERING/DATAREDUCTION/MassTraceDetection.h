@@ -39,9 +39,11 @@
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 #include <OpenMS/CONCEPT/ProgressLogger.h>
+#include <OpenMS/INTERFACES/IMSDataConsumer.h>
 
 namespace OpenMS
 {
+  class OnDiscMSExperiment;
 
   /**
     @brief A mass trace extraction method that gathers peaks similar in m/z and moving along retention time.
@@ -65,6 +67,14 @@ namespace OpenMS
     length as well as having the minimal sample rate criterion fulfilled) get
     added to the result.
 
+    Besides the in-memory run() on a @ref MSExperiment, spectra can be streamed
+    through a MassTraceDetection::Consumer (or from an @ref OnDiscMSExperiment).
+    In streaming mode only a sliding window of filtered MS1 spectra is held in
+    memory: apices are processed in blocks of @p streaming_block_size spectra
+    and traces may extend @p streaming_block_overlap spectra beyond their
+    block. If the whole run fits into a single block, the result is identical
+    to the in-memory run.
+
     @htmlinclude OpenMS_MassTraceDetection.parameters
 
     @ingroup Quantitation
@@ -95,6 +105,19 @@ public:
     /// Invokes the run method (see above) on merely a subregion of a @ref MSExperiment map.
     void run(PeakMap::ConstAreaIterator & begin, PeakMap::ConstAreaIterator & end, std::vector<MassTrace> & found_masstraces);
 
+    /**
+      @brief Streaming variant of run() that reads one spectrum at a time from disk.
+
+      Only MS1 spectra are loaded; the meta data of @p input_exp must be available
+      (i.e. the file must not have been opened with skipMetaData).
+
+      @exception Exception::Precondition if the meta data of @p input_exp is missing
+      @exception Exception::InvalidValue if there are less than three MS1 spectra
+    */
+    void run(OnDiscMSExperiment & input_exp, std::vector<MassTrace> & found_masstraces);
+
+    class Consumer;
+
     /** @name Private methods and members 
     */
 protected:
@@ -102,14 +125,44 @@ protected:
 
 private:
 
-    typedef std::multimap<double, std::pair<Size, Size> > MapIdxSortedByInt;
-
-    /// The internal run method
-    void run_(const MapIdxSortedByInt& chrom_apices,
-              const Size peak_count, 
+    /// A potential chromatographic apex (peak @p peak_idx of the filtered scan @p scan_idx)
+    struct Apex
+    {
+      Apex(double intensity, Size scan_idx, Size peak_idx) :
+        intensity(intensity), scan_idx(scan_idx), peak_idx(peak_idx)
+      {}
+
+      /// Processing order: decreasing intensity, ties are resolved towards later scans and peaks
+      static bool precedes(const Apex& a, const Apex& b)
+      {
+        if (a.intensity != b.intensity) return a.intensity > b.intensity;
+        if (a.scan_idx != b.scan_idx) return a.scan_idx > b.scan_idx;
+        return a.peak_idx > b.peak_idx;
+      }
+
+      double intensity;
+      Size scan_idx;
+      Size peak_idx;
+    };
+
+    /// Copies the peaks of @p spectrum above the noise threshold into @p filtered and appends its potential apices (as scan @p scan_idx) to @p chrom_apices
+    void filterSpectrum_(const MSSpectrum & spectrum, Size scan_idx, MSSpectrum & filtered, std::vector<Apex> & chrom_apices) const;
+
+    /**
+      @brief The internal run method
+
+      Extends traces from @p chrom_apices (sorted by Apex::precedes) within
+      @p work_exp and appends them to @p found_masstraces. @p peak_visited
+      (indexed via @p spec_offsets) and @p trace_number are updated, so that
+      consecutive calls on overlapping windows can share them.
+    */
+    void run_(const std::vector<Apex> & chrom_apices,
               const PeakMap & work_exp,
-              const std::vector<Size>& spec_offsets,
-              std::vector<MassTrace> & found_masstraces);
+              const std::vector<Size> & spec_offsets,
+              std::vector<bool> & peak_visited,
+              Size & trace_number,
+              std::vector<MassTrace> & found_masstraces,
+              bool report_progress);
 
     // parameter stuff
     double mass_error_ppm_;
@@ -124,6 +177,64 @@ private:
     double max_trace_length_;
 
     bool reestimate_mt_sd_;
+
+    Size streaming_block_size_;
+    Size streaming_block_overlap_;
+  };
+
+  /**
+    @brief Runs mass trace detection on a stream of spectra (e.g. from MzMLFile::transform).
+
+    Non-MS1 spectra and chromatograms are ignored. Spectra have to arrive in
+    order of increasing RT; unsorted spectra are sorted by m/z on the fly. The
+    MassTraceDetection (and its parameters) must stay unchanged while the
+    consumer is in use. Detected traces are appended to the given vector, which
+    is cleared first.
+    Call finish() after the last spectrum has been consumed.
+  */
+  class OPENMS_DLLAPI MassTraceDetection::Consumer :
+    public Interfaces::IMSDataConsumer
+  {
+public:
+    Consumer(MassTraceDetection & mtd, std::vector<MassTrace> & found_masstraces);
+
+    ~Consumer() override;
+
+    void consumeSpectrum(SpectrumType & s) override;
+
+    void consumeChromatogram(ChromatogramType & /* c */) override {}
+
+    void setExpectedSize(Size /* expectedSpectra */, Size /* expectedChromatograms */) override {}
+
+    void setExperimentalSettings(const ExperimentalSettings & /* exp */) override {}
+
+    /**
+      @brief Processes the spectra still held in the window
+
+      @exception Exception::InvalidValue if less than three MS1 spectra were consumed
+    */
+    void finish();
+
+private:
+    /// Processes all pending apices before (global) scan @p core_end and drops spectra that are no longer needed
+    void processBlock_(Size core_end);
+
+    MassTraceDetection & mtd_;
+    std::vector<MassTrace> & found_masstraces_;
+
+    /// Filtered MS1 spectra of the current window
+    PeakMap window_;
+    /// First peak of each window spectrum in peak_visited_
+    std::vector<Size> spec_offsets_;
+    std::vector<bool> peak_visited_;
+    /// Apices of not yet processed spectra (with global scan indices)
+    std::vector<Apex> pending_apices_;
+    /// Global scan index of the first window spectrum
+    Size window_begin_;
+    /// Global scan index of the first spectrum whose apices are still pending
+    Size core_begin_;
+    Size spectra_count_;
+    Size trace_number_;
   };
 }
 
@@ -167,6 +167,37 @@ private:
 
     static const char encoder_[];
     static const char decoder_[];
+
+    /**
+        @brief Decodes raw Base64 characters into a byte buffer
+
+        Blocks of valid characters are decoded with SSSE3/AVX2 instructions
+        if the CPU supports them (detected at runtime), everything else
+        (padding, whitespace, tails) is handled by a scalar table lookup.
+        Characters outside of the Base64 alphabet are skipped.
+
+        @param in Pointer to the Base64 characters
+        @param length Number of characters in @p in
+        @param out Output buffer, needs room for at least ((length + 3) / 4) * 3 bytes
+
+        @return The number of bytes written to @p out
+    */
+    static Size decodeRaw_(const char * in, Size length, Byte * out);
+
+    /**
+        @brief Inflates zlib-compressed data directly into the memory of @p out
+
+        Avoids the intermediate buffers (and copies) of qUncompress.
+
+        @throw Exception::ConversionError if the data cannot be decompressed or does not fit the element size
+    */
+    template <typename ToType>
+    static void inflateInto_(const Byte * in, Size length, std::vector<ToType> & out);
+
+    /// Swaps the byte order of all elements of @p data in place
+    template <typename ToType>
+    static void swapByteOrder_(std::vector<ToType> & data);
+
     /// Decodes a Base64 string to a vector of floating point numbers
     template <typename ToType>
     static void decodeUncompressed_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out);
@@ -347,62 +378,88 @@ private:
   }
 
   template <typename ToType>
-  void Base64::decodeCompressed_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out)
+  void Base64::inflateInto_(const Byte * in, Size length, std::vector<ToType> & out)
   {
-    out.clear();
-    if (in == "") return;
-
     const Size element_size = sizeof(ToType);
 
-    String decompressed;
+    z_stream zs;
+    zs.zalloc = Z_NULL;
+    zs.zfree = Z_NULL;
+    zs.opaque = Z_NULL;
+    zs.next_in = const_cast<Bytef *>(reinterpret_cast<const Bytef *>(in));
+    zs.avail_in = (uInt) length;
+    if (inflateInit(&zs) != Z_OK)
+    {
+      throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Decompression error?");
+    }
 
-    QByteArray qt_byte_array = QByteArray::fromRawData(in.c_str(), (int) in.size());
-    QByteArray bazip = QByteArray::fromBase64(qt_byte_array);
-    QByteArray czip;
-    czip.resize(4);
-    czip[0] = (bazip.size() & 0xff000000) >> 24;
-    czip[1] = (bazip.size() & 0x00ff0000) >> 16;
-    czip[2] = (bazip.size() & 0x0000ff00) >> 8;
-    czip[3] = (bazip.size() & 0x000000ff);
-    czip += bazip;
-    QByteArray base64_uncompressed = qUncompress(czip);
+    // peak data usually compresses by a factor of 2-4, start with a generous
+    // guess and grow the output vector geometrically if needed
+    out.resize(std::max(length * 4 / element_size, Size(16)));
+    Size written = 0;
+    int zlib_error;
+    do
+    {
+      if (written == out.size() * element_size)
+      {
+        out.resize(out.size() * 2);
+      }
+      zs.next_out = reinterpret_cast<Bytef *>(&out[0]) + written;
+      zs.avail_out = (uInt) (out.size() * element_size - written);
+      zlib_error = inflate(&zs, Z_NO_FLUSH);
+      written = out.size() * element_size - zs.avail_out;
+    }
+    while (zlib_error == Z_OK);
+    inflateEnd(&zs);
 
-    if (base64_uncompressed.isEmpty())
+    if (zlib_error != Z_STREAM_END || written == 0)
     {
+      out.clear();
       throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Decompression error?");
     }
-    decompressed.resize(base64_uncompressed.size());
-
-    std::copy(base64_uncompressed.begin(), base64_uncompressed.end(), decompressed.begin());
+    if (written % element_size != 0)
+    {
+      out.clear();
+      throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Bad BufferCount?");
+    }
+    out.resize(written / element_size);
+  }
 
-    void* byte_buffer = reinterpret_cast<void *>(&decompressed[0]);
-    Size buffer_size = decompressed.size();
+  template <typename ToType>
+  void Base64::swapByteOrder_(std::vector<ToType> & data)
+  {
+    if (data.empty()) return;
 
-    const ToType * float_buffer = reinterpret_cast<const ToType *>(byte_buffer);
-    if (buffer_size % element_size != 0)
+    if (sizeof(ToType) == 4) // 32 bit
     {
-      throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Bad BufferCount?");
+      UInt32 * p = reinterpret_cast<UInt32 *>(&data[0]);
+      std::transform(p, p + data.size(), p, endianize32);
     }
-    
-    Size float_count = buffer_size / element_size;
-    
+    else // 64 bit
+    {
+      UInt64 * p = reinterpret_cast<UInt64 *>(&data[0]);
+      std::transform(p, p + data.size(), p, endianize64);
+    }
+  }
+
+  template <typename ToType>
+  void Base64::decodeCompressed_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out)
+  {
+    out.clear();
+    if (in == "") return;
+
+    // Base64 -> compressed bytes, then inflate straight into the output vector
+    std::string compressed;
+    compressed.resize((in.size() + 3) / 4 * 3);
+    Size compressed_size = decodeRaw_(in.c_str(), in.size(), reinterpret_cast<Byte *>(&compressed[0]));
+
+    inflateInto_(reinterpret_cast<const Byte *>(compressed.c_str()), compressed_size, out);
+
     // change endianness if necessary
     if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
     {
-      if (element_size == 4) // 32 bit
-      {
-        UInt32 * p = reinterpret_cast<UInt32 *>(byte_buffer);
-        std::transform(p, p + float_count, p, endianize32);
-      }
-      else // 64 bit
-      {
-        UInt64 * p = reinterpret_cast<UInt64 *>(byte_buffer);
-        std::transform(p, p + float_count, p, endianize64);
-      }
+      swapByteOrder_(out);
     }
-
-    // copy values
-    out.assign(float_buffer, float_buffer + float_count);
   }
 
   template <typename ToType>
@@ -421,103 +478,19 @@ private:
       throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Malformed base64 input, length is not a multiple of 4.");
     }
 
-    Size src_size = in.size();
-    // last one or two '=' are skipped if contained
-    int padding = 0;
-    if (in[src_size - 1] == '=') padding++;
-    if (in[src_size - 2] == '=') padding++;
-
-    src_size -= padding;
-
-    UInt a;
-    UInt b;
-
-    UInt offset = 0;
-    int inc = 1;
-    UInt written = 0;
-
     const Size element_size = sizeof(ToType);
 
-    // enough for either float or double
-    char element[8] = "\x00\x00\x00\x00\x00\x00\x00";
+    // decode directly into the memory of the output vector, incomplete
+    // trailing elements are dropped
+    out.resize((in.size() / 4 * 3) / element_size + 1);
+    Size written = decodeRaw_(in.c_str(), in.size(), reinterpret_cast<Byte *>(&out[0]));
+    out.resize(written / element_size);
 
     // Parse little endian data in big endian OpenMS (or other way round)
     if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || 
        (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
     {
-      offset = (element_size - 1);              // other endian
-      inc = -1;
-    }
-    else
-    {
-      offset = 0;
-      inc = 1;
-    }
-
-    //reserve enough space in the output vector
-    out.reserve((UInt)(std::ceil((4.0 * src_size) / 3.0) + 6.0));
-
-    // sort all read bytes correctly into a char[4] (double) or
-    // char[8] (float) and push_back when necessary.
-    for (Size i = 0; i < src_size; i += 4)
-    {
-      // decode 4 Base64-Chars to 3 Byte
-      // -------------------------------
-
-      // decode the first two chars
-      a = decoder_[(int)in[i] - 43] - 62;
-      b = decoder_[(int)in[i + 1] - 43] - 62;
-      if (i + 1 >= src_size)
-      {
-        b = 0;
-      }
-      // write first byte (6 bits from a and 2 highest bits from b)
-      element[offset] = (unsigned char) ((a << 2) | (b >> 4));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
-
-      // decode the third char
-      a = decoder_[(int)in[i + 2] - 43] - 62;
-      if (i + 2 >= src_size)
-      {
-        a = 0;
-      }
-      // write second byte (4 lowest bits from b and 4 highest bits from a)
-      element[offset] = (unsigned char) (((b & 15) << 4) | (a >> 2));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
-
-      // decode the fourth char
-      b = decoder_[(int)in[i + 3] - 43] - 62;
-      if (i + 3 >= src_size)
-      {
-        b = 0;
-      }
-      // write third byte (2 lowest bits from a and 6 bits from b)
-      element[offset] = (unsigned char) (((a & 3) << 6) | b);
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
+      swapByteOrder_(out);
     }
   }
 
@@ -0,0 +1,115 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/INTERFACES/IMSDataConsumer.h>
+
+#include <OpenMS/KERNEL/StandardTypes.h>
+
+#include <OpenMS/FORMAT/HANDLERS/ColumnarCachedMzMLHandler.h>
+
+namespace OpenMS
+{
+
+    /**
+      @brief Consumer writing MS data to a columnar cache file
+
+      Writes the data of each spectrum and chromatogram to disk as soon as it
+      is consumed (see ColumnarCachedMzMLHandler::Writer), so the data never
+      has to be held in memory completely. Only the m/z (RT) and intensity
+      values are cached, meta data is not stored (except RT, MS level and
+      native id of spectra).
+
+      The file can be accessed through ColumnarCachedMzMLHandler or
+      SpectrumAccessOpenMSCachedColumnar after the consumer was destroyed
+      (or close() was called).
+    */
+    class OPENMS_DLLAPI MSDataColumnarCachedConsumer :
+      public Interfaces::IMSDataConsumer
+    {
+      typedef MSSpectrum SpectrumType;
+      typedef MSChromatogram ChromatogramType;
+
+    public:
+
+      /**
+        @brief Constructor
+
+        Opens the output file.
+
+        @param filename The output file name to which data is written
+        @param clearData Whether to clear the spectral and chromatogram data
+        after writing (only keep meta-data)
+        @param mz_32bit Store m/z (and chromatogram RT) values in single precision
+        @param intensity_32bit Store intensity values in single precision
+      */
+      MSDataColumnarCachedConsumer(const String& filename, bool clearData = true,
+                                   bool mz_32bit = false, bool intensity_32bit = false);
+
+      /**
+        @brief Destructor
+
+        Closes the output file (if close() was not called before).
+      */
+      ~MSDataColumnarCachedConsumer() override;
+
+      /**
+        @brief Write a spectrum to the output file
+
+        @note May delete data from spectrum (if clearData is set)
+      */
+      void consumeSpectrum(SpectrumType & s) override;
+
+      /**
+        @brief Write a chromatogram to the output file
+
+        @note May delete data from chromatogram (if clearData is set)
+      */
+      void consumeChromatogram(ChromatogramType & c) override;
+
+      void setExpectedSize(Size /* expectedSpectra */, Size /* expectedChromatograms */) override {;}
+
+      void setExperimentalSettings(const ExperimentalSettings& /* exp */) override {;}
+
+      /// Write the offset table and close the file, no further data can be consumed afterwards
+      void close();
+
+    protected:
+      Internal::ColumnarCachedMzMLHandler::Writer writer_;
+      bool clearData_;
+    };
+
+} //end namespace OpenMS
+
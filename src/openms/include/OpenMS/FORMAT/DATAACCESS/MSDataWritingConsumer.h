@@ -195,6 +195,12 @@ namespace OpenMS
       */
       virtual void doCleanup_();
 
+      /// Encode (in parallel) and write all spectra collected for parallel writing
+      void writePendingSpectra_();
+
+      /// Encode (in parallel) and write all chromatograms collected for parallel writing
+      void writePendingChromatograms_();
+
     protected:
 
       /// File stream (to write mzML)
@@ -226,6 +232,10 @@ namespace OpenMS
       std::vector<std::vector< ConstDataProcessingPtr > > dps_;
       /// The dataprocessing to be added to each spectrum/chromatogram
       DataProcessingPtr additional_dataprocessing_;
+      /// Spectra waiting to be written (only used with PeakFileOptions::getParallelWriting)
+      std::vector<SpectrumType> pending_spectra_;
+      /// Chromatograms waiting to be written (only used with PeakFileOptions::getParallelWriting)
+      std::vector<ChromatogramType> pending_chromatograms_;
     };
 
     /**
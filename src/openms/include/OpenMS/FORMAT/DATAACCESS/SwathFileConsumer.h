@@ -42,12 +42,14 @@
 
 // Consumers
 #include <OpenMS/FORMAT/DATAACCESS/MSDataCachedConsumer.h>
+#include <OpenMS/FORMAT/DATAACCESS/MSDataColumnarCachedConsumer.h>
 #include <OpenMS/FORMAT/DATAACCESS/MSDataWritingConsumer.h>
 #include <OpenMS/FORMAT/DATAACCESS/MSDataTransformingConsumer.h>
 
 // Helpers
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathHelper.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCachedColumnar.h>
 
 #include <OpenMS/INTERFACES/IMSDataConsumer.h>
 #include <OpenMS/FORMAT/HANDLERS/CachedMzMLHandler.h>
@@ -155,7 +157,7 @@ public:
       if (ms1_map_)
       {
         OpenSwath::SwathMap map;
-        map.sptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(ms1_map_);
+        map.sptr = getMS1SpectrumAccess_();
         map.lower = -1;
         map.upper = -1;
         map.center = -1;
@@ -175,7 +177,7 @@ public:
       for (Size i = 0; i < swath_maps_.size(); i++)
       {
         OpenSwath::SwathMap map;
-        map.sptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(swath_maps_[i]);
+        map.sptr = getSwathSpectrumAccess_(i);
         map.lower = swath_map_boundaries_[i].lower;
         map.upper = swath_map_boundaries_[i].upper;
         map.center = swath_map_boundaries_[i].center;
@@ -303,6 +305,26 @@ protected:
      */
     virtual void ensureMapsAreFilled_() = 0;
 
+    /**
+     * @brief Data access for the MS1 map (called after ensureMapsAreFilled_)
+     *
+     * By default, accesses the data through ms1_map_ (in memory or cached).
+     */
+    virtual OpenSwath::SpectrumAccessPtr getMS1SpectrumAccess_()
+    {
+      return SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(ms1_map_);
+    }
+
+    /**
+     * @brief Data access for SWATH map @p swath_nr (called after ensureMapsAreFilled_)
+     *
+     * By default, accesses the data through swath_maps_ (in memory or cached).
+     */
+    virtual OpenSwath::SpectrumAccessPtr getSwathSpectrumAccess_(Size swath_nr)
+    {
+      return SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(swath_maps_[swath_nr]);
+    }
+
     /// A list of Swath map identifiers (lower/upper boundary and center)
     std::vector<OpenSwath::SwathMap> swath_map_boundaries_;
 
@@ -534,6 +556,100 @@ protected:
     std::vector<int> nr_ms2_spectra_;
   };
 
+  /**
+   * @brief On-disk columnar cached implementation of FullSwathFileConsumer
+   *
+   * Writes all spectra immediately to disk in a user-specified caching
+   * location using the MSDataColumnarCachedConsumer (one file per SWATH
+   * window and one for the MS1 map). The resulting maps are accessed through
+   * SpectrumAccessOpenMSCachedColumnar, which memory-maps the files and does
+   * not need any meta data files. In contrast to CachedSwathFileConsumer, no
+   * spectra (not even their meta data) are kept in memory.
+   *
+   */
+  class OPENMS_DLLAPI ColumnarCachedSwathFileConsumer :
+    public FullSwathFileConsumer
+  {
+
+public:
+    typedef PeakMap MapType;
+    typedef MapType::SpectrumType SpectrumType;
+    typedef MapType::ChromatogramType ChromatogramType;
+
+    ColumnarCachedSwathFileConsumer(const std::vector<OpenSwath::SwathMap>& known_window_boundaries,
+            const String& cachedir, const String& basename) :
+      FullSwathFileConsumer(known_window_boundaries),
+      ms1_consumer_(),
+      swath_consumers_(),
+      cachedir_(cachedir),
+      basename_(basename)
+    {}
+
+    ~ColumnarCachedSwathFileConsumer() override {}
+
+protected:
+    String getSwathFilename_(Size swath_nr) const
+    {
+      return cachedir_ + basename_ + "_" + String(swath_nr) + ".columnar.cached";
+    }
+
+    String getMS1Filename_() const
+    {
+      return cachedir_ + basename_ + "_ms1.columnar.cached";
+    }
+
+    void consumeSwathSpectrum_(MapType::SpectrumType& s, size_t swath_nr) override
+    {
+      while (swath_consumers_.size() <= swath_nr)
+      {
+        swath_consumers_.push_back(boost::shared_ptr<MSDataColumnarCachedConsumer>(
+              new MSDataColumnarCachedConsumer(getSwathFilename_(swath_consumers_.size()), true)));
+        // empty placeholder, the data is only on disk
+        swath_maps_.push_back(boost::shared_ptr<PeakMap>(new PeakMap));
+      }
+      swath_consumers_[swath_nr]->consumeSpectrum(s);
+    }
+
+    void consumeMS1Spectrum_(MapType::SpectrumType& s) override
+    {
+      if (!ms1_consumer_)
+      {
+        ms1_consumer_.reset(new MSDataColumnarCachedConsumer(getMS1Filename_(), true));
+        ms1_map_ = boost::shared_ptr<PeakMap>(new PeakMap);
+      }
+      ms1_consumer_->consumeSpectrum(s);
+    }
+
+    void ensureMapsAreFilled_() override
+    {
+      // write the offset tables, after this the files can be opened for reading
+      for (Size i = 0; i < swath_consumers_.size(); ++i)
+      {
+        swath_consumers_[i]->close();
+      }
+      if (ms1_consumer_)
+      {
+        ms1_consumer_->close();
+      }
+    }
+
+    OpenSwath::SpectrumAccessPtr getMS1SpectrumAccess_() override
+    {
+      return OpenSwath::SpectrumAccessPtr(new SpectrumAccessOpenMSCachedColumnar(getMS1Filename_()));
+    }
+
+    OpenSwath::SpectrumAccessPtr getSwathSpectrumAccess_(Size swath_nr) override
+    {
+      return OpenSwath::SpectrumAccessPtr(new SpectrumAccessOpenMSCachedColumnar(getSwathFilename_(swath_nr)));
+    }
+
+    boost::shared_ptr<MSDataColumnarCachedConsumer> ms1_consumer_;
+    std::vector<boost::shared_ptr<MSDataColumnarCachedConsumer> > swath_consumers_;
+
+    String cachedir_;
+    String basename_;
+  };
+
   /**
    * @brief On-disk mzML implementation of FullSwathFileConsumer
    *
@@ -6,6 +6,7 @@ set(sources_list_h
   CsiFingerIdMzTabWriter.h
   MSDataAggregatingConsumer.h
   MSDataCachedConsumer.h
+  MSDataColumnarCachedConsumer.h
   MSDataChainingConsumer.h
   MSDataStoringConsumer.h
   MSDataSqlConsumer.h
@@ -0,0 +1,296 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/KERNEL/StandardTypes.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <memory>
+#include <vector>
+#include <string>
+
+class QFile;
+
+namespace OpenMS
+{
+
+namespace Internal
+{
+
+  /**
+    @brief Columnar on-disk cache for spectra and chromatograms that can be memory-mapped
+
+    In contrast to the memdump format of CachedMzMLHandler (where every data
+    item has to be located by scanning the file and then read through a
+    file stream), this format stores a fixed-size header, an offset table
+    and all data arrays as contiguous columns. The whole file is
+    memory-mapped on opening, after which the raw m/z (RT) and intensity
+    columns of any spectrum (chromatogram) can be accessed directly as a
+    pointer into the mapping without any copying, seeking or parsing.
+
+    The file layout (version 1, host byte order) is:
+      - a 64 byte header (magic, version, flags, number of spectra and chromatograms, table offsets)
+      - the data columns, each starting at a 64 byte aligned offset
+      - the native ids of all spectra and chromatograms
+      - an offset table with one 48 byte entry per spectrum and per chromatogram
+        (column offsets, number of data points, RT, MS level and native id location)
+
+    Since the table is located through the header, the data can be written
+    while it is read (see Writer and MSDataColumnarCachedConsumer) and only
+    the table needs to be kept in memory until the file is closed.
+
+    Both columns are stored in double precision by default, single precision
+    can be chosen separately for m/z (RT) and intensity values when writing
+    the file. Only the two primary data arrays are stored, additional float
+    data arrays and meta data are not part of the cache (use
+    CachedMzMLHandler::writeMetadata for the latter).
+
+    All access functions are const and the mapping is shared between copies,
+    therefore multiple threads can read from the same file concurrently.
+  */
+  class OPENMS_DLLAPI ColumnarCachedMzMLHandler
+  {
+public:
+
+    /// Read-only view of a single data column inside the mapped file
+    template <typename DataType>
+    struct ColumnView
+    {
+      const DataType* data;
+      Size size;
+
+      const DataType* begin() const { return data; }
+      const DataType* end() const { return data + size; }
+      const DataType& operator[](Size i) const { return data[i]; }
+    };
+
+    /// Default constructor (no file opened)
+    ColumnarCachedMzMLHandler();
+
+    /**
+      @brief Constructor, opens and maps a columnar cache file
+
+      @throws Exception::FileNotFound is thrown if the file cannot be opened
+      @throws Exception::ParseError is thrown if the file is not a valid columnar cache
+    */
+    explicit ColumnarCachedMzMLHandler(const String& filename);
+
+    /// Copy constructor (shares the underlying mapping)
+    ColumnarCachedMzMLHandler(const ColumnarCachedMzMLHandler& rhs);
+
+    /// Assignment operator (shares the underlying mapping)
+    ColumnarCachedMzMLHandler& operator=(const ColumnarCachedMzMLHandler& rhs);
+
+    /// Destructor
+    ~ColumnarCachedMzMLHandler();
+
+    /**
+      @brief Streaming writer for the columnar cache
+
+      Data columns are written as soon as a spectrum or chromatogram is
+      added, the offset table and the header are written by close() (or
+      upon destruction).
+    */
+    class OPENMS_DLLAPI Writer
+    {
+  public:
+      /**
+        @brief Opens the output file
+
+        @param filename The output file
+        @param mz_32bit Store m/z (and chromatogram RT) values in single precision
+        @param intensity_32bit Store intensity values in single precision
+
+        @throws Exception::UnableToCreateFile is thrown if the file cannot be created
+      */
+      Writer(const String& filename, bool mz_32bit = false, bool intensity_32bit = false);
+
+      /// Destructor, closes the file if close() was not called
+      ~Writer();
+
+      /// Append the data of a spectrum
+      void addSpectrum(const MSSpectrum& spectrum);
+
+      /// Append the data of a chromatogram
+      void addChromatogram(const MSChromatogram& chromatogram);
+
+      /**
+        @brief Write native ids, offset table and header and close the file
+
+        @throws Exception::UnableToCreateFile is thrown if writing failed
+      */
+      void close();
+
+  private:
+      struct Impl;
+      std::unique_ptr<Impl> impl_;
+
+      Writer(const Writer&) = delete;
+      Writer& operator=(const Writer&) = delete;
+    };
+
+    /**
+      @brief Write all spectra and chromatograms of @p exp to a columnar cache file
+
+      @param exp The data to be written
+      @param filename The output file
+      @param mz_32bit Store m/z (and chromatogram RT) values in single precision
+      @param intensity_32bit Store intensity values in single precision
+
+      @throws Exception::UnableToCreateFile is thrown if the file cannot be written
+    */
+    static void write(const PeakMap& exp, const String& filename, bool mz_32bit = false, bool intensity_32bit = false);
+
+    /**
+      @brief Open and map a columnar cache file (closes a previously opened file)
+
+      @throws Exception::FileNotFound is thrown if the file cannot be opened
+      @throws Exception::ParseError is thrown if the file is not a valid columnar cache
+    */
+    void open(const String& filename);
+
+    /// Returns the name of the opened file
+    const String& getFilename() const;
+
+    /// Returns the number of spectra in the file
+    Size getNrSpectra() const;
+
+    /// Returns the number of chromatograms in the file
+    Size getNrChromatograms() const;
+
+    /// Whether m/z (and chromatogram RT) values are stored in single precision
+    bool hasSinglePrecisionMZ() const;
+
+    /// Whether intensity values are stored in single precision
+    bool hasSinglePrecisionIntensity() const;
+
+    /** @name Access to spectrum and chromatogram meta information stored in the offset table
+    */
+    //@{
+    Size getSpectrumSize(Size id) const;
+
+    double getSpectrumRT(Size id) const;
+
+    int getSpectrumMSLevel(Size id) const;
+
+    std::string getSpectrumNativeID(Size id) const;
+
+    Size getChromatogramSize(Size id) const;
+
+    std::string getChromatogramNativeID(Size id) const;
+    //@}
+
+    /** @name Zero-copy access to the data columns
+
+      The template argument has to match the stored precision (float or
+      double), otherwise Exception::IllegalArgument is thrown. The returned
+      views remain valid as long as any handler sharing the mapping exists.
+    */
+    //@{
+    template <typename DataType>
+    ColumnView<DataType> getSpectrumMZ(Size id) const
+    {
+      return makeView_<DataType>(column_(id, false, false, sizeof(DataType)), getSpectrumSize(id));
+    }
+
+    template <typename DataType>
+    ColumnView<DataType> getSpectrumIntensity(Size id) const
+    {
+      return makeView_<DataType>(column_(id, false, true, sizeof(DataType)), getSpectrumSize(id));
+    }
+
+    template <typename DataType>
+    ColumnView<DataType> getChromatogramRT(Size id) const
+    {
+      return makeView_<DataType>(column_(id, true, false, sizeof(DataType)), getChromatogramSize(id));
+    }
+
+    template <typename DataType>
+    ColumnView<DataType> getChromatogramIntensity(Size id) const
+    {
+      return makeView_<DataType>(column_(id, true, true, sizeof(DataType)), getChromatogramSize(id));
+    }
+    //@}
+
+    /** @name Copy the data columns into double precision vectors (independent of the stored precision)
+    */
+    //@{
+    void getSpectrumData(Size id, std::vector<double>& mz, std::vector<double>& intensity) const;
+
+    void getChromatogramData(Size id, std::vector<double>& rt, std::vector<double>& intensity) const;
+    //@}
+
+protected:
+
+    template <typename DataType>
+    static ColumnView<DataType> makeView_(const char* ptr, Size size)
+    {
+      ColumnView<DataType> view;
+      view.data = reinterpret_cast<const DataType*>(ptr);
+      view.size = size;
+      return view;
+    }
+
+    /// Pointer to the offset table entry of a spectrum or chromatogram
+    const char* entry_(Size id, bool chromatogram) const;
+
+    /// Pointer to a data column, checks that @p value_size matches the stored precision
+    const char* column_(Size id, bool chromatogram, bool intensity, Size value_size) const;
+
+    /// Copy a column into double precision
+    void copyColumn_(Size id, bool chromatogram, bool intensity, std::vector<double>& out) const;
+
+    /// Read the header and check the offset table of the mapped file
+    void readHeader_();
+
+    String filename_;
+    boost::shared_ptr<QFile> mapped_file_;
+    /// Fallback storage in case the file cannot be memory-mapped
+    boost::shared_ptr<std::vector<char> > buffer_;
+    const char* data_;
+    UInt64 data_size_;
+    UInt64 table_offset_;
+    UInt64 nr_spectra_;
+    UInt64 nr_chromatograms_;
+    UInt32 flags_;
+  };
+
+}
+}
+
@@ -45,6 +45,10 @@
 #include <string>
 #include <fstream>
 
+#include <boost/shared_ptr.hpp>
+
+class QFile;
+
 namespace OpenMS
 {
 
@@ -69,10 +73,16 @@ namespace Internal
     extracting all the offsets of the <chromatogram> and <spectrum> tags. These
     offsets are stored as members of this class as well as the offset to the <indexList> element
 
-    @note This implementation is @a not thread-safe since it keeps internally a
-    single file access pointer which it moves when accessing a specific
-    data item. The caller is responsible to ensure that access is performed
-    atomically.
+    @note By default, this implementation is @a not thread-safe since it
+    keeps internally a single file access pointer which it moves when
+    accessing a specific data item. The caller is responsible to ensure that
+    access is performed atomically.
+
+    Alternatively, the file can be memory-mapped (see setMemoryMapped()). The
+    file is then mapped once (read-only) and the offsets from the indexList
+    point directly into the mapping, so spectra and chromatograms can be
+    decoded concurrently from many threads using a single instance. Copies
+    share the mapping.
 
   */
   class OPENMS_DLLAPI IndexedMzMLHandler
@@ -93,6 +103,20 @@ namespace Internal
       bool parsing_success_;
       /// Whether to skip XML checks
       bool skip_xml_checks_;
+      /// Whether openFile should memory-map the file
+      bool use_memory_mapping_;
+      /// The memory-mapped file (shared between copies, unmapped when the last copy is gone)
+      boost::shared_ptr<QFile> mapped_file_;
+      /// Start of the mapping (nullptr if the file is not mapped)
+      const char* mapped_data_;
+      /// Size of the mapping
+      std::streamoff mapped_size_;
+
+    /// Map the file given by filename_, returns false if this is not possible
+    bool mapFile_();
+
+    /// Read the text in [startidx, endidx) from the mapping or the filestream
+    std::string readText_(std::streampos startidx, std::streampos endidx);
 
     /**
       @brief Try to parse the footer of the indexedmzML
@@ -220,6 +244,26 @@ namespace Internal
       skip_xml_checks_ = skip;
     }
 
+    /**
+      @brief Whether to memory-map the file in openFile (default: false)
+
+      Has to be set before openFile() is called. If the file cannot be mapped
+      (e.g. insufficient address space), the file stream is used instead.
+
+      @note With a memory-mapped file, all get*ById functions may be called
+      concurrently from multiple threads.
+    */
+    void setMemoryMapped(bool memory_mapped)
+    {
+      use_memory_mapping_ = memory_mapped;
+    }
+
+    /// Whether the currently opened file is memory-mapped
+    bool isMemoryMapped() const
+    {
+      return mapped_data_ != nullptr;
+    }
+
   };
 }
 }
@@ -49,6 +49,8 @@
 #include <OpenMS/FORMAT/ControlledVocabulary.h>
 #include <OpenMS/FORMAT/VALIDATORS/SemanticValidator.h>
 
+#include <future>
+
 
 //MISSING:
 // - more than one selected ion per precursor (warning if more than one)
@@ -209,6 +211,19 @@ protected:
 
       typedef MzMLHandlerHelper::BinaryData BinaryData;
 
+      /**
+          @brief Warnings and errors found while decoding the binary data of a spectrum or chromatogram
+
+          Decoding runs in parallel (and possibly in a background thread, see
+          PeakFileOptions::getPipelinedProcessing()), so the messages are
+          collected here and reported on the parsing thread.
+      */
+      struct DecodingDiagnostics
+      {
+        std::vector<String> warnings;
+        String error; ///< non-empty if the data could not be read
+      };
+
       /**@name Helper functions for storing data in memory
        * @anchor helper_read
        */
@@ -219,6 +234,10 @@ protected:
 
           Will populate all spectra on the current work stack with data (using
           multiple threads if available) and append them to the result.
+
+          If PeakFileOptions::getPipelinedProcessing() is set, the work stack
+          is decoded in a background thread instead and appended to the result
+          during the next call (or by flushPendingSpectra_()).
       */
       void populateSpectraWithData_();
 
@@ -227,6 +246,8 @@ protected:
 
           Will populate all chromatograms on the current work stack with data (using
           multiple threads if available) and append them to the result.
+
+          See populateSpectraWithData_() for pipelined processing.
       */
       void populateChromatogramsWithData_();
 
@@ -252,12 +273,14 @@ protected:
           @param length The input data length (number of data points)
           @param peak_file_options Will be used if only part of the data should be copied (RT, mz or intensity range)
           @param spectrum The output spectrum
+          @param diagnostics Collects warnings and errors (reported later by reportDiagnostics_())
 
       */
       void populateSpectraWithData_(std::vector<MzMLHandlerHelper::BinaryData>& input_data,
                                     Size& length,
                                     const PeakFileOptions& peak_file_options,
-                                    SpectrumType& spectrum);
+                                    SpectrumType& spectrum,
+                                    DecodingDiagnostics& diagnostics) const;
 
       /**
           @brief Fill a single chromatogram with data from input
@@ -269,12 +292,14 @@ protected:
           @param length The input data length (number of data points)
           @param peak_file_options Will be used if only part of the data should be copied (RT, mz or intensity range)
           @param chromatogram The output chromatogram
+          @param diagnostics Collects warnings and errors (reported later by reportDiagnostics_())
 
       */
       void populateChromatogramsWithData_(std::vector<MzMLHandlerHelper::BinaryData>& input_data,
                                           Size& length,
                                           const PeakFileOptions& peak_file_options,
-                                          ChromatogramType& inp_chromatogram);
+                                          ChromatogramType& inp_chromatogram,
+                                          DecodingDiagnostics& diagnostics) const;
 
       /// Fills the current chromatogram with data points and meta data
       void fillChromatogramData_();
@@ -323,6 +348,42 @@ protected:
                               Size chrom_idx,
                               const Internal::MzMLValidator& validator);
 
+      /**
+        @brief Write out consecutive spectra, encoding them in parallel
+
+        All spectra are serialized into separate buffers by multiple threads
+        (binary data encoding being the expensive part) and then written to
+        @p os in order while recording the offsets for the index.
+
+        @param first_idx Index of the first spectrum of @p spectra in the spectrumList
+      */
+      void writeSpectra_(std::ostream& os,
+                         const std::vector<const SpectrumType*>& spectra,
+                         Size first_idx,
+                         const Internal::MzMLValidator& validator,
+                         bool renew_native_ids,
+                         std::vector<std::vector< ConstDataProcessingPtr > >& dps);
+
+      /// Write out consecutive chromatograms, encoding them in parallel (see writeSpectra_)
+      void writeChromatograms_(std::ostream& os,
+                               const std::vector<const ChromatogramType*>& chromatograms,
+                               Size first_idx,
+                               const Internal::MzMLValidator& validator);
+
+      /// Write the <spectrum> element (without recording its offset)
+      void writeSpectrumElement_(std::ostream& os,
+                                 const SpectrumType& spec,
+                                 Size spec_idx,
+                                 const String& native_id,
+                                 const Internal::MzMLValidator& validator,
+                                 const std::vector<std::vector< ConstDataProcessingPtr > >& dps);
+
+      /// Write the <chromatogram> element (without recording its offset)
+      void writeChromatogramElement_(std::ostream& os,
+                                     const ChromatogramType& chromatogram,
+                                     Size chrom_idx,
+                                     const Internal::MzMLValidator& validator);
+
       template <typename ContainerT>
       void writeContainerData_(std::ostream& os, const PeakFileOptions& pf_options_, const ContainerT& container, String array_type);
 
@@ -457,6 +518,7 @@ protected:
         std::vector<BinaryData> data;
         Size default_array_length;
         SpectrumType spectrum;
+        DecodingDiagnostics diagnostics;
       };
 
       /// Vector of spectrum data stored for later parallel processing
@@ -474,11 +536,88 @@ protected:
         std::vector<BinaryData> data;
         Size default_array_length;
         ChromatogramType chromatogram;
+        DecodingDiagnostics diagnostics;
       };
 
       /// Vector of chromatogram data stored for later parallel processing
       std::vector<ChromatogramData> chromatogram_data_;
 
+      /// Decodes the binary data of all spectra in @p spectrum_data (using multiple threads if available)
+      void decodeSpectra_(std::vector<SpectrumData>& spectrum_data);
+
+      /// Decodes the binary data of all chromatograms in @p chromatogram_data (using multiple threads if available)
+      void decodeChromatograms_(std::vector<ChromatogramData>& chromatogram_data);
+
+      /**
+          @brief Reports the diagnostics collected while decoding (on the parsing thread)
+
+          Passes all warnings to warning() and the first error to fatalError().
+
+          @exception Exception::ParseError is thrown if the data of any item could not be read
+      */
+      template <typename DataType>
+      void reportDiagnostics_(const std::vector<DataType>& data) const
+      {
+        for (const DataType& d : data)
+        {
+          for (const String& w : d.diagnostics.warnings)
+          {
+            warning(LOAD, w);
+          }
+        }
+        for (const DataType& d : data)
+        {
+          if (!d.diagnostics.error.empty())
+          {
+            fatalError(LOAD, d.diagnostics.error);
+          }
+        }
+      }
+
+      /// Passes decoded spectra on to the consumer / experiment and clears @p spectrum_data
+      void appendSpectra_(std::vector<SpectrumData>& spectrum_data);
+
+      /// Passes decoded chromatograms on to the consumer / experiment and clears @p chromatogram_data
+      void appendChromatograms_(std::vector<ChromatogramData>& chromatogram_data);
+
+      /// Waits for the spectra decoded in the background (if any) and appends them
+      void flushPendingSpectra_();
+
+      /// Waits for the chromatograms decoded in the background (if any) and appends them
+      void flushPendingChromatograms_();
+
+      /**@name Recycling of binary data buffers
+
+          The base64 strings and decoded arrays of a binary data array are
+          large, short-lived allocations. Instead of releasing them after each
+          spectrum (which interleaves them with the long-lived peak data and
+          fragments the heap), they are handed back to a pool and reused by the
+          next binary data arrays, so that their capacity is only allocated once
+          per data pool.
+      */
+      //@{
+      /// Returns an empty BinaryData object, reusing the buffers of a recycled one if available
+      BinaryData acquireBinaryData_();
+
+      /// Resets the binary data arrays in @p data, moves them to the pool and clears @p data
+      void recycleBinaryData_(std::vector<BinaryData>& data);
+
+      /// Pool of recycled binary data arrays (only accessed from the parsing thread)
+      std::vector<BinaryData> bin_data_pool_;
+      //@}
+
+      /**@name Data pools decoded in the background (pipelined processing)
+
+          Declared after the data they operate on, so that destruction of the
+          futures (which blocks until decoding is done) happens first.
+      */
+      //@{
+      std::vector<SpectrumData> pending_spectrum_data_;
+      std::vector<ChromatogramData> pending_chromatogram_data_;
+      std::future<void> pending_spectra_;
+      std::future<void> pending_chromatograms_;
+      //@}
+
       //@}
       /**@name temporary data structures to hold written data
        *
@@ -39,6 +39,8 @@
 
 #include <OpenMS/OPENSWATHALGO/DATAACCESS/SwathMap.h>
 
+#include <map>
+
 // forward declarations
 struct sqlite3;
 struct sqlite3_stmt;
@@ -73,12 +75,38 @@ namespace OpenMS
         This class contains the internal data structures and SQL statements for
         communication with the SQLite database
 
+        For random access (readSpectra, readChromatograms with a set of
+        indices) the handler keeps a read-only connection to the database
+        open and re-uses pre-compiled SQL statements across calls. Compressed
+        data arrays are decoded in parallel (if OpenMP is enabled). Each copy
+        of the handler owns its own connection, therefore a single handler
+        object must not be used to read concurrently from multiple threads,
+        use one copy per thread instead.
+
     */
     class OPENMS_DLLAPI MzMLSqliteHandler
     {
 
 public:
 
+      /**
+          @brief Entry of the spectrum index of a sqMass file
+
+          Contains the minimal information needed to select spectra by
+          retention time or precursor isolation window without loading any
+          spectral data.
+      */
+      struct SpectrumIndexEntry
+      {
+        Int id; ///< Spectrum id (equal to the index of the spectrum in the file)
+        String native_id; ///< Native id of the spectrum
+        Int ms_level; ///< MS level of the spectrum
+        double rt; ///< Retention time of the spectrum
+        double precursor_mz; ///< Target m/z of the isolation window (0.0 if no precursor is present)
+        double isolation_lower; ///< Absolute lower bound of the isolation window
+        double isolation_upper; ///< Absolute upper bound of the isolation window
+      };
+
       /**
           @brief Constructor of sqMass file
 
@@ -86,6 +114,15 @@ public:
       */
       MzMLSqliteHandler(String filename);
 
+      /// Copy constructor (the copy opens its own database connection)
+      MzMLSqliteHandler(const MzMLSqliteHandler& rhs);
+
+      /// Assignment operator (the database connection is not shared)
+      MzMLSqliteHandler& operator=(const MzMLSqliteHandler& rhs);
+
+      /// Destructor
+      ~MzMLSqliteHandler();
+
       /**@name Functions for reading files 
        *
        * ----------------------------------- 
@@ -111,6 +148,31 @@ public:
       */
       void readSpectra(std::vector<MSSpectrum> & exp, const std::vector<int> & indices, bool meta_only = false) const;
 
+      /**
+          @brief Read the data of a set of spectra into contiguous arrays
+
+          Reads the m/z and intensity arrays of the requested spectra without
+          creating MSSpectrum objects. The data of spectrum @p indices[k] is
+          stored in the half-open range [offsets[k], offsets[k+1]) of @p mz
+          and @p intensity, @p offsets therefore has indices.size() + 1
+          entries.
+
+          @param indices The spectra to read
+          @param mz The m/z values of all requested spectra
+          @param intensity The intensity values of all requested spectra
+          @param offsets Start positions of each spectrum in @p mz and @p intensity
+
+          @throw Exception::IllegalArgument if a requested spectrum does not exist or the data is corrupt
+      */
+      void readSpectraData(const std::vector<int> & indices, std::vector<double> & mz, std::vector<double> & intensity, std::vector<Size> & offsets) const;
+
+      /**
+          @brief Read the spectrum index (id, retention time, MS level and precursor isolation window of each spectrum)
+
+          @param index The resulting index, sorted by spectrum id
+      */
+      void readSpectrumIndex(std::vector<SpectrumIndexEntry> & index) const;
+
       /**
           @brief Read an set of chromatograms (potentially restricted to a subset)
 
@@ -164,15 +226,28 @@ protected:
 
       void populateChromatogramsWithData_(sqlite3 *db, std::vector<MSChromatogram>& chromatograms) const;
 
-      void populateChromatogramsWithData_(sqlite3 *db, std::vector<MSChromatogram>& chromatograms, const std::vector<int> & indices) const;
+      void populateChromatogramsWithData_(std::vector<MSChromatogram>& chromatograms, const std::vector<int> & indices) const;
 
       void populateSpectraWithData_(sqlite3 *db, std::vector<MSSpectrum>& spectra) const;
 
-      void populateSpectraWithData_(sqlite3 *db, std::vector<MSSpectrum>& spectra, const std::vector<int> & indices) const;
+      void populateSpectraWithData_(std::vector<MSSpectrum>& spectra, const std::vector<int> & indices) const;
 
       void prepareChroms_(sqlite3 *db, std::vector<MSChromatogram>& chromatograms) const;
 
+      void prepareChroms_(std::vector<MSChromatogram>& chromatograms, const std::vector<int> & indices) const;
+
       void prepareSpectra_(sqlite3 *db, std::vector<MSSpectrum>& spectra) const;
+
+      void prepareSpectra_(std::vector<MSSpectrum>& spectra, const std::vector<int> & indices) const;
+
+      /// Returns the (lazily opened) read connection used for random access
+      sqlite3* getReadDB_() const;
+
+      /// Returns a pre-compiled statement on the read connection (compiled on first use, reset and unbound on every call)
+      sqlite3_stmt* getCachedStatement_(const std::string& sql) const;
+
+      /// Finalizes all cached statements and closes the read connection
+      void closeReadDB_() const;
       //@}
 
 public:
@@ -252,6 +327,11 @@ protected:
       double linear_abs_mass_acc_; 
       double write_full_meta_; 
       int sql_batch_size_; 
+
+      /// Read connection used for random access (owned by this object, never shared between copies)
+      mutable sqlite3* read_db_;
+      /// Pre-compiled statements on read_db_, indexed by their SQL
+      mutable std::map<std::string, sqlite3_stmt*> cached_statements_;
     };
 
 
@@ -192,6 +192,19 @@ public:
     /// Whether to write an index at the end of the file (e.g. indexedmzML file format)
     void setWriteIndex(bool write_index);
 
+    /**
+        @brief Whether spectra and chromatograms are encoded in parallel when writing
+
+        If enabled, batches of spectra and chromatograms (of size
+        getMaxDataPoolSize()) are serialized and their binary data arrays
+        encoded (base64, zlib, numpress) by multiple threads before being
+        written to the output in order. The output is identical to sequential
+        writing, at the cost of buffering one batch.
+    */
+    bool getParallelWriting() const;
+    /// Set whether spectra and chromatograms are encoded in parallel when writing
+    void setParallelWriting(bool parallel);
+
     /// Set numpress configuration options for m/z or rt dimension
     MSNumpressCoder::NumpressConfig getNumpressConfigurationMassTime() const;
     /// Get numpress configuration options for m/z or rt dimension
@@ -219,6 +232,17 @@ public:
     Size getMaxDataPoolSize() const;
     /// Set maximal size of the data pool
     void setMaxDataPoolSize(Size size);
+    /**
+        @brief Whether data pools are decoded in the background while parsing continues
+
+        If enabled, a full data pool is handed to a background thread for
+        (parallel) decoding of its binary data while the parser already fills
+        the next pool. At most one pool per data type is decoded at a time and
+        spectra/chromatograms are still passed on in file order.
+    */
+    bool getPipelinedProcessing() const;
+    /// Set whether data pools are decoded in the background while parsing continues
+    void setPipelinedProcessing(bool pipelined);
     //@}
 
     /// do these options skip spectra or chromatograms due to RT or MSLevel filters?
@@ -245,10 +269,12 @@ private:
     bool sort_chromatograms_by_rt_;
     bool fill_data_;
     bool write_index_;
+    bool parallel_writing_;
     MSNumpressCoder::NumpressConfig np_config_mz_;
     MSNumpressCoder::NumpressConfig np_config_int_;
     MSNumpressCoder::NumpressConfig np_config_fda_;
     Size maximal_data_pool_size_;
+    bool pipelined_processing_;
 
   };
 
@@ -87,7 +87,9 @@ public:
       @param [IN] file Input filename
       @param [IN] tmp Temporary directory (for cached data)
       @param [OUT] exp_meta Experimenal metadata from mzML file
-      @param [IN] readoptions How are spectra accessed after reading - tradeoff between memory usage and time (disk caching)
+      @param [IN] readoptions How are spectra accessed after reading - tradeoff between memory usage and time (disk caching):
+                  "normal" (in memory), "cache" (cached to disk), "cacheColumnar" (cached to disk in the memory-mappable
+                  columnar format, see ColumnarCachedMzMLHandler) or "split" (write one mzML file per window)
       @param [IN] plugin_consumer An intermediate custom consumer
       @return Swath maps for MS2 and MS1 (unless readoptions == split, which returns no data)
     */
@@ -112,6 +114,10 @@ protected:
     OpenSwath::SpectrumAccessPtr doCacheFile_(const String& in, const String& tmp, const String& tmp_fname,
                                               boost::shared_ptr<PeakMap > experiment_metadata);
 
+    /// Cache a file to disk in the columnar format (see ColumnarCachedMzMLHandler)
+    OpenSwath::SpectrumAccessPtr doCacheFileColumnar_(const String& in, const String& tmp, const String& tmp_fname,
+                                                      boost::shared_ptr<PeakMap > experiment_metadata);
+
     /// Only read the meta data from a file and use it to populate exp_meta
     boost::shared_ptr< PeakMap > populateMetaData_(const String& file);
 
@@ -0,0 +1,490 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg$
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/KERNEL/MSSpectrum.h>
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/Macros.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief A spectrum which stores its peaks as separate, contiguous m/z and intensity arrays.
+
+    MSSpectrum stores its peaks as an array of Peak1D structures (array of
+    structures). Algorithms which only access m/z values (e.g. binary search)
+    or only intensities (e.g. summing up intensities) have to stride over the
+    unused member and the padding of each peak, and cannot be vectorized by
+    the compiler. This class stores the same data as structure of arrays: all
+    m/z values and all intensities are stored in their own contiguous
+    std::vector which can be accessed (and exchanged without copying)
+    directly.
+
+    The value types of the m/z and the intensity array are template
+    parameters. The default (double m/z, float intensity) corresponds to the
+    precision of Peak1D, single precision m/z values halve the memory
+    bandwidth needed to search a spectrum, double precision intensities
+    correspond to OpenSwath::BinaryDataArray (see
+    OpenSwathDataAccessHelper::convertToSpectrumPtr which exchanges the
+    arrays without copying).
+
+    Searching (MZBegin, MZEnd, findNearest) and sorting (sortByPosition,
+    sortByIntensity) follow the semantics of the corresponding MSSpectrum
+    functions but use positions (indices) instead of iterators.
+
+    Only the retention time and the MS level are stored as meta data, use
+    MSSpectrum if the full meta data is needed.
+
+    @ingroup Kernel
+  */
+  template <typename MZType = double, typename IntensityType = float>
+  class ColumnarSpectrum
+  {
+public:
+
+    /// Type of the m/z values
+    typedef MZType MZValueType;
+    /// Type of the intensity values
+    typedef IntensityType IntensityValueType;
+    /// Container type of the m/z values
+    typedef std::vector<MZType> MZArrayType;
+    /// Container type of the intensity values
+    typedef std::vector<IntensityType> IntensityArrayType;
+
+    /// Default constructor
+    ColumnarSpectrum() :
+      rt_(-1.0),
+      ms_level_(1)
+    {
+    }
+
+    /// Constructor from MSSpectrum (copies the peaks, the retention time and the MS level)
+    explicit ColumnarSpectrum(const MSSpectrum& spectrum) :
+      rt_(-1.0),
+      ms_level_(1)
+    {
+      assign(spectrum);
+    }
+
+    /// Copy constructor
+    ColumnarSpectrum(const ColumnarSpectrum&) = default;
+
+    /// Move constructor
+    ColumnarSpectrum(ColumnarSpectrum&&) = default;
+
+    /// Assignment operator
+    ColumnarSpectrum& operator=(const ColumnarSpectrum&) = default;
+
+    /// Move assignment operator
+    ColumnarSpectrum& operator=(ColumnarSpectrum&&) = default;
+
+    /// Destructor
+    ~ColumnarSpectrum() = default;
+
+    /// Equality operator
+    bool operator==(const ColumnarSpectrum& rhs) const
+    {
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wfloat-equal"
+      return mz_ == rhs.mz_ &&
+             intensity_ == rhs.intensity_ &&
+             rt_ == rhs.rt_ &&
+             ms_level_ == rhs.ms_level_;
+#pragma clang diagnostic pop
+    }
+
+    /// Inequality operator
+    bool operator!=(const ColumnarSpectrum& rhs) const
+    {
+      return !(operator==(rhs));
+    }
+
+    /**
+      @name Conversion from and to MSSpectrum
+    */
+    //@{
+    /// Replaces the peaks with the peaks of @p spectrum and copies its retention time and MS level
+    void assign(const MSSpectrum& spectrum)
+    {
+      const Size n = spectrum.size();
+      mz_.resize(n);
+      intensity_.resize(n);
+      for (Size i = 0; i < n; ++i)
+      {
+        mz_[i] = static_cast<MZType>(spectrum[i].getMZ());
+        intensity_[i] = static_cast<IntensityType>(spectrum[i].getIntensity());
+      }
+      rt_ = spectrum.getRT();
+      ms_level_ = spectrum.getMSLevel();
+    }
+
+    /// Replaces the peaks of @p spectrum with the peaks stored here and sets its retention time and MS level (other meta data is not changed)
+    void copyTo(MSSpectrum& spectrum) const
+    {
+      const Size n = mz_.size();
+      spectrum.resize(n);
+      for (Size i = 0; i < n; ++i)
+      {
+        spectrum[i].setMZ(mz_[i]);
+        spectrum[i].setIntensity(intensity_[i]);
+      }
+      spectrum.setRT(rt_);
+      spectrum.setMSLevel(ms_level_);
+    }
+    //@}
+
+    /**
+      @name Peak access
+    */
+    //@{
+    /// Returns the number of peaks
+    Size size() const
+    {
+      return mz_.size();
+    }
+
+    /// Returns true if there are no peaks
+    bool empty() const
+    {
+      return mz_.empty();
+    }
+
+    /// Removes all peaks (the meta data is kept)
+    void clear()
+    {
+      mz_.clear();
+      intensity_.clear();
+    }
+
+    /// Reserves space for @p n peaks
+    void reserve(Size n)
+    {
+      mz_.reserve(n);
+      intensity_.reserve(n);
+    }
+
+    /// Resizes the spectrum to @p n peaks
+    void resize(Size n)
+    {
+      mz_.resize(n);
+      intensity_.resize(n);
+    }
+
+    /// Appends a peak
+    void push_back(MZType mz, IntensityType intensity)
+    {
+      mz_.push_back(mz);
+      intensity_.push_back(intensity);
+    }
+
+    /// Returns the m/z value of peak @p i
+    MZType getMZ(Size i) const
+    {
+      OPENMS_PRECONDITION(i < size(), "Index out of range")
+      return mz_[i];
+    }
+
+    /// Sets the m/z value of peak @p i
+    void setMZ(Size i, MZType mz)
+    {
+      OPENMS_PRECONDITION(i < size(), "Index out of range")
+      mz_[i] = mz;
+    }
+
+    /// Returns the intensity of peak @p i
+    IntensityType getIntensity(Size i) const
+    {
+      OPENMS_PRECONDITION(i < size(), "Index out of range")
+      return intensity_[i];
+    }
+
+    /// Sets the intensity of peak @p i
+    void setIntensity(Size i, IntensityType intensity)
+    {
+      OPENMS_PRECONDITION(i < size(), "Index out of range")
+      intensity_[i] = intensity;
+    }
+
+    /// Non-mutable access to the m/z array
+    const MZArrayType& getMZArray() const
+    {
+      return mz_;
+    }
+
+    /// Non-mutable access to the intensity array
+    const IntensityArrayType& getIntensityArray() const
+    {
+      return intensity_;
+    }
+
+    /// Mutable access to the m/z array (the size of the array must not be changed)
+    MZArrayType& getMZArray()
+    {
+      return mz_;
+    }
+
+    /// Mutable access to the intensity array (the size of the array must not be changed)
+    IntensityArrayType& getIntensityArray()
+    {
+      return intensity_;
+    }
+
+    /**
+      @brief Exchanges the m/z and intensity arrays with @p mz and @p intensity (without copying)
+
+      @exception Exception::IllegalArgument is thrown if the arrays differ in length
+    */
+    void swapArrays(MZArrayType& mz, IntensityArrayType& intensity)
+    {
+      if (mz.size() != intensity.size())
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+            String("m/z and intensity arrays differ in length (") + mz.size() + " vs. " + intensity.size() + ")");
+      }
+      mz_.swap(mz);
+      intensity_.swap(intensity);
+    }
+    //@}
+
+    /**
+      @name Meta data
+    */
+    //@{
+    /// Returns the retention time
+    double getRT() const
+    {
+      return rt_;
+    }
+
+    /// Sets the retention time
+    void setRT(double rt)
+    {
+      rt_ = rt;
+    }
+
+    /// Returns the MS level
+    UInt getMSLevel() const
+    {
+      return ms_level_;
+    }
+
+    /// Sets the MS level
+    void setMSLevel(UInt ms_level)
+    {
+      ms_level_ = ms_level;
+    }
+    //@}
+
+    /**
+      @name Sorting peaks
+    */
+    //@{
+    /// Returns true if the peaks are sorted by ascending m/z
+    bool isSorted() const
+    {
+      return std::is_sorted(mz_.begin(), mz_.end());
+    }
+
+    /// Sorts the peaks by ascending m/z (stable)
+    void sortByPosition()
+    {
+      if (isSorted()) return;
+
+      std::vector<Size> order(size());
+      std::iota(order.begin(), order.end(), 0);
+      const MZArrayType& mz = mz_;
+      std::stable_sort(order.begin(), order.end(), [&mz](Size a, Size b) { return mz[a] < mz[b]; });
+      applyPermutation_(order);
+    }
+
+    /**
+      @brief Sorts the peaks by intensity (stable)
+
+      @param reverse Sort by descending intensity if true (ascending otherwise)
+    */
+    void sortByIntensity(bool reverse = false)
+    {
+      std::vector<Size> order(size());
+      std::iota(order.begin(), order.end(), 0);
+      const IntensityArrayType& intensity = intensity_;
+      if (reverse)
+      {
+        std::stable_sort(order.begin(), order.end(), [&intensity](Size a, Size b) { return intensity[a] > intensity[b]; });
+      }
+      else
+      {
+        std::stable_sort(order.begin(), order.end(), [&intensity](Size a, Size b) { return intensity[a] < intensity[b]; });
+      }
+      applyPermutation_(order);
+    }
+    //@}
+
+    /**
+      @name Searching peaks
+
+      @note All searches require the peaks to be sorted by m/z (see sortByPosition).
+    */
+    //@{
+    /// Returns the position of the first peak with m/z not smaller than @p mz (size() if there is none)
+    Size MZBegin(double mz) const
+    {
+      return MZBegin(0, mz, size());
+    }
+
+    /// Returns the position of the first peak in [@p begin, @p end) with m/z not smaller than @p mz (@p end if there is none)
+    Size MZBegin(Size begin, double mz, Size end) const
+    {
+      OPENMS_PRECONDITION(begin <= end && end <= size(), "Invalid range")
+      return std::lower_bound(mz_.begin() + begin, mz_.begin() + end, mz,
+                              [](MZType a, double b) { return a < b; }) - mz_.begin();
+    }
+
+    /// Returns the position of the first peak with m/z larger than @p mz (size() if there is none)
+    Size MZEnd(double mz) const
+    {
+      return MZEnd(0, mz, size());
+    }
+
+    /// Returns the position of the first peak in [@p begin, @p end) with m/z larger than @p mz (@p end if there is none)
+    Size MZEnd(Size begin, double mz, Size end) const
+    {
+      OPENMS_PRECONDITION(begin <= end && end <= size(), "Invalid range")
+      return std::upper_bound(mz_.begin() + begin, mz_.begin() + end, mz,
+                              [](double a, MZType b) { return a < b; }) - mz_.begin();
+    }
+
+    /**
+      @brief Binary search for the peak nearest to a specific m/z
+
+      @param mz The searched for mass-to-charge ratio searched
+      @return Returns the index of the peak.
+
+      @exception Exception::Precondition is thrown if the spectrum is empty (not only in debug mode)
+    */
+    Size findNearest(double mz) const
+    {
+      // no peak => no search
+      if (empty()) throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "There must be at least one peak to determine the nearest peak!");
+
+      // search for position for inserting
+      Size i = MZBegin(mz);
+      // border cases
+      if (i == 0) return 0;
+      if (i == size()) return size() - 1;
+
+      // the peak before or the current peak are closest
+      if (std::fabs(mz_[i] - mz) < std::fabs(mz_[i - 1] - mz))
+      {
+        return i;
+      }
+      return i - 1;
+    }
+
+    /**
+      @brief Binary search for the peak nearest to a specific m/z given a +/- tolerance window in Th
+
+      @return Returns the index of the peak or -1 if no peak present in tolerance window or if spectrum is empty
+    */
+    Int findNearest(double mz, double tolerance) const
+    {
+      return findNearest(mz, tolerance, tolerance);
+    }
+
+    /**
+      @brief Search for the peak nearest to a specific m/z given two +/- tolerance windows in Th
+
+      @return Returns the index of the peak or -1 if no peak present in tolerance window or if spectrum is empty
+    */
+    Int findNearest(double mz, double tolerance_left, double tolerance_right) const
+    {
+      if (empty()) return -1;
+
+      // do a binary search for nearest peak first
+      Size i = findNearest(mz);
+      const double nearest_mz = mz_[i];
+
+      if (nearest_mz < mz)
+      {
+        if (nearest_mz >= mz - tolerance_left) return static_cast<Int>(i); // nearest peak is in left tolerance window
+        if (i == size() - 1) return -1; // we are at the last peak which is too far left
+        // There still might be a peak to the right of mz that falls in the right window
+        ++i;
+        if (mz_[i] <= mz + tolerance_right) return static_cast<Int>(i);
+      }
+      else
+      {
+        if (nearest_mz <= mz + tolerance_right) return static_cast<Int>(i); // nearest peak is in right tolerance window
+        if (i == 0) return -1; // we are at the first peak which is too far right
+        --i;
+        if (mz_[i] >= mz - tolerance_left) return static_cast<Int>(i);
+      }
+
+      // neither in the left nor the right tolerance window
+      return -1;
+    }
+    //@}
+
+protected:
+
+    /// Reorders both arrays such that the new peak i is the old peak order[i]
+    void applyPermutation_(const std::vector<Size>& order)
+    {
+      MZArrayType mz(order.size());
+      IntensityArrayType intensity(order.size());
+      for (Size i = 0; i < order.size(); ++i)
+      {
+        mz[i] = mz_[order[i]];
+        intensity[i] = intensity_[order[i]];
+      }
+      mz_.swap(mz);
+      intensity_.swap(intensity);
+    }
+
+    /// The m/z values
+    MZArrayType mz_;
+    /// The intensity values
+    IntensityArrayType intensity_;
+    /// Retention time
+    double rt_;
+    /// MS level
+    UInt ms_level_;
+  };
+
+} // namespace OpenMS
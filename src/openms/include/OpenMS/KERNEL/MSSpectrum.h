@@ -333,6 +333,50 @@ public:
     */
     Int findNearest(CoordinateType mz, CoordinateType tolerance_left, CoordinateType tolerance_right) const;
 
+    /**
+      @brief Batch search for the peaks nearest to a list of sorted m/z values
+
+      Equivalent to calling findNearest(CoordinateType) for every query, but
+      all queries are resolved in a single forward sweep over the spectrum
+      (using exponential search from the last match), which is considerably
+      faster than independent binary searches when many peaks are matched.
+
+      @param mz_queries The searched for mass-to-charge ratios (sorted ascending)
+      @param result Index of the nearest peak for each query (same length as @p mz_queries)
+
+      @note Both the spectrum and @p mz_queries must be sorted with respect to m/z! Otherwise the result is undefined.
+
+      @exception Exception::Precondition is thrown if the spectrum is empty and @p mz_queries is not
+    */
+    void findNearest(const std::vector<CoordinateType>& mz_queries, std::vector<Size>& result) const;
+
+    /**
+      @brief Batch search for the peaks nearest to a list of sorted m/z values given a +/- tolerance window
+
+      Equivalent to calling findNearest(CoordinateType, CoordinateType) for
+      every query. If @p tolerance_ppm is true, the window is computed
+      relative to each query m/z.
+
+      @param mz_queries The searched for mass-to-charge ratios (sorted ascending)
+      @param tolerance The non-negative tolerance applied to both sides of each query
+      @param tolerance_ppm Whether @p tolerance is given in ppm (true) or Th (false)
+      @param result Index of the matched peak or -1 for each query (same length as @p mz_queries)
+
+      @note Both the spectrum and @p mz_queries must be sorted with respect to m/z! Otherwise the result is undefined.
+      @note Peaks exactly on borders are considered in tolerance window.
+    */
+    void findNearest(const std::vector<CoordinateType>& mz_queries, CoordinateType tolerance, bool tolerance_ppm, std::vector<Int>& result) const;
+
+    /**
+      @brief Batch search for peak range begin
+
+      Equivalent to calling MZBegin(CoordinateType) for every query, returning
+      indices instead of iterators (size() denotes the end).
+
+      @note Both the spectrum and @p mz_queries must be sorted with respect to m/z! Otherwise the result is undefined.
+    */
+    void MZBegin(const std::vector<CoordinateType>& mz_queries, std::vector<Size>& result) const;
+
     /**
       @brief Binary search for peak range begin
 
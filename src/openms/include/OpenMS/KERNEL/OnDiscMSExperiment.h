@@ -56,14 +56,19 @@ namespace OpenMS
 
     @ingroup Kernel
 
-    @note This implementation is @a not thread-safe since it keeps internally a
-    single file access pointer which it moves when accessing a specific
-    data item. Please provide a separate copy to each thread, e.g. 
+    @note By default, this implementation is @a not thread-safe since it
+    keeps internally a single file access pointer which it moves when
+    accessing a specific data item. Please provide a separate copy to each
+    thread, e.g. 
 
     @code
     #pragma omp parallel for firstprivate(ondisc_map) 
     @endcode
 
+    If the file is opened memory-mapped (see openFile()), spectra and
+    chromatograms can be retrieved concurrently from a single (shared)
+    instance instead.
+
   */
   class OPENMS_DLLAPI OnDiscMSExperiment
   {
@@ -86,12 +91,17 @@ public:
       This tries to read the indexed mzML by parsing the index and then reading
       the meta information into memory.
 
+      @param filename The indexed mzML file
+      @param skipMetaData Do not load the meta information
+      @param memory_mapped Map the file into memory (read-only), this allows concurrent access from multiple threads
+
       @return Whether the parsing of the file was successful (if false, the
       file most likely was not an indexed mzML file)
     */
-    bool openFile(const String& filename, bool skipMetaData = false)
+    bool openFile(const String& filename, bool skipMetaData = false, bool memory_mapped = false)
     {
       filename_ = filename;
+      indexed_mzml_file_.setMemoryMapped(memory_mapped);
       indexed_mzml_file_.openFile(filename);
       if (filename != "" && !skipMetaData)
       {
@@ -221,6 +231,12 @@ public:
       return indexed_mzml_file_.getChromatogramById(id);
     }
 
+    /// Whether the opened file is memory-mapped (only then a single instance may be accessed from multiple threads)
+    bool isMemoryMapped() const
+    {
+      return indexed_mzml_file_.isMemoryMapped();
+    }
+
     ///sets whether to skip some XML checks and be fast instead
     void setSkipXMLChecks(bool skip)
     {
@@ -99,7 +99,7 @@ namespace OpenMS
 
   /// checks if an adduct (e.g.a 'M+2K-H;1+') is valid, i.e. if the losses (==negative amounts) can actually be lost by the compound given in @p db_entry.
   /// If the negative parts are present in @p db_entry, true is returned.
-  bool AdductInfo::isCompatible(EmpiricalFormula db_entry) const
+  bool AdductInfo::isCompatible(const EmpiricalFormula& db_entry) const
   {
     return db_entry.contains(ef_ * -1);
   }
@@ -556,24 +556,10 @@ namespace OpenMS
     }
 
     // Depending on ion_mode_internal_, either positive or negative adducts are used
-    std::vector<AdductInfo>::const_iterator it_s, it_e;
-    if (ion_mode == "positive")
-    {
-      it_s = pos_adducts_.begin();
-      it_e = pos_adducts_.end();
-    }
-    else if (ion_mode == "negative")
-    {
-      it_s = neg_adducts_.begin();
-      it_e = neg_adducts_.end();
-    }
-    else
-    {
-      throw Exception::InvalidParameter(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, String("Ion mode cannot be set to '") + ion_mode + "'. Must be 'positive' or 'negative'!");
-    }
+    const std::vector<AdductInfo>& adducts = getAdducts_(ion_mode);
 
     std::pair<Size, Size> hit_idx;
-    for (std::vector<AdductInfo>::const_iterator it = it_s; it != it_e; ++it)
+    for (std::vector<AdductInfo>::const_iterator it = adducts.begin(); it != adducts.end(); ++it)
     {
       if (observed_charge != 0 && (std::abs(observed_charge) != std::abs(it->getCharge())))
       { // charge of evidence and adduct must match in absolute terms (absolute, since any FeatureFinder gives only positive charges, even for negative-mode spectra)
@@ -582,88 +568,210 @@ namespace OpenMS
       }
 
       // get potential hits as indices in masskey_table
-      double neutral_mass = it->getNeutralMass(observed_mz); // calculate mass of uncharged small molecule without adduct mass
-
-      // Our database is just a set of neutral masses (i.e., without adducts)
-      // However, given is either an absolute m/z tolerance or a ppm tolerance for the observed m/z
-      // We now need an upper bound on the absolute allowed mass difference, given the above tolerance in m/z.
-      // The selected candidates then have an mass tolerance which corresponds to the user's m/z tolerance.
-      // (the other approach is to precompute m/z values for all combinations of adducts, charges and DB entries -- too much)
-      double diff_mz;
-      // check if mass error window is given in ppm or Da
-      if (mass_error_unit_ == "ppm")
-      {
-        // convert ppm to absolute m/z tolerance for the current candidate
-        diff_mz = (observed_mz / 1e6) * mass_error_value_;
-      }
-      else
-      {
-        diff_mz = mass_error_value_;
-      }
-      // convert absolute m/z diff to absolute mass diff
-      // What about the adduct?
-      // absolute mass error: the adduct itself is irrelevant here since its a constant for both the theoretical and observed mass
-      //       ppm tolerance: the diff_mz accounts for it already (heavy adducts lead to larger m/z tolerance)
-      double diff_mass = diff_mz * std::abs(it->getCharge()); // do not use observed charge (could be 0=unknown)
+      double neutral_mass, diff_mass;
+      getNeutralMassWindow_(observed_mz, *it, neutral_mass, diff_mass);
 
       searchMass_(neutral_mass, diff_mass, hit_idx);
 
       //std::cerr << ion_mode_internal_ << " adduct: " << adduct_name << ", " << adduct_mass << " Da, " << query_mass << " qm(against DB), " << charge << " q\n";
 
       // store information from query hits in AccurateMassSearchResult objects
-      for (Size i = hit_idx.first; i < hit_idx.second; ++i)
+      appendHits_(observed_mz, neutral_mass, *it, hit_idx, results);
+    }
+
+    // if result is empty, add a 'not-found' indicator if empty hits should be stored
+    appendNotFound_(observed_mz, observed_charge, results);
+
+    return;
+  }
+
+  void AccurateMassSearchEngine::queryByMZ(const std::vector<double>& observed_mzs, const std::vector<Int>& observed_charges, const String& ion_mode, std::vector<std::vector<AccurateMassSearchResult> >& results) const
+  {
+    if (!is_initialized_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "AccurateMassSearchEngine::init() was not called!");
+    }
+    if (observed_mzs.size() != observed_charges.size())
+    {
+      throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, observed_charges.size());
+    }
+
+    const std::vector<AdductInfo>& adducts = getAdducts_(ion_mode);
+
+    // same check as in searchMass_(), which is only reached if at least one adduct matches a query
+    if (mass_mappings_.empty())
+    {
+      for (Size q = 0; q < observed_charges.size(); ++q)
       {
-        // check if DB entry is compatible to the adduct
-        if (!it->isCompatible(EmpiricalFormula(mass_mappings_[i].formula)))
+        for (Size a = 0; a < adducts.size(); ++a)
         {
-          // only written if TOPP tool has --debug
-          LOG_DEBUG << "'" << mass_mappings_[i].formula << "' cannot have adduct '" << it->getName() << "'. Omitting.\n";
-          continue;
+          if (observed_charges[q] == 0 || std::abs(observed_charges[q]) == std::abs(adducts[a].getCharge()))
+          {
+            throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "There are no entries found in mass-to-ids mapping file! Aborting... ", "0");
+          }
         }
+      }
+    }
+
+    results.clear();
+    results.resize(observed_mzs.size());
 
-        // compute ppm errors
-        double db_mass = mass_mappings_[i].mass;
-        double theoretical_mz = it->getMZ(db_mass);
-        double error_ppm_mz = Math::getPPM(observed_mz, theoretical_mz); // negative values are allowed!
-
-        AccurateMassSearchResult ams_result;
-        ams_result.setObservedMZ(observed_mz);
-        ams_result.setCalculatedMZ(theoretical_mz);
-        ams_result.setQueryMass(neutral_mass);
-        ams_result.setFoundMass(db_mass);
-        ams_result.setCharge(std::abs(it->getCharge())); // use theoretical adducts charge (is always valid); native charge might be zero
-        ams_result.setMZErrorPPM(error_ppm_mz);
-        ams_result.setMatchingIndex(i);
-        ams_result.setFoundAdduct(it->getName());
-        ams_result.setEmpiricalFormula(mass_mappings_[i].formula);
-        ams_result.setMatchingHMDBids(mass_mappings_[i].massIDs);
-
-        results.push_back(ams_result);
-
-        // ams_result.outputResults();
-        // std::cout << "****************************************************" << std::endl;
+    const Size chunk_size(1024);
+    const SignedSize chunk_count((observed_mzs.size() + chunk_size - 1) / chunk_size);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (SignedSize chunk = 0; chunk < chunk_count; ++chunk)
+    {
+      const Size q_begin(chunk * chunk_size);
+      const Size q_end(std::min(q_begin + chunk_size, observed_mzs.size()));
+
+      // neutral mass windows of all (query, adduct) pairs of this chunk, in the
+      // order queryByMZ() would visit them
+      std::vector<Size> window_query, window_adduct;
+      std::vector<double> window_mass, window_lower, window_upper;
+      for (Size q = q_begin; q < q_end; ++q)
+      {
+        for (Size a = 0; a < adducts.size(); ++a)
+        {
+          if (observed_charges[q] != 0 && (std::abs(observed_charges[q]) != std::abs(adducts[a].getCharge()))) continue;
+
+          double neutral_mass, diff_mass;
+          getNeutralMassWindow_(observed_mzs[q], adducts[a], neutral_mass, diff_mass);
+          window_query.push_back(q);
+          window_adduct.push_back(a);
+          window_mass.push_back(neutral_mass);
+          window_lower.push_back(neutral_mass - diff_mass);
+          window_upper.push_back(neutral_mass + diff_mass);
+        }
       }
 
+      // sweep the windows (by increasing lower bound) over the sorted DB masses
+      std::vector<Size> order(window_lower.size());
+      for (Size w = 0; w < order.size(); ++w)
+      {
+        order[w] = w;
+      }
+      std::sort(order.begin(), order.end(), [&window_lower](Size l, Size r) { return window_lower[l] < window_lower[r]; });
+
+      std::vector<std::pair<Size, Size> > window_hits(order.size());
+      Size db_idx(0);
+      for (Size o = 0; o < order.size(); ++o)
+      {
+        const Size w = order[o];
+        // first entry equal or larger than the lower bound
+        while (db_idx < mass_mappings_.size() && mass_mappings_[db_idx].mass < window_lower[w]) ++db_idx;
+        // first entry greater than the upper bound
+        Size end_idx(db_idx);
+        while (end_idx < mass_mappings_.size() && mass_mappings_[end_idx].mass <= window_upper[w]) ++end_idx;
+        window_hits[w] = std::make_pair(db_idx, end_idx);
+      }
+
+      for (Size w = 0; w < window_hits.size(); ++w)
+      {
+        const Size q = window_query[w];
+        appendHits_(observed_mzs[q], window_mass[w], adducts[window_adduct[w]], window_hits[w], results[q]);
+      }
+      for (Size q = q_begin; q < q_end; ++q)
+      {
+        appendNotFound_(observed_mzs[q], observed_charges[q], results[q]);
+      }
     }
+  }
 
-    // if result is empty, add a 'not-found' indicator if empty hits should be stored
-    if (results.empty() && keep_unidentified_masses_)
+  const std::vector<AdductInfo>& AccurateMassSearchEngine::getAdducts_(const String& ion_mode) const
+  {
+    if (ion_mode == "positive")
     {
+      return pos_adducts_;
+    }
+    else if (ion_mode == "negative")
+    {
+      return neg_adducts_;
+    }
+    throw Exception::InvalidParameter(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, String("Ion mode cannot be set to '") + ion_mode + "'. Must be 'positive' or 'negative'!");
+  }
+
+  void AccurateMassSearchEngine::getNeutralMassWindow_(double observed_mz, const AdductInfo& adduct, double& neutral_mass, double& diff_mass) const
+  {
+    neutral_mass = adduct.getNeutralMass(observed_mz); // calculate mass of uncharged small molecule without adduct mass
+
+    // Our database is just a set of neutral masses (i.e., without adducts)
+    // However, given is either an absolute m/z tolerance or a ppm tolerance for the observed m/z
+    // We now need an upper bound on the absolute allowed mass difference, given the above tolerance in m/z.
+    // The selected candidates then have an mass tolerance which corresponds to the user's m/z tolerance.
+    // (the other approach is to precompute m/z values for all combinations of adducts, charges and DB entries -- too much)
+    double diff_mz;
+    // check if mass error window is given in ppm or Da
+    if (mass_error_unit_ == "ppm")
+    {
+      // convert ppm to absolute m/z tolerance for the current candidate
+      diff_mz = (observed_mz / 1e6) * mass_error_value_;
+    }
+    else
+    {
+      diff_mz = mass_error_value_;
+    }
+    // convert absolute m/z diff to absolute mass diff
+    // What about the adduct?
+    // absolute mass error: the adduct itself is irrelevant here since its a constant for both the theoretical and observed mass
+    //       ppm tolerance: the diff_mz accounts for it already (heavy adducts lead to larger m/z tolerance)
+    diff_mass = diff_mz * std::abs(adduct.getCharge()); // do not use observed charge (could be 0=unknown)
+  }
+
+  void AccurateMassSearchEngine::appendHits_(double observed_mz, double neutral_mass, const AdductInfo& adduct, const std::pair<Size, Size>& hit_indices, std::vector<AccurateMassSearchResult>& results) const
+  {
+    for (Size i = hit_indices.first; i < hit_indices.second; ++i)
+    {
+      // check if DB entry is compatible to the adduct
+      if (!adduct.isCompatible(mass_mappings_[i].parsed_formula))
+      {
+        // only written if TOPP tool has --debug (may be called from parallel queryByMZ())
+#ifdef _OPENMP
+#pragma omp critical (LOG_DEBUG_access)
+#endif
+        LOG_DEBUG << "'" << mass_mappings_[i].formula << "' cannot have adduct '" << adduct.getName() << "'. Omitting.\n";
+        continue;
+      }
+
+      // compute ppm errors
+      double db_mass = mass_mappings_[i].mass;
+      double theoretical_mz = adduct.getMZ(db_mass);
+      double error_ppm_mz = Math::getPPM(observed_mz, theoretical_mz); // negative values are allowed!
+
       AccurateMassSearchResult ams_result;
       ams_result.setObservedMZ(observed_mz);
-      ams_result.setCalculatedMZ(std::numeric_limits<double>::quiet_NaN());
-      ams_result.setQueryMass(std::numeric_limits<double>::quiet_NaN());
-      ams_result.setFoundMass(std::numeric_limits<double>::quiet_NaN());
-      ams_result.setCharge(observed_charge);
-      ams_result.setMZErrorPPM(std::numeric_limits<double>::quiet_NaN());
-      ams_result.setMatchingIndex(-1); // this is checked to identify 'not-found'
-      ams_result.setFoundAdduct("null");
-      ams_result.setEmpiricalFormula("");
-      ams_result.setMatchingHMDBids(std::vector<String>(1, "null"));
+      ams_result.setCalculatedMZ(theoretical_mz);
+      ams_result.setQueryMass(neutral_mass);
+      ams_result.setFoundMass(db_mass);
+      ams_result.setCharge(std::abs(adduct.getCharge())); // use theoretical adducts charge (is always valid); native charge might be zero
+      ams_result.setMZErrorPPM(error_ppm_mz);
+      ams_result.setMatchingIndex(i);
+      ams_result.setFoundAdduct(adduct.getName());
+      ams_result.setEmpiricalFormula(mass_mappings_[i].formula);
+      ams_result.setMatchingHMDBids(mass_mappings_[i].massIDs);
+
       results.push_back(ams_result);
     }
+  }
 
-    return;
+  void AccurateMassSearchEngine::appendNotFound_(double observed_mz, Int observed_charge, std::vector<AccurateMassSearchResult>& results) const
+  {
+    if (!results.empty() || !keep_unidentified_masses_) return;
+
+    AccurateMassSearchResult ams_result;
+    ams_result.setObservedMZ(observed_mz);
+    ams_result.setCalculatedMZ(std::numeric_limits<double>::quiet_NaN());
+    ams_result.setQueryMass(std::numeric_limits<double>::quiet_NaN());
+    ams_result.setFoundMass(std::numeric_limits<double>::quiet_NaN());
+    ams_result.setCharge(observed_charge);
+    ams_result.setMZErrorPPM(std::numeric_limits<double>::quiet_NaN());
+    ams_result.setMatchingIndex(-1); // this is checked to identify 'not-found'
+    ams_result.setFoundAdduct("null");
+    ams_result.setEmpiricalFormula("");
+    ams_result.setMatchingHMDBids(std::vector<String>(1, "null"));
+    results.push_back(ams_result);
   }
 
   void AccurateMassSearchEngine::queryByFeature(const Feature& feature, const Size& feature_index, const String& ion_mode, std::vector<AccurateMassSearchResult>& results) const
@@ -676,27 +784,32 @@ namespace OpenMS
     std::vector<AccurateMassSearchResult> results_part;
 
     queryByMZ(feature.getMZ(), feature.getCharge(), ion_mode, results_part);
+    setFeatureInfo_(feature, feature_index, results_part);
+
+    // append
+    results.insert(results.end(), results_part.begin(), results_part.end());
+  }
 
+  void AccurateMassSearchEngine::setFeatureInfo_(const Feature& feature, Size feature_index, std::vector<AccurateMassSearchResult>& results) const
+  {
     Size isotope_export = (Size)param_.getValue("mzTab:exportIsotopeIntensities");
 
-    for (Size hit_idx = 0; hit_idx < results_part.size(); ++hit_idx)
+    std::vector<double> mti;
+    if (isotope_export > 0 && feature.metaValueExists("masstrace_intensity"))
+    {
+      mti = feature.getMetaValue("masstrace_intensity");
+    }
+
+    for (Size hit_idx = 0; hit_idx < results.size(); ++hit_idx)
     {
-      results_part[hit_idx].setObservedRT(feature.getRT());
-      results_part[hit_idx].setSourceFeatureIndex(feature_index);
-      results_part[hit_idx].setObservedIntensity(feature.getIntensity());
+      results[hit_idx].setObservedRT(feature.getRT());
+      results[hit_idx].setSourceFeatureIndex(feature_index);
+      results[hit_idx].setObservedIntensity(feature.getIntensity());
       
-      std::vector<double> mti;
       if (isotope_export > 0)
       {
-          if (feature.metaValueExists("masstrace_intensity"))
-          {
-            mti = feature.getMetaValue("masstrace_intensity");
-          }
-        results_part[hit_idx].setMasstraceIntensities(mti);
+        results[hit_idx].setMasstraceIntensities(mti);
       }
-      
-      // append
-      results.push_back(results_part[hit_idx]);
     }
   }
 
@@ -709,10 +822,14 @@ namespace OpenMS
     results.clear();
     // get hits
     queryByMZ(cfeat.getMZ(), cfeat.getCharge(), ion_mode, results);
+    setConsensusFeatureInfo_(cfeat, cf_index, number_of_maps, results);
+  }
 
+  void AccurateMassSearchEngine::setConsensusFeatureInfo_(const ConsensusFeature& cfeat, Size cf_index, Size number_of_maps, std::vector<AccurateMassSearchResult>& results) const
+  {
     // collect meta data:
     // intensities for all maps as given in handles; 0 if no handle is present for a map
-    ConsensusFeature::HandleSetType ind_feats(cfeat.getFeatures()); // sorted by MapIndices
+    const ConsensusFeature::HandleSetType& ind_feats(cfeat.getFeatures()); // sorted by MapIndices
     ConsensusFeature::const_iterator f_it = ind_feats.begin();
     std::vector<double> tmp_f_ints;
     for (Size map_idx = 0; map_idx < number_of_maps; ++map_idx)
@@ -764,37 +881,57 @@ namespace OpenMS
       ion_mode_internal = resolveAutoMode_(fmap);
     }
 
+    // query all features at once
+    std::vector<double> query_mzs(fmap.size());
+    std::vector<Int> query_charges(fmap.size());
+    for (Size i = 0; i < fmap.size(); ++i)
+    {
+      query_mzs[i] = fmap[i].getMZ();
+      query_charges[i] = fmap[i].getCharge();
+    }
+    QueryResultsTable feature_results;
+    queryByMZ(query_mzs, query_charges, ion_mode_internal, feature_results);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)fmap.size(); ++i)
+    {
+      std::vector<AccurateMassSearchResult>& query_results = feature_results[i];
+      setFeatureInfo_(fmap[i], i, query_results);
+
+      if (query_results.empty()) continue; // cannot happen if a 'not-found' dummy was added
+
+      bool is_dummy = (query_results[0].getMatchingIndex() == (Size)-1);
+      if (iso_similarity_ && !is_dummy && 
+          fmap[i].metaValueExists("num_of_masstraces") && (Size)fmap[i].getMetaValue("num_of_masstraces") > 1)
+      { // compute isotope pattern similarities (do not take the best-scoring one, since it might have really bad ppm or other properties -- 
+        // it is impossible to decide here which one is best
+        for (Size hit_idx = 0; hit_idx < query_results.size(); ++hit_idx)
+        {
+          const EmpiricalFormula& emp_formula(mass_mappings_[query_results[hit_idx].getMatchingIndex()].parsed_formula);
+          double iso_sim(computeIsotopePatternSimilarity_(fmap[i], emp_formula));
+          query_results[hit_idx].setIsotopesSimScore(iso_sim);
+        }
+      }
+    }
+
     // map for storing overall results
     QueryResultsTable overall_results;
     Size dummy_count(0);
     for (Size i = 0; i < fmap.size(); ++i)
     {
-      std::vector<AccurateMassSearchResult> query_results;
+      std::vector<AccurateMassSearchResult>& query_results = feature_results[i];
 
       // std::cout << i << ": " << fmap[i].getMetaValue(3) << " mass: " << fmap[i].getMZ() << " num_traces: " << fmap[i].getMetaValue("num_of_masstraces") << " charge: " << fmap[i].getCharge() << std::endl;
-      queryByFeature(fmap[i], i, ion_mode_internal, query_results);
-
       if (query_results.size() == 0) continue; // cannot happen if a 'not-found' dummy was added
 
       bool is_dummy = (query_results[0].getMatchingIndex() == (Size)-1);
       if (is_dummy) ++dummy_count;
 
-      if (iso_similarity_ && !is_dummy)
+      if (iso_similarity_ && !is_dummy && !fmap[i].metaValueExists("num_of_masstraces"))
       {
-        if (!fmap[i].metaValueExists("num_of_masstraces"))
-        {
-          LOG_WARN << "Feature does not contain meta value 'num_of_masstraces'. Cannot compute isotope similarity.";
-        }
-        else if ((Size)fmap[i].getMetaValue("num_of_masstraces") > 1)
-        { // compute isotope pattern similarities (do not take the best-scoring one, since it might have really bad ppm or other properties -- 
-          // it is impossible to decide here which one is best
-          for (Size hit_idx = 0; hit_idx < query_results.size(); ++hit_idx)
-          {
-            String emp_formula(query_results[hit_idx].getFormulaString());
-            double iso_sim(computeIsotopePatternSimilarity_(fmap[i], EmpiricalFormula(emp_formula)));
-            query_results[hit_idx].setIsotopesSimScore(iso_sim);
-          }
-        }
+        LOG_WARN << "Feature does not contain meta value 'num_of_masstraces'. Cannot compute isotope similarity.";
       }
 
       // debug output
@@ -804,8 +941,9 @@ namespace OpenMS
       //        }
 
       // String feat_label(fmap[i].getMetaValue(3));
-      overall_results.push_back(query_results);
       annotate_(query_results, fmap[i]);
+      overall_results.push_back(std::vector<AccurateMassSearchResult>());
+      overall_results.back().swap(query_results);
     }
     // add dummy protein identification which is required to keep peptidehits alive during store()
     fmap.getProteinIdentifications().resize(fmap.getProteinIdentifications().size() + 1);
@@ -878,16 +1016,24 @@ namespace OpenMS
     ConsensusMap::ColumnHeaders fd_map = cmap.getColumnHeaders();
     Size num_of_maps = fd_map.size();
 
+    // query all consensus features at once
+    std::vector<double> query_mzs(cmap.size());
+    std::vector<Int> query_charges(cmap.size());
+    for (Size i = 0; i < cmap.size(); ++i)
+    {
+      query_mzs[i] = cmap[i].getMZ();
+      query_charges[i] = cmap[i].getCharge();
+    }
+
     // map for storing overall results
     QueryResultsTable overall_results;
+    queryByMZ(query_mzs, query_charges, ion_mode_internal, overall_results);
 
     for (Size i = 0; i < cmap.size(); ++i)
     {
-      std::vector<AccurateMassSearchResult> query_results;
       // std::cout << i << ": " << cmap[i].getMetaValue(3) << " mass: " << cmap[i].getMZ() << " num_traces: " << cmap[i].getMetaValue("num_of_masstraces") << " charge: " << cmap[i].getCharge() << std::endl;
-      queryByConsensusFeature(cmap[i], i, num_of_maps, ion_mode_internal, query_results);
-      annotate_(query_results, cmap[i]);
-      overall_results.push_back(query_results);
+      setConsensusFeatureInfo_(cmap[i], i, num_of_maps, overall_results[i]);
+      annotate_(overall_results[i], cmap[i]);
     }
     // add dummy protein identification which is required to keep peptidehits alive during store()
     cmap.getProteinIdentifications().resize(cmap.getProteinIdentifications().size() + 1);
@@ -1356,6 +1502,8 @@ namespace OpenMS
         {
           throw Exception::InvalidParameter(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, String("File '") + filename + "' in line " + line_count + " as '" + line + "' cannot be parsed. Found " + word_count + " entries, expected at least three!");
         }
+        // parse the formula only once (needed for every adduct compatibility check)
+        entry.parsed_formula = EmpiricalFormula(entry.formula);
         mass_mappings_.push_back(entry);
       }
     }
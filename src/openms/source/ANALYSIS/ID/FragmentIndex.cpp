@@ -0,0 +1,182 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/ID/FragmentIndex.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/KERNEL/MSSpectrum.h>
+
+#include <algorithm>
+#include <numeric>
+#include <limits>
+
+namespace OpenMS
+{
+
+  FragmentIndex::FragmentIndex(double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm) :
+    fragment_mass_tolerance_(fragment_mass_tolerance),
+    fragment_mass_tolerance_unit_ppm_(fragment_mass_tolerance_unit_ppm),
+    built_(false)
+  {
+  }
+
+  Size FragmentIndex::addCandidate(double precursor_mass, const PeakSpectrum& theo_spectrum)
+  {
+    if (built_)
+    {
+      throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Candidates can't be added after FragmentIndex::build() was called.");
+    }
+
+    if (precursor_masses_.size() >= std::numeric_limits<UInt32>::max())
+    {
+      throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Too many candidates in FragmentIndex.");
+    }
+
+    const UInt32 candidate = static_cast<UInt32>(precursor_masses_.size());
+    precursor_masses_.push_back(precursor_mass);
+
+    fragments_.reserve(fragments_.size() + theo_spectrum.size());
+    for (const Peak1D& p : theo_spectrum)
+    {
+      Fragment f;
+      f.mz = static_cast<float>(p.getMZ());
+      f.candidate = candidate;
+      fragments_.push_back(f);
+    }
+    return candidate;
+  }
+
+  void FragmentIndex::build()
+  {
+    if (built_) { return; }
+
+    // order candidates by precursor mass
+    candidate_order_.resize(precursor_masses_.size());
+    std::iota(candidate_order_.begin(), candidate_order_.end(), 0);
+    std::stable_sort(candidate_order_.begin(), candidate_order_.end(),
+      [this](Size a, Size b) { return precursor_masses_[a] < precursor_masses_[b]; });
+
+    std::vector<UInt32> internal_id(candidate_order_.size());
+    std::vector<double> sorted_masses(candidate_order_.size());
+    for (Size i = 0; i != candidate_order_.size(); ++i)
+    {
+      internal_id[candidate_order_[i]] = static_cast<UInt32>(i);
+      sorted_masses[i] = precursor_masses_[candidate_order_[i]];
+    }
+    precursor_masses_.swap(sorted_masses);
+
+    // relabel fragments and sort by m/z (candidate ids ascending within equal m/z)
+    for (Fragment& f : fragments_)
+    {
+      f.candidate = internal_id[f.candidate];
+    }
+    std::sort(fragments_.begin(), fragments_.end(),
+      [](const Fragment& a, const Fragment& b) { return a.mz < b.mz || (a.mz == b.mz && a.candidate < b.candidate); });
+    fragments_.shrink_to_fit();
+
+    built_ = true;
+  }
+
+  bool FragmentIndex::isBuilt() const
+  {
+    return built_;
+  }
+
+  void FragmentIndex::clear()
+  {
+    fragments_.clear();
+    precursor_masses_.clear();
+    candidate_order_.clear();
+    built_ = false;
+  }
+
+  Size FragmentIndex::size() const
+  {
+    return precursor_masses_.size();
+  }
+
+  Size FragmentIndex::getNumberOfFragments() const
+  {
+    return fragments_.size();
+  }
+
+  void FragmentIndex::query(const PeakSpectrum& spectrum,
+                            double precursor_mass_low,
+                            double precursor_mass_high,
+                            Size min_shared_peaks,
+                            std::vector<std::pair<Size, Size> >& hits) const
+  {
+    if (!built_)
+    {
+      throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "FragmentIndex::build() must be called before querying.");
+    }
+
+    hits.clear();
+
+    // candidates in the precursor window form a contiguous id range
+    const UInt32 first = static_cast<UInt32>(std::lower_bound(precursor_masses_.begin(), precursor_masses_.end(), precursor_mass_low) - precursor_masses_.begin());
+    const UInt32 last = static_cast<UInt32>(std::upper_bound(precursor_masses_.begin(), precursor_masses_.end(), precursor_mass_high) - precursor_masses_.begin());
+    if (first >= last) { return; }
+
+    std::vector<UInt32> shared_peaks(last - first, 0);
+
+    for (const Peak1D& p : spectrum)
+    {
+      const double mz = p.getMZ();
+      const double tolerance = fragment_mass_tolerance_unit_ppm_ ? mz * fragment_mass_tolerance_ * 1e-6 : fragment_mass_tolerance_;
+      const float low = static_cast<float>(mz - tolerance);
+      const float high = static_cast<float>(mz + tolerance);
+
+      std::vector<Fragment>::const_iterator it = std::lower_bound(fragments_.begin(), fragments_.end(), low,
+        [](const Fragment& f, float value) { return f.mz < value; });
+
+      for (; it != fragments_.end() && it->mz <= high; ++it)
+      {
+        // unsigned arithmetic: ids below first wrap around and fail the range check
+        const UInt32 offset = it->candidate - first;
+        if (offset < last - first) { ++shared_peaks[offset]; }
+      }
+    }
+
+    for (UInt32 i = 0; i != shared_peaks.size(); ++i)
+    {
+      if (shared_peaks[i] >= min_shared_peaks && shared_peaks[i] > 0)
+      {
+        hits.push_back(std::make_pair(candidate_order_[first + i], static_cast<Size>(shared_peaks[i])));
+      }
+    }
+  }
+
+} // namespace OpenMS
+
@@ -111,29 +111,56 @@ namespace OpenMS
     // keep track of assigned/unassigned precursors
     std::map<Size, Size> assigned_precursors;
 
-    // store which peptides fit which feature (and avoid double entries)
-    // consensusMap -> {peptide_index}
-    std::vector<std::set<size_t> > mapping(map.size());
-
-    DoubleList mz_values;
-    double rt_pep;
-    IntList charges;
+    // index the positions to match against (consensus centroids or
+    // subelements); every position is a degenerate box
+    std::vector<DBoundingBox<2> > positions;
+    std::vector<Size> position_to_cf;
+    for (Size cm_index = 0; cm_index < map.size(); ++cm_index)
+    {
+      if (!measure_from_subelements)
+      {
+        positions.push_back(DBoundingBox<2>(map[cm_index].getPosition(), map[cm_index].getPosition()));
+        position_to_cf.push_back(cm_index);
+      }
+      else
+      {
+        for (ConsensusFeature::HandleSetType::const_iterator it_handle = map[cm_index].getFeatures().begin();
+             it_handle != map[cm_index].getFeatures().end();
+             ++it_handle)
+        {
+          positions.push_back(DBoundingBox<2>(it_handle->getPosition(), it_handle->getPosition()));
+          position_to_cf.push_back(cm_index);
+        }
+      }
+    }
+    const BoxIndex index(positions);
 
     // for statistics
     Size id_matches_none(0), id_matches_single(0), id_matches_multiple(0);
 
-    // iterate over the peptide IDs
-    for (Size i = 0; i < ids.size(); ++i)
+    // matches of each peptide ID: (consensus feature index, map index of the
+    // matching subelement or -1); computed in parallel, applied in ID order
+    std::vector<std::vector<std::pair<Size, SignedSize> > > id_matches(ids.size());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)ids.size(); ++i)
     {
       if (ids[i].getHits().empty()) continue;
 
+      DoubleList mz_values;
+      double rt_pep;
+      IntList charges;
       getIDDetails_(ids[i], rt_pep, mz_values, charges);
 
-      bool id_mapped(false);
+      std::vector<Size> candidates = findCandidates_(index, position_to_cf, rt_pep, mz_values);
 
-      // iterate over the features
-      for (Size cm_index = 0; cm_index < map.size(); ++cm_index)
+      // iterate over the candidate features
+      for (Size c = 0; c < candidates.size(); ++c)
       {
+        const ConsensusFeature& cf = map[candidates[c]];
+
         // if set to TRUE, we leave the i_mz-loop as we added the whole ID with all hits
         bool was_added = false; // was current pep-m/z matched?!
 
@@ -162,58 +189,64 @@ namespace OpenMS
           //check if we compare distance from centroid or subelements
           if (!measure_from_subelements)
           {
-            if (isMatch_(rt_pep - map[cm_index].getRT(), mz_pep, map[cm_index].getMZ()) && (ignore_charge_ || ListUtils::contains(current_charges, map[cm_index].getCharge())))
+            if (isMatch_(rt_pep - cf.getRT(), mz_pep, cf.getMZ()) && (ignore_charge_ || ListUtils::contains(current_charges, cf.getCharge())))
             {
-              id_mapped = true;
               was_added = true;
-              map[cm_index].getPeptideIdentifications().push_back(ids[i]);
-              ++assigned_ids[i];
+              id_matches[i].push_back(std::make_pair(candidates[c], SignedSize(-1)));
             }
           }
           else
           {
-            for (ConsensusFeature::HandleSetType::const_iterator it_handle = map[cm_index].getFeatures().begin();
-                 it_handle != map[cm_index].getFeatures().end();
+            for (ConsensusFeature::HandleSetType::const_iterator it_handle = cf.getFeatures().begin();
+                 it_handle != cf.getFeatures().end();
                  ++it_handle)
             {
               if (isMatch_(rt_pep - it_handle->getRT(), mz_pep, it_handle->getMZ())  && (ignore_charge_ || ListUtils::contains(current_charges, it_handle->getCharge())))
               {
-                id_mapped = true;
                 was_added = true;
-                if (mapping[cm_index].count(i) == 0)
-                {
-                  // Store the map index of the peptide feature in the id the feature was mapped to.
-                  PeptideIdentification id_pep = ids[i];
-                  if (annotate_ids_with_subelements)
-                  {
-                    id_pep.setMetaValue("map_index", it_handle->getMapIndex());
-                  }
-                  
-                  map[cm_index].getPeptideIdentifications().push_back(id_pep);
-                  ++assigned_ids[i];
-                  mapping[cm_index].insert(i);
-                }
+                // remember the map index of the peptide feature the id was mapped to
+                id_matches[i].push_back(std::make_pair(candidates[c], SignedSize(it_handle->getMapIndex())));
                 break; // we added this peptide already.. no need to check other handles
               }
             }
-            // continue to here
           }
 
           if (was_added) break;
 
         } // m/z values to check
-
-        // break to here
-
       } // features
+    }
+
+    for (Size i = 0; i < ids.size(); ++i)
+    {
+      if (ids[i].getHits().empty()) continue;
 
       // the id has not been mapped to any consensus feature
-      if (!id_mapped)
+      if (id_matches[i].empty())
       {
         map.getUnassignedPeptideIdentifications().push_back(ids[i]);
         ++id_matches_none;
+        continue;
+      }
+
+      for (Size m = 0; m < id_matches[i].size(); ++m)
+      {
+        ConsensusFeature& cf = map[id_matches[i][m].first];
+        if (measure_from_subelements && annotate_ids_with_subelements)
+        {
+          // Store the map index of the peptide feature in the id the feature was mapped to.
+          PeptideIdentification id_pep = ids[i];
+          id_pep.setMetaValue("map_index", UInt64(id_matches[i][m].second));
+          cf.getPeptideIdentifications().push_back(id_pep);
+        }
+        else
+        {
+          cf.getPeptideIdentifications().push_back(ids[i]);
+        }
+        ++assigned_ids[i];
       }
     } // Identifications
+    std::vector<std::vector<std::pair<Size, SignedSize> > >().swap(id_matches);
 
     for (std::map<Size, Size>::const_iterator it = assigned_ids.begin(); it != assigned_ids.end(); ++it)
     {
@@ -227,7 +260,8 @@ namespace OpenMS
       }
     }
 
-    vector<Size> unidentified = mapPrecursorsToIdentifications(spectra, ids).unidentified;
+    SpectraIdentificationState id_state = mapPrecursorsToIdentifications(spectra, ids);
+    const vector<Size>& unidentified = id_state.unidentified;
 
     if (!ids.empty() && !spectra.empty())
     {
@@ -236,8 +270,8 @@ namespace OpenMS
 
       LOG_INFO << "Identification state of spectra: \n"
                << "Unidentified: " << unidentified.size() << "\n"
-               << "Identified:   " << mapPrecursorsToIdentifications(spectra, ids).identified.size() << "\n"
-               << "No precursor: " << mapPrecursorsToIdentifications(spectra, ids).no_precursors.size() << endl;
+               << "Identified:   " << id_state.identified.size() << "\n"
+               << "No precursor: " << id_state.no_precursors.size() << endl;
     }
 
     // we need a valid search run identifier so we try to:
@@ -267,76 +301,101 @@ namespace OpenMS
     Size spectrum_matches_none(0), spectrum_matches_single(0), spectrum_matches_multiple(0);
 
     // are there any mapped but unidentified precursors?
+    // (all precursors of unidentified spectra, as (spectrum index, precursor index))
+    std::vector<std::pair<Size, Size> > precursor_queries;
     for (Size ui = 0; ui != unidentified.size(); ++ui)
+    {
+      for (Size i_p = 0; i_p < spectra[unidentified[ui]].getPrecursors().size(); ++i_p)
+      {
+        precursor_queries.push_back(std::make_pair(unidentified[ui], i_p));
+      }
+    }
+
+    // matches of each precursor: (consensus feature index, map index of the matching subelement or -1)
+    std::vector<std::vector<std::pair<Size, SignedSize> > > precursor_matches(precursor_queries.size());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize q = 0; q < (SignedSize)precursor_queries.size(); ++q)
+    {
+      const MSSpectrum& spectrum = spectra[precursor_queries[q].first];
+      const Precursor& precursor = spectrum.getPrecursors()[precursor_queries[q].second];
+
+      // check by precursor mass and spectrum RT
+      double mz_p = precursor.getMZ();
+      int z_p = precursor.getCharge();
+      double rt_value = spectrum.getRT();
+
+      // charge states to use for checking:
+      IntList current_charges;
+      if (!ignore_charge_)
+      {
+        current_charges.push_back(z_p);
+        current_charges.push_back(0); // "not specified" always matches
+      }
+
+      std::vector<Size> candidates = findCandidates_(index, position_to_cf, rt_value, DoubleList(1, mz_p));
+
+      // iterate over the candidate consensus features
+      for (Size c = 0; c < candidates.size(); ++c)
+      {
+        const ConsensusFeature& cf = map[candidates[c]];
+
+        // check if we compare distance from centroid or subelements
+        if (!measure_from_subelements) // measure from centroid
+        {
+          if (isMatch_(rt_value - cf.getRT(), mz_p, cf.getMZ()) && (ignore_charge_ || ListUtils::contains(current_charges, cf.getCharge())))
+          {
+            precursor_matches[q].push_back(std::make_pair(candidates[c], SignedSize(-1)));
+          }
+        }
+        else // measure from subelements
+        {
+          for (ConsensusFeature::HandleSetType::const_iterator it_handle = cf.getFeatures().begin();
+               it_handle != cf.getFeatures().end();
+               ++it_handle)
+          {
+            if (isMatch_(rt_value - it_handle->getRT(), mz_p, it_handle->getMZ())  && (ignore_charge_ || ListUtils::contains(current_charges, it_handle->getCharge())))
+            {
+              precursor_matches[q].push_back(std::make_pair(candidates[c], SignedSize(it_handle->getMapIndex())));
+            }
+          }
+        }
+      }
+    }
+
+    for (Size ui = 0, q = 0; ui != unidentified.size(); ++ui)
     {
       Size spectrum_index = unidentified[ui];
       const MSSpectrum& spectrum = spectra[spectrum_index];
-      const vector<Precursor>& precursors = spectrum.getPrecursors();
 
       bool precursor_mapped(false);
 
-      // check if precursor has been identified
-      for (Size i_p = 0; i_p < precursors.size(); ++i_p)
+      for (Size i_p = 0; i_p < spectrum.getPrecursors().size(); ++i_p, ++q)
       {
-        // check by precursor mass and spectrum RT
-        double mz_p = precursors[i_p].getMZ();
-        int z_p = precursors[i_p].getCharge();
-        double rt_value = spectrum.getRT();
-
         PeptideIdentification precursor_empty_id;
-        precursor_empty_id.setRT(rt_value);
-        precursor_empty_id.setMZ(mz_p);
+        precursor_empty_id.setRT(spectrum.getRT());
+        precursor_empty_id.setMZ(spectrum.getPrecursors()[i_p].getMZ());
         precursor_empty_id.setMetaValue("spectrum_index", spectrum_index);
-        if (!spectra[spectrum_index].getNativeID().empty())
+        if (!spectrum.getNativeID().empty())
         {
-          precursor_empty_id.setMetaValue("spectrum_reference",  spectra[spectrum_index].getNativeID());
+          precursor_empty_id.setMetaValue("spectrum_reference",  spectrum.getNativeID());
         }
         precursor_empty_id.setIdentifier(empty_protein_id.getIdentifier());
 
-        // iterate over the consensus features
-        for (Size cm_index = 0; cm_index < map.size(); ++cm_index)
+        for (Size m = 0; m < precursor_matches[q].size(); ++m)
         {
-          // charge states to use for checking:
-          IntList current_charges;
-          if (!ignore_charge_)
+          if (measure_from_subelements && annotate_ids_with_subelements)
           {
-            current_charges.push_back(z_p);
-            current_charges.push_back(0); // "not specified" always matches
-          }
-
-          // check if we compare distance from centroid or subelements
-          if (!measure_from_subelements) // measure from centroid
-          {
-            if (isMatch_(rt_value - map[cm_index].getRT(), mz_p, map[cm_index].getMZ()) && (ignore_charge_ || ListUtils::contains(current_charges, map[cm_index].getCharge())))
-            {
-              map[cm_index].getPeptideIdentifications().push_back(precursor_empty_id);
-              ++assigned_precursors[spectrum_index];
-              precursor_mapped = true;
-            }
+            // store the map index the precursor was mapped to
+            // we use no undesrscore here to be compatible with linkers
+            precursor_empty_id.setMetaValue("map_index", Size(precursor_matches[q][m].second));
           }
-          else // measure from subelements
-          {
-            for (ConsensusFeature::HandleSetType::const_iterator it_handle = map[cm_index].getFeatures().begin();
-                 it_handle != map[cm_index].getFeatures().end();
-                 ++it_handle)
-            {
-              if (isMatch_(rt_value - it_handle->getRT(), mz_p, it_handle->getMZ())  && (ignore_charge_ || ListUtils::contains(current_charges, it_handle->getCharge())))
-              {
-                if (annotate_ids_with_subelements)
-                {                  
-                  // store the map index the precursor was mapped to                  
-                  Size map_index = it_handle->getMapIndex();
-
-                  // we use no undesrscore here to be compatible with linkers
-                  precursor_empty_id.setMetaValue("map_index", map_index);
-                }
-                map[cm_index].getPeptideIdentifications().push_back(precursor_empty_id);
-                ++assigned_precursors[spectrum_index];
-                precursor_mapped = true;
-              }
-            }
-          }
-        } // m/z values to check
+          map[precursor_matches[q][m].first].getPeptideIdentifications().push_back(precursor_empty_id);
+          ++assigned_precursors[spectrum_index];
+          precursor_mapped = true;
+        }
       }
       if (!precursor_mapped) ++spectrum_matches_none;
     }
@@ -433,31 +492,9 @@ namespace OpenMS
       max_rt = std::max(max_rt, box.maxPosition().getX());
     }
     
-    // hash bounding boxes of features by RT:
-    // RT range is partitioned into slices (bins) of 1 second; every feature
-    // that overlaps a certain slice is hashed into the corresponding bin
-    std::vector<std::vector<SignedSize> > hash_table;
-    // make sure the RT hash table has indices >= 0 and doesn't waste space
-    // in the beginning:
-    SignedSize offset(0);
-    
-    if (map.size() > 0)
-    {
-      // std::cout << "Setting up hash table..." << std::endl;
-      offset = SignedSize(floor(min_rt));
-      // this only works if features were found
-      hash_table.resize(SignedSize(floor(max_rt)) - offset + 1);
-      for (Size index = 0; index < boxes.size(); ++index)
-      {
-        const DBoundingBox<2> & box = boxes[index];
-        for (SignedSize i = SignedSize(floor(box.minPosition().getX()));
-             i <= SignedSize(floor(box.maxPosition().getX())); ++i)
-        {
-          hash_table[i - offset].push_back(index);
-        }
-      }
-    }
-    else
+    // index bounding boxes of features by RT (1 second bins) and m/z
+    const BoxIndex index(boxes);
+    if (map.empty())
     {
       LOG_WARN << "IDMapper received an empty FeatureMap! All peptides are mapped as 'unassigned'!" << std::endl;
     }
@@ -466,34 +503,38 @@ namespace OpenMS
     Size matches_none = 0, matches_single = 0, matches_multi = 0;
     
     // std::cout << "Finding matches..." << std::endl;
-    // iterate over peptide IDs:
-    for (std::vector<PeptideIdentification>::const_iterator id_it =
-         ids.begin(); id_it != ids.end(); ++id_it)
+    // matching features of each peptide ID (computed in parallel, applied in ID order)
+    std::vector<std::vector<Size> > id_matches(ids.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)ids.size(); ++i)
     {
-      // std::cout << "Peptide ID: " << id_it - ids.begin() << std::endl;
-
-      if (id_it->getHits().empty()) continue;
+      if (ids[i].getHits().empty()) continue;
 
       DoubleList mz_values;
       double rt_value;
       IntList charges;
-      getIDDetails_(*id_it, rt_value, mz_values, charges, use_avg_mass);
+      getIDDetails_(ids[i], rt_value, mz_values, charges, use_avg_mass);
       
-      if ((rt_value < min_rt) || (rt_value > max_rt))             // RT out of bounds
-      {
-        map.getUnassignedPeptideIdentifications().push_back(*id_it);
-        ++matches_none;
-        continue;
-      }
+      if ((rt_value < min_rt) || (rt_value > max_rt)) continue; // RT out of bounds
       
       // iterate over candidate features:
-      Size index = SignedSize(floor(rt_value)) - offset;
-      Size matching_features = 0;
-      for (std::vector<SignedSize>::iterator hash_it =
-           hash_table[index].begin(); hash_it != hash_table[index].end();
-           ++hash_it)
+      std::vector<Size> candidates, mz_candidates;
+      for (Size i_mz = 0; i_mz < mz_values.size(); ++i_mz)
+      {
+        index.query(rt_value, rt_value, mz_values[i_mz], mz_values[i_mz], mz_candidates);
+        candidates.insert(candidates.end(), mz_candidates.begin(), mz_candidates.end());
+      }
+      if (mz_values.size() > 1)
+      {
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+      }
+
+      for (std::vector<Size>::const_iterator cand_it = candidates.begin(); cand_it != candidates.end(); ++cand_it)
       {
-        Feature & feat = map[*hash_it];
+        const Feature & feat = map[*cand_it];
         
         // need to check the charge state?
         bool check_charge = !ignore_charge_;
@@ -514,44 +555,39 @@ namespace OpenMS
           }
           
           DPosition<2> id_pos(rt_value, *mz_it);
-          if (boxes[*hash_it].encloses(id_pos))                 // potential match
+          if (boxes[*cand_it].encloses(id_pos))                 // potential match
           {
             if (use_centroid_mz)
             {
               // only one m/z value to check, which was already incorporated
               // into the overall bounding box -> success!
-              feat.getPeptideIdentifications().push_back(*id_it);
-              ++matching_features;
+              id_matches[i].push_back(*cand_it);
               break;                     // "mz_it" loop
             }
             // else: check all the mass traces
-            bool found_match = false;
-            for (std::vector<ConvexHull2D>::iterator ch_it =
-                 feat.getConvexHulls().begin(); ch_it !=
-                 feat.getConvexHulls().end(); ++ch_it)
+            if (enclosedByMassTrace_(feat, id_pos, use_centroid_rt))
             {
-              DBoundingBox<2> box = ch_it->getBoundingBox();
-              if (use_centroid_rt)
-              {
-                box.setMinX(feat.getRT());
-                box.setMaxX(feat.getRT());
-              }
-              increaseBoundingBox_(box);
-              if (box.encloses(id_pos)) // success!
-              {
-                feat.getPeptideIdentifications().push_back(*id_it);
-                ++matching_features;
-                found_match = true;
-                break; // "ch_it" loop
-              }
+              id_matches[i].push_back(*cand_it);
+              break; // "mz_it" loop
             }
-            if (found_match) break; // "mz_it" loop
           }
         }
       }
+    }
+
+    for (Size i = 0; i < ids.size(); ++i)
+    {
+      if (ids[i].getHits().empty()) continue;
+
+      for (Size m = 0; m < id_matches[i].size(); ++m)
+      {
+        map[id_matches[i][m]].getPeptideIdentifications().push_back(ids[i]);
+      }
+
+      Size matching_features = id_matches[i].size();
       if (matching_features == 0)
       {
-        map.getUnassignedPeptideIdentifications().push_back(*id_it);
+        map.getUnassignedPeptideIdentifications().push_back(ids[i]);
         ++matches_none;
       }
       else if (matching_features == 1) 
@@ -563,12 +599,12 @@ namespace OpenMS
         ++matches_multi;
       }
     }
+    std::vector<std::vector<Size> >().swap(id_matches);
 
     vector<Size> unidentified = mapPrecursorsToIdentifications(spectra, ids).unidentified;
 
     // map all unidentified precursor to features
     Size spectrum_matches_none(0);
-    Size spectrum_matches(0);
     Size spectrum_matches_single(0);
     Size spectrum_matches_multi(0);
     
@@ -596,104 +632,101 @@ namespace OpenMS
     }
 
     // are there any mapped but unidentified precursors?
-    for (Size i = 0; i != unidentified.size(); ++i)
+    // (all precursors of unidentified spectra, as (spectrum index, precursor index))
+    std::vector<std::pair<Size, Size> > precursor_queries;
+    for (Size ui = 0; ui != unidentified.size(); ++ui)
     {
-      Size spectrum_index = unidentified[i];
-      const MSSpectrum& spectrum = spectra[spectrum_index];
-      const vector<Precursor>& precursors = spectrum.getPrecursors();
-
-      // check if precursor has been identified
-      for (Size i_p = 0; i_p < precursors.size(); ++i_p)
+      for (Size i_p = 0; i_p < spectra[unidentified[ui]].getPrecursors().size(); ++i_p)
       {
-        // check by precursor mass and spectrum RT
-        double mz_p = precursors[i_p].getMZ();
-        double rt_value = spectrum.getRT();
-        int z_p = precursors[i_p].getCharge();
+        precursor_queries.push_back(std::make_pair(unidentified[ui], i_p));
+      }
+    }
 
-        if ((rt_value < min_rt) || (rt_value > max_rt)) // RT out of bounds
-        {
-          ++spectrum_matches_none;
-          continue;
-        }
-      
-        // iterate over candidate features:
-        Size index = SignedSize(floor(rt_value)) - offset;
-        Size matching_features = 0;
+    // matching features of each precursor
+    std::vector<std::vector<Size> > precursor_matches(precursor_queries.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize q = 0; q < (SignedSize)precursor_queries.size(); ++q)
+    {
+      const MSSpectrum& spectrum = spectra[precursor_queries[q].first];
+      const Precursor& precursor = spectrum.getPrecursors()[precursor_queries[q].second];
 
-        PeptideIdentification precursor_empty_id;
-        precursor_empty_id.setRT(rt_value);
-        precursor_empty_id.setMZ(mz_p);
-        precursor_empty_id.setMetaValue("spectrum_index", spectrum_index);
-        if (!spectra[spectrum_index].getNativeID().empty())
+      // check by precursor mass and spectrum RT
+      double mz_p = precursor.getMZ();
+      double rt_value = spectrum.getRT();
+      int z_p = precursor.getCharge();
+
+      if ((rt_value < min_rt) || (rt_value > max_rt)) continue; // RT out of bounds
+
+      // iterate over candidate features:
+      std::vector<Size> candidates;
+      index.query(rt_value, rt_value, mz_p, mz_p, candidates);
+      for (std::vector<Size>::const_iterator cand_it = candidates.begin(); cand_it != candidates.end(); ++cand_it)
+      {
+        const Feature & feat = map[*cand_it];
+      
+        // (optinally) check charge state
+        if (!ignore_charge_)
         {
-          precursor_empty_id.setMetaValue("spectrum_reference",  spectra[spectrum_index].getNativeID());
+          if (z_p != feat.getCharge()) continue;
         }
-        precursor_empty_id.setIdentifier(empty_protein_id.getIdentifier());
-        //precursor_empty_id.setCharge(z_p);
+      
+        DPosition<2> id_pos(rt_value, mz_p);
 
-        for (std::vector<SignedSize>::iterator hash_it =
-           hash_table[index].begin(); hash_it != hash_table[index].end();
-           ++hash_it)
+        if (boxes[*cand_it].encloses(id_pos)) // potential match
         {
-          Feature & feat = map[*hash_it];
-        
-          // (optinally) check charge state
-          if (!ignore_charge_)
+          if (use_centroid_mz)
           {
-            if (z_p != feat.getCharge()) continue;
+            // only one m/z value to check, which was already incorporated
+            // into the overall bounding box -> success!
+            precursor_matches[q].push_back(*cand_it);
+            break; // "mz_it" loop
           }
-        
-          DPosition<2> id_pos(rt_value, mz_p);
-
-          if (boxes[*hash_it].encloses(id_pos)) // potential match
+          // else: check all the mass traces
+          if (enclosedByMassTrace_(feat, id_pos, use_centroid_rt))
           {
-            if (use_centroid_mz)
-            {
-              // only one m/z value to check, which was already incorporated
-              // into the overall bounding box -> success!
-              feat.getPeptideIdentifications().push_back(precursor_empty_id);
-              ++spectrum_matches;
-              break; // "mz_it" loop
-            }
-            // else: check all the mass traces
-            bool found_match = false;
-            for (std::vector<ConvexHull2D>::iterator ch_it =
-                  feat.getConvexHulls().begin(); ch_it !=
-                  feat.getConvexHulls().end(); ++ch_it)
-            {
-              DBoundingBox<2> box = ch_it->getBoundingBox();
-              if (use_centroid_rt)
-              {
-                box.setMinX(feat.getRT());
-                box.setMaxX(feat.getRT());
-              }
-              increaseBoundingBox_(box);
-              if (box.encloses(id_pos)) // success!
-              {
-                feat.getPeptideIdentifications().push_back(precursor_empty_id);
-                ++matching_features;
-                found_match = true;
-                break; // "ch_it" loop
-              }
-            }
-
-            if (found_match) break; // "mz_it" loop
+            precursor_matches[q].push_back(*cand_it);
+            break; // "mz_it" loop
           }
         }
+      }
+    }
 
-        if (matching_features == 0)
-        {
-          ++spectrum_matches_none;
-        }
-        else if (matching_features == 1) 
-        {
-          ++spectrum_matches_single;
-        }
-        else 
-        {
-          ++spectrum_matches_multi;
-        }
-      }             
+    for (Size q = 0; q < precursor_queries.size(); ++q)
+    {
+      Size spectrum_index = precursor_queries[q].first;
+      const MSSpectrum& spectrum = spectra[spectrum_index];
+
+      PeptideIdentification precursor_empty_id;
+      precursor_empty_id.setRT(spectrum.getRT());
+      precursor_empty_id.setMZ(spectrum.getPrecursors()[precursor_queries[q].second].getMZ());
+      precursor_empty_id.setMetaValue("spectrum_index", spectrum_index);
+      if (!spectrum.getNativeID().empty())
+      {
+        precursor_empty_id.setMetaValue("spectrum_reference",  spectrum.getNativeID());
+      }
+      precursor_empty_id.setIdentifier(empty_protein_id.getIdentifier());
+      //precursor_empty_id.setCharge(z_p);
+
+      for (Size m = 0; m < precursor_matches[q].size(); ++m)
+      {
+        map[precursor_matches[q][m]].getPeptideIdentifications().push_back(precursor_empty_id);
+      }
+
+      Size matching_features = precursor_matches[q].size();
+      if (matching_features == 0)
+      {
+        ++spectrum_matches_none;
+      }
+      else if (matching_features == 1) 
+      {
+        ++spectrum_matches_single;
+      }
+      else 
+      {
+        ++spectrum_matches_multi;
+      }
     }    
     
     // some statistics output
@@ -709,6 +742,46 @@ namespace OpenMS
     
   }
 
+  bool IDMapper::enclosedByMassTrace_(const Feature& feat, const DPosition<2>& id_pos, bool use_centroid_rt) const
+  {
+    for (std::vector<ConvexHull2D>::const_iterator ch_it =
+         feat.getConvexHulls().begin(); ch_it !=
+         feat.getConvexHulls().end(); ++ch_it)
+    {
+      DBoundingBox<2> box = ch_it->getBoundingBox();
+      if (use_centroid_rt)
+      {
+        box.setMinX(feat.getRT());
+        box.setMaxX(feat.getRT());
+      }
+      increaseBoundingBox_(box);
+      if (box.encloses(id_pos)) // success!
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::vector<Size> IDMapper::findCandidates_(const BoxIndex& index, const std::vector<Size>& position_to_element, double rt, const DoubleList& mz_values) const
+  {
+    std::vector<Size> candidates, hits;
+    for (Size i_mz = 0; i_mz < mz_values.size(); ++i_mz)
+    {
+      // slightly enlarged window; candidates are checked exactly with isMatch_() later
+      double mz_tol = getAbsoluteMZTolerance_(mz_values[i_mz]) * (1.0 + 1e-6) + std::fabs(mz_values[i_mz]) * 1e-12;
+      double rt_tol = rt_tolerance_ * (1.0 + 1e-6) + std::fabs(rt) * 1e-12;
+      index.query(rt - rt_tol, rt + rt_tol, mz_values[i_mz] - mz_tol, mz_values[i_mz] + mz_tol, hits);
+      for (Size h = 0; h < hits.size(); ++h)
+      {
+        candidates.push_back(position_to_element[hits[h]]);
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    return candidates;
+  }
+
   double IDMapper::getAbsoluteMZTolerance_(const double mz) const
   {
     if (measure_ == MEASURE_PPM)
@@ -780,7 +853,7 @@ namespace OpenMS
     }
   }
 
-  void IDMapper::increaseBoundingBox_(DBoundingBox<2>& box)
+  void IDMapper::increaseBoundingBox_(DBoundingBox<2>& box) const
   {
     DPosition<2> sub_min(rt_tolerance_,
                          getAbsoluteMZTolerance_(box.minPosition().getY())),
@@ -823,4 +896,78 @@ namespace OpenMS
     return use_avg_mass;
   }
 
+  IDMapper::BoxIndex::BoxIndex(const std::vector<DBoundingBox<2> >& boxes, double rt_bin_width) :
+    rt_bin_width_(rt_bin_width),
+    bin_offset_(0)
+  {
+    rt_min_.reserve(boxes.size());
+    rt_max_.reserve(boxes.size());
+    mz_max_.reserve(boxes.size());
+    SignedSize first_bin = std::numeric_limits<SignedSize>::max(), last_bin = std::numeric_limits<SignedSize>::min();
+    for (Size i = 0; i < boxes.size(); ++i)
+    {
+      rt_min_.push_back(boxes[i].minPosition().getX());
+      rt_max_.push_back(boxes[i].maxPosition().getX());
+      mz_max_.push_back(boxes[i].maxPosition().getY());
+      if (rt_min_[i] > rt_max_[i] || boxes[i].minPosition().getY() > mz_max_[i]) continue;
+      first_bin = std::min(first_bin, SignedSize(floor(rt_min_[i] / rt_bin_width_)));
+      last_bin = std::max(last_bin, SignedSize(floor(rt_max_[i] / rt_bin_width_)));
+    }
+    if (first_bin > last_bin) return; // nothing to index
+
+    bin_offset_ = first_bin;
+    bins_.resize(last_bin - first_bin + 1);
+    bin_max_mz_width_.resize(bins_.size(), 0.0);
+    for (Size i = 0; i < boxes.size(); ++i)
+    {
+      double mz_min = boxes[i].minPosition().getY();
+      if (rt_min_[i] > rt_max_[i] || mz_min > mz_max_[i]) continue;
+      for (SignedSize b = SignedSize(floor(rt_min_[i] / rt_bin_width_)); b <= SignedSize(floor(rt_max_[i] / rt_bin_width_)); ++b)
+      {
+        bins_[b - bin_offset_].push_back(std::make_pair(mz_min, i));
+        bin_max_mz_width_[b - bin_offset_] = std::max(bin_max_mz_width_[b - bin_offset_], mz_max_[i] - mz_min);
+      }
+    }
+    for (Size b = 0; b < bins_.size(); ++b)
+    {
+      std::sort(bins_[b].begin(), bins_[b].end());
+    }
+  }
+
+  void IDMapper::BoxIndex::query(double rt_min, double rt_max, double mz_min, double mz_max, std::vector<Size>& result) const
+  {
+    result.clear();
+    if (bins_.empty() || rt_min > rt_max || mz_min > mz_max) return;
+
+    SignedSize first_bin = std::max(SignedSize(floor(rt_min / rt_bin_width_)) - bin_offset_, SignedSize(0));
+    SignedSize last_bin = std::min(SignedSize(floor(rt_max / rt_bin_width_)) - bin_offset_, SignedSize(bins_.size()) - 1);
+    for (SignedSize b = first_bin; b <= last_bin; ++b)
+    {
+      const std::vector<std::pair<double, Size> >& bin = bins_[b];
+      // boxes starting above mz_max cannot intersect; walk down from there
+      // until no box of this bin can reach mz_min anymore (the bound is
+      // generous to be safe from rounding, boxes are checked exactly below)
+      std::vector<std::pair<double, Size> >::const_iterator it = std::upper_bound(bin.begin(), bin.end(),
+        std::make_pair(mz_max, std::numeric_limits<Size>::max()));
+      double lowest_start = mz_min - 2 * bin_max_mz_width_[b];
+      while (it != bin.begin())
+      {
+        --it;
+        if (it->first < lowest_start) break;
+        Size i = it->second;
+        if (mz_max_[i] >= mz_min && rt_min_[i] <= rt_max && rt_max_[i] >= rt_min)
+        {
+          result.push_back(i);
+        }
+      }
+    }
+    std::sort(result.begin(), result.end());
+    if (last_bin > first_bin) result.erase(std::unique(result.begin(), result.end()), result.end());
+  }
+
+  Size IDMapper::BoxIndex::size() const
+  {
+    return rt_min_.size();
+  }
+
 } // namespace OpenMS
@@ -35,6 +35,7 @@
 #include <OpenMS/ANALYSIS/ID/MetaboliteSpectralMatching.h>
 
 
+#include <exception>
 #include <numeric>
 #include <boost/math/special_functions/factorials.hpp>
 
@@ -288,86 +289,38 @@ MetaboliteSpectralMatching::~MetaboliteSpectralMatching()
 double MetaboliteSpectralMatching::computeHyperScore(MSSpectrum exp_spectrum, MSSpectrum db_spectrum,
                              const double& fragment_mass_error, const double& mz_lower_bound)
 {
-
-  double dot_product(0.0);
-  Size matched_ions_count(0);
-
-  // scan for matching peaks between observed and DB stored spectra
-  for (MSSpectrum::iterator frag_it = exp_spectrum.MZBegin(mz_lower_bound); frag_it != exp_spectrum.end(); ++frag_it)
+  std::vector<double> exp_mz, db_mz;
+  std::vector<float> exp_intensity, db_intensity;
+  for (MSSpectrum::ConstIterator it = exp_spectrum.begin(); it != exp_spectrum.end(); ++it)
   {
-    double frag_mz = frag_it->getMZ();
-
-    double mz_offset = fragment_mass_error;
-
-    if (mz_error_unit_ == "ppm")
-    {
-      mz_offset = frag_mz * 1e-6 * fragment_mass_error;
-    }
-
-    MSSpectrum::iterator db_mass_it = db_spectrum.MZBegin(frag_mz - mz_offset);
-    MSSpectrum::iterator db_mass_end = db_spectrum.MZEnd(frag_mz + mz_offset);
-
-    std::pair<double, Peak1D> nearest_peak(mz_offset + 1.0, Peak1D());
-
-    // linear search for peak nearest to observed fragment peak
-    for (; db_mass_it != db_mass_end; ++db_mass_it)
-    {
-      double db_mz(db_mass_it->getMZ());
-      double abs_mass_diff(std::abs(frag_mz - db_mz));
-
-      if (abs_mass_diff < nearest_peak.first) {
-        nearest_peak.first = abs_mass_diff;
-        nearest_peak.second = *db_mass_it;
-      }
-    }
-
-    // update dot product
-    if (nearest_peak.second.getIntensity() > 0.0)
-    {
-      ++matched_ions_count;
-      dot_product += frag_it->getIntensity() * nearest_peak.second.getIntensity();
-    }
+    exp_mz.push_back(it->getMZ());
+    exp_intensity.push_back(it->getIntensity());
   }
-
-  double matched_ions_term(0.0);
-
-  // return score 0 if too few matched ions
-  if (matched_ions_count < 3)
+  for (MSSpectrum::ConstIterator it = db_spectrum.begin(); it != db_spectrum.end(); ++it)
   {
-    return matched_ions_term;
+    db_mz.push_back(it->getMZ());
+    db_intensity.push_back(it->getIntensity());
   }
 
-
-  if (matched_ions_count <= boost::math::max_factorial<double>::value)
-  {
-    matched_ions_term = std::log(boost::math::factorial<double>((double)matched_ions_count));
-  }
-  else
-  {
-    matched_ions_term = std::log(boost::math::factorial<double>(boost::math::max_factorial<double>::value));
-  }
-
-  double hyperscore(std::log(dot_product) + matched_ions_term);
-
-
-  if (hyperscore < 0)
-  {
-    hyperscore = 0;
-  }
-
-  return hyperscore;
+  return computeHyperScore_(exp_mz, exp_intensity, db_mz.data(), db_intensity.data(), db_mz.size(), fragment_mass_error, mz_lower_bound);
 }
 
 void MetaboliteSpectralMatching::run(PeakMap & msexp, PeakMap & spec_db, MzTab& mztab_out)
 {
   std::sort(spec_db.begin(), spec_db.end(), PrecursorMZLess);
 
-  std::vector<double> mz_keys;
+  // index the (now sorted) library; indices of matches then refer to the sorted library
+  SpectralLibraryIndex index;
+  index.build(spec_db);
+
+  run(msexp, spec_db, index, mztab_out);
+}
 
-  // copy precursor m/z values to vector for searching
-  for (Size spec_idx = 0; spec_idx < spec_db.size(); ++spec_idx)
+void MetaboliteSpectralMatching::run(PeakMap & msexp, const PeakMap & spec_db, const SpectralLibraryIndex & index, MzTab& mztab_out)
+{
+  if (!index.matches(spec_db))
   {
-    mz_keys.push_back(spec_db[spec_idx].getPrecursors()[0].getMZ());
+    throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "The spectral library index was not built from the given spectral library.");
   }
 
   // remove potential noise peaks by selecting the ten most intense peak per 100 Da window
@@ -387,19 +340,34 @@ void MetaboliteSpectralMatching::run(PeakMap & msexp, PeakMap & spec_db, MzTab&
   wm.filterPeakMap(msexp);
 
 
-  // container storing results
-  std::vector<SpectralMatch> matching_results;
+  // results of each spectrum (collected in spectrum order below)
+  std::vector<std::vector<SpectralMatch> > spectrum_results(msexp.size());
 
-
-  for (Size spec_idx = 0; spec_idx < msexp.size(); ++spec_idx)
+  // exceptions must not leave the parallel region (this would terminate the program)
+  std::exception_ptr search_error;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+  for (SignedSize spec_idx = 0; spec_idx < (SignedSize)msexp.size(); ++spec_idx)
   {
     // std::cout << "merged spectrum no. " << spec_idx << " with #fragment ions: " << msexp[spec_idx].size() << std::endl;
+    const MSSpectrum& spectrum = msexp[spec_idx];
+
+    std::vector<double> exp_mz;
+    std::vector<float> exp_intensity;
+    exp_mz.reserve(spectrum.size());
+    exp_intensity.reserve(spectrum.size());
+    for (MSSpectrum::ConstIterator it = spectrum.begin(); it != spectrum.end(); ++it)
+    {
+      exp_mz.push_back(it->getMZ());
+      exp_intensity.push_back(it->getIntensity());
+    }
 
     // iterate over all precursor masses
-    for (Size prec_idx = 0; prec_idx < msexp[spec_idx].getPrecursors().size(); ++prec_idx)
+    for (Size prec_idx = 0; prec_idx < spectrum.getPrecursors().size(); ++prec_idx)
     {
       // get precursor m/z
-      double precursor_mz(msexp[spec_idx].getPrecursors()[prec_idx].getMZ());
+      double precursor_mz(spectrum.getPrecursors()[prec_idx].getMZ());
 
       // std::cout << "precursor no. " << prec_idx << ": mz " << precursor_mz << " ";
 
@@ -421,52 +389,59 @@ void MetaboliteSpectralMatching::run(PeakMap & msexp, PeakMap & spec_db, MzTab&
       // std::cout << "lower mz: " << prec_mz_lowerbound << " ";
       // std::cout << "upper mz: " << prec_mz_upperbound << std::endl;
 
-      std::vector<double>::const_iterator lower_it = std::lower_bound(mz_keys.begin(), mz_keys.end(), prec_mz_lowerbound);
-      std::vector<double>::const_iterator upper_it = std::upper_bound(mz_keys.begin(), mz_keys.end(), prec_mz_upperbound);
-
-      Size start_idx(lower_it - mz_keys.begin());
-      Size end_idx(upper_it - mz_keys.begin());
+      std::pair<Size, Size> candidates = index.findPrecursorRange(prec_mz_lowerbound, prec_mz_upperbound);
 
       //std::cout << "identifying " << msexp[spec_idx].getMetaValue("Massbank_Accession_ID") << std::endl;
 
       std::vector<SpectralMatch> partial_results;
 
-      for (Size search_idx = start_idx; search_idx < end_idx; ++search_idx)
+      for (Size search_idx = candidates.first; search_idx < candidates.second; ++search_idx)
       {
         // do spectral matching
-        // std::cout << "scanning " << spec_db[search_idx].getPrecursors()[0].getMZ() << " " << spec_db[search_idx].getMetaValue("Metabolite_Name") << std::endl;
 
         // check for charge state of precursor ions: do they match?
-        if ( (ion_mode_ == "positive" && spec_db[search_idx].getPrecursors()[0].getCharge() < 0) || (ion_mode_ == "negative" && spec_db[search_idx].getPrecursors()[0].getCharge() > 0))
+        if ( (ion_mode_ == "positive" && index.getPrecursorCharge(search_idx) < 0) || (ion_mode_ == "negative" && index.getPrecursorCharge(search_idx) > 0))
         {
           continue;
         }
 
-        double hyperscore(computeHyperScore(msexp[spec_idx], spec_db[search_idx], fragment_mz_error_, 0.0));
+        double hyperscore(computeHyperScore_(exp_mz, exp_intensity, index.getPeakMZ(search_idx), index.getPeakIntensity(search_idx), index.getPeakCount(search_idx), fragment_mz_error_, 0.0));
 
         // std::cout << " scored with " << hyperScore << std::endl;
         if (hyperscore > 0)
         {
-          // std::cout << "  ** detected " << spec_db[search_idx].getMetaValue("Massbank_Accession_ID") << " " << spec_db[search_idx].getMetaValue("Metabolite_Name") << " scored with " << hyperscore << std::endl;
+          const Size db_idx = index.getLibraryIndex(search_idx);
+          const MSSpectrum& db_spectrum = spec_db[db_idx];
 
           // score result temporarily
           SpectralMatch tmp_match;
           tmp_match.setObservedPrecursorMass(precursor_mz);
-          tmp_match.setFoundPrecursorMass(spec_db[search_idx].getPrecursors()[0].getMZ());
-          double obs_rt = std::floor(msexp[spec_idx].getRT() * 10)/10.0;
+          tmp_match.setFoundPrecursorMass(index.getPrecursorMZ(search_idx));
+          double obs_rt = std::floor(spectrum.getRT() * 10)/10.0;
           tmp_match.setObservedPrecursorRT(obs_rt);
-          tmp_match.setFoundPrecursorCharge(spec_db[search_idx].getPrecursors()[0].getCharge());
+          tmp_match.setFoundPrecursorCharge(index.getPrecursorCharge(search_idx));
           tmp_match.setMatchingScore(hyperscore);
           tmp_match.setObservedSpectrumIndex(spec_idx);
-          tmp_match.setMatchingSpectrumIndex(search_idx);
-
-          tmp_match.setPrimaryIdentifier(spec_db[search_idx].getMetaValue("Massbank_Accession_ID"));
-          tmp_match.setSecondaryIdentifier(spec_db[search_idx].getMetaValue("HMDB_ID"));
-          tmp_match.setSumFormula(spec_db[search_idx].getMetaValue("Sum_Formula"));
-          tmp_match.setCommonName(spec_db[search_idx].getMetaValue("Metabolite_Name"));
-          tmp_match.setInchiString(spec_db[search_idx].getMetaValue("Inchi_String"));
-          tmp_match.setSMILESString(spec_db[search_idx].getMetaValue("SMILES_String"));
-          tmp_match.setPrecursorAdduct(spec_db[search_idx].getMetaValue("Precursor_Ion"));
+          tmp_match.setMatchingSpectrumIndex(db_idx);
+
+          // a missing meta value throws; the exception is rethrown after the parallel loop
+          try
+          {
+            tmp_match.setPrimaryIdentifier(db_spectrum.getMetaValue("Massbank_Accession_ID"));
+            tmp_match.setSecondaryIdentifier(db_spectrum.getMetaValue("HMDB_ID"));
+            tmp_match.setSumFormula(db_spectrum.getMetaValue("Sum_Formula"));
+            tmp_match.setCommonName(db_spectrum.getMetaValue("Metabolite_Name"));
+            tmp_match.setInchiString(db_spectrum.getMetaValue("Inchi_String"));
+            tmp_match.setSMILESString(db_spectrum.getMetaValue("SMILES_String"));
+            tmp_match.setPrecursorAdduct(db_spectrum.getMetaValue("Precursor_Ion"));
+          }
+          catch (...)
+          {
+#ifdef _OPENMP
+#pragma omp critical (MetaboliteSpectralMatching_run)
+#endif
+            if (!search_error) search_error = std::current_exception();
+          }
 
 
           partial_results.push_back(tmp_match);
@@ -487,7 +462,7 @@ void MetaboliteSpectralMatching::run(PeakMap & msexp, PeakMap & spec_db, MzTab&
         for (Size result_idx = 0; result_idx < last_result_idx; ++result_idx)
         {
           // std::cout << "score: " << partial_results[result_idx].getMatchingScore() << " " << partial_results[result_idx].getMatchingSpectrumIndex() << std::endl;
-          matching_results.push_back(partial_results[result_idx]);
+          spectrum_results[spec_idx].push_back(partial_results[result_idx]);
         }
       }
 
@@ -495,12 +470,20 @@ void MetaboliteSpectralMatching::run(PeakMap & msexp, PeakMap & spec_db, MzTab&
       {
         if (partial_results.size() > 0)
         {
-          matching_results.push_back(partial_results[0]);
+          spectrum_results[spec_idx].push_back(partial_results[0]);
         }
       }
 
     } // end precursor loop
   } // end spectra loop
+  if (search_error) std::rethrow_exception(search_error);
+
+  // container storing results
+  std::vector<SpectralMatch> matching_results;
+  for (Size spec_idx = 0; spec_idx < spectrum_results.size(); ++spec_idx)
+  {
+    matching_results.insert(matching_results.end(), spectrum_results[spec_idx].begin(), spectrum_results[spec_idx].end());
+  }
 
   // write final results to MzTab
   exportMzTab_(matching_results, mztab_out);
@@ -521,6 +504,82 @@ void MetaboliteSpectralMatching::updateMembers_()
 
 /// private methods
 
+double MetaboliteSpectralMatching::computeHyperScore_(const std::vector<double>& exp_mz, const std::vector<float>& exp_intensity,
+                                                      const double* db_mz, const float* db_intensity, Size db_size,
+                                                      double fragment_mass_error, double mz_lower_bound) const
+{
+  double dot_product(0.0);
+  Size matched_ions_count(0);
+
+  const bool ppm_error(mz_error_unit_ == "ppm");
+  const double* db_mz_end(db_mz + db_size);
+
+  // scan for matching peaks between observed and DB stored spectra
+  for (Size frag_idx = std::lower_bound(exp_mz.begin(), exp_mz.end(), mz_lower_bound) - exp_mz.begin(); frag_idx < exp_mz.size(); ++frag_idx)
+  {
+    double frag_mz = exp_mz[frag_idx];
+
+    double mz_offset = fragment_mass_error;
+
+    if (ppm_error)
+    {
+      mz_offset = frag_mz * 1e-6 * fragment_mass_error;
+    }
+
+    const double* db_mass_it = std::lower_bound(db_mz, db_mz_end, frag_mz - mz_offset);
+    const double* db_mass_end = std::upper_bound(db_mz, db_mz_end, frag_mz + mz_offset);
+
+    double nearest_diff(mz_offset + 1.0);
+    float nearest_intensity(0.0);
+
+    // linear search for peak nearest to observed fragment peak
+    for (; db_mass_it < db_mass_end; ++db_mass_it)
+    {
+      double abs_mass_diff(std::abs(frag_mz - *db_mass_it));
+
+      if (abs_mass_diff < nearest_diff) {
+        nearest_diff = abs_mass_diff;
+        nearest_intensity = db_intensity[db_mass_it - db_mz];
+      }
+    }
+
+    // update dot product
+    if (nearest_intensity > 0.0)
+    {
+      ++matched_ions_count;
+      dot_product += exp_intensity[frag_idx] * nearest_intensity;
+    }
+  }
+
+  double matched_ions_term(0.0);
+
+  // return score 0 if too few matched ions
+  if (matched_ions_count < 3)
+  {
+    return matched_ions_term;
+  }
+
+
+  if (matched_ions_count <= boost::math::max_factorial<double>::value)
+  {
+    matched_ions_term = std::log(boost::math::factorial<double>((double)matched_ions_count));
+  }
+  else
+  {
+    matched_ions_term = std::log(boost::math::factorial<double>(boost::math::max_factorial<double>::value));
+  }
+
+  double hyperscore(std::log(dot_product) + matched_ions_term);
+
+
+  if (hyperscore < 0)
+  {
+    hyperscore = 0;
+  }
+
+  return hyperscore;
+}
+
 void MetaboliteSpectralMatching::exportMzTab_(const std::vector<SpectralMatch>& overall_results, MzTab& mztab_out)
 {
   // iterate the overall results table
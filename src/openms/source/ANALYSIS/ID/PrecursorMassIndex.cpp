@@ -0,0 +1,233 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/ID/PrecursorMassIndex.h>
+
+#include <OpenMS/CONCEPT/Constants.h>
+#include <OpenMS/CONCEPT/Exception.h>
+
+#include <algorithm>
+
+namespace OpenMS
+{
+
+  PrecursorMassIndex::PrecursorMassIndex() :
+    built_(false)
+  {
+  }
+
+  void PrecursorMassIndex::add(double mass, Size spectrum_index, int isotope_error)
+  {
+    Entry e;
+    e.mass = mass;
+    e.spectrum_index = spectrum_index;
+    e.isotope_error = isotope_error;
+    entries_.push_back(e);
+    built_ = false;
+  }
+
+  void PrecursorMassIndex::addPrecursor(double precursor_mass, Size spectrum_index, const IntList& isotope_errors)
+  {
+    for (int isotope_error : isotope_errors)
+    {
+      add(precursor_mass - isotope_error * Constants::C13C12_MASSDIFF_U, spectrum_index, isotope_error);
+    }
+  }
+
+  void PrecursorMassIndex::build()
+  {
+    // stable: entries of equal mass stay in insertion order (as in a multimap)
+    std::stable_sort(entries_.begin(), entries_.end(),
+      [](const Entry& a, const Entry& b) { return a.mass < b.mass; });
+
+    eytzinger_.assign(entries_.size() + 1, 0.0);
+    eytzinger_rank_.assign(entries_.size() + 1, 0);
+    Size sorted_index(0);
+    fillEytzinger_(sorted_index, 1);
+
+    built_ = true;
+  }
+
+  void PrecursorMassIndex::fillEytzinger_(Size& sorted_index, Size node)
+  {
+    if (node >= eytzinger_.size()) { return; }
+    fillEytzinger_(sorted_index, 2 * node);
+    eytzinger_[node] = entries_[sorted_index].mass;
+    eytzinger_rank_[node] = sorted_index;
+    ++sorted_index;
+    fillEytzinger_(sorted_index, 2 * node + 1);
+  }
+
+  bool PrecursorMassIndex::isBuilt() const
+  {
+    return built_;
+  }
+
+  void PrecursorMassIndex::clear()
+  {
+    entries_.clear();
+    eytzinger_.clear();
+    eytzinger_rank_.clear();
+    built_ = false;
+  }
+
+  Size PrecursorMassIndex::size() const
+  {
+    return entries_.size();
+  }
+
+  bool PrecursorMassIndex::empty() const
+  {
+    return entries_.empty();
+  }
+
+  PrecursorMassIndex::ConstIterator PrecursorMassIndex::begin() const
+  {
+    return entries_.begin();
+  }
+
+  PrecursorMassIndex::ConstIterator PrecursorMassIndex::end() const
+  {
+    return entries_.end();
+  }
+
+  const PrecursorMassIndex::Entry& PrecursorMassIndex::operator[](Size index) const
+  {
+    return entries_[index];
+  }
+
+  Size PrecursorMassIndex::lowerBound_(double mass) const
+  {
+    const Size n = entries_.size();
+    Size node = 1;
+    while (node <= n)
+    {
+      node = 2 * node + (eytzinger_[node] < mass);
+    }
+    // remove the trailing right turns and the last left turn to get the answer node
+    while (node & 1) { node >>= 1; }
+    node >>= 1;
+    return node == 0 ? n : eytzinger_rank_[node];
+  }
+
+  Size PrecursorMassIndex::upperBound_(double mass) const
+  {
+    const Size n = entries_.size();
+    Size node = 1;
+    while (node <= n)
+    {
+      node = 2 * node + (eytzinger_[node] <= mass);
+    }
+    while (node & 1) { node >>= 1; }
+    node >>= 1;
+    return node == 0 ? n : eytzinger_rank_[node];
+  }
+
+  void PrecursorMassIndex::checkBuilt_(const char* function) const
+  {
+    if (!built_)
+    {
+      throw Exception::Precondition(__FILE__, __LINE__, function, "PrecursorMassIndex::build() must be called before searching.");
+    }
+  }
+
+  PrecursorMassIndex::Range PrecursorMassIndex::findByMass(double mass_low, double mass_high) const
+  {
+    checkBuilt_(OPENMS_PRETTY_FUNCTION);
+    const Size first = lowerBound_(mass_low);
+    const Size last = std::max(first, upperBound_(mass_high));
+    return Range(entries_.begin() + first, entries_.begin() + last);
+  }
+
+  PrecursorMassIndex::Range PrecursorMassIndex::find(double mass, double tolerance, bool tolerance_unit_ppm) const
+  {
+    const double allowed_error = tolerance_unit_ppm ? mass * tolerance * 1e-6 : tolerance;
+    return findByMass(mass - allowed_error, mass + allowed_error);
+  }
+
+  void PrecursorMassIndex::find(const std::vector<double>& masses, double tolerance, bool tolerance_unit_ppm, std::vector<Range>& ranges) const
+  {
+    checkBuilt_(OPENMS_PRETTY_FUNCTION);
+    ranges.clear();
+    ranges.reserve(masses.size());
+
+    if (!std::is_sorted(masses.begin(), masses.end()))
+    {
+      for (double mass : masses)
+      {
+        ranges.push_back(find(mass, tolerance, tolerance_unit_ppm));
+      }
+      return;
+    }
+
+    // window borders increase with the query masses: continue each search from the previous window
+    Size first(0), last(0);
+    for (double mass : masses)
+    {
+      const double allowed_error = tolerance_unit_ppm ? mass * tolerance * 1e-6 : tolerance;
+      first = gallopLowerBound_(first, mass - allowed_error);
+      last = gallopUpperBound_(std::max(first, last), mass + allowed_error);
+      ranges.push_back(Range(entries_.begin() + first, entries_.begin() + last));
+    }
+  }
+
+  Size PrecursorMassIndex::gallopLowerBound_(Size from, double mass) const
+  {
+    // double the step until the entry at from + step is no longer below mass
+    Size step(1);
+    while (from + step < entries_.size() && entries_[from + step].mass < mass)
+    {
+      from += step;
+      step *= 2;
+    }
+    const Size to = std::min(from + step, entries_.size());
+    return std::lower_bound(entries_.begin() + from, entries_.begin() + to, mass,
+      [](const Entry& e, double m) { return e.mass < m; }) - entries_.begin();
+  }
+
+  Size PrecursorMassIndex::gallopUpperBound_(Size from, double mass) const
+  {
+    Size step(1);
+    while (from + step < entries_.size() && entries_[from + step].mass <= mass)
+    {
+      from += step;
+      step *= 2;
+    }
+    const Size to = std::min(from + step, entries_.size());
+    return std::upper_bound(entries_.begin() + from, entries_.begin() + to, mass,
+      [](double m, const Entry& e) { return m < e.mass; }) - entries_.begin();
+  }
+
+} // namespace OpenMS
+
@@ -0,0 +1,404 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/ID/SpectralLibraryIndex.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+// magic number and format version of stored SpectralLibraryIndex files
+#define SPECTRAL_LIBRARY_INDEX_FILE_IDENTIFIER 8095
+#define SPECTRAL_LIBRARY_INDEX_FILE_VERSION 1
+
+namespace OpenMS
+{
+
+SpectralLibraryIndex::SpectralLibraryIndex() :
+  checksum_(0),
+  bin_width_(1.0),
+  min_mz_(0.0),
+  bin_offsets_(1, 0),
+  precursor_mz_(),
+  precursor_charge_(),
+  library_index_(),
+  peak_offsets_(1, 0),
+  peak_mz_(),
+  peak_intensity_()
+{
+  checksum_ = computeChecksum_();
+}
+
+void SpectralLibraryIndex::build(const PeakMap& spec_db, double bin_width)
+{
+  if (bin_width <= 0.0)
+  {
+    throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Bin width must be positive.", String(bin_width));
+  }
+
+  // order of the library spectra by precursor m/z (stable, so an already sorted library keeps its order)
+  std::vector<std::pair<double, Size> > order;
+  order.reserve(spec_db.size());
+  for (Size spec_idx = 0; spec_idx < spec_db.size(); ++spec_idx)
+  {
+    if (spec_db[spec_idx].getPrecursors().empty())
+    {
+      throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, String("Library spectrum ") + spec_idx + " has no precursor.");
+    }
+    order.push_back(std::make_pair(spec_db[spec_idx].getPrecursors()[0].getMZ(), spec_idx));
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [](const std::pair<double, Size>& a, const std::pair<double, Size>& b) { return a.first < b.first; });
+
+  bin_width_ = bin_width;
+  min_mz_ = order.empty() ? 0.0 : order.front().first;
+
+  precursor_mz_.clear();
+  precursor_charge_.clear();
+  library_index_.clear();
+  peak_offsets_.assign(1, 0);
+  peak_mz_.clear();
+  peak_intensity_.clear();
+
+  Size peak_count(0);
+  for (Size spec_idx = 0; spec_idx < spec_db.size(); ++spec_idx)
+  {
+    peak_count += spec_db[spec_idx].size();
+  }
+  precursor_mz_.reserve(order.size());
+  precursor_charge_.reserve(order.size());
+  library_index_.reserve(order.size());
+  peak_offsets_.reserve(order.size() + 1);
+  peak_mz_.reserve(peak_count);
+  peak_intensity_.reserve(peak_count);
+
+  for (Size i = 0; i < order.size(); ++i)
+  {
+    const MSSpectrum& spec = spec_db[order[i].second];
+    precursor_mz_.push_back(order[i].first);
+    precursor_charge_.push_back(spec.getPrecursors()[0].getCharge());
+    library_index_.push_back(order[i].second);
+    for (MSSpectrum::ConstIterator it = spec.begin(); it != spec.end(); ++it)
+    {
+      peak_mz_.push_back(it->getMZ());
+      peak_intensity_.push_back(it->getIntensity());
+    }
+    peak_offsets_.push_back(peak_mz_.size());
+  }
+
+  // first entry of each precursor bin
+  Size bin_count = precursor_mz_.empty() ? 0 : (Size)((precursor_mz_.back() - min_mz_) / bin_width_) + 1;
+  bin_offsets_.assign(bin_count + 1, precursor_mz_.size());
+  for (Size i = precursor_mz_.size(); i > 0; --i)
+  {
+    bin_offsets_[(Size)((precursor_mz_[i - 1] - min_mz_) / bin_width_)] = i - 1;
+  }
+  // empty bins start where the next non-empty one starts
+  for (Size b = bin_count; b > 0; --b)
+  {
+    bin_offsets_[b - 1] = std::min(bin_offsets_[b - 1], bin_offsets_[b]);
+  }
+
+  checksum_ = computeChecksum_();
+}
+
+namespace
+{
+  template <typename T>
+  void writeVector(std::ofstream& ofs, const std::vector<T>& data)
+  {
+    Size size = data.size();
+    ofs.write((char*)&size, sizeof(size));
+    if (size > 0) ofs.write((char*)&data[0], sizeof(T) * size);
+  }
+
+  template <typename T>
+  bool readVector(std::ifstream& ifs, std::vector<T>& data)
+  {
+    Size size(0);
+    ifs.read((char*)&size, sizeof(size));
+    if (!ifs.good()) return false;
+    // reject sizes larger than the rest of the file (corrupt size field)
+    std::streampos pos = ifs.tellg();
+    ifs.seekg(0, std::ios::end);
+    std::streamoff remaining = ifs.tellg() - pos;
+    ifs.seekg(pos);
+    if (size > (Size)remaining / sizeof(T)) return false;
+    data.resize(size);
+    if (size > 0) ifs.read((char*)&data[0], sizeof(T) * size);
+    return ifs.good();
+  }
+
+  /// FNV-1a hash over the bytes of @p value, continuing from @p hash
+  template <typename T>
+  UInt64 hashValue(UInt64 hash, const T& value)
+  {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+    for (Size k = 0; k < sizeof(T); ++k)
+    {
+      hash ^= bytes[k];
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  const UInt64 CHECKSUM_SEED = 14695981039346656037ULL;
+
+  /// hash of a single library entry; called with the same values for the index arrays and for the library spectra
+  template <typename MZIterator, typename IntensityIterator>
+  UInt64 hashEntry(UInt64 hash, double precursor_mz, Int precursor_charge, Size peak_count,
+                   MZIterator mz, IntensityIterator intensity)
+  {
+    hash = hashValue(hash, precursor_mz);
+    hash = hashValue(hash, precursor_charge);
+    hash = hashValue(hash, (UInt64)peak_count);
+    for (Size k = 0; k < peak_count; ++k, ++mz, ++intensity)
+    {
+      hash = hashValue(hash, (double)*mz);
+      hash = hashValue(hash, (float)*intensity);
+    }
+    return hash;
+  }
+
+  /// iterators over the m/z and intensity values of the peaks of a spectrum
+  struct PeakMZIterator
+  {
+    MSSpectrum::ConstIterator it;
+    double operator*() const { return it->getMZ(); }
+    PeakMZIterator& operator++() { ++it; return *this; }
+  };
+
+  struct PeakIntensityIterator
+  {
+    MSSpectrum::ConstIterator it;
+    float operator*() const { return it->getIntensity(); }
+    PeakIntensityIterator& operator++() { ++it; return *this; }
+  };
+}
+
+void SpectralLibraryIndex::store(const String& filename) const
+{
+  std::ofstream ofs(filename.c_str(), std::ios::binary);
+  if (ofs.fail())
+  {
+    throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+  }
+
+  int file_identifier = SPECTRAL_LIBRARY_INDEX_FILE_IDENTIFIER;
+  int version = SPECTRAL_LIBRARY_INDEX_FILE_VERSION;
+  ofs.write((char*)&file_identifier, sizeof(file_identifier));
+  ofs.write((char*)&version, sizeof(version));
+  ofs.write((char*)&checksum_, sizeof(checksum_));
+  ofs.write((char*)&bin_width_, sizeof(bin_width_));
+  ofs.write((char*)&min_mz_, sizeof(min_mz_));
+  writeVector(ofs, bin_offsets_);
+  writeVector(ofs, precursor_mz_);
+  writeVector(ofs, precursor_charge_);
+  writeVector(ofs, library_index_);
+  writeVector(ofs, peak_offsets_);
+  writeVector(ofs, peak_mz_);
+  writeVector(ofs, peak_intensity_);
+  ofs.close();
+}
+
+void SpectralLibraryIndex::load(const String& filename)
+{
+  std::ifstream ifs(filename.c_str(), std::ios::binary);
+  if (ifs.fail())
+  {
+    throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+  }
+
+  int file_identifier(0);
+  ifs.read((char*)&file_identifier, sizeof(file_identifier));
+  if (file_identifier != SPECTRAL_LIBRARY_INDEX_FILE_IDENTIFIER)
+  {
+    throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+      "File might not be a spectral library index (wrong file magic number). Aborting!", filename);
+  }
+
+  int version(0);
+  ifs.read((char*)&version, sizeof(version));
+  if (version != SPECTRAL_LIBRARY_INDEX_FILE_VERSION)
+  {
+    throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+      String("Spectral library index has format version ") + version + ", expected " + SPECTRAL_LIBRARY_INDEX_FILE_VERSION + ". Please rebuild the index.", filename);
+  }
+
+  ifs.read((char*)&checksum_, sizeof(checksum_));
+  ifs.read((char*)&bin_width_, sizeof(bin_width_));
+  ifs.read((char*)&min_mz_, sizeof(min_mz_));
+  bool ok = ifs.good() &&
+            readVector(ifs, bin_offsets_) &&
+            readVector(ifs, precursor_mz_) &&
+            readVector(ifs, precursor_charge_) &&
+            readVector(ifs, library_index_) &&
+            readVector(ifs, peak_offsets_) &&
+            readVector(ifs, peak_mz_) &&
+            readVector(ifs, peak_intensity_);
+  // consistency of the arrays (all offsets and indices need to be within bounds) and of the data
+  ok = ok && bin_width_ > 0.0 && isConsistent_() && checksum_ == computeChecksum_();
+  if (!ok)
+  {
+    *this = SpectralLibraryIndex();
+    throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+      "Spectral library index is truncated or corrupt. Aborting!", filename);
+  }
+}
+
+Size SpectralLibraryIndex::size() const
+{
+  return precursor_mz_.size();
+}
+
+bool SpectralLibraryIndex::matches(const PeakMap& spec_db) const
+{
+  if (spec_db.size() != size()) return false;
+  UInt64 checksum(CHECKSUM_SEED);
+  for (Size i = 0; i < size(); ++i)
+  {
+    const MSSpectrum& spec = spec_db[library_index_[i]];
+    if (spec.getPrecursors().empty() ||
+        spec.getPrecursors()[0].getMZ() != precursor_mz_[i] ||
+        spec.size() != getPeakCount(i))
+    {
+      return false;
+    }
+    PeakMZIterator mz = {spec.begin()};
+    PeakIntensityIterator intensity = {spec.begin()};
+    checksum = hashEntry(checksum, spec.getPrecursors()[0].getMZ(), spec.getPrecursors()[0].getCharge(), spec.size(), mz, intensity);
+  }
+  return checksum == checksum_;
+}
+
+UInt64 SpectralLibraryIndex::getChecksum() const
+{
+  return checksum_;
+}
+
+UInt64 SpectralLibraryIndex::computeChecksum_() const
+{
+  UInt64 checksum(CHECKSUM_SEED);
+  for (Size i = 0; i < size(); ++i)
+  {
+    checksum = hashEntry(checksum, precursor_mz_[i], precursor_charge_[i], getPeakCount(i), getPeakMZ(i), getPeakIntensity(i));
+  }
+  return checksum;
+}
+
+bool SpectralLibraryIndex::isConsistent_() const
+{
+  // array sizes
+  if (bin_offsets_.empty() || precursor_charge_.size() != precursor_mz_.size() ||
+      library_index_.size() != precursor_mz_.size() || peak_offsets_.size() != precursor_mz_.size() + 1 ||
+      peak_intensity_.size() != peak_mz_.size())
+  {
+    return false;
+  }
+  // findPrecursorRange() needs at least one bin for a non-empty index
+  if (!precursor_mz_.empty() && bin_offsets_.size() < 2) return false;
+
+  // offsets start at zero, are monotone and end at the array size
+  if (bin_offsets_.front() != 0 || bin_offsets_.back() != precursor_mz_.size() ||
+      peak_offsets_.front() != 0 || peak_offsets_.back() != peak_mz_.size())
+  {
+    return false;
+  }
+  for (Size b = 1; b < bin_offsets_.size(); ++b)
+  {
+    if (bin_offsets_[b - 1] > bin_offsets_[b]) return false;
+  }
+  for (Size i = 1; i < peak_offsets_.size(); ++i)
+  {
+    if (peak_offsets_[i - 1] > peak_offsets_[i]) return false;
+  }
+
+  // entries are sorted by precursor and refer to a spectrum of the library
+  for (Size i = 0; i < precursor_mz_.size(); ++i)
+  {
+    if (library_index_[i] >= precursor_mz_.size()) return false;
+    if (i > 0 && !(precursor_mz_[i - 1] <= precursor_mz_[i])) return false;
+  }
+  return true;
+}
+
+std::pair<Size, Size> SpectralLibraryIndex::findPrecursorRange(double mz_lower, double mz_upper) const
+{
+  if (precursor_mz_.empty() || mz_upper < mz_lower) return std::make_pair(Size(0), Size(0));
+
+  const SignedSize last_bin = (SignedSize)bin_offsets_.size() - 2;
+  // bins containing the bounds (clamped to the index)
+  SignedSize lower_bin = std::max(SignedSize(0), std::min(last_bin, (SignedSize)std::floor((mz_lower - min_mz_) / bin_width_)));
+  SignedSize upper_bin = std::max(SignedSize(0), std::min(last_bin, (SignedSize)std::floor((mz_upper - min_mz_) / bin_width_)));
+
+  std::vector<double>::const_iterator begin = precursor_mz_.begin();
+  Size first = std::lower_bound(begin + bin_offsets_[lower_bin], begin + bin_offsets_[lower_bin + 1], mz_lower) - begin;
+  Size last = std::upper_bound(begin + bin_offsets_[upper_bin], begin + bin_offsets_[upper_bin + 1], mz_upper) - begin;
+  return std::make_pair(first, std::max(first, last));
+}
+
+double SpectralLibraryIndex::getPrecursorMZ(Size i) const
+{
+  return precursor_mz_[i];
+}
+
+Int SpectralLibraryIndex::getPrecursorCharge(Size i) const
+{
+  return precursor_charge_[i];
+}
+
+Size SpectralLibraryIndex::getLibraryIndex(Size i) const
+{
+  return library_index_[i];
+}
+
+Size SpectralLibraryIndex::getPeakCount(Size i) const
+{
+  return peak_offsets_[i + 1] - peak_offsets_[i];
+}
+
+const double* SpectralLibraryIndex::getPeakMZ(Size i) const
+{
+  return peak_mz_.data() + peak_offsets_[i];
+}
+
+const float* SpectralLibraryIndex::getPeakIntensity(Size i) const
+{
+  return peak_intensity_.data() + peak_offsets_[i];
+}
+
+}
@@ -16,6 +16,7 @@ ConsensusIDAlgorithmRanks.cpp
 ConsensusIDAlgorithmSimilarity.cpp
 ConsensusIDAlgorithmWorst.cpp
 FalseDiscoveryRate.cpp
+FragmentIndex.cpp
 HiddenMarkovModel.cpp
 IDConflictResolverAlgorithm.cpp
 IDMapper.cpp
@@ -23,12 +24,14 @@ IDRipper.cpp
 IDDecoyProbability.cpp
 MetaboliteSpectralMatching.cpp
 PeptideProteinResolution.cpp
+PrecursorMassIndex.cpp
 PrecursorPurity.cpp
 ProtonDistributionModel.cpp
 PeptideIndexing.cpp
 PercolatorFeatureSetHelper.cpp
 SiriusAdapterAlgorithm.cpp
 SiriusMSConverter.cpp
+SpectralLibraryIndex.cpp
 )
 
 ### add path to the filenames
@@ -36,6 +36,11 @@
 #include <OpenMS/FILTERING/BASELINE/MorphologicalFilter.h>
 #include <OpenMS/MATH/STATISTICS/BasicStatistics.h>
 #include <OpenMS/MATH/MISC/LinearInterpolation.h>
+#include <OpenMS/KERNEL/ComparatorUtils.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 // #define Debug_PoseClusteringAffineSuperimposer
 
@@ -62,6 +67,11 @@ namespace OpenMS
                                                 "and to disregard weak signals during alignment.  For using all points, set this to -1.");
     defaults_.setMinInt("num_used_points", -1);
 
+    defaults_.setValue("subsample_stride", 1, "Of the elements selected by 'num_used_points', use only every n-th one "
+                                              "(ranked by decreasing intensity, ties are kept in input order) for hashing.  "
+                                              "Increase this to reduce the running time on very large maps.", ListUtils::create<String>("advanced"));
+    defaults_.setMinInt("subsample_stride", 1);
+
     defaults_.setValue("scaling_bucket_size", 0.005, "The scaling of the retention time "
                                                      "interval is being hashed into buckets of this size during pose "
                                                      "clustering.  A good choice for this would be a bit smaller than the "
@@ -133,6 +143,46 @@ namespace OpenMS
     rt_high_hash_.setMapping(shift_bucket_size, rt_buckets_num_half, rt_high);
   }
 
+  /**
+    @brief Adds the histogram of @p from to the histogram of @p to (same mapping required).
+  */
+  void addHashTable(const Math::LinearInterpolation<double, double>& from,
+                    Math::LinearInterpolation<double, double>& to)
+  {
+    const Math::LinearInterpolation<double, double>::container_type& from_data = from.getData();
+    Math::LinearInterpolation<double, double>::container_type& to_data = to.getData();
+    for (Size index = 0; index < to_data.size(); ++index)
+    {
+      to_data[index] += from_data[index];
+    }
+  }
+
+  /**
+    @brief Empty copies (same mapping) of the hash tables, filled by a single thread during hashing.
+  */
+  struct AffineHashTables
+  {
+    AffineHashTables(const Math::LinearInterpolation<double, double>& scaling_1,
+                     const Math::LinearInterpolation<double, double>& scaling_2,
+                     const Math::LinearInterpolation<double, double>& rt_low,
+                     const Math::LinearInterpolation<double, double>& rt_high) :
+      scaling_hash_1(scaling_1),
+      scaling_hash_2(scaling_2),
+      rt_low_hash(rt_low),
+      rt_high_hash(rt_high)
+    {
+      std::fill(scaling_hash_1.getData().begin(), scaling_hash_1.getData().end(), 0.);
+      std::fill(scaling_hash_2.getData().begin(), scaling_hash_2.getData().end(), 0.);
+      std::fill(rt_low_hash.getData().begin(), rt_low_hash.getData().end(), 0.);
+      std::fill(rt_high_hash.getData().begin(), rt_high_hash.getData().end(), 0.);
+    }
+
+    Math::LinearInterpolation<double, double> scaling_hash_1;
+    Math::LinearInterpolation<double, double> scaling_hash_2;
+    Math::LinearInterpolation<double, double> rt_low_hash;
+    Math::LinearInterpolation<double, double> rt_high_hash;
+  };
+
   /**
     @brief Estimates scaling by trying different (weighted) affine transformations.
 
@@ -145,8 +195,13 @@ namespace OpenMS
     round, only consider quadruplets where the scaling factor matches the
     estimated bounds of (scale_low_1,scale_high_1), discard all other data.
 
+    The items of the model map are distributed over all threads (unless pairs
+    are dumped), the progress (and time) of each round is reported through
+    @p logger.
+
   */
-  void affineTransformationHashing(const bool do_dump_pairs,
+  void affineTransformationHashing(const ProgressLogger& logger,
+                                   const bool do_dump_pairs,
                                    const std::vector<Peak2D> & model_map,
                                    const std::vector<Peak2D> & scene_map,
                                    Math::LinearInterpolation<double, double>& scaling_hash_1,
@@ -176,135 +231,195 @@ namespace OpenMS
       dump_pairs_file << "#" << ' ' << "i" << ' ' << "j" << ' ' << "k" << ' ' << "l" << ' ' << std::endl;
     }
 
-    // first point in model map (i)
-    for (Size i = 0, i_low = 0, i_high = 0, k_low = 0, k_high = 0; i < model_map_size - 1; ++i)
+    // Compute the m/z windows around each item i of the model map up front
+    // (in the model map and in the scene map), so that the items can be
+    // processed independently of each other below.
+    std::vector<std::pair<Size, Size> > i_windows(model_map_size), k_windows(model_map_size);
+    for (Size i = 0, i_low = 0, i_high = 0, k_low = 0, k_high = 0; i < model_map_size; ++i)
     {
       // Adjust window around i in model map (get all features in a m/z range of item i in the model map)
       while (i_low < model_map_size && model_map[i_low].getMZ() < model_map[i].getMZ() - mz_pair_max_distance)
         ++i_low;
       while (i_high < model_map_size && model_map[i_high].getMZ() <= model_map[i].getMZ() + mz_pair_max_distance)
         ++i_high;
-      // stop if there are too many features are in our window
-      double i_winlength_factor = 1. / (i_high - i_low);
-      i_winlength_factor -= winlength_factor_baseline;
-      if (i_winlength_factor <= 0)
-        continue;
+      i_windows[i] = std::make_pair(i_low, i_high);
 
       // Adjust window around k in scene map (get all features in a m/z range of item i in the scene map)
       while (k_low < scene_map_size && scene_map[k_low].getMZ() < model_map[i].getMZ() - mz_pair_max_distance)
         ++k_low;
       while (k_high < scene_map_size && scene_map[k_high].getMZ() <= model_map[i].getMZ() + mz_pair_max_distance)
         ++k_high;
+      k_windows[i] = std::make_pair(k_low, k_high);
+    }
+
+    // Every thread hashes into its own (empty) copies of the hash tables,
+    // these are added up in the order of the threads afterwards. Dumping the
+    // pairs requires a single thread.
+    Size num_threads = 1;
+#ifdef _OPENMP
+    if (!do_dump_pairs) num_threads = omp_get_max_threads();
+#endif
+    std::vector<AffineHashTables> thread_hashes(num_threads,
+      AffineHashTables(scaling_hash_1, scaling_hash_2, rt_low_hash_, rt_high_hash_));
 
-      // Iterate through all matching features in the scene map that are
-      // within the m/z distance of item i from the model map.
-      // first point in scene map (k)
-      for (Size k = k_low; k < k_high; ++k)
+    logger.startProgress(0, model_map_size - 1, "affine hashing, round " + String(hashing_round));
+    Size progress = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads((int)num_threads)
+#endif
+    {
+      Size thread_num = 0;
+#ifdef _OPENMP
+      thread_num = omp_get_thread_num();
+#endif
+      Math::LinearInterpolation<double, double>& scaling_hash_1_local = thread_hashes[thread_num].scaling_hash_1;
+      Math::LinearInterpolation<double, double>& scaling_hash_2_local = thread_hashes[thread_num].scaling_hash_2;
+      Math::LinearInterpolation<double, double>& rt_low_hash_local = thread_hashes[thread_num].rt_low_hash;
+      Math::LinearInterpolation<double, double>& rt_high_hash_local = thread_hashes[thread_num].rt_high_hash;
+
+      // first point in model map (i)
+      // (the work per item decreases with i, interleaving balances the load)
+#ifdef _OPENMP
+#pragma omp for schedule(static, 1)
+#endif
+      for (SignedSize signed_i = 0; signed_i < (SignedSize)model_map_size - 1; ++signed_i)
       {
+        const Size i = signed_i;
+#ifdef _OPENMP
+#pragma omp critical (PoseClusteringAffineSuperimposer_progress)
+#endif
+        logger.setProgress(++progress);
+
+        const Size i_low = i_windows[i].first, i_high = i_windows[i].second;
+        const Size k_low = k_windows[i].first, k_high = k_windows[i].second;
+
         // stop if there are too many features are in our window
-        double k_winlength_factor = 1. / (k_high - k_low);
-        k_winlength_factor -= winlength_factor_baseline;
-        if (k_winlength_factor <= 0)
+        double i_winlength_factor = 1. / (i_high - i_low);
+        i_winlength_factor -= winlength_factor_baseline;
+        if (i_winlength_factor <= 0)
           continue;
 
-        // compute similarity of intensities i k by taking the ratio of the two intensities
-        double similarity_ik;
-        {
-          const double int_i = model_map[i].getIntensity();
-          const double int_k = scene_map[k].getIntensity() * total_intensity_ratio;
-          similarity_ik = (int_i < int_k) ? int_i / int_k : int_k / int_i;
-          // weight is inverse proportional to number of elements with similar mz
-          similarity_ik *= i_winlength_factor;
-          similarity_ik *= k_winlength_factor;
-        }
-
-        // second point in model map (j)
-        for (Size j = i + 1, j_low = i_low, j_high = i_low, l_low = k_low, l_high = k_high; j < model_map_size; ++j)
+        // Iterate through all matching features in the scene map that are
+        // within the m/z distance of item i from the model map.
+        // first point in scene map (k)
+        for (Size k = k_low; k < k_high; ++k)
         {
-          // diff in model map -> skip features that are too far away in RT
-          double diff_model = model_map[j].getRT() - model_map[i].getRT();
-          if (fabs(diff_model) < rt_pair_min_distance)
-            continue;
-
-          // Adjust window around j in model map
-          while (j_low < model_map_size && model_map[j_low].getMZ() < model_map[i].getMZ() - mz_pair_max_distance)
-            ++j_low;
-          while (j_high < model_map_size && model_map[j_high].getMZ() <= model_map[i].getMZ() + mz_pair_max_distance)
-            ++j_high;
-          double j_winlength_factor = 1. / (j_high - j_low);
-          j_winlength_factor -= winlength_factor_baseline;
-          if (j_winlength_factor <= 0)
+          // stop if there are too many features are in our window
+          double k_winlength_factor = 1. / (k_high - k_low);
+          k_winlength_factor -= winlength_factor_baseline;
+          if (k_winlength_factor <= 0)
             continue;
 
-          // Adjust window around l in scene map
-          while (l_low < scene_map_size && scene_map[l_low].getMZ() < model_map[j].getMZ() - mz_pair_max_distance)
-            ++l_low;
-          while (l_high < scene_map_size && scene_map[l_high].getMZ() <= model_map[j].getMZ() + mz_pair_max_distance)
-            ++l_high;
+          // compute similarity of intensities i k by taking the ratio of the two intensities
+          double similarity_ik;
+          {
+            const double int_i = model_map[i].getIntensity();
+            const double int_k = scene_map[k].getIntensity() * total_intensity_ratio;
+            similarity_ik = (int_i < int_k) ? int_i / int_k : int_k / int_i;
+            // weight is inverse proportional to number of elements with similar mz
+            similarity_ik *= i_winlength_factor;
+            similarity_ik *= k_winlength_factor;
+          }
 
-          // second point in scene map (l)
-          for (Size l = l_low; l < l_high; ++l)
+          // second point in model map (j)
+          for (Size j = i + 1, j_low = i_low, j_high = i_low, l_low = k_low, l_high = k_high; j < model_map_size; ++j)
           {
-            double l_winlength_factor = 1. / (l_high - l_low);
-            l_winlength_factor -= winlength_factor_baseline;
-            if (l_winlength_factor <= 0)
+            // diff in model map -> skip features that are too far away in RT
+            double diff_model = model_map[j].getRT() - model_map[i].getRT();
+            if (fabs(diff_model) < rt_pair_min_distance)
               continue;
 
-            // diff in scene map -> skip features that are too far away in RT
-            double diff_scene = scene_map[l].getRT() - scene_map[k].getRT();
-
-            // avoid cross mappings (i,j) -> (k,l) (e.g. i_rt < j_rt and k_rt > l_rt)
-            // and point pairs with equal retention times (e.g. i_rt == j_rt)
-            if (fabs(diff_scene) < rt_pair_min_distance || ((diff_model > 0) != (diff_scene > 0)))
+            // Adjust window around j in model map
+            while (j_low < model_map_size && model_map[j_low].getMZ() < model_map[i].getMZ() - mz_pair_max_distance)
+              ++j_low;
+            while (j_high < model_map_size && model_map[j_high].getMZ() <= model_map[i].getMZ() + mz_pair_max_distance)
+              ++j_high;
+            double j_winlength_factor = 1. / (j_high - j_low);
+            j_winlength_factor -= winlength_factor_baseline;
+            if (j_winlength_factor <= 0)
               continue;
 
-            // compute the transformation (i,j) -> (k,l)
-            double scaling = diff_model / diff_scene;
-            double shift = model_map[i].getRT() - scene_map[k].getRT() * scaling;
+            // Adjust window around l in scene map
+            while (l_low < scene_map_size && scene_map[l_low].getMZ() < model_map[j].getMZ() - mz_pair_max_distance)
+              ++l_low;
+            while (l_high < scene_map_size && scene_map[l_high].getMZ() <= model_map[j].getMZ() + mz_pair_max_distance)
+              ++l_high;
 
-            // compute similarity of intensities i k j l
-            double similarity_ik_jl;
-            {
-              // compute similarity of intensities j l
-              const double int_j = model_map[j].getIntensity();
-              const double int_l = scene_map[l].getIntensity() * total_intensity_ratio;
-              double similarity_jl = (int_j < int_l) ? int_j / int_l : int_l / int_j;
-              // weight is inverse proportional to number of elements with similar mz
-              similarity_jl *= j_winlength_factor;
-              similarity_jl *= l_winlength_factor;
-              similarity_ik_jl = similarity_ik * similarity_jl;
-            }
-
-            // hash the images of scaling, rt_low and rt_high into their respective hash tables
-            // store the scaling parameter and the (estimated) transformation of start/end of the maps in hashes
-            //   -> in round 2, discard values outside of scale_low_1 and
-            //   scale_high_1 (estimated before in scalingEstimate)
-            if (hashing_round == 1)
+            // second point in scene map (l)
+            for (Size l = l_low; l < l_high; ++l)
             {
-              // hashing round 1 (estimate the scaling only)
-              scaling_hash_1.addValue(log(scaling), similarity_ik_jl);
-            }
-            else if (scaling >= scale_low_1 && scaling <= scale_high_1)
-            {
-              // hashing round 2 (estimate scaling and shift)
-              scaling_hash_2.addValue(log(scaling), similarity_ik_jl);
+              double l_winlength_factor = 1. / (l_high - l_low);
+              l_winlength_factor -= winlength_factor_baseline;
+              if (l_winlength_factor <= 0)
+                continue;
+
+              // diff in scene map -> skip features that are too far away in RT
+              double diff_scene = scene_map[l].getRT() - scene_map[k].getRT();
 
-              const double rt_low_image = shift + rt_low * scaling;
-              rt_low_hash_.addValue(rt_low_image, similarity_ik_jl);
-              const double rt_high_image = shift + rt_high * scaling;
-              rt_high_hash_.addValue(rt_high_image, similarity_ik_jl);
+              // avoid cross mappings (i,j) -> (k,l) (e.g. i_rt < j_rt and k_rt > l_rt)
+              // and point pairs with equal retention times (e.g. i_rt == j_rt)
+              if (fabs(diff_scene) < rt_pair_min_distance || ((diff_model > 0) != (diff_scene > 0)))
+                continue;
+
+              // compute the transformation (i,j) -> (k,l)
+              double scaling = diff_model / diff_scene;
+              double shift = model_map[i].getRT() - scene_map[k].getRT() * scaling;
+
+              // compute similarity of intensities i k j l
+              double similarity_ik_jl;
+              {
+                // compute similarity of intensities j l
+                const double int_j = model_map[j].getIntensity();
+                const double int_l = scene_map[l].getIntensity() * total_intensity_ratio;
+                double similarity_jl = (int_j < int_l) ? int_j / int_l : int_l / int_j;
+                // weight is inverse proportional to number of elements with similar mz
+                similarity_jl *= j_winlength_factor;
+                similarity_jl *= l_winlength_factor;
+                similarity_ik_jl = similarity_ik * similarity_jl;
+              }
 
-              if (do_dump_pairs)
+              // hash the images of scaling, rt_low and rt_high into their respective hash tables
+              // store the scaling parameter and the (estimated) transformation of start/end of the maps in hashes
+              //   -> in round 2, discard values outside of scale_low_1 and
+              //   scale_high_1 (estimated before in scalingEstimate)
+              if (hashing_round == 1)
               {
-                dump_pairs_file << i << ' ' << model_map[i].getRT() << ' ' << model_map[i].getMZ() << ' ' << j << ' ' << model_map[j].getRT() << ' '
-                                << model_map[j].getMZ() << ' ' << k << ' ' << scene_map[k].getRT() << ' ' << scene_map[k].getMZ() << ' ' << l << ' '
-                                << scene_map[l].getRT() << ' ' << scene_map[l].getMZ() << ' ' << similarity_ik_jl << ' ' << std::endl;
+                // hashing round 1 (estimate the scaling only)
+                scaling_hash_1_local.addValue(log(scaling), similarity_ik_jl);
               }
-            }
-          }   // l
-        }   // j
-      }   // k
-    }   // i
+              else if (scaling >= scale_low_1 && scaling <= scale_high_1)
+              {
+                // hashing round 2 (estimate scaling and shift)
+                scaling_hash_2_local.addValue(log(scaling), similarity_ik_jl);
+
+                const double rt_low_image = shift + rt_low * scaling;
+                rt_low_hash_local.addValue(rt_low_image, similarity_ik_jl);
+                const double rt_high_image = shift + rt_high * scaling;
+                rt_high_hash_local.addValue(rt_high_image, similarity_ik_jl);
+
+                if (do_dump_pairs)
+                {
+                  dump_pairs_file << i << ' ' << model_map[i].getRT() << ' ' << model_map[i].getMZ() << ' ' << j << ' ' << model_map[j].getRT() << ' '
+                                  << model_map[j].getMZ() << ' ' << k << ' ' << scene_map[k].getRT() << ' ' << scene_map[k].getMZ() << ' ' << l << ' '
+                                  << scene_map[l].getRT() << ' ' << scene_map[l].getMZ() << ' ' << similarity_ik_jl << ' ' << std::endl;
+                }
+              }
+            }   // l
+          }   // j
+        }   // k
+      }   // i
+    }   // omp parallel
+
+    // add up the histograms of all threads
+    for (Size t = 0; t < thread_hashes.size(); ++t)
+    {
+      addHashTable(thread_hashes[t].scaling_hash_1, scaling_hash_1);
+      addHashTable(thread_hashes[t].scaling_hash_2, scaling_hash_2);
+      addHashTable(thread_hashes[t].rt_low_hash, rt_low_hash_);
+      addHashTable(thread_hashes[t].rt_high_hash, rt_high_hash_);
+    }
+    logger.endProgress();
   }
 
   /**
@@ -715,6 +830,34 @@ namespace OpenMS
     }
   }
 
+  void PoseClusteringAffineSuperimposer::selectByIntensityRank(std::vector<Peak2D>& map, const Size num_used_points, const Size stride)
+  {
+    if (stride <= 1)
+    {
+      // sort the last data points by ascending intensity (from the right, using reverse iterators)
+      //  -> linear in complexity, should be faster than sorting and then taking cutoff
+      if (map.size() > num_used_points)
+      {
+        std::nth_element(map.rbegin(), map.rbegin() + (map.size() - num_used_points),
+            map.rend(), Peak2D::IntensityLess());
+        map.resize(num_used_points);
+      }
+      return;
+    }
+
+    std::stable_sort(map.begin(), map.end(), reverseComparator(Peak2D::IntensityLess()));
+    if (map.size() > num_used_points)
+    {
+      map.resize(num_used_points);
+    }
+    Size kept = 0;
+    for (Size rank = 0; rank < map.size(); rank += stride)
+    {
+      map[kept++] = map[rank];
+    }
+    map.resize(kept);
+  }
+
   double computeIntensityRatio(const std::vector<Peak2D> & model_map, const std::vector<Peak2D> & scene_map)
   {
     double total_int_model_map = 0;
@@ -809,22 +952,11 @@ namespace OpenMS
     {
       // truncate the data as necessary
       const Size num_used_points = (Int) param_.getValue("num_used_points");
+      const Size subsample_stride = (Int) param_.getValue("subsample_stride");
 
-      // sort the last data points by ascending intensity (from the right, using reverse iterators)
-      //  -> linear in complexity, should be faster than sorting and then taking cutoff
-      if (model_map.size() > num_used_points)
-      {
-        std::nth_element(model_map.rbegin(), model_map.rbegin() + (model_map.size() - num_used_points),
-            model_map.rend(), Peak2D::IntensityLess());
-        model_map.resize(num_used_points);
-      }
+      selectByIntensityRank(model_map, num_used_points, subsample_stride);
       setProgress(++actual_progress);
-      if (scene_map.size() > num_used_points)
-      {
-        std::nth_element(scene_map.rbegin(), scene_map.rbegin() + (scene_map.size() - num_used_points),
-            scene_map.rend(), Peak2D::IntensityLess());
-        scene_map.resize(num_used_points);
-      }
+      selectByIntensityRank(scene_map, num_used_points, subsample_stride);
       setProgress(++actual_progress);
     }
     // sort by ascending m/z
@@ -904,6 +1036,11 @@ namespace OpenMS
     static Int dump_buckets_serial = 0;
     ++dump_buckets_serial;
 
+    // reports progress and running time of each hashing round (separate
+    // logger, nested into the progress of this superimposer)
+    ProgressLogger hashing_logger;
+    hashing_logger.setLogType(getLogType());
+
     //**************************************************************************
     // Step 4: Hashing
     //         Compute the transformations between each point pair in the model
@@ -919,6 +1056,7 @@ namespace OpenMS
     ///////////////////////////////////////////////////////////////////
     // Step 4.1 First round of hashing: Estimate the scaling
     affineTransformationHashing(
+      hashing_logger,
       do_dump_pairs,
       model_map, scene_map,
       scaling_hash_1, scaling_hash_2, rt_low_hash_, rt_high_hash_,
@@ -959,6 +1097,7 @@ namespace OpenMS
     // thereby re-estimate the scaling. This uses the first guess of the
     // scaling to reduce noise in the histograms.
     affineTransformationHashing(
+      hashing_logger,
       do_dump_pairs,
       model_map, scene_map,
       scaling_hash_1, scaling_hash_2, rt_low_hash_, rt_high_hash_,
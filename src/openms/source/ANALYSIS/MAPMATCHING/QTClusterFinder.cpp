@@ -189,9 +189,6 @@ namespace OpenMS
   void QTClusterFinder::run_internal_(const vector<MapType>& input_maps,
                              ConsensusMap& result_map, bool do_progress)
   {
-    // clear temporary data structures
-    already_used_.clear();
-
     num_maps_ = input_maps.size();
     if (num_maps_ < 2)
     {
@@ -199,6 +196,17 @@ namespace OpenMS
                                        "At least two input maps required");
     }
 
+    // features are numbered consecutively over all input maps
+    map_offsets_.assign(1, 0);
+    for (Size map_index = 0; map_index < num_maps_; ++map_index)
+    {
+      map_offsets_.push_back(map_offsets_.back() + input_maps[map_index].size());
+    }
+    const Size num_features = map_offsets_.back();
+
+    // clear temporary data structures
+    already_used_.assign(num_features, false);
+
     // set up the distance functor (and set other parameters)
     // for the current partition
     double max_intensity = 0.0;
@@ -239,18 +247,17 @@ namespace OpenMS
 
     // compute QT clustering:
     // std::cout << "Clustering..." << std::endl;
-    list<QTCluster> clustering;
+    vector<QTCluster> clustering;
     computeClustering_(grid, clustering);
     // number of clusters == number of data points:
     Size size = clustering.size();
 
     // create a temp. map storing which grid features are next to which clusters
     typedef OpenMSBoost::unordered_map<Size, std::vector<GridFeature*> > NeighborList;
-    ElementMapping element_mapping;
-    for (list<QTCluster>::iterator it = clustering.begin();
-         it != clustering.end(); ++it)
+    ElementMapping element_mapping(num_features);
+    for (Size cluster_index = 0; cluster_index < clustering.size(); ++cluster_index)
     {
-      NeighborList neigh = it->getAllNeighbors();
+      NeighborList neigh = clustering[cluster_index].getAllNeighbors();
       for (NeighborList::iterator n_it = neigh.begin(); n_it != neigh.end(); ++n_it)
       {
         for (std::vector<GridFeature*>::iterator i_it = n_it->second.begin();
@@ -258,17 +265,23 @@ namespace OpenMS
         {
           // remember for each feature (gridfeature) all the cluster elements
           // it belongs to
-          element_mapping[*i_it].push_back(&(*it));
+          element_mapping[featureIndex_(*i_it)].push_back(cluster_index);
         }
       }
     }
 
     // ensure that all cluster centers are in the list
-    for (list<QTCluster>::iterator it = clustering.begin();
-         it != clustering.end(); ++it)
+    for (Size cluster_index = 0; cluster_index < clustering.size(); ++cluster_index)
     {
-      OpenMS::GridFeature* center_feature = it->getCenterPoint();
-      element_mapping[center_feature].push_back(&(*it));
+      OpenMS::GridFeature* center_feature = clustering[cluster_index].getCenterPoint();
+      element_mapping[featureIndex_(center_feature)].push_back(cluster_index);
+    }
+
+    // initial cluster qualities
+    ClusterQueue cluster_queue;
+    for (Size cluster_index = 0; cluster_index < clustering.size(); ++cluster_index)
+    {
+      cluster_queue.push(ClusterQuality(clustering[cluster_index].getQuality(), cluster_index));
     }
 
     ProgressLogger logger;
@@ -283,7 +296,7 @@ namespace OpenMS
     {
       // std::cout << "Clusters: " << clustering.size() << std::endl;
       ConsensusFeature consensus_feature;
-      makeConsensusFeature_(clustering, consensus_feature, element_mapping, grid);
+      makeConsensusFeature_(clustering, cluster_queue, consensus_feature, element_mapping, grid);
       if (!clustering.empty())
       {
         result_map.push_back(consensus_feature);
@@ -294,27 +307,25 @@ namespace OpenMS
     if (do_progress) logger.endProgress();
   }
 
-  void QTClusterFinder::makeConsensusFeature_(list<QTCluster>& clustering,
+  void QTClusterFinder::makeConsensusFeature_(vector<QTCluster>& clustering,
+                                              ClusterQueue& cluster_queue,
                                               ConsensusFeature& feature,
                                               ElementMapping& element_mapping,
                                               Grid& grid)
   {
-    // find the best cluster (a valid cluster with the highest score)
-    // -> this is equivalent to std::max_element but we can skip invalid clusters
-    list<QTCluster>::iterator best = clustering.begin();
-    while (best != clustering.end() && best->isInvalid()) // find start element
+    // find the best cluster (a valid cluster with the highest score, the
+    // first one in case of ties): skip queue entries of invalid clusters and
+    // entries with outdated qualities (every update pushes a new entry)
+    vector<QTCluster>::iterator best = clustering.end();
+    while (!cluster_queue.empty())
     {
-      ++best;
-    }
-    for (list<QTCluster>::iterator it = best;
-         it != clustering.end(); ++it)
-    {
-      if (!it->isInvalid())
+      const ClusterQuality top = cluster_queue.top();
+      cluster_queue.pop();
+      QTCluster& cluster = clustering[top.second];
+      if (!cluster.isInvalid() && cluster.getQuality() == top.first)
       {
-        if (it->getQuality() > best->getQuality())
-        {
-          best = it;
-        }
+        best = clustering.begin() + top.second;
+        break;
       }
     }
 
@@ -361,7 +372,7 @@ namespace OpenMS
     for (OpenMSBoost::unordered_map<Size, OpenMS::GridFeature*>::const_iterator
          it = elements.begin(); it != elements.end(); ++it)
     {
-      already_used_.insert(it->second);
+      already_used_[featureIndex_(it->second)] = true;
     }
 
     // update the clustering:
@@ -375,39 +386,46 @@ namespace OpenMS
       // Identify all features that could potentially have been touched by this
       //  Get all clusters that may potentially need updating
 
-      ElementMapping tmp_element_mapping; // modify copy, then update
+      // (feature index, cluster index) pairs to add to element_mapping (modify copy, then update)
+      vector<std::pair<Size, Size> > tmp_element_mapping;
 
-      for (std::vector<QTCluster*>::iterator
-           cluster  = element_mapping[&(*it->second)].begin();
-           cluster != element_mapping[&(*it->second)].end(); ++cluster)
+      const vector<Size>& touched_clusters = element_mapping[featureIndex_(it->second)];
+      for (vector<Size>::const_iterator cluster_index = touched_clusters.begin();
+           cluster_index != touched_clusters.end(); ++cluster_index)
       {
+        QTCluster& cluster = clustering[*cluster_index];
+
         // we do not want to update invalid features (saves time and does not
         // recompute the quality)
-        if (!(*cluster)->isInvalid())
+        if (!cluster.isInvalid())
         {
           // remove the elements of the new feature from the cluster
-          if ((*cluster)->update(elements))
+          if (cluster.update(elements))
           {
             // If update returns true, it means that at least one element was
             // removed from the cluster and we need to update that cluster
 
             // Get the coordinates of the current cluster
-            const Int x = (*cluster)->getXCoord(); 
-            const Int y = (*cluster)->getYCoord();
+            const Int x = cluster.getXCoord();
+            const Int y = cluster.getYCoord();
 
             ////////////////////////////////////////
             // Step 1: Iterate through all neighboring grid features and try to
             // add elements to the current cluster to replace the ones we just
             // removed
-            const OpenMS::GridFeature* center_feature = (*cluster)->getCenterPoint();
-            addClusterElements_(x, y, grid, (**cluster), center_feature);
+            const OpenMS::GridFeature* center_feature = cluster.getCenterPoint();
+            addClusterElements_(x, y, grid, cluster, center_feature, feature_distance_);
+
+            // the quality has changed: add a new entry to the queue (the old
+            // one is skipped later)
+            cluster_queue.push(ClusterQuality(cluster.getQuality(), *cluster_index));
 
             ////////////////////////////////////////
             // Step 2: update element_mapping as the best feature for each
             // cluster may have changed
             typedef OpenMSBoost::unordered_map<Size,
                     std::vector<GridFeature*> > NeighborList;
-            NeighborList neigh = (*cluster)->getAllNeighbors();
+            NeighborList neigh = cluster.getAllNeighbors();
             for (NeighborList::iterator n_it = neigh.begin(); n_it != neigh.end(); ++n_it)
             {
               for (std::vector<GridFeature*>::iterator i_it =
@@ -415,27 +433,23 @@ namespace OpenMS
               {
                 // remember for each feature (gridfeature) all the cluster
                 // elements it belongs to
-                tmp_element_mapping[*i_it].push_back(*cluster);
+                tmp_element_mapping.push_back(make_pair(featureIndex_(*i_it), *cluster_index));
               }
             }
           }
         }
       }
 
-      for (ElementMapping::iterator it = tmp_element_mapping.begin(); 
-          it != tmp_element_mapping.end(); ++it )
+      for (vector<std::pair<Size, Size> >::const_iterator it = tmp_element_mapping.begin();
+          it != tmp_element_mapping.end(); ++it)
       {
-        for (std::vector<QTCluster*>::iterator it2 = it->second.begin();
-            it2 != it->second.end(); ++it2)
-        {
-          element_mapping[ it->first ].push_back(*it2);
-        }
+        element_mapping[it->first].push_back(it->second);
       }
     }
   }
 
   void QTClusterFinder::addClusterElements_(int x, int y, const Grid& grid, QTCluster& cluster,
-    const OpenMS::GridFeature* center_feature)
+    const OpenMS::GridFeature* center_feature, FeatureDistance& feature_distance) const
   {
     cluster.initializeCluster();
 
@@ -469,7 +483,7 @@ namespace OpenMS
 
             // Skip features that we have already used -> we cannot add them to
             // be neighbors any more
-            if (already_used_.find(neighbor_feature) != already_used_.end() )
+            if (already_used_[featureIndex_(neighbor_feature)])
             {
               continue;
             }
@@ -478,7 +492,7 @@ namespace OpenMS
             if (center_feature != neighbor_feature)
             {
               // NOTE: this actually caches the distance -> memory problem
-              double dist = getDistance_(center_feature, neighbor_feature);
+              double dist = getDistance_(feature_distance, center_feature, neighbor_feature);
 
               if (dist == FeatureDistance::infinity)
               {
@@ -531,35 +545,56 @@ namespace OpenMS
   }
 
   void QTClusterFinder::computeClustering_(Grid& grid,
-                                           list<QTCluster>& clustering)
+                                           vector<QTCluster>& clustering)
   {
     clustering.clear();
-    already_used_.clear();
+    already_used_.assign(already_used_.size(), false);
 
     // FeatureDistance produces normalized distances (between 0 and 1):
     const double max_distance = 1.0;
 
-    // iterate over all grid cells:
+    // create one cluster per grid feature (in grid order)
     for (Grid::iterator it = grid.begin(); it != grid.end(); ++it)
     {
       const Grid::CellIndex& act_coords = it.index();
       const Int x = act_coords[0], y = act_coords[1];
 
       OpenMS::GridFeature* center_feature = it->second;
-      QTCluster cluster(center_feature, num_maps_, max_distance, use_IDs_, x, y);
+      clustering.push_back(QTCluster(center_feature, num_maps_, max_distance, use_IDs_, x, y));
+    }
 
-      addClusterElements_(x, y, grid, cluster, center_feature);
+    // the clusters are independent of each other: collect their elements in parallel
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      // FeatureDistance modifies internal state, so every thread uses a copy
+      FeatureDistance feature_distance(feature_distance_);
 
-      clustering.push_back(cluster);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 100)
+#endif
+      for (SignedSize i = 0; i < (SignedSize)clustering.size(); ++i)
+      {
+        QTCluster& cluster = clustering[i];
+        addClusterElements_(cluster.getXCoord(), cluster.getYCoord(), grid, cluster,
+                            cluster.getCenterPoint(), feature_distance);
+      }
     }
   }
 
-  double QTClusterFinder::getDistance_(const OpenMS::GridFeature* left,
-                                       const OpenMS::GridFeature* right)
+  Size QTClusterFinder::featureIndex_(const OpenMS::GridFeature* feature) const
   {
-    return feature_distance_(left->getFeature(), right->getFeature()).second;
+    return map_offsets_[feature->getMapIndex()] + feature->getFeatureIndex();
   }
-  
+
+  double QTClusterFinder::getDistance_(FeatureDistance& feature_distance,
+                                       const OpenMS::GridFeature* left,
+                                       const OpenMS::GridFeature* right) const
+  {
+    return feature_distance(left->getFeature(), right->getFeature()).second;
+  }
+
 
   QTClusterFinder::~QTClusterFinder()
   {
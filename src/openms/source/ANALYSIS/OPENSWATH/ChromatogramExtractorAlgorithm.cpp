@@ -38,6 +38,8 @@
 
 #include <OpenMS/CONCEPT/Exception.h>
 
+#include <algorithm>
+
 namespace OpenMS
 {
 
@@ -95,32 +97,22 @@ namespace OpenMS
       integrated_intensity += (*int_walker);
     }
 
-    // (i) Walk to the left one step and then keep walking left until we go
-    // outside the window. Note for the first step to the left we have to
-    // check for the walker becoming equal to the first data point.
+    // (i) Walk to the left until we go outside the window (or past the
+    // first data point). If we moved past the end of the spectrum, the last
+    // peak was already considered above.
     mz_walker  = mz_it;
     int_walker = int_it;
-    if (mz_it != mz_start)
+    if (mz_it == mz_end)
     {
       --mz_walker;
       --int_walker;
-
-      // Special case: target m/z is larger than first data point but the first
-      // data point is inside the window.
-      // Then, mz_it is the second data point, mz_walker now points to the very
-      // first data point. If mz_it was the first data point, we already added
-      // it above. We still need to add this point if it is inside the window
-      // (while loop below will not catch it)
-      if (mz_walker == mz_start && (*mz_walker) > left && (*mz_walker) < right)
-      {
-        integrated_intensity += (*int_walker);
-      }
     }
-    while (mz_walker != mz_start && (*mz_walker) > left && (*mz_walker) < right)
+    while (mz_walker != mz_start)
     {
-      integrated_intensity += (*int_walker);
       --mz_walker;
       --int_walker;
+      if (!((*mz_walker) > left && (*mz_walker) < right)) break;
+      integrated_intensity += (*int_walker);
     }
 
     // (ii) Walk to the right one step and then keep walking right until we are
@@ -211,35 +203,25 @@ namespace OpenMS
       integrated_intensity += (*int_walker);
     }
 
-    // (i) Walk to the left one step and then keep walking left until we go
-    // outside the window. Note for the first step to the left we have to
-    // check for the walker becoming equal to the first data point.
+    // (i) Walk to the left until we go outside the window (or past the
+    // first data point). If we moved past the end of the spectrum, the last
+    // peak was already considered above.
     mz_walker  = mz_it;
     int_walker = int_it;
     im_walker = im_it;
-    if (mz_it != mz_start)
+    if (mz_it == mz_end)
     {
       --mz_walker;
       --im_walker;
       --int_walker;
-
-      // Special case: target m/z is larger than first data point but the first
-      // data point is inside the window.
-      // Then, mz_it is the second data point, mz_walker now points to the very
-      // first data point. If mz_it was the first data point, we already added
-      // it above. We still need to add this point if it is inside the window
-      // (while loop below will not catch it)
-      if (mz_walker == mz_start && (*mz_walker) > left && (*mz_walker) < right && (*im_walker) > left_im && (*im_walker) < right_im)
-      {
-        integrated_intensity += (*int_walker);
-      }
     }
-    while (mz_walker != mz_start && (*mz_walker) > left && (*mz_walker) < right)
+    while (mz_walker != mz_start)
     {
-      if (*im_walker > left_im && *im_walker < right_im) integrated_intensity += (*int_walker);
       --mz_walker;
       --im_walker;
       --int_walker;
+      if (!((*mz_walker) > left && (*mz_walker) < right)) break;
+      if (*im_walker > left_im && *im_walker < right_im) integrated_intensity += (*int_walker);
     }
 
     // (ii) Walk to the right one step and then keep walking right until we are
@@ -291,6 +273,42 @@ namespace OpenMS
         "Input to extractChromatogram needs to be sorted by m/z");
     }
 
+    // Precompute the extraction windows (open intervals) of all coordinates.
+    // As the coordinates are sorted by m/z, both the left and the right
+    // boundaries are sorted as well.
+    const Size nr_coordinates = extraction_coordinates.size();
+    std::vector<double> window_left(nr_coordinates);
+    std::vector<double> window_right(nr_coordinates);
+    for (Size k = 0; k < nr_coordinates; ++k)
+    {
+      const double mz = extraction_coordinates[k].mz;
+      if (ppm)
+      {
+        window_left[k]  = mz - mz * mz_extraction_window / 2.0 * 1.0e-6;
+        window_right[k] = mz + mz * mz_extraction_window / 2.0 * 1.0e-6;
+      }
+      else
+      {
+        window_left[k]  = mz - mz_extraction_window / 2.0;
+        window_right[k] = mz + mz_extraction_window / 2.0;
+      }
+    }
+
+    // Write directly into the output arrays; chromatograms covering the whole
+    // RT range receive one data point per (non-empty) spectrum.
+    std::vector<std::vector<double>* > output_time(nr_coordinates);
+    std::vector<std::vector<double>* > output_intensity(nr_coordinates);
+    for (Size k = 0; k < nr_coordinates; ++k)
+    {
+      output_time[k] = &output[k]->getTimeArray()->data;
+      output_intensity[k] = &output[k]->getIntensityArray()->data;
+      if (extraction_coordinates[k].rt_end - extraction_coordinates[k].rt_start <= 0)
+      {
+        output_time[k]->reserve(output_time[k]->size() + input_size);
+        output_intensity[k]->reserve(output_intensity[k]->size() + input_size);
+      }
+    }
+
     //go through all spectra
     startProgress(0, input_size, "Extracting chromatograms");
     for (Size scan_idx = 0; scan_idx < input_size; ++scan_idx)
@@ -331,12 +349,19 @@ namespace OpenMS
 
       // go through all transitions / chromatograms which are sorted by
       // ProductMZ. We can use this to step through the spectrum and at the
-      // same time step through the transitions. We increase the peak counter
-      // until we hit the next transition and then extract the signal.
-      for (Size k = 0; k < extraction_coordinates.size(); ++k)
+      // same time step through the transitions: the first peak inside
+      // (peak_left) and the first peak right of (peak_right) the current
+      // window only ever move to the right, so all windows are resolved in a
+      // single merge-like pass over the spectrum.
+      const double* spec_mz = &mz_arr->data[0];
+      const double* spec_int = &int_arr->data[0];
+      const Size nr_peaks = mz_arr->data.size();
+      Size peak_left = 0;
+      Size peak_right = 0;
+      const double current_rt = s_meta.RT;
+      for (Size k = 0; k < nr_coordinates; ++k)
       {
         double integrated_intensity = 0;
-        double current_rt = s_meta.RT;
         if (extraction_coordinates[k].rt_end - extraction_coordinates[k].rt_start > 0 &&
              (current_rt < extraction_coordinates[k].rt_start ||
               current_rt > extraction_coordinates[k].rt_end) )
@@ -347,8 +372,19 @@ namespace OpenMS
         const bool use_im = (extraction_coordinates[k].ion_mobility >= 0.0 && has_im);
         if (!use_im && used_filter == 1)
         {
-          extract_value_tophat(mz_start, mz_it, mz_end, int_it,
-                               extraction_coordinates[k].mz, integrated_intensity, mz_extraction_window, ppm);
+          while (peak_left < nr_peaks && spec_mz[peak_left] <= window_left[k])
+          {
+            ++peak_left;
+          }
+          peak_right = std::max(peak_right, peak_left);
+          while (peak_right < nr_peaks && spec_mz[peak_right] < window_right[k])
+          {
+            ++peak_right;
+          }
+          for (Size p = peak_left; p < peak_right; ++p)
+          {
+            integrated_intensity += spec_int[p];
+          }
         }
         else if (use_im && used_filter == 1)
         {
@@ -362,8 +398,8 @@ namespace OpenMS
         }
 
         // Time is first, intensity is second
-        output[k]->getTimeArray()->data.push_back(current_rt);
-        output[k]->getIntensityArray()->data.push_back(integrated_intensity);
+        output_time[k]->push_back(current_rt);
+        output_intensity[k]->push_back(integrated_intensity);
       }
     }
     endProgress();
@@ -71,6 +71,28 @@ namespace OpenMS
     return sptr;
   }
 
+  void OpenSwathDataAccessHelper::convertToColumnarSpectrum(const OpenSwath::SpectrumPtr sptr, ColumnarSpectrum<double, double> & spectrum)
+  {
+    std::vector<double> mz_array = sptr->getMZArray()->data;
+    std::vector<double> intensity_array = sptr->getIntensityArray()->data;
+    spectrum.swapArrays(mz_array, intensity_array);
+  }
+
+  OpenSwath::SpectrumPtr OpenSwathDataAccessHelper::convertToSpectrumPtr(ColumnarSpectrum<double, double> && spectrum)
+  {
+    OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
+    std::vector<double> empty_mz, empty_intensity;
+    spectrum.swapArrays(empty_mz, empty_intensity);
+    sptr->getMZArray()->data.swap(empty_mz);
+    sptr->getIntensityArray()->data.swap(empty_intensity);
+    return sptr;
+  }
+
+  void OpenSwathDataAccessHelper::swapArrays(OpenSwath::SpectrumPtr sptr, ColumnarSpectrum<double, double> & spectrum)
+  {
+    spectrum.swapArrays(sptr->getMZArray()->data, sptr->getIntensityArray()->data);
+  }
+
   OpenSwath::ChromatogramPtr OpenSwathDataAccessHelper::convertToChromatogramPtr(const OpenMS::MSChromatogram & chromatogram)
   {
     OpenSwath::ChromatogramPtr cptr(new OpenSwath::Chromatogram);
@@ -0,0 +1,147 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCachedColumnar.h>
+
+#include <OpenMS/CONCEPT/Macros.h>
+
+namespace OpenMS
+{
+
+  SpectrumAccessOpenMSCachedColumnar::SpectrumAccessOpenMSCachedColumnar(const String& filename) :
+    handler_(filename)
+  {
+  }
+
+  SpectrumAccessOpenMSCachedColumnar::SpectrumAccessOpenMSCachedColumnar(const Internal::ColumnarCachedMzMLHandler& handler) :
+    handler_(handler)
+  {
+  }
+
+  SpectrumAccessOpenMSCachedColumnar::~SpectrumAccessOpenMSCachedColumnar()
+  {
+  }
+
+  SpectrumAccessOpenMSCachedColumnar::SpectrumAccessOpenMSCachedColumnar(const SpectrumAccessOpenMSCachedColumnar& rhs) :
+    handler_(rhs.handler_)
+  {
+    // this only shares the mapping, no data is copied
+  }
+
+  boost::shared_ptr<OpenSwath::ISpectrumAccess> SpectrumAccessOpenMSCachedColumnar::lightClone() const
+  {
+    return boost::shared_ptr<SpectrumAccessOpenMSCachedColumnar>(new SpectrumAccessOpenMSCachedColumnar(*this));
+  }
+
+  OpenSwath::SpectrumPtr SpectrumAccessOpenMSCachedColumnar::getSpectrumById(int id)
+  {
+    OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+    OPENMS_PRECONDITION(id < (int)getNrSpectra(), "Id cannot be larger than number of spectra");
+
+    OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
+    handler_.getSpectrumData(id, sptr->getMZArray()->data, sptr->getIntensityArray()->data);
+    return sptr;
+  }
+
+  OpenSwath::SpectrumMeta SpectrumAccessOpenMSCachedColumnar::getSpectrumMetaById(int id) const
+  {
+    OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+    OPENMS_PRECONDITION(id < (int)getNrSpectra(), "Id cannot be larger than number of spectra");
+
+    OpenSwath::SpectrumMeta meta;
+    meta.RT = handler_.getSpectrumRT(id);
+    meta.ms_level = handler_.getSpectrumMSLevel(id);
+    meta.id = handler_.getSpectrumNativeID(id);
+    meta.index = id;
+    return meta;
+  }
+
+  std::vector<std::size_t> SpectrumAccessOpenMSCachedColumnar::getSpectraByRT(double RT, double deltaRT) const
+  {
+    OPENMS_PRECONDITION(deltaRT >= 0, "Delta RT needs to be a positive number");
+
+    // binary search on the RT values of the offset table (spectra are sorted
+    // by RT) for the first spectrum past the beginning of the RT domain, then
+    // add spectra as long as they are below RT + deltaRT.
+    std::vector<std::size_t> result;
+    std::size_t lower = 0, upper = getNrSpectra();
+    while (lower < upper)
+    {
+      std::size_t mid = lower + (upper - lower) / 2;
+      if (handler_.getSpectrumRT(mid) < RT - deltaRT) lower = mid + 1;
+      else upper = mid;
+    }
+    if (lower == getNrSpectra()) return result;
+
+    result.push_back(lower);
+    for (std::size_t i = lower + 1; i < getNrSpectra() && handler_.getSpectrumRT(i) < RT + deltaRT; ++i)
+    {
+      result.push_back(i);
+    }
+    return result;
+  }
+
+  size_t SpectrumAccessOpenMSCachedColumnar::getNrSpectra() const
+  {
+    return handler_.getNrSpectra();
+  }
+
+  OpenSwath::ChromatogramPtr SpectrumAccessOpenMSCachedColumnar::getChromatogramById(int id)
+  {
+    OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+    OPENMS_PRECONDITION(id < (int)getNrChromatograms(), "Id cannot be larger than number of chromatograms");
+
+    OpenSwath::ChromatogramPtr cptr(new OpenSwath::Chromatogram);
+    handler_.getChromatogramData(id, cptr->getTimeArray()->data, cptr->getIntensityArray()->data);
+    return cptr;
+  }
+
+  size_t SpectrumAccessOpenMSCachedColumnar::getNrChromatograms() const
+  {
+    return handler_.getNrChromatograms();
+  }
+
+  std::string SpectrumAccessOpenMSCachedColumnar::getChromatogramNativeID(int id) const
+  {
+    OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+    OPENMS_PRECONDITION(id < (int)getNrChromatograms(), "Id cannot be larger than number of chromatograms");
+    return handler_.getChromatogramNativeID(id);
+  }
+
+  const Internal::ColumnarCachedMzMLHandler& SpectrumAccessOpenMSCachedColumnar::getHandler() const
+  {
+    return handler_;
+  }
+
+} //end namespace OpenMS
@@ -0,0 +1,197 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessPrefetching.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+
+namespace OpenMS
+{
+
+  SpectrumAccessPrefetching::SpectrumAccessPrefetching(OpenSwath::SpectrumAccessPtr sptr,
+      Size prefetch_size, Size memory_budget) :
+    SpectrumAccessTransforming(sptr),
+    prefetch_size_(prefetch_size),
+    memory_budget_(memory_budget),
+    nr_spectra_(0),
+    prefetch_sptr_(),
+    buffered_bytes_(0),
+    next_id_(-1),
+    generation_(0),
+    failed_(false),
+    stop_(false)
+  {
+    if (prefetch_size_ == 0)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "The number of spectra to read ahead needs to be at least 1.");
+    }
+    nr_spectra_ = (int)sptr_->getNrSpectra();
+    prefetch_sptr_ = sptr_->lightClone();
+    thread_ = std::thread(&SpectrumAccessPrefetching::run_, this);
+  }
+
+  SpectrumAccessPrefetching::~SpectrumAccessPrefetching()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cond_.notify_all();
+    thread_.join();
+  }
+
+  boost::shared_ptr<OpenSwath::ISpectrumAccess> SpectrumAccessPrefetching::lightClone() const
+  {
+    // each clone reads ahead independently on its own thread
+    return boost::shared_ptr<SpectrumAccessPrefetching>(
+        new SpectrumAccessPrefetching(sptr_->lightClone(), prefetch_size_, memory_budget_));
+  }
+
+  Size SpectrumAccessPrefetching::getPrefetchSize() const
+  {
+    return prefetch_size_;
+  }
+
+  Size SpectrumAccessPrefetching::getMemoryBudget() const
+  {
+    return memory_budget_;
+  }
+
+  OpenSwath::SpectrumPtr SpectrumAccessPrefetching::getSpectrumById(int id)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (true)
+      {
+        // drop spectra that were skipped by the caller
+        while (!buffer_.empty() && buffer_.front().first < id)
+        {
+          buffered_bytes_ -= estimateSize_(buffer_.front().second);
+          buffer_.pop_front();
+        }
+
+        if (!buffer_.empty() && buffer_.front().first == id)
+        {
+          OpenSwath::SpectrumPtr s = buffer_.front().second;
+          buffered_bytes_ -= estimateSize_(s);
+          buffer_.pop_front();
+          cond_.notify_all(); // there is space for the next spectrum now
+          return s;
+        }
+
+        // the requested spectrum is the next one to be read ahead: wait for it
+        if (buffer_.empty() && id == next_id_ && id < nr_spectra_ && !failed_)
+        {
+          cond_.wait(lock);
+          continue;
+        }
+        break;
+      }
+
+      // outside of the read-ahead window: start reading ahead after the requested spectrum
+      buffer_.clear();
+      buffered_bytes_ = 0;
+      next_id_ = id + 1;
+      ++generation_;
+      failed_ = false;
+    }
+    cond_.notify_all();
+
+    // prefetch_sptr_ is used by the background thread, so read with our own access
+    return sptr_->getSpectrumById(id);
+  }
+
+  bool SpectrumAccessPrefetching::canPrefetch_() const
+  {
+    return !failed_ && next_id_ >= 0 && next_id_ < nr_spectra_ &&
+           buffer_.size() < prefetch_size_ &&
+           (memory_budget_ == 0 || buffer_.empty() || buffered_bytes_ < memory_budget_);
+  }
+
+  void SpectrumAccessPrefetching::run_()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+      cond_.wait(lock, [this]() { return stop_ || canPrefetch_(); });
+      if (stop_) return;
+
+      const int id = next_id_;
+      const Size generation = generation_;
+
+      // read without holding the lock, so the caller can consume buffered spectra meanwhile
+      lock.unlock();
+      OpenSwath::SpectrumPtr s;
+      bool success = true;
+      try
+      {
+        s = prefetch_sptr_->getSpectrumById(id);
+      }
+      catch (...)
+      {
+        success = false; // the caller will read the spectrum again and get the error
+      }
+      lock.lock();
+
+      // discard the spectrum if the window was moved in the meantime
+      if (generation == generation_)
+      {
+        if (success)
+        {
+          buffered_bytes_ += estimateSize_(s);
+          buffer_.push_back(std::make_pair(id, s));
+          ++next_id_;
+        }
+        else
+        {
+          failed_ = true;
+        }
+      }
+      cond_.notify_all();
+    }
+  }
+
+  Size SpectrumAccessPrefetching::estimateSize_(const OpenSwath::SpectrumPtr& spectrum)
+  {
+    Size bytes = 0;
+    if (!spectrum) return bytes;
+    for (const auto& arr : spectrum->getDataArrays())
+    {
+      bytes += arr->data.size() * sizeof(double);
+    }
+    return bytes;
+  }
+
+}
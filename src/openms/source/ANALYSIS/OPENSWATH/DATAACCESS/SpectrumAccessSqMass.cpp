@@ -37,15 +37,32 @@
 namespace OpenMS
 {
 
+  namespace
+  {
+    bool entryIdLess(const OpenMS::Internal::MzMLSqliteHandler::SpectrumIndexEntry& e, int id)
+    {
+      return e.id < id;
+    }
+
+    bool rtLess(const std::pair<double, std::size_t>& a, double rt)
+    {
+      return a.first < rt;
+    }
+  }
+
     /// Constructor
   SpectrumAccessSqMass::SpectrumAccessSqMass(const OpenMS::Internal::MzMLSqliteHandler& handler) :
       handler_(handler)
-    {}
+    {
+      readIndex_();
+    }
 
     SpectrumAccessSqMass::SpectrumAccessSqMass(const OpenMS::Internal::MzMLSqliteHandler& handler, const std::vector<int> & indices) :
       handler_(handler),
       sidx_(indices)
-    {}
+    {
+      readIndex_();
+    }
 
 
     SpectrumAccessSqMass::SpectrumAccessSqMass(const SpectrumAccessSqMass& sp, const std::vector<int>& indices) :
@@ -54,10 +71,20 @@ namespace OpenMS
       if (indices.empty())
       {
         sidx_ = sp.sidx_;
+        meta_ = sp.meta_;
       }
       else if (sp.sidx_.empty())
       {
         sidx_ = indices;
+        // indices refer to spectrum ids, look them up in the full index
+        for (Size k = 0; k < indices.size(); k++)
+        {
+          std::vector<OpenMS::Internal::MzMLSqliteHandler::SpectrumIndexEntry>::const_iterator it =
+            std::lower_bound(sp.meta_.begin(), sp.meta_.end(), indices[k], entryIdLess);
+          if (it == sp.meta_.end() || it->id != indices[k]) throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+              String("Error creating SpectrumAccessSqMass with an index ") + indices[k] + " that does not exist in the file");
+          meta_.push_back(*it);
+        }
       }
       else
       {
@@ -67,8 +94,10 @@ namespace OpenMS
           if (indices[k] >= (int)sp.sidx_.size()) throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
               String("Error creating SpectrumAccessSqMass with an index ") + indices[k] + " that exceeds the number of available data " + sp.sidx_.size());
           sidx_.push_back( sp.sidx_[ indices[k] ] );
+          meta_.push_back( sp.meta_[ indices[k] ] );
         }
       }
+      createRTIndex_();
     }
 
     /// Destructor
@@ -77,40 +106,66 @@ namespace OpenMS
     /// Copy constructor
     SpectrumAccessSqMass::SpectrumAccessSqMass(const SpectrumAccessSqMass & rhs) :
       handler_(rhs.handler_),
-      sidx_(rhs.sidx_)
+      sidx_(rhs.sidx_),
+      meta_(rhs.meta_),
+      rt_index_(rhs.rt_index_)
     {
     }
 
-    /// Light clone operator (actual data will not get copied)
-    boost::shared_ptr<OpenSwath::ISpectrumAccess> SpectrumAccessSqMass::lightClone() const
+    void SpectrumAccessSqMass::readIndex_()
     {
-      return boost::shared_ptr<SpectrumAccessSqMass>(new SpectrumAccessSqMass(*this));
-    }
+      std::vector<OpenMS::Internal::MzMLSqliteHandler::SpectrumIndexEntry> full_index;
+      handler_.readSpectrumIndex(full_index);
 
-    OpenSwath::SpectrumPtr SpectrumAccessSqMass::getSpectrumById(int id)
-    {
-      std::vector<int> indices;
       if (sidx_.empty())
       {
-        indices.push_back(id);
+        meta_.swap(full_index);
       }
       else
       {
-        indices.push_back(sidx_[id]);
+        meta_.reserve(sidx_.size());
+        for (Size k = 0; k < sidx_.size(); k++)
+        {
+          std::vector<OpenMS::Internal::MzMLSqliteHandler::SpectrumIndexEntry>::const_iterator it =
+            std::lower_bound(full_index.begin(), full_index.end(), sidx_[k], entryIdLess);
+          if (it == full_index.end() || it->id != sidx_[k]) throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+              String("Error creating SpectrumAccessSqMass with an index ") + sidx_[k] + " that does not exist in the file");
+          meta_.push_back(*it);
+        }
+      }
+      createRTIndex_();
+    }
+
+    void SpectrumAccessSqMass::createRTIndex_()
+    {
+      rt_index_.clear();
+      rt_index_.reserve(meta_.size());
+      for (Size k = 0; k < meta_.size(); k++)
+      {
+        rt_index_.push_back(std::make_pair(meta_[k].rt, k));
       }
+      // spectra are usually stored by increasing retention time, in which case this is a no-op
+      std::sort(rt_index_.begin(), rt_index_.end());
+    }
 
-      // read MSSpectra and prepare for conversion
-      std::vector<MSSpectrum> tmp_spectra;
-      handler_.readSpectra(tmp_spectra, indices, false);
+    /// Light clone operator (actual data will not get copied)
+    boost::shared_ptr<OpenSwath::ISpectrumAccess> SpectrumAccessSqMass::lightClone() const
+    {
+      return boost::shared_ptr<SpectrumAccessSqMass>(new SpectrumAccessSqMass(*this));
+    }
+
+    OpenSwath::SpectrumPtr SpectrumAccessSqMass::getSpectrumById(int id)
+    {
+      OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+      OPENMS_PRECONDITION(id < (int)getNrSpectra(), "Id cannot be larger than number of spectra");
 
-      const MSSpectrumType& spectrum = tmp_spectra[0];
+      std::vector<int> indices(1, meta_[id].id);
+
+      // read data directly into the binary data arrays
+      std::vector<Size> offsets;
       OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
       OpenSwath::BinaryDataArrayPtr mz_array(new OpenSwath::BinaryDataArray);
-      for (MSSpectrumType::const_iterator it = spectrum.begin(); it != spectrum.end(); ++it)
-      {
-        mz_array->data.push_back(it->getMZ());
-        intensity_array->data.push_back(it->getIntensity());
-      }
+      handler_.readSpectraData(indices, mz_array->data, intensity_array->data, offsets);
 
       OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
       sptr->setMZArray(mz_array);
@@ -120,65 +175,42 @@ namespace OpenMS
 
     OpenSwath::SpectrumMeta SpectrumAccessSqMass::getSpectrumMetaById(int id) const
     {
-      std::vector<int> indices;
-      if (sidx_.empty())
-      {
-        indices.push_back(id);
-      }
-      else
-      {
-        indices.push_back(sidx_[id]);
-      }
-
-      // read MSSpectra and prepare for conversion
-      std::vector<MSSpectrum> tmp_spectra;
-      handler_.readSpectra(tmp_spectra, indices, false);
+      OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+      OPENMS_PRECONDITION(id < (int)getNrSpectra(), "Id cannot be larger than number of spectra");
 
-      const MSSpectrumType& spectrum = tmp_spectra[0];
       OpenSwath::SpectrumMeta m;
-      m.id = spectrum.getNativeID();
-      m.RT = spectrum.getRT();
-      m.ms_level = spectrum.getMSLevel();
+      m.index = meta_[id].id;
+      m.id = meta_[id].native_id;
+      m.RT = meta_[id].rt;
+      m.ms_level = meta_[id].ms_level;
       return m;
     }
 
     void SpectrumAccessSqMass::getAllSpectra(std::vector< OpenSwath::SpectrumPtr > & spectra, std::vector< OpenSwath::SpectrumMeta > & spectra_meta) const
     {
-      // read MSSpectra and prepare for conversion
-      std::vector<MSSpectrum> tmp_spectra;
+      if (meta_.empty()) return;
 
-      if (sidx_.empty())
-      {
-        MSExperiment exp;
-        {
-          handler_.readExperiment(exp, false);
-        }
-
-        tmp_spectra = exp.getSpectra();
-      }
-      else
+      // read all data in a single batch into contiguous arrays
+      std::vector<int> indices;
+      indices.reserve(meta_.size());
+      for (Size k = 0; k < meta_.size(); k++)
       {
-        handler_.readSpectra(tmp_spectra, sidx_, false);
+        indices.push_back(meta_[k].id);
       }
-      spectra.reserve(tmp_spectra.size());
-      spectra_meta.reserve(tmp_spectra.size());
-    
-      for (Size k = 0; k < tmp_spectra.size(); k++)
+      std::vector<double> mz, intensity;
+      std::vector<Size> offsets;
+      handler_.readSpectraData(indices, mz, intensity, offsets);
+
+      spectra.reserve(spectra.size() + meta_.size());
+      spectra_meta.reserve(spectra_meta.size() + meta_.size());
+      for (Size k = 0; k < meta_.size(); k++)
       {
-        const MSSpectrumType& spectrum = tmp_spectra[k];
         OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
         OpenSwath::BinaryDataArrayPtr mz_array(new OpenSwath::BinaryDataArray);
-        for (MSSpectrumType::const_iterator it = spectrum.begin(); it != spectrum.end(); ++it)
-        {
-          mz_array->data.push_back(it->getMZ());
-          intensity_array->data.push_back(it->getIntensity());
-        }
+        mz_array->data.assign(mz.begin() + offsets[k], mz.begin() + offsets[k + 1]);
+        intensity_array->data.assign(intensity.begin() + offsets[k], intensity.begin() + offsets[k + 1]);
 
-        OpenSwath::SpectrumMeta m;
-        m.id = spectrum.getNativeID();
-        m.RT = spectrum.getRT();
-        m.ms_level = spectrum.getMSLevel();
-        spectra_meta.push_back(m);
+        spectra_meta.push_back(getSpectrumMetaById(static_cast<int>(k)));
 
         OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
         sptr->setMZArray(mz_array);
@@ -190,39 +222,31 @@ namespace OpenMS
     std::vector<std::size_t> SpectrumAccessSqMass::getSpectraByRT(double RT, double deltaRT) const
     {
       OPENMS_PRECONDITION(deltaRT >= 0, "Delta RT needs to be a positive number");
-      std::vector<std::size_t> res = handler_.getSpectraIndicesbyRT(RT, deltaRT, sidx_);
 
-      if (sidx_.empty())
+      // if deltaRT is zero, only the first spectrum at or after RT is returned
+      std::vector<std::size_t> result;
+      if (deltaRT > 0.0)
       {
-        return res;
+        std::vector<std::pair<double, std::size_t> >::const_iterator it =
+          std::lower_bound(rt_index_.begin(), rt_index_.end(), RT - deltaRT, rtLess);
+        for (; it != rt_index_.end() && it->first <= RT + deltaRT; ++it)
+        {
+          result.push_back(it->second);
+        }
+        std::sort(result.begin(), result.end());
       }
       else
       {
-        // we need to map the resulting indices back to the external indices
-        std::vector<std::size_t> res_mapped;
-        for (Size k = 0; k < res.size(); k++)
-        {
-          for (Size s_it = 0; s_it < sidx_.size(); s_it++)
-          {
-            if (res[k] == (size_t)sidx_[s_it]) {res_mapped.push_back(s_it);}
-          }
-        }
-        return res_mapped;
+        std::vector<std::pair<double, std::size_t> >::const_iterator it =
+          std::lower_bound(rt_index_.begin(), rt_index_.end(), RT, rtLess);
+        if (it != rt_index_.end()) result.push_back(it->second);
       }
+      return result;
     }
 
     size_t SpectrumAccessSqMass::getNrSpectra() const
     {
-      size_t res;
-      if (sidx_.empty())
-      {
-        res = handler_.getNrSpectra();
-      }
-      else
-      {
-        res = sidx_.size();
-      }
-      return res;
+      return meta_.size();
     }
 
     OpenSwath::ChromatogramPtr SpectrumAccessSqMass::getChromatogramById(int /* id */)
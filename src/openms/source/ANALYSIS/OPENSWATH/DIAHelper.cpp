@@ -35,7 +35,7 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/DIAHelper.h>
 
 #include <OpenMS/CHEMISTRY/TheoreticalSpectrumGenerator.h>
-#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/CoarseIsotopePatternGenerator.h>
+#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/AveragineIsotopeTable.h>
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/FeatureFinderAlgorithmPickedHelperStructs.h>
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/FeatureFinderAlgorithm.h>
 
@@ -107,12 +107,9 @@ namespace OpenMS
                                          std::vector<std::pair<double, double> >& isotopesSpec, const double charge,
                                          const int nr_isotopes, const double mannmass)
     {
-      typedef OpenMS::FeatureFinderAlgorithmPickedHelperStructs::TheoreticalIsotopePattern TheoreticalIsotopePattern;
-      // create the theoretical distribution
-      CoarseIsotopePatternGenerator solver(nr_isotopes);
-      TheoreticalIsotopePattern isotopes;
+      // create the theoretical distribution (from the shared, precomputed table)
       //std::cout << product_mz * charge << std::endl;
-      auto d = solver.estimateFromPeptideWeight(product_mz * charge);
+      auto d = AveragineIsotopeTable::estimateFromPeptideWeight(product_mz * charge, nr_isotopes);
 
       double mass = product_mz;
       for (IsotopeDistribution::Iterator it = d.begin(); it != d.end(); ++it)
@@ -36,6 +36,7 @@
 
 #include <OpenMS/CONCEPT/Constants.h>
 #include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/CoarseIsotopePatternGenerator.h>
+#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/AveragineIsotopeTable.h>
 
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/FeatureFinderAlgorithmPickedHelperStructs.h>
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/FeatureFinderAlgorithm.h>
@@ -411,9 +412,8 @@ namespace OpenMS
     }
     else
     {
-      // create the theoretical distribution from the peptide weight
-      CoarseIsotopePatternGenerator solver(dia_nr_isotopes_ + 1);
-      isotope_dist = solver.estimateFromPeptideWeight(std::fabs(product_mz * putative_fragment_charge));
+      // create the theoretical distribution from the peptide weight (using the shared, precomputed table)
+      isotope_dist = AveragineIsotopeTable::estimateFromPeptideWeight(std::fabs(product_mz * putative_fragment_charge), dia_nr_isotopes_ + 1);
     }
 
 
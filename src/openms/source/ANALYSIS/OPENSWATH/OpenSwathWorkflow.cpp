@@ -34,6 +34,14 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathWorkflow.h>
 
+#include <OpenMS/ANALYSIS/OPENSWATH/OrderedTaskOutput.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/SwathTaskQueue.h>
+#include <OpenMS/SYSTEM/StopWatch.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 // OpenSwathCalibrationWorkflow
 namespace OpenMS
 {
@@ -316,6 +324,10 @@ namespace OpenMS
             // This creates an InMemory object that keeps all data in memory
             current_swath_map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*current_swath_map) );
           }
+          else
+          {
+            current_swath_map = getExtractionAccess_(current_swath_map);
+          }
 
           prepareExtractionCoordinates_(tmp_out, coordinates, transition_exp_used, trafo_inverse, cp);
           extractor.extractChromatograms(current_swath_map, tmp_out, coordinates, cp.mz_extraction_window,
@@ -406,6 +418,26 @@ namespace OpenMS
 namespace OpenMS
 {
 
+  namespace
+  {
+    /// The selected transitions and the spectrum access of an open SWATH map
+    struct SwathMapTasks
+    {
+      OpenSwath::LightTargetedExperiment transitions;
+      OpenSwath::SpectrumAccessPtr swath_map;
+      int batch_size = 0;
+    };
+
+    /// The output of a single (SWATH map, batch) task
+    struct SwathTaskResult
+    {
+      std::vector< MSChromatogram > chromatograms;
+      FeatureMap features;
+      std::vector< String > tsv_lines;
+      std::vector< String > osw_lines;
+    };
+  }
+
   void OpenSwathWorkflow::performExtraction(
     const std::vector< OpenSwath::SwathMap > & swath_maps,
     const TransformationDescription trafo,
@@ -468,142 +500,210 @@ namespace OpenMS
     }
 
     // (iii) Perform extraction and scoring of fragment ion chromatograms (MS2)
-    // We set dynamic scheduling such that the maps are worked on in the order
-    // in which they were given to the program / acquired. This gives much
-    // better load balancing than static allocation.
+    // Each batch of each SWATH map is an independent task: all threads take
+    // the next pending batch of the open maps (in the order in which they
+    // were given to the program / acquired), so that maps with many
+    // transitions do not leave threads idle at the end of the run. Results
+    // are written out in (map, batch) order by an ordered output stage.
+    // Results that are written out of order are buffered; threads that are
+    // too far ahead of the output wait so that memory usage stays bounded.
 #ifdef _OPENMP
-    int total_nr_threads = omp_get_max_threads(); // store total number of threads we are allowed to use
-    if (threads_outer_loop_ > -1)
-    {
-      omp_set_nested(1);
-      omp_set_dynamic(0);
-      omp_set_num_threads(std::min(threads_outer_loop_, omp_get_max_threads()) ); // use at most threads_outer_loop_ threads here
-    }
-#pragma omp parallel for schedule(dynamic,1)
+    const int max_pending_results = 2 * omp_get_max_threads();
+#else
+    const int max_pending_results = 1;
 #endif
-    for (SignedSize i = 0; i < boost::numeric_cast<SignedSize>(swath_maps.size()); ++i)
-    {
-      if (!swath_maps[i].ms1) // skip MS1
+    SwathTaskQueue task_queue(swath_maps.size(), threads_outer_loop_);
+    std::vector< SwathMapTasks > map_tasks(swath_maps.size());
+    OrderedTaskOutput<SwathTaskResult> task_output(swath_maps.size(), max_pending_results, [&](SwathTaskResult& result)
       {
+        if (tsv_writer.isActive()) tsv_writer.writeLines(result.tsv_lines);
+        if (osw_writer.isActive()) osw_writer.writeLines(result.osw_lines);
+        writeOutFeaturesAndChroms_(result.chromatograms, result.features, out_featureFile, store_features, chromConsumer);
+      });
 
-        // Step 1: select which transitions to extract (proceed in batches)
-        OpenSwath::LightTargetedExperiment transition_exp_used_all;
-        OpenSwathHelper::selectSwathTransitions(transition_exp, transition_exp_used_all,
-            cp.min_upper_edge_dist, swath_maps[i].lower, swath_maps[i].upper);
-        if (transition_exp_used_all.getTransitions().size() > 0) // skip if no transitions found
-        {
+    task_timings_.clear();
+    StopWatch task_clock;
+    task_clock.start();
+    int nr_threads = 1;
 
-          OpenSwath::SpectrumAccessPtr current_swath_map = swath_maps[i].sptr;
-          if (load_into_memory)
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+#ifdef _OPENMP
+#pragma omp master
+      nr_threads = omp_get_num_threads();
+      const int thread_nr = omp_get_thread_num();
+#else
+      const int thread_nr = 0;
+#endif
+      Size i, pep_idx;
+      SwathTaskQueue::Action action;
+      while ((action = task_queue.next(i, pep_idx)) != SwathTaskQueue::DONE)
+      {
+        if (action == SwathTaskQueue::OPEN_MAP)
+        {
+          // Step 1: select which transitions to extract (proceed in batches)
+          SwathMapTasks& current = map_tasks[i];
+          Size nr_batches = 0;
+          if (!swath_maps[i].ms1) // skip MS1
           {
-            // This creates an InMemory object that keeps all data in memory
-            current_swath_map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*current_swath_map) );
-          }
+            OpenSwathHelper::selectSwathTransitions(transition_exp, current.transitions,
+                cp.min_upper_edge_dist, swath_maps[i].lower, swath_maps[i].upper);
+            if (current.transitions.getTransitions().size() > 0) // skip if no transitions found
+            {
+              current.swath_map = swath_maps[i].sptr;
+              if (load_into_memory)
+              {
+                // This creates an InMemory object that keeps all data in memory
+                current.swath_map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*current.swath_map) );
+              }
 
-          int batch_size;
-          if (batchSize <= 0 || batchSize >= (int)transition_exp_used_all.getCompounds().size())
-          {
-            batch_size = transition_exp_used_all.getCompounds().size();
-          }
-          else
-          {
-            batch_size = batchSize;
+              Size nr_compounds = current.transitions.getCompounds().size();
+              if (batchSize <= 0 || batchSize >= (int)nr_compounds)
+              {
+                current.batch_size = nr_compounds;
+              }
+              else
+              {
+                current.batch_size = batchSize;
+              }
+              nr_batches = (nr_compounds + current.batch_size - 1) / current.batch_size;
+            }
           }
 
-          SignedSize nr_batches = (transition_exp_used_all.getCompounds().size() / batch_size);
-
-          // If we have a multiple of threads_outer_loop_ here, then use nested
-          // parallelization here. E.g. if we use 8 threads for the outer loop,
-          // but we have a total of 24 cores available, each of the 8 threads
-          // will then create a team of 3 threads to work on the batches
-          // individually.
-          //
-          // We should avoid oversubscribing the CPUs, therefore we use integer division.
-          // -- see https://docs.oracle.com/cd/E19059-01/stud.10/819-0501/2_nested.html
+          task_output.setNrBatches(i, nr_batches);
+          if (task_queue.opened(i, nr_batches))
+          {
+            map_tasks[i] = SwathMapTasks();
 #ifdef _OPENMP
-          int outer_thread_nr = omp_get_thread_num();
-          omp_set_num_threads(std::max(1, total_nr_threads / threads_outer_loop_) );
+#pragma omp critical (progress)
 #endif
-#pragma omp parallel for schedule(dynamic, 1)
-          for (SignedSize pep_idx = 0; pep_idx <= nr_batches; pep_idx++)
-          {
-            OpenSwath::SpectrumAccessPtr current_swath_map_inner = current_swath_map;
+            this->setProgress(++progress);
+          }
+          continue;
+        }
 
-#ifdef _OPENMP
-            // To ensure multi-threading safe access to the individual spectra, we
-            // need to use a light clone of the spectrum access (if multiple threads
-            // share a single filestream and call seek on it, chaos will ensue).
-            if (total_nr_threads / threads_outer_loop_ > 1)
-            {
-              current_swath_map_inner = current_swath_map->lightClone();
-            }
+        const SwathMapTasks& current = map_tasks[i];
+        TaskTiming timing;
+        timing.swath_map_idx = i;
+        timing.batch_idx = pep_idx;
+        timing.thread = thread_nr;
+        timing.start = task_clock.getClockTime();
 
-#pragma omp critical (osw_write_stdout)
-#endif
-            {
-              std::cout << "Thread " <<
+        // To ensure multi-threading safe access to the individual spectra, we
+        // need to use a light clone of the spectrum access (if multiple threads
+        // share a single filestream and call seek on it, chaos will ensue).
 #ifdef _OPENMP
-              outer_thread_nr << "_" << omp_get_thread_num() << " " <<
+        OpenSwath::SpectrumAccessPtr current_swath_map_inner = current.swath_map->lightClone();
+#pragma omp critical (osw_write_stdout)
 #else
-              "0" << 
+        OpenSwath::SpectrumAccessPtr current_swath_map_inner = current.swath_map;
 #endif
-              "will analyze " << transition_exp_used_all.getCompounds().size() <<  " compounds and "
-              << transition_exp_used_all.getTransitions().size() <<  " transitions "
-              "from SWATH " << i << " (batch " << pep_idx << " out of " << nr_batches << ")" << std::endl;
-            }
+        {
+          std::cout << "Thread " << thread_nr << " " <<
+          "will analyze " << current.transitions.getCompounds().size() <<  " compounds and "
+          << current.transitions.getTransitions().size() <<  " transitions "
+          "from SWATH " << i << " (batch " << pep_idx << " out of " << task_queue.getNrBatches(i) << ")" << std::endl;
+        }
 
-            // Create the new, batch-size transition experiment
-            OpenSwath::LightTargetedExperiment transition_exp_used;
-            selectCompoundsForBatch_(transition_exp_used_all, transition_exp_used, batch_size, pep_idx);
+        // Create the new, batch-size transition experiment
+        OpenSwath::LightTargetedExperiment transition_exp_used;
+        selectCompoundsForBatch_(current.transitions, transition_exp_used, current.batch_size, pep_idx);
+        timing.nr_compounds = transition_exp_used.getCompounds().size();
 
-            // Step 2.1: extract these transitions
-            ChromatogramExtractor extractor;
-            std::vector< OpenSwath::ChromatogramPtr > chrom_list;
-            std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
+        // Step 2.1: extract these transitions
+        ChromatogramExtractor extractor;
+        std::vector< OpenSwath::ChromatogramPtr > chrom_list;
+        std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
 
-            // Step 2.2: prepare the extraction coordinates and extract chromatograms
-            // chrom_list contains one entry for each fragment ion (transition) in transition_exp_used
-            prepareExtractionCoordinates_(chrom_list, coordinates, transition_exp_used, trafo_inverse, cp);
-            extractor.extractChromatograms(current_swath_map_inner, chrom_list, coordinates, cp.mz_extraction_window,
-                cp.ppm, cp.im_extraction_window, cp.extraction_function);
+        // Step 2.2: prepare the extraction coordinates and extract chromatograms
+        // chrom_list contains one entry for each fragment ion (transition) in transition_exp_used
+        prepareExtractionCoordinates_(chrom_list, coordinates, transition_exp_used, trafo_inverse, cp);
+        // (the map used for scoring below is accessed randomly and thus not read ahead)
+        extractor.extractChromatograms(load_into_memory ? current_swath_map_inner : getExtractionAccess_(current_swath_map_inner),
+            chrom_list, coordinates, cp.mz_extraction_window,
+            cp.ppm, cp.im_extraction_window, cp.extraction_function);
 
-            // Step 2.3: convert chromatograms back to OpenMS::MSChromatogram and write to output
-            PeakMap chrom_exp;
-            extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used,  SpectrumSettings(), 
-                                          chrom_exp.getChromatograms(), false, cp.im_extraction_window);
+        // Step 2.3: convert chromatograms back to OpenMS::MSChromatogram
+        SwathTaskResult result;
+        extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used, SpectrumSettings(),
+                                      result.chromatograms, false, cp.im_extraction_window);
+        timing.extraction_end = task_clock.getClockTime();
+
+        // Step 3: score these extracted transitions
+        std::vector< OpenSwath::SwathMap > tmp = {swath_maps[i]};
+        tmp.back().sptr = current_swath_map_inner;
+        scoreAllChromatograms_(result.chromatograms, ms1_chromatograms, tmp, transition_exp_used,
+            feature_finder_param, trafo, cp.rt_extraction_window, result.features, tsv_writer, osw_writer,
+            result.tsv_lines, result.osw_lines, ms1_isotopes);
+
+        // Step 4: hand all chromatograms and features to the ordered output
+        // stage, which writes them into the output object / file once all
+        // previous tasks are written.
+        task_output.push(i, pep_idx, result);
+        timing.end = task_clock.getClockTime();
 
+#ifdef _OPENMP
+#pragma omp critical (osw_task_timings)
+#endif
+        task_timings_.push_back(timing);
 
-            // Step 3: score these extracted transitions
-            FeatureMap featureFile;
-            std::vector< OpenSwath::SwathMap > tmp = {swath_maps[i]};
-            tmp.back().sptr = current_swath_map_inner;
-            scoreAllChromatograms_(chrom_exp.getChromatograms(), ms1_chromatograms, tmp, transition_exp_used,
-                feature_finder_param, trafo, cp.rt_extraction_window, featureFile, tsv_writer, osw_writer, ms1_isotopes);
+        if (task_queue.finished(i))
+        {
+          map_tasks[i] = SwathMapTasks(); // release the (in-memory) map
+#ifdef _OPENMP
+#pragma omp critical (progress)
+#endif
+          this->setProgress(++progress);
+        }
+      }
+    }
+    this->endProgress();
 
-            // Step 4: write all chromatograms and features out into an output object / file
-            // (this needs to be done in a critical section since we only have one
-            // output file and one output map).
-            #pragma omp critical (osw_write_out)
-            {
-              writeOutFeaturesAndChroms_(chrom_exp.getChromatograms(), featureFile, out_featureFile, store_features, chromConsumer);
-            }
-          }
+    reportTaskTimings_(nr_threads);
+  }
 
-        } // continue 2 (no continue due to OpenMP)
-      } // continue 1 (no continue due to OpenMP)
+  void OpenSwathWorkflow::reportTaskTimings_(int nr_threads) const
+  {
+    if (task_timings_.empty()) return;
+
+    // The time between the first thread running out of tasks and the last
+    // task finishing is the tail in which threads are idle. Threads that did
+    // not process any task (e.g. fewer tasks than threads) are not counted.
+    std::vector<double> thread_end(nr_threads, -1.0);
+    double total_time = 0.0;
+    for (const TaskTiming& t : task_timings_)
+    {
+      if (t.thread >= 0 && t.thread < nr_threads) thread_end[t.thread] = std::max(thread_end[t.thread], t.end);
+      total_time += t.end - t.start;
+    }
+    double last_end = 0.0;
+    double first_idle = std::numeric_limits<double>::max();
+    Size nr_active_threads = 0;
+    for (double end : thread_end)
+    {
+      if (end < 0.0) continue;
+      last_end = std::max(last_end, end);
+      first_idle = std::min(first_idle, end);
+      ++nr_active_threads;
+    }
+    if (nr_active_threads == 0) first_idle = last_end;
 
-      #pragma omp critical (progress)
-      this->setProgress(++progress);
+    std::vector<TaskTiming> slowest(task_timings_);
+    std::sort(slowest.begin(), slowest.end(),
+              [](const TaskTiming& a, const TaskTiming& b) { return a.end - a.start > b.end - b.start; });
 
-    }
-    this->endProgress();
-    
-#ifdef _OPENMP
-    if (threads_outer_loop_ > -1)
+    LOG_DEBUG << "Processed " << task_timings_.size() << " tasks on " << nr_active_threads << " of " << nr_threads
+              << " thread(s) in " << last_end << " s (mean task time " << total_time / task_timings_.size()
+              << " s, idle tail " << last_end - first_idle << " s). Slowest tasks:" << std::endl;
+    for (Size k = 0; k < std::min(Size(5), slowest.size()); ++k)
     {
-      omp_set_num_threads(total_nr_threads); // set number of available threads back to initial value
+      const TaskTiming& t = slowest[k];
+      LOG_DEBUG << "  SWATH " << t.swath_map_idx << " (batch " << t.batch_idx << ", " << t.nr_compounds << " compounds): "
+                << t.end - t.start << " s (extraction " << t.extraction_end - t.start << " s, scoring "
+                << t.end - t.extraction_end << " s) on thread " << t.thread << std::endl;
     }
-#endif    
   }
 
   void OpenSwathWorkflow::writeOutFeaturesAndChroms_(
@@ -640,6 +740,15 @@ namespace OpenMS
     }
   }
 
+  OpenSwath::SpectrumAccessPtr OpenSwathWorkflowBase::getExtractionAccess_(const OpenSwath::SpectrumAccessPtr& swath_map) const
+  {
+    if (prefetch_size_ == 0 || swath_map->getNrSpectra() < 2)
+    {
+      return swath_map;
+    }
+    return boost::shared_ptr<SpectrumAccessPrefetching>(new SpectrumAccessPrefetching(swath_map, prefetch_size_));
+  }
+
   void OpenSwathWorkflowBase::MS1Extraction_(const std::vector< OpenSwath::SwathMap > & swath_maps,
                                              std::vector< MSChromatogram >& ms1_chromatograms,
                                              Interfaces::IMSDataConsumer* chromConsumer,
@@ -672,7 +781,8 @@ namespace OpenMS
 
         // prepare the extraction coordinates and extract chromatogram
         prepareExtractionCoordinates_(chrom_list, coordinates, transition_exp_used, trafo_inverse, cp, true, ms1_isotopes);
-        extractor.extractChromatograms(ms1_map_, chrom_list, coordinates, cp.mz_extraction_window,
+        extractor.extractChromatograms(load_into_memory ? ms1_map_ : getExtractionAccess_(ms1_map_),
+            chrom_list, coordinates, cp.mz_extraction_window,
             cp.ppm, cp.im_extraction_window, cp.extraction_function);
 
         extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used,
@@ -717,6 +827,50 @@ namespace OpenMS
     OpenSwathOSWWriter & osw_writer,
     int nr_ms1_isotopes,
     bool ms1only) const
+  {
+    std::vector<String> to_tsv_output, to_osw_output;
+    scoreAllChromatograms_(ms2_chromatograms, ms1_chromatograms, swath_maps, transition_exp, feature_finder_param,
+                           trafo, rt_extraction_window, output, tsv_writer, osw_writer, to_tsv_output, to_osw_output,
+                           nr_ms1_isotopes, ms1only);
+
+    // Only write at the very end since this is a step that needs a barrier
+    if (tsv_writer.isActive())
+    {
+#ifdef _OPENMP
+#pragma omp critical (osw_write_tsv)
+#endif
+      {
+        tsv_writer.writeLines(to_tsv_output);
+      }
+    }
+
+    // Only write at the very end since this is a step that needs a barrier
+    if (osw_writer.isActive())
+    {
+#ifdef _OPENMP
+#pragma omp critical (osw_write_tsv)
+#endif
+      {
+        osw_writer.writeLines(to_osw_output);
+      }
+    }
+  }
+
+  void OpenSwathWorkflow::scoreAllChromatograms_(
+    const std::vector< OpenMS::MSChromatogram > & ms2_chromatograms,
+    const std::vector< OpenMS::MSChromatogram > & ms1_chromatograms,
+    const std::vector< OpenSwath::SwathMap >& swath_maps,
+    const OpenSwath::LightTargetedExperiment& transition_exp,
+    const Param& feature_finder_param,
+    TransformationDescription trafo,
+    const double rt_extraction_window,
+    FeatureMap& output,
+    OpenSwathTSVWriter & tsv_writer,
+    OpenSwathOSWWriter & osw_writer,
+    std::vector<String> & to_tsv_output,
+    std::vector<String> & to_osw_output,
+    int nr_ms1_isotopes,
+    bool ms1only) const
   {
     TransformationDescription trafo_inv = trafo;
     trafo_inv.invert();
@@ -778,7 +932,6 @@ namespace OpenMS
       assay_map[transition_exp.getTransitions()[i].getPeptideRef()].push_back(&transition_exp.getTransitions()[i]);
     }
 
-    std::vector<String> to_tsv_output, to_osw_output;
     ///////////////////////////////////
     // Start of main function
     // Iterating over all the assays
@@ -875,28 +1028,6 @@ namespace OpenMS
         to_osw_output.push_back(osw_writer.prepareLine(pep, transition, output, id));
       }
     }
-
-    // Only write at the very end since this is a step that needs a barrier
-    if (tsv_writer.isActive())
-    {
-#ifdef _OPENMP
-#pragma omp critical (osw_write_tsv)
-#endif
-      {
-        tsv_writer.writeLines(to_tsv_output);
-      }
-    }
-
-    // Only write at the very end since this is a step that needs a barrier
-    if (osw_writer.isActive())
-    {
-#ifdef _OPENMP
-#pragma omp critical (osw_write_tsv)
-#endif
-      {
-        osw_writer.writeLines(to_osw_output);
-      }
-    }
   }
 
 
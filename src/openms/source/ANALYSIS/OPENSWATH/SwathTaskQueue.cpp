@@ -0,0 +1,119 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/SwathTaskQueue.h>
+
+namespace OpenMS
+{
+
+  SwathTaskQueue::SwathTaskQueue(Size nr_maps, int max_open) :
+    state_(nr_maps, UNOPENED),
+    nr_batches_(nr_maps, 0),
+    next_batch_(nr_maps, 0),
+    remaining_(nr_maps, 0),
+    first_open_(0),
+    next_map_(0),
+    nr_open_(0),
+    nr_opening_(0),
+    max_open_(max_open)
+  {
+  }
+
+  SwathTaskQueue::Action SwathTaskQueue::next(Size& map_idx, Size& batch_idx)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+      while (first_open_ < next_map_ && state_[first_open_] == FINISHED) ++first_open_;
+      for (Size k = first_open_; k < next_map_; ++k)
+      {
+        if (state_[k] == OPEN && next_batch_[k] < nr_batches_[k])
+        {
+          map_idx = k;
+          batch_idx = next_batch_[k]++;
+          return BATCH;
+        }
+      }
+      if (next_map_ < state_.size() && (max_open_ <= 0 || nr_open_ < (Size)max_open_))
+      {
+        map_idx = next_map_++;
+        state_[map_idx] = OPENING;
+        ++nr_open_;
+        ++nr_opening_;
+        return OPEN_MAP;
+      }
+      if (next_map_ == state_.size() && nr_opening_ == 0)
+      {
+        return DONE;
+      }
+      // a map is being opened or too many maps are open: wait for batches
+      cv_.wait(lock);
+    }
+  }
+
+  bool SwathTaskQueue::opened(Size map_idx, Size nr_batches)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    nr_batches_[map_idx] = nr_batches;
+    remaining_[map_idx] = nr_batches;
+    state_[map_idx] = OPEN;
+    --nr_opening_;
+    if (nr_batches == 0) close_(map_idx);
+    cv_.notify_all();
+    return nr_batches == 0;
+  }
+
+  bool SwathTaskQueue::finished(Size map_idx)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--remaining_[map_idx] > 0) return false;
+    close_(map_idx);
+    cv_.notify_all();
+    return true;
+  }
+
+  Size SwathTaskQueue::getNrBatches(Size map_idx)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nr_batches_[map_idx];
+  }
+
+  void SwathTaskQueue::close_(Size map_idx)
+  {
+    state_[map_idx] = FINISHED;
+    --nr_open_;
+  }
+
+}
+
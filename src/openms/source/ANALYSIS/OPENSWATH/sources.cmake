@@ -31,6 +31,7 @@ set(sources_list
   SwathMapMassCorrection.cpp
   SwathWindowLoader.cpp
   SwathQC.cpp
+  SwathTaskQueue.cpp
   SpectrumAddition.cpp
   TargetedSpectraExtractor.cpp
   TransitionTSVFile.cpp
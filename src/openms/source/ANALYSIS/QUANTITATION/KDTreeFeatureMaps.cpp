@@ -35,6 +35,8 @@
 #include <OpenMS/ANALYSIS/QUANTITATION/KDTreeFeatureMaps.h>
 #include <OpenMS/MATH/MISC/MathFunctions.h>
 
+#include <algorithm>
+
 using namespace std;
 
 namespace OpenMS
@@ -45,9 +47,6 @@ void KDTreeFeatureMaps::addFeature(Size mt_map_index, const BaseFeature* feature
   map_index_.push_back(mt_map_index);
   features_.push_back(feature);
   rt_.push_back(feature->getRT());
-
-  KDTreeFeatureNode mt_node(this, size() - 1);
-  kd_tree_.insert(mt_node);
 }
 
 const BaseFeature* KDTreeFeatureMaps::feature(Size i) const
@@ -87,7 +86,8 @@ Size KDTreeFeatureMaps::size() const
 
 Size KDTreeFeatureMaps::treeSize() const
 {
-  return kd_tree_.size();
+  // features not (yet) in the tree are searched linearly
+  return size();
 }
 
 Size KDTreeFeatureMaps::numMaps() const
@@ -99,12 +99,18 @@ void KDTreeFeatureMaps::clear()
 {
   features_.clear();
   map_index_.clear();
+  rt_.clear();
   kd_tree_.clear();
 }
 
 void KDTreeFeatureMaps::optimizeTree()
 {
-  kd_tree_.optimize();
+  vector<double> mz_values(size());
+  for (Size i = 0; i < size(); ++i)
+  {
+    mz_values[i] = mz(i);
+  }
+  kd_tree_.build(rt_, mz_values);
 }
 
 void KDTreeFeatureMaps::getNeighborhood(Size index, vector<Size>& result_indices, double rt_tol, double mz_tol, bool mz_ppm, bool include_features_from_same_map, double max_pairwise_log_fc) const
@@ -143,22 +149,27 @@ void KDTreeFeatureMaps::getNeighborhood(Size index, vector<Size>& result_indices
 
 void KDTreeFeatureMaps::queryRegion(double rt_low, double rt_high, double mz_low, double mz_high, vector<Size>& result_indices, Size ignored_map_index) const
 {
-  // set up tolerance window as region for the 2D tree
-  FeatureKDTree::_Region_ region;
-  region._M_low_bounds[0] = rt_low;
-  region._M_high_bounds[0] = rt_high;
-  region._M_low_bounds[1] = mz_low;
-  region._M_high_bounds[1] = mz_high;
+  // range-query tolerance window in the 2D tree
+  vector<Size> tmp_result;
+  kd_tree_.queryRegion(rt_low, rt_high, mz_low, mz_high, tmp_result);
 
-  // range-query tolerance window
-  vector<KDTreeFeatureNode> tmp_result;
-  kd_tree_.find_within_range(region, back_insert_iterator<vector<KDTreeFeatureNode> >(tmp_result));
+  // features added after the tree was built
+  for (Size i = kd_tree_.size(); i < size(); ++i)
+  {
+    if (rt_[i] >= rt_low && rt_[i] <= rt_high && mz(i) >= mz_low && mz(i) <= mz_high)
+    {
+      tmp_result.push_back(i);
+    }
+  }
+
+  // tree order is arbitrary, report features in a deterministic order
+  sort(tmp_result.begin(), tmp_result.end());
 
   // add indices to result
   result_indices.clear();
-  for (vector<KDTreeFeatureNode>::const_iterator it = tmp_result.begin(); it != tmp_result.end(); ++it)
+  for (vector<Size>::const_iterator it = tmp_result.begin(); it != tmp_result.end(); ++it)
   {
-    Size found_index = it->getIndex();
+    Size found_index = *it;
     if (ignored_map_index == numeric_limits<Size>::max() || map_index_[found_index] != ignored_map_index)
     {
       result_indices.push_back(found_index);
@@ -172,6 +183,8 @@ void KDTreeFeatureMaps::applyTransformations(const vector<TransformationModelLow
   {
     rt_[i] = trafos[map_index_[i]]->evaluate(features_[i]->getRT());
   }
+  // the tree is outdated (features are searched linearly until optimizeTree() is called)
+  kd_tree_.clear();
 }
 
 void KDTreeFeatureMaps::updateMembers_()
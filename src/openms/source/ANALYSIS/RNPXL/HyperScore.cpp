@@ -37,6 +37,8 @@
 #include <OpenMS/KERNEL/MSSpectrum.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 
+#include <algorithm>
+
 using std::vector;
 
 namespace OpenMS
@@ -73,14 +75,35 @@ namespace OpenMS
       return 0.0;
     }
 
+    // resolve all theoretical peaks in one sweep over the experimental spectrum
+    vector<double> theo_mzs;
+    theo_mzs.reserve(theo_spectrum.size());
+    for (Size i = 0; i < theo_spectrum.size(); ++i)
+    {
+      theo_mzs.push_back(theo_spectrum[i].getMZ());
+    }
+    vector<Size> nearest;
+    if (std::is_sorted(theo_mzs.begin(), theo_mzs.end()))
+    {
+      exp_spectrum.findNearest(theo_mzs, nearest);
+    }
+    else
+    {
+      nearest.reserve(theo_mzs.size());
+      for (Size i = 0; i < theo_mzs.size(); ++i)
+      {
+        nearest.push_back(exp_spectrum.findNearest(theo_mzs[i]));
+      }
+    }
+
     for (Size i = 0; i < theo_spectrum.size(); ++i)
     {
-      const double theo_mz = theo_spectrum[i].getMZ();
+      const double theo_mz = theo_mzs[i];
 
       double max_dist_dalton = fragment_mass_tolerance_unit_ppm ? theo_mz * fragment_mass_tolerance * 1e-6 : fragment_mass_tolerance;
 
-      // iterate over peaks in experimental spectrum in given fragment tolerance around theoretical peak
-      Size index = exp_spectrum.findNearest(theo_mz);
+      // nearest peak in experimental spectrum to the theoretical peak
+      Size index = nearest[i];
 
       const double exp_mz = exp_spectrum[index].getMZ();
       const double theo_intensity = theo_spectrum[i].getIntensity();
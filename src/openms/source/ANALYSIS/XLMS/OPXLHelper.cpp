@@ -37,6 +37,7 @@
 #include <OpenMS/CHEMISTRY/ModificationsDB.h>
 #include <OpenMS/CONCEPT/LogStream.h>
 #include <OpenMS/MATH/STATISTICS/StatisticFunctions.h>
+#include <OpenMS/ANALYSIS/ID/PrecursorMassIndex.h>
 
 // turn on additional debug output
 // #define DEBUG_OPXLHELPER
@@ -55,6 +56,14 @@ namespace OpenMS
     double min_precursor = spectrum_precursors[0];
     double max_precursor = spectrum_precursors[spectrum_precursors.size()-1];
 
+    // index of the spectrum precursor masses, entries refer to positions in spectrum_precursors
+    PrecursorMassIndex spectrum_precursor_index;
+    for (Size i = 0; i < spectrum_precursors.size(); ++i)
+    {
+      spectrum_precursor_index.add(spectrum_precursors[i], i);
+    }
+    spectrum_precursor_index.build();
+
     for (SignedSize p1 = 0; p1 < static_cast<SignedSize>(peptides.size()); ++p1)
     {
       // get the amino acid sequence of this peptide as a character string
@@ -76,7 +85,7 @@ namespace OpenMS
         // call function to compare with spectrum precursor masses
         // will only add this candidate, if the mass is within the given tolerance to any precursor in the spectra data
         // after the first monolink is added, stop enumerating masses (if other candidates fit within the same precursor, they will have exactly the same fragment matching)
-        if (filter_and_add_candidate(mass_to_candidates, spectrum_precursors, precursor_correction_positions, precursor_mass_tolerance_unit_ppm, precursor_mass_tolerance, precursor))
+        if (filter_and_add_candidate(mass_to_candidates, spectrum_precursor_index, precursor_correction_positions, precursor_mass_tolerance_unit_ppm, precursor_mass_tolerance, precursor))
         {
           break;
         }
@@ -117,7 +126,7 @@ namespace OpenMS
         precursor.beta_index = peptides.size() + 1; // an out-of-range index to represent an empty index
 
         // call function to compare with spectrum precursor masses
-        filter_and_add_candidate(mass_to_candidates, spectrum_precursors, precursor_correction_positions, precursor_mass_tolerance_unit_ppm, precursor_mass_tolerance, precursor);
+        filter_and_add_candidate(mass_to_candidates, spectrum_precursor_index, precursor_correction_positions, precursor_mass_tolerance_unit_ppm, precursor_mass_tolerance, precursor);
       }
 
       // check for minimal mass of second peptide, jump farther than current peptide if possible
@@ -162,41 +171,24 @@ namespace OpenMS
         precursor.beta_index = p2;
 
         // call function to compare with spectrum precursor masses
-        filter_and_add_candidate(mass_to_candidates, spectrum_precursors, precursor_correction_positions, precursor_mass_tolerance_unit_ppm, precursor_mass_tolerance, precursor);
+        filter_and_add_candidate(mass_to_candidates, spectrum_precursor_index, precursor_correction_positions, precursor_mass_tolerance_unit_ppm, precursor_mass_tolerance, precursor);
       }
     }
     // cout << "Enumerated pairs with sequence " << countA << " of " << peptides.size() << ";\t Current pair count: " << mass_to_candidates.size() << " | current size in mb: " << mass_to_candidates.size() * sizeof(OPXLDataStructs::XLPrecursor) / 1024 / 1024 << endl;
     return mass_to_candidates;
   }
 
-  bool OPXLHelper::filter_and_add_candidate(vector<OPXLDataStructs::XLPrecursor>& mass_to_candidates, const vector< double >& spectrum_precursors, vector< int >& precursor_correction_positions, bool precursor_mass_tolerance_unit_ppm, double precursor_mass_tolerance, OPXLDataStructs::XLPrecursor precursor)
+  bool OPXLHelper::filter_and_add_candidate(vector<OPXLDataStructs::XLPrecursor>& mass_to_candidates, const PrecursorMassIndex& spectrum_precursors, vector< int >& precursor_correction_positions, bool precursor_mass_tolerance_unit_ppm, double precursor_mass_tolerance, OPXLDataStructs::XLPrecursor precursor)
   {
-    vector< double >::const_iterator low_it;
-    vector< double >::const_iterator up_it;
-
-    // compute absolute tolerance from relative, if necessary
-    double allowed_error = 0;
-    if (precursor_mass_tolerance_unit_ppm) // ppm
-    {
-      allowed_error = precursor.precursor_mass * precursor_mass_tolerance * 1e-6;
-    }
-    else // Dalton
-    {
-      allowed_error = precursor_mass_tolerance;
-    }
-
-    // find precursor with m/z >= low end of range
-    low_it = lower_bound(spectrum_precursors.begin(), spectrum_precursors.end(), precursor.precursor_mass - allowed_error);
-    // find precursor with m/z > (not equal to) high end of range
-    up_it =  upper_bound(spectrum_precursors.begin(), spectrum_precursors.end(), precursor.precursor_mass + allowed_error);
-    // if these two are equal, there is no precursor within the range
+    // find all precursors within the tolerance
+    PrecursorMassIndex::Range matching_precursors = spectrum_precursors.find(precursor.precursor_mass, precursor_mass_tolerance, precursor_mass_tolerance_unit_ppm);
 
-    if (low_it != up_it) // if they are not equal, there are matching precursors in the data
+    if (matching_precursors.first != matching_precursors.second) // there are matching precursors in the data
     {
       // found_matching_precursors = true;
       mass_to_candidates.push_back(precursor);
       // take the position of the highest matching precursor mass in the vector (prioritize smallest correction)
-      precursor_correction_positions.push_back(std::distance(spectrum_precursors.begin(), std::prev(up_it, 1)));
+      precursor_correction_positions.push_back(std::prev(matching_precursors.second, 1)->spectrum_index);
       return true;
     }
     else
@@ -361,7 +361,7 @@ namespace OpenMS
     return formula_.find(element) != formula_.end();
   }
 
-  bool EmpiricalFormula::contains(const EmpiricalFormula& ef)
+  bool EmpiricalFormula::contains(const EmpiricalFormula& ef) const
   {
     for (const auto& it : ef) 
     {
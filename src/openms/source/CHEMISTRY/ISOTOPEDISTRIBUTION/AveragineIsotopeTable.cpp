@@ -0,0 +1,209 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/AveragineIsotopeTable.h>
+
+#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/CoarseIsotopePatternGenerator.h>
+#include <OpenMS/CHEMISTRY/EmpiricalFormula.h>
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+
+#include <cmath>
+
+namespace OpenMS
+{
+  namespace
+  {
+    // Element counts are from Senko's Averagine model (same as CoarseIsotopePatternGenerator::estimateFromPeptideWeight)
+    EmpiricalFormula averagineFormula(double average_weight)
+    {
+      EmpiricalFormula ef;
+      ef.estimateFromWeightAndComp(average_weight, 4.9384, 7.7583, 1.3577, 1.4773, 0.0417, 0);
+      return ef;
+    }
+  }
+
+  const Size AveragineIsotopeTable::MAX_SHARED_ISOTOPES;
+  const Size AveragineIsotopeTable::BLOCK_SIZE;
+
+  AveragineIsotopeTable::AveragineIsotopeTable(Size max_isotope, double max_mass, double bin_width) :
+    max_isotope_(max_isotope),
+    max_mass_(max_mass),
+    bin_width_(bin_width),
+    nr_bins_(0)
+  {
+    if (!(bin_width > 0.0) || max_mass < 0.0)
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Bin width needs to be positive and maximal mass non-negative", String(bin_width));
+    }
+    nr_bins_ = static_cast<Size>(std::ceil(max_mass_ / bin_width_));
+    blocks_ = std::vector<std::atomic<const Block*> >((nr_bins_ + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    for (Size i = 0; i < blocks_.size(); ++i)
+    {
+      blocks_[i].store(nullptr);
+    }
+  }
+
+  AveragineIsotopeTable::~AveragineIsotopeTable()
+  {
+    for (Size i = 0; i < blocks_.size(); ++i)
+    {
+      delete blocks_[i].load();
+    }
+  }
+
+  const AveragineIsotopeTable& AveragineIsotopeTable::getInstance(Size max_isotope)
+  {
+    if (max_isotope > MAX_SHARED_ISOTOPES)
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "No shared table for more than " + String(MAX_SHARED_ISOTOPES) + " isotopes", String(max_isotope));
+    }
+
+    // the tables are never deleted (same as other singletons like ElementDB)
+    static std::atomic<const AveragineIsotopeTable*> instances[MAX_SHARED_ISOTOPES + 1] = {};
+    const AveragineIsotopeTable* table = instances[max_isotope].load(std::memory_order_acquire);
+    if (table == nullptr)
+    {
+      const AveragineIsotopeTable* new_table = new AveragineIsotopeTable(max_isotope);
+      if (instances[max_isotope].compare_exchange_strong(table, new_table, std::memory_order_acq_rel))
+      {
+        table = new_table;
+      }
+      else
+      {
+        delete new_table; // another thread was faster
+      }
+    }
+    return *table;
+  }
+
+  IsotopeDistribution AveragineIsotopeTable::estimateFromPeptideWeight(double average_weight, Size max_isotope)
+  {
+    if (max_isotope > MAX_SHARED_ISOTOPES)
+    {
+      return CoarseIsotopePatternGenerator(max_isotope).estimateFromPeptideWeight(average_weight);
+    }
+    return getInstance(max_isotope).estimateFromPeptideWeight(average_weight);
+  }
+
+  IsotopeDistribution AveragineIsotopeTable::estimateFromPeptideWeight(double average_weight) const
+  {
+    if (!(average_weight >= 0.0) || average_weight >= max_mass_)
+    {
+      return compute_(average_weight);
+    }
+    Size bin = static_cast<Size>(average_weight / bin_width_);
+    // (guard against rounding errors in the bin computation)
+    if (bin >= nr_bins_ || average_weight < bin * bin_width_ || average_weight > (bin + 1) * bin_width_)
+    {
+      return compute_(average_weight);
+    }
+
+    const Block& block = getBlock_(bin / BLOCK_SIZE);
+    Int idx = block.distribution_index[bin % BLOCK_SIZE];
+    if (idx < 0)
+    {
+      return compute_(average_weight);
+    }
+    return block.distributions[idx];
+  }
+
+  Size AveragineIsotopeTable::getMaxIsotope() const
+  {
+    return max_isotope_;
+  }
+
+  double AveragineIsotopeTable::getMaxMass() const
+  {
+    return max_mass_;
+  }
+
+  double AveragineIsotopeTable::getBinWidth() const
+  {
+    return bin_width_;
+  }
+
+  IsotopeDistribution AveragineIsotopeTable::compute_(double average_weight) const
+  {
+    return CoarseIsotopePatternGenerator(max_isotope_).estimateFromPeptideWeight(average_weight);
+  }
+
+  const AveragineIsotopeTable::Block& AveragineIsotopeTable::getBlock_(Size block_idx) const
+  {
+    const Block* block = blocks_[block_idx].load(std::memory_order_acquire);
+    if (block != nullptr)
+    {
+      return *block;
+    }
+
+    // Compute all bins of the block. The sum formula only ever increases
+    // with the weight (the heavy atoms are monotonous in the weight and the
+    // number of hydrogens is monotonous as long as the heavy atoms do not
+    // change), so if the formula is identical at both borders of a bin, it
+    // is identical for all weights inside the bin.
+    Block* new_block = new Block;
+    Size first_bin = block_idx * BLOCK_SIZE;
+    Size last_bin = std::min(first_bin + BLOCK_SIZE, nr_bins_);
+    new_block->distribution_index.resize(last_bin - first_bin, -1);
+
+    CoarseIsotopePatternGenerator solver(max_isotope_);
+    EmpiricalFormula left = averagineFormula(first_bin * bin_width_);
+    EmpiricalFormula last_formula;
+    for (Size bin = first_bin; bin < last_bin; ++bin)
+    {
+      EmpiricalFormula right = averagineFormula((bin + 1) * bin_width_);
+      if (left == right)
+      {
+        if (new_block->distributions.empty() || !(left == last_formula))
+        {
+          new_block->distributions.push_back(left.getIsotopeDistribution(solver));
+          last_formula = left;
+        }
+        new_block->distribution_index[bin - first_bin] = static_cast<Int>(new_block->distributions.size()) - 1;
+      }
+      left = right;
+    }
+
+    const Block* expected = nullptr;
+    if (!blocks_[block_idx].compare_exchange_strong(expected, new_block, std::memory_order_acq_rel))
+    {
+      delete new_block; // another thread was faster
+      return *expected;
+    }
+    return *new_block;
+  }
+
+}
@@ -4,6 +4,7 @@ set(directory source/CHEMISTRY/ISOTOPEDISTRIBUTION)
 
 ### list all filenames of the directory here
 set(sources_list
+  AveragineIsotopeTable.cpp
   CoarseIsotopePatternGenerator.cpp
   FineIsotopePatternGenerator.cpp
   IsotopeDistribution.cpp
@@ -0,0 +1,206 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/DATASTRUCTURES/StaticKDTree2D.h>
+#include <OpenMS/CONCEPT/Exception.h>
+
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace OpenMS
+{
+  namespace
+  {
+    /// compares point indices by one of their coordinates
+    struct CoordinateLess
+    {
+      explicit CoordinateLess(const std::vector<double>& coordinates) :
+        coordinates_(coordinates)
+      {
+      }
+
+      bool operator()(Size left, Size right) const
+      {
+        return coordinates_[left] < coordinates_[right];
+      }
+
+      const std::vector<double>& coordinates_;
+    };
+
+    /// subrange [begin, end) of the tree split in dimension dim
+    struct SubTree
+    {
+      Size begin;
+      Size end;
+      Size dim;
+    };
+  }
+
+  const Size StaticKDTree2D::bucket_size_ = 16;
+
+  StaticKDTree2D::StaticKDTree2D() :
+    x_(),
+    y_(),
+    index_()
+  {
+  }
+
+  void StaticKDTree2D::build(const std::vector<double>& x, const std::vector<double>& y)
+  {
+    if (x.size() != y.size())
+    {
+      throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, y.size());
+    }
+
+    std::vector<Size> order(x.size());
+    for (Size i = 0; i < order.size(); ++i)
+    {
+      order[i] = i;
+    }
+    build_(order, 0, order.size(), 0, x, y);
+
+    // store the points in tree order
+    x_.resize(order.size());
+    y_.resize(order.size());
+    for (Size i = 0; i < order.size(); ++i)
+    {
+      x_[i] = x[order[i]];
+      y_[i] = y[order[i]];
+    }
+    index_.swap(order);
+  }
+
+  void StaticKDTree2D::build_(std::vector<Size>& order, Size begin, Size end, Size dim, const std::vector<double>& x, const std::vector<double>& y)
+  {
+    if (end - begin <= bucket_size_)
+    {
+      return;
+    }
+    // median in the middle, smaller (or equal) coordinates to the left,
+    // larger (or equal) coordinates to the right
+    const Size mid = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+                     CoordinateLess(dim == 0 ? x : y));
+    build_(order, begin, mid, 1 - dim, x, y);
+    build_(order, mid + 1, end, 1 - dim, x, y);
+  }
+
+  void StaticKDTree2D::clear()
+  {
+    x_.clear();
+    y_.clear();
+    index_.clear();
+  }
+
+  Size StaticKDTree2D::size() const
+  {
+    return index_.size();
+  }
+
+  bool StaticKDTree2D::empty() const
+  {
+    return index_.empty();
+  }
+
+  void StaticKDTree2D::queryRegion(double x_low, double x_high, double y_low, double y_high, std::vector<Size>& result) const
+  {
+    if (index_.empty())
+    {
+      return;
+    }
+
+    // every level halves the subrange, so the stack never exceeds one entry per bit
+    SubTree stack[2 * sizeof(Size) * 8];
+    Size stack_size = 0;
+    SubTree root = {0, index_.size(), 0};
+    stack[stack_size++] = root;
+
+    while (stack_size > 0)
+    {
+      const SubTree current = stack[--stack_size];
+
+      if (current.end - current.begin <= bucket_size_)
+      {
+        // bucket: linear scan
+        for (Size i = current.begin; i < current.end; ++i)
+        {
+          if (x_[i] >= x_low && x_[i] <= x_high && y_[i] >= y_low && y_[i] <= y_high)
+          {
+            result.push_back(index_[i]);
+          }
+        }
+        continue;
+      }
+
+      const Size mid = current.begin + (current.end - current.begin) / 2;
+      if (x_[mid] >= x_low && x_[mid] <= x_high && y_[mid] >= y_low && y_[mid] <= y_high)
+      {
+        result.push_back(index_[mid]);
+      }
+
+      const double split = (current.dim == 0) ? x_[mid] : y_[mid];
+      const double low = (current.dim == 0) ? x_low : y_low;
+      const double high = (current.dim == 0) ? x_high : y_high;
+      if (high >= split)
+      {
+        SubTree right = {mid + 1, current.end, 1 - current.dim};
+        stack[stack_size++] = right;
+      }
+      if (low <= split)
+      {
+        SubTree left = {current.begin, mid, 1 - current.dim};
+        stack[stack_size++] = left;
+      }
+    }
+  }
+
+  void StaticKDTree2D::queryRegions(const std::vector<Region>& regions, std::vector<std::vector<Size> >& results) const
+  {
+    results.resize(regions.size());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)regions.size(); ++i)
+    {
+      const Region& region = regions[i];
+      results[i].clear();
+      queryRegion(region.x_low, region.x_high, region.y_low, region.y_high, results[i]);
+    }
+  }
+
+} // namespace OpenMS
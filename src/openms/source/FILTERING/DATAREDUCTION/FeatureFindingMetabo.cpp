@@ -33,7 +33,7 @@
 // --------------------------------------------------------------------------
 
 #include <OpenMS/FILTERING/DATAREDUCTION/FeatureFindingMetabo.h>
-#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/CoarseIsotopePatternGenerator.h>
+#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/AveragineIsotopeTable.h>
 #include <OpenMS/SYSTEM/File.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathHelper.h>
 
@@ -193,6 +193,11 @@ namespace OpenMS
     return tmp_labels;
   }
 
+  const std::vector<const MassTrace*>& FeatureHypothesis::getMassTraces() const
+  {
+    return iso_pattern_;
+  }
+
   void FeatureHypothesis::setScore( const double& score )
   {
     feat_score_ = score;
@@ -350,8 +355,7 @@ namespace OpenMS
 
   double FeatureFindingMetabo::computeAveragineSimScore_(const std::vector<double>& hypo_ints, const double& mol_weight) const
   {
-    CoarseIsotopePatternGenerator solver(hypo_ints.size());
-    auto isodist = solver.estimateFromPeptideWeight(mol_weight);
+    auto isodist = AveragineIsotopeTable::estimateFromPeptideWeight(mol_weight, hypo_ints.size());
     // isodist.renormalize();
 
     IsotopeDistribution::ContainerType averagine_dist = isodist.getContainer();
@@ -657,14 +661,7 @@ namespace OpenMS
     FeatureHypothesis tmp_hypo;
     tmp_hypo.addMassTrace(*candidates[0]);
     tmp_hypo.setScore((candidates[0]->getIntensity(use_smoothed_intensities_)) / total_intensity);
-
-#ifdef _OPENMP
-#pragma omp critical (OPENMS_FFMetabo_output_hypos)
-#endif
-    {
-      // pushing back to shared vector needs to be synchronized
-      output_hypotheses.push_back(tmp_hypo);
-    }
+    output_hypotheses.push_back(tmp_hypo);
 
     for (Size charge = charge_lower_bound_; charge <= charge_upper_bound_; ++charge)
     {
@@ -739,14 +736,7 @@ namespace OpenMS
           fh_tmp.setScore(fh_tmp.getScore() + weighted_score);
           fh_tmp.setCharge(charge);
           last_iso_idx = best_idx;
-
-#ifdef _OPENMP
-#pragma omp critical (OPENMS_FFMetabo_output_hypos)
-#endif
-          {
-            // pushing back to shared vector needs to be synchronized
-            output_hypotheses.push_back(fh_tmp);
-          }
+          output_hypotheses.push_back(fh_tmp);
         }
         else
         {
@@ -800,10 +790,13 @@ namespace OpenMS
     // and generate isotopic / charge hypotheses
     // *********************************************************** //
 
-    std::vector<FeatureHypothesis> feat_hypos;
+    // hypotheses are collected per reference trace (no synchronization
+    // needed) and concatenated in trace order afterwards, which makes the
+    // result independent of the thread schedule
+    std::vector<std::vector<FeatureHypothesis> > hypos_per_trace(input_mtraces.size());
     Size progress(0);
 #ifdef _OPENMP
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic, 64)
 #endif
     for (SignedSize i = 0; i < (SignedSize)input_mtraces.size(); ++i)
     {
@@ -832,12 +825,25 @@ namespace OpenMS
           local_traces.push_back(&input_mtraces[ext_idx]);
         }
       }
-      findLocalFeatures_(local_traces, total_intensity, feat_hypos);
+      findLocalFeatures_(local_traces, total_intensity, hypos_per_trace[i]);
     }
     this->endProgress();
 
-    // sort feature candidates by their score
-    std::sort(feat_hypos.begin(), feat_hypos.end(), CmpHypothesesByScore());
+    Size hypo_count(0);
+    for (Size i = 0; i < hypos_per_trace.size(); ++i)
+    {
+      hypo_count += hypos_per_trace[i].size();
+    }
+    std::vector<FeatureHypothesis> feat_hypos;
+    feat_hypos.reserve(hypo_count);
+    for (Size i = 0; i < hypos_per_trace.size(); ++i)
+    {
+      feat_hypos.insert(feat_hypos.end(), hypos_per_trace[i].begin(), hypos_per_trace[i].end());
+      std::vector<FeatureHypothesis>().swap(hypos_per_trace[i]);
+    }
+
+    // sort feature candidates by their score (stable, to resolve ties deterministically)
+    std::stable_sort(feat_hypos.begin(), feat_hypos.end(), CmpHypothesesByScore());
 
 #ifdef FFM_DEBUG
     std::cout << "size of hypotheses: " << feat_hypos.size() << std::endl;
@@ -855,100 +861,174 @@ namespace OpenMS
     // scoring one. Accept them if they do not contain traces that have 
     // already been used by a higher scoring hypothesis.
     // *********************************************************** //
-    std::map<String, bool> trace_excl_map;
-    for (Size hypo_idx = 0; hypo_idx < feat_hypos.size(); ++hypo_idx)
+
+    // traces are excluded by label; map each trace to a dense label id
+    std::vector<Size> trace_label_ids(input_mtraces.size());
+    Size label_count(0);
+    {
+      std::map<String, Size> label_ids;
+      for (Size i = 0; i < input_mtraces.size(); ++i)
+      {
+        std::map<String, Size>::const_iterator it = label_ids.insert(std::make_pair(input_mtraces[i].getLabel(), label_ids.size())).first;
+        trace_label_ids[i] = it->second;
+      }
+      label_count = label_ids.size();
+    }
+    std::vector<bool> label_excluded(label_count, false);
+    const MassTrace* first_trace = &input_mtraces[0];
+
+    const bool use_isotope_filter = (isotope_filtering_model_ != "none" && isotope_filtering_model_ != "peptides");
+
+    // Hypotheses are processed in batches: collision checks against the
+    // traces used so far and the (expensive) SVM isotope filter are
+    // evaluated in parallel for the whole batch. Since exclusions only grow,
+    // the serial greedy selection afterwards just has to re-check collisions
+    // within the batch and yields the same result as a fully serial pass.
+    const Size batch_size(1024);
+    std::vector<Size> accepted_hypos;
+    std::vector<int> accepted_pass_filter;
+    std::vector<char> batch_collides(batch_size);
+    std::vector<int> batch_pass_filter(batch_size);
+    for (Size batch_begin = 0; batch_begin < feat_hypos.size(); batch_begin += batch_size)
     {
-      // std::cout << "score now: " <<  feat_hypos[hypo_idx].getScore() << std::endl;
-      std::vector<String> labels(feat_hypos[hypo_idx].getLabels());
-      bool trace_coll = false;   // trace collision?
-      for (Size lab_idx = 0; lab_idx < labels.size(); ++lab_idx)
+      Size batch_end = std::min(batch_begin + batch_size, feat_hypos.size());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+      for (SignedSize j = 0; j < (SignedSize)(batch_end - batch_begin); ++j)
       {
-        if (trace_excl_map.find(labels[lab_idx]) != trace_excl_map.end())
+        const std::vector<const MassTrace*>& traces = feat_hypos[batch_begin + j].getMassTraces();
+        bool trace_coll = false;   // trace collision?
+        for (Size t = 0; t < traces.size(); ++t)
         {
-          trace_coll = true;
-          break;
+          if (label_excluded[trace_label_ids[traces[t] - first_trace]])
+          {
+            trace_coll = true;
+            break;
+          }
         }
+        batch_collides[j] = trace_coll;
+
+        // Check whether the trace passes the intensity filter (metabolites
+        // only). This is based on a pre-trained SVM model of isotopic
+        // intensities.
+        // -1 == 'did not test'; 0 = no pass; 1 = pass
+        batch_pass_filter[j] = (use_isotope_filter && !trace_coll) ? isLegalIsotopePattern_(feat_hypos[batch_begin + j]) : -1;
       }
 
-#ifdef FFM_DEBUG
-      if (feat_hypos[hypo_idx].getSize() > 1)
+      for (Size hypo_idx = batch_begin; hypo_idx < batch_end; ++hypo_idx)
       {
-        std::cout << "check for collision: " << trace_coll << " " << 
-          feat_hypos[hypo_idx].getLabel() << " " << isLegalIsotopePattern_(feat_hypos[hypo_idx]) << 
-          " " << feat_hypos[hypo_idx].getScore() << std::endl;
-      }
+        Size j = hypo_idx - batch_begin;
+        if (batch_collides[j]) continue;
+
+        // re-check against traces used by hypotheses accepted in this batch
+        const std::vector<const MassTrace*>& traces = feat_hypos[hypo_idx].getMassTraces();
+        bool trace_coll = false;   // trace collision?
+        for (Size t = 0; t < traces.size(); ++t)
+        {
+          if (label_excluded[trace_label_ids[traces[t] - first_trace]])
+          {
+            trace_coll = true;
+            break;
+          }
+        }
+
+#ifdef FFM_DEBUG
+        if (feat_hypos[hypo_idx].getSize() > 1)
+        {
+          std::cout << "check for collision: " << trace_coll << " " << 
+            feat_hypos[hypo_idx].getLabel() << " " << batch_pass_filter[j] << 
+            " " << feat_hypos[hypo_idx].getScore() << std::endl;
+        }
 #endif
 
-      // Skip hypotheses that contain a mass trace that has already been used
-      if (trace_coll) 
-      {
-        continue;
-      }
+        // Skip hypotheses that contain a mass trace that has already been used
+        if (trace_coll) 
+        {
+          continue;
+        }
 
-      // Check whether the trace  passes the intensity filter (metabolites
-      // only). This is based on a pre-trained SVM model of isotopic
-      // intensities.
-      int pass_isotope_filter = -1; // -1 == 'did not test'; 0 = no pass; 1 = pass
-      if (isotope_filtering_model_ != "none" && isotope_filtering_model_ != "peptides")
-      {
-        pass_isotope_filter = isLegalIsotopePattern_(feat_hypos[hypo_idx]);
-      }
-    
-      // std::cout << "\nlegal iso? " << feat_hypos[hypo_idx].getLabel() << " score: " << feat_hypos[hypo_idx].getScore() << " " << result << std::endl;
+        if (batch_pass_filter[j] == 0) // not passing filter
+        {
+          continue;
+        }
 
-      if (pass_isotope_filter == 0) // not passing filter
-      {
-        continue;
-      }
+        // filter out single traces if option is set
+        if (remove_single_traces_ && feat_hypos[hypo_idx].getCharge() == 0)
+        {
+          continue;
+        }
 
-      // filter out single traces if option is set
-      if (remove_single_traces_ && feat_hypos[hypo_idx].getCharge() == 0)
-      {
-        continue;
-      }
+        //
+        // Now accept hypothesis
+        //
+        accepted_hypos.push_back(hypo_idx);
+        accepted_pass_filter.push_back(batch_pass_filter[j]);
 
-      //
-      // Now accept hypothesis
-      //
+        // add used traces to exclusion map
+        for (Size t = 0; t < traces.size(); ++t)
+        {
+          label_excluded[trace_label_ids[traces[t] - first_trace]] = true;
+        }
+      }
+    }
 
-      Feature f;
-      f.setRT(feat_hypos[hypo_idx].getCentroidRT());
-      f.setMZ(feat_hypos[hypo_idx].getCentroidMZ());
+    // assemble the accepted features in parallel
+    std::vector<Feature> features(accepted_hypos.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for (SignedSize k = 0; k < (SignedSize)accepted_hypos.size(); ++k)
+    {
+      const FeatureHypothesis& hypo = feat_hypos[accepted_hypos[k]];
+      Feature& f = features[k];
+      f.setRT(hypo.getCentroidRT());
+      f.setMZ(hypo.getCentroidMZ());
 
       if (report_summed_ints_)
       {
-        f.setIntensity(feat_hypos[hypo_idx].getSummedFeatureIntensity(use_smoothed_intensities_));
+        f.setIntensity(hypo.getSummedFeatureIntensity(use_smoothed_intensities_));
       }
       else
       {
-        f.setIntensity(feat_hypos[hypo_idx].getMonoisotopicFeatureIntensity(use_smoothed_intensities_));
+        f.setIntensity(hypo.getMonoisotopicFeatureIntensity(use_smoothed_intensities_));
       }
 
-      f.setWidth(feat_hypos[hypo_idx].getFWHM());
-      f.setCharge(feat_hypos[hypo_idx].getCharge());
-      f.setMetaValue(3, feat_hypos[hypo_idx].getLabel());
+      f.setWidth(hypo.getFWHM());
+      f.setCharge(hypo.getCharge());
+      f.setMetaValue(3, hypo.getLabel());
 
       // store isotope intensities
-      std::vector<double> all_ints(feat_hypos[hypo_idx].getAllIntensities(use_smoothed_intensities_));
+      std::vector<double> all_ints(hypo.getAllIntensities(use_smoothed_intensities_));
       f.setMetaValue("num_of_masstraces", all_ints.size());
-      if (report_convex_hulls_) f.setConvexHulls(feat_hypos[hypo_idx].getConvexHulls());
-      f.setOverallQuality(feat_hypos[hypo_idx].getScore());
+      if (report_convex_hulls_) f.setConvexHulls(hypo.getConvexHulls());
+      f.setOverallQuality(hypo.getScore());
       f.setMetaValue("masstrace_intensity", all_ints);
-      f.setMetaValue("masstrace_centroid_rt", feat_hypos[hypo_idx].getAllCentroidRT());
-      f.setMetaValue("masstrace_centroid_mz", feat_hypos[hypo_idx].getAllCentroidMZ());;
-      f.setMetaValue("isotope_distances", feat_hypos[hypo_idx].getIsotopeDistances());
-      f.setMetaValue("legal_isotope_pattern", pass_isotope_filter);
-      f.applyMemberFunction(&UniqueIdInterface::setUniqueId);
-      output_featmap.push_back(f);
-
-      if (report_chromatograms_)
-      {
-        output_chromatograms.push_back(feat_hypos[hypo_idx].getChromatograms(f.getUniqueId()));
-      }
-      // add used traces to exclusion map
-      for (Size lab_idx = 0; lab_idx < labels.size(); ++lab_idx)
+      f.setMetaValue("masstrace_centroid_rt", hypo.getAllCentroidRT());
+      f.setMetaValue("masstrace_centroid_mz", hypo.getAllCentroidMZ());
+      f.setMetaValue("isotope_distances", hypo.getIsotopeDistances());
+      f.setMetaValue("legal_isotope_pattern", accepted_pass_filter[k]);
+    }
+
+    // unique ids are drawn serially (in order of acceptance)
+    output_featmap.reserve(features.size());
+    for (Size k = 0; k < features.size(); ++k)
+    {
+      features[k].applyMemberFunction(&UniqueIdInterface::setUniqueId);
+      output_featmap.push_back(features[k]);
+    }
+    std::vector<Feature>().swap(features);
+
+    if (report_chromatograms_)
+    {
+      output_chromatograms.resize(accepted_hypos.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+      for (SignedSize k = 0; k < (SignedSize)accepted_hypos.size(); ++k)
       {
-        trace_excl_map[labels[lab_idx]] = true;
+        output_chromatograms[k] = feat_hypos[accepted_hypos[k]].getChromatograms(output_featmap[k].getUniqueId());
       }
     }
     output_featmap.setUniqueId(UniqueIdGenerator::getUniqueId());
@@ -34,9 +34,10 @@
 
 #include <OpenMS/FILTERING/DATAREDUCTION/MassTraceDetection.h>
 
+#include <OpenMS/KERNEL/OnDiscMSExperiment.h>
 #include <OpenMS/MATH/STATISTICS/StatisticFunctions.h>
 
-#include <boost/dynamic_bitset.hpp>
+#include <algorithm>
 
 namespace OpenMS
 {
@@ -62,6 +63,11 @@ namespace OpenMS
     defaults_.setValue("min_trace_length", 5.0, "Minimum expected length of a mass trace (in seconds).", ListUtils::create<String>("advanced"));
     defaults_.setValue("max_trace_length", -1.0, "Maximum expected length of a mass trace (in seconds). Set to a negative value to disable maximal length check during mass trace detection.", ListUtils::create<String>("advanced"));
 
+    defaults_.setValue("streaming_block_size", 1000, "Streaming mode only: number of MS1 spectra whose apices are processed together. Together with 'streaming_block_overlap' this bounds the number of spectra held in memory.", ListUtils::create<String>("advanced"));
+    defaults_.setMinInt("streaming_block_size", 1);
+    defaults_.setValue("streaming_block_overlap", 250, "Streaming mode only: number of MS1 spectra a mass trace may extend beyond the block of its apex. Should exceed the longest expected trace (in scans).", ListUtils::create<String>("advanced"));
+    defaults_.setMinInt("streaming_block_overlap", 0);
+
     defaultsToParam_();
 
     this->setLogType(CMD);
@@ -187,6 +193,28 @@ namespace OpenMS
   }
 
 
+  void MassTraceDetection::filterSpectrum_(const MSSpectrum& spectrum, Size scan_idx, MSSpectrum& filtered, std::vector<Apex>& chrom_apices) const
+  {
+    std::vector<Size> indices_passing;
+    for (Size peak_idx = 0; peak_idx < spectrum.size(); ++peak_idx)
+    {
+      double tmp_peak_int(spectrum[peak_idx].getIntensity());
+      if (tmp_peak_int > noise_threshold_int_)
+      {
+        // Assume that noise_threshold_int_ contains the noise level of the
+        // data and we want to be chrom_peak_snr times above the noise level
+        // --> add this peak as possible chromatographic apex
+        if (tmp_peak_int > chrom_peak_snr_ * noise_threshold_int_)
+        {
+          chrom_apices.push_back(Apex(tmp_peak_int, scan_idx, indices_passing.size()));
+        }
+        indices_passing.push_back(peak_idx);
+      }
+    }
+    filtered = spectrum;
+    filtered.select(indices_passing);
+  }
+
   void MassTraceDetection::run(const PeakMap& input_exp, std::vector<MassTrace>& found_masstraces)
   {
     // make sure the output vector is empty
@@ -196,13 +224,10 @@ namespace OpenMS
     //   - use work_exp for actual work (remove peaks below noise threshold)
     //   - store potential apices in chrom_apices
     PeakMap work_exp;
-    MapIdxSortedByInt chrom_apices;
+    std::vector<Apex> chrom_apices;
 
     Size total_peak_count(0);
     std::vector<Size> spec_offsets;
-    spec_offsets.push_back(0);
-
-    Size spectra_count(0);
 
     // *********************************************************** //
     //  Step 1: Detecting potential chromatographic apices
@@ -212,57 +237,68 @@ namespace OpenMS
       // check if this is a MS1 survey scan
       if (it->getMSLevel() != 1) continue;
 
-      std::vector<Size> indices_passing;
-      for (Size peak_idx = 0; peak_idx < it->size(); ++peak_idx)
-      {
-        double tmp_peak_int((*it)[peak_idx].getIntensity());
-        if (tmp_peak_int > noise_threshold_int_)
-        {
-          // Assume that noise_threshold_int_ contains the noise level of the
-          // data and we want to be chrom_peak_snr times above the noise level
-          // --> add this peak as possible chromatographic apex
-          if (tmp_peak_int > chrom_peak_snr_ * noise_threshold_int_)
-          {
-            chrom_apices.insert(std::make_pair(tmp_peak_int, std::make_pair(spectra_count, indices_passing.size())));
-          }
-          indices_passing.push_back(peak_idx);
-          ++total_peak_count;
-        }
-      }
-      PeakMap::SpectrumType tmp_spec(*it);
-      tmp_spec.select(indices_passing);
-      work_exp.addSpectrum(tmp_spec);
-      spec_offsets.push_back(spec_offsets.back() + tmp_spec.size());
-      ++spectra_count;
+      MSSpectrum tmp_spec;
+      filterSpectrum_(*it, work_exp.size(), tmp_spec, chrom_apices);
+      spec_offsets.push_back(total_peak_count);
+      total_peak_count += tmp_spec.size();
+      work_exp.addSpectrum(std::move(tmp_spec));
     }
 
-    if (spectra_count < 3)
+    if (work_exp.size() < 3)
     {
       throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
-                                    "Input map consists of too few MS1 spectra (less than 3!). Aborting...", String(spectra_count));
+                                    "Input map consists of too few MS1 spectra (less than 3!). Aborting...", String(work_exp.size()));
     }
 
-    // discard last spectrum's offset
-    spec_offsets.pop_back();
+    std::sort(chrom_apices.begin(), chrom_apices.end(), Apex::precedes);
 
     // *********************************************************************
     // Step 2: start extending mass traces beginning with the apex peak (go
     // through all peaks in order of decreasing intensity)
     // *********************************************************************
-    run_(chrom_apices, total_peak_count, work_exp, spec_offsets, found_masstraces);
+    std::vector<bool> peak_visited(total_peak_count, false);
+    Size trace_number(1);
+
+    this->startProgress(0, total_peak_count, "mass trace detection");
+    run_(chrom_apices, work_exp, spec_offsets, peak_visited, trace_number, found_masstraces, true);
+    this->endProgress();
 
     return;
   } // end of MassTraceDetection::run
 
-  void MassTraceDetection::run_(const MapIdxSortedByInt& chrom_apices,
-                                const Size total_peak_count, 
-                                const PeakMap& work_exp, 
-                                const std::vector<Size>& spec_offsets,
-                                std::vector<MassTrace>& found_masstraces)
+  void MassTraceDetection::run(OnDiscMSExperiment& input_exp, std::vector<MassTrace>& found_masstraces)
   {
-    boost::dynamic_bitset<> peak_visited(total_peak_count);
-    Size trace_number(1);
+    boost::shared_ptr<PeakMap> meta = input_exp.getMetaData();
+    if (!meta || meta->size() != input_exp.getNrSpectra())
+    {
+      throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                    "Streaming mass trace detection requires the spectrum meta data of the on-disc experiment.");
+    }
+
+    Consumer consumer(*this, found_masstraces);
 
+    this->startProgress(0, input_exp.getNrSpectra(), "mass trace detection (streaming)");
+    for (Size i = 0; i < input_exp.getNrSpectra(); ++i)
+    {
+      this->setProgress(i);
+      // do not load the peaks of spectra the consumer would skip anyway
+      if ((*meta)[i].getMSLevel() != 1) continue;
+
+      MSSpectrum spectrum = input_exp.getSpectrum(i);
+      consumer.consumeSpectrum(spectrum);
+    }
+    consumer.finish();
+    this->endProgress();
+  }
+
+  void MassTraceDetection::run_(const std::vector<Apex>& chrom_apices,
+                                const PeakMap& work_exp,
+                                const std::vector<Size>& spec_offsets,
+                                std::vector<bool>& peak_visited,
+                                Size& trace_number,
+                                std::vector<MassTrace>& found_masstraces,
+                                bool report_progress)
+  {
     // check presence of FWHM meta data
     int fwhm_meta_idx(-1);
     Size fwhm_meta_count(0);
@@ -284,15 +320,13 @@ namespace OpenMS
       throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
                                     String("FWHM meta arrays are expected to be missing or present for all MS spectra [") + fwhm_meta_count + "/" + work_exp.size() + "].");
     }
-     
 
-    this->startProgress(0, total_peak_count, "mass trace detection");
     Size peaks_detected(0);
 
-    for (MapIdxSortedByInt::const_reverse_iterator m_it = chrom_apices.rbegin(); m_it != chrom_apices.rend(); ++m_it)
+    for (std::vector<Apex>::const_iterator m_it = chrom_apices.begin(); m_it != chrom_apices.end(); ++m_it)
     {
-      Size apex_scan_idx(m_it->second.first);
-      Size apex_peak_idx(m_it->second.second);
+      Size apex_scan_idx(m_it->scan_idx);
+      Size apex_peak_idx(m_it->peak_idx);
 
       if (peak_visited[spec_offsets[apex_scan_idx] + apex_peak_idx])
       {
@@ -539,12 +573,9 @@ namespace OpenMS
         found_masstraces.push_back(new_trace);
 
         peaks_detected += new_trace.getSize();
-        this->setProgress(peaks_detected);
+        if (report_progress) this->setProgress(peaks_detected);
       }
     }
-
-    this->endProgress();
-
   }
   
   void MassTraceDetection::updateMembers_()
@@ -560,6 +591,88 @@ namespace OpenMS
     min_trace_length_ = (double)param_.getValue("min_trace_length");
     max_trace_length_ = (double)param_.getValue("max_trace_length");
     reestimate_mt_sd_ = param_.getValue("reestimate_mt_sd").toBool();
+    streaming_block_size_ = (Size)param_.getValue("streaming_block_size");
+    streaming_block_overlap_ = (Size)param_.getValue("streaming_block_overlap");
+  }
+
+  MassTraceDetection::Consumer::Consumer(MassTraceDetection& mtd, std::vector<MassTrace>& found_masstraces) :
+    mtd_(mtd),
+    found_masstraces_(found_masstraces),
+    window_begin_(0),
+    core_begin_(0),
+    spectra_count_(0),
+    trace_number_(1)
+  {
+    found_masstraces_.clear();
+  }
+
+  MassTraceDetection::Consumer::~Consumer()
+  {
+  }
+
+  void MassTraceDetection::Consumer::consumeSpectrum(SpectrumType& s)
+  {
+    if (s.getMSLevel() != 1) return;
+
+    if (!s.isSorted()) s.sortByPosition();
+
+    MSSpectrum filtered;
+    mtd_.filterSpectrum_(s, spectra_count_, filtered, pending_apices_);
+    spec_offsets_.push_back(peak_visited_.size());
+    peak_visited_.resize(peak_visited_.size() + filtered.size(), false);
+    window_.addSpectrum(std::move(filtered));
+    ++spectra_count_;
+
+    // the next block is complete once its overlap region has arrived as well
+    if (spectra_count_ >= core_begin_ + mtd_.streaming_block_size_ + mtd_.streaming_block_overlap_)
+    {
+      processBlock_(core_begin_ + mtd_.streaming_block_size_);
+    }
+  }
+
+  void MassTraceDetection::Consumer::finish()
+  {
+    if (spectra_count_ < 3)
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                    "Input map consists of too few MS1 spectra (less than 3!). Aborting...", String(spectra_count_));
+    }
+    processBlock_(spectra_count_);
+  }
+
+  void MassTraceDetection::Consumer::processBlock_(Size core_end)
+  {
+    // apices arrive in scan order, so the ones of the current block form a prefix
+    std::vector<Apex>::iterator block_end = pending_apices_.begin();
+    while (block_end != pending_apices_.end() && block_end->scan_idx < core_end) ++block_end;
+
+    std::vector<Apex> block_apices;
+    block_apices.reserve(block_end - pending_apices_.begin());
+    for (std::vector<Apex>::const_iterator it = pending_apices_.begin(); it != block_end; ++it)
+    {
+      block_apices.push_back(Apex(it->intensity, it->scan_idx - window_begin_, it->peak_idx));
+    }
+    pending_apices_.erase(pending_apices_.begin(), block_end);
+    std::sort(block_apices.begin(), block_apices.end(), Apex::precedes);
+
+    mtd_.run_(block_apices, window_, spec_offsets_, peak_visited_, trace_number_, found_masstraces_, false);
+    core_begin_ = core_end;
+
+    // keep only the spectra later traces may still extend into
+    Size keep_from = core_end > mtd_.streaming_block_overlap_ ? core_end - mtd_.streaming_block_overlap_ : 0;
+    if (keep_from <= window_begin_) return;
+
+    Size drop = std::min(keep_from - window_begin_, window_.size());
+    Size dropped_peaks = drop < spec_offsets_.size() ? spec_offsets_[drop] : peak_visited_.size();
+
+    window_.getSpectra().erase(window_.getSpectra().begin(), window_.getSpectra().begin() + drop);
+    peak_visited_.erase(peak_visited_.begin(), peak_visited_.begin() + dropped_peaks);
+    spec_offsets_.erase(spec_offsets_.begin(), spec_offsets_.begin() + drop);
+    for (Size i = 0; i < spec_offsets_.size(); ++i)
+    {
+      spec_offsets_[i] -= dropped_peaks;
+    }
+    window_begin_ += drop;
   }
 
 }
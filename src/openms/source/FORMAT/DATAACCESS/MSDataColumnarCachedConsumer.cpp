@@ -0,0 +1,85 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/DATAACCESS/MSDataColumnarCachedConsumer.h>
+
+#include <OpenMS/KERNEL/MSSpectrum.h>
+#include <OpenMS/KERNEL/MSChromatogram.h>
+
+namespace OpenMS
+{
+  MSDataColumnarCachedConsumer::MSDataColumnarCachedConsumer(const String& filename, bool clearData,
+                                                             bool mz_32bit, bool intensity_32bit) :
+    writer_(filename, mz_32bit, intensity_32bit),
+    clearData_(clearData)
+  {
+  }
+
+  MSDataColumnarCachedConsumer::~MSDataColumnarCachedConsumer()
+  {
+    // the writer closes the file (if not done yet)
+  }
+
+  void MSDataColumnarCachedConsumer::close()
+  {
+    writer_.close();
+  }
+
+  void MSDataColumnarCachedConsumer::consumeSpectrum(SpectrumType & s)
+  {
+    writer_.addSpectrum(s);
+
+    // Clear all spectral data including all float/int data arrays (but not string arrays)
+    if (clearData_)
+    {
+      s.clear(false);
+      s.setFloatDataArrays({});
+      s.setIntegerDataArrays({});
+    }
+  }
+
+  void MSDataColumnarCachedConsumer::consumeChromatogram(ChromatogramType & c)
+  {
+    writer_.addChromatogram(c);
+
+    // Clear all chromatogram data including all float/int data arrays (but not string arrays)
+    if (clearData_)
+    {
+      c.clear(false);
+      c.setFloatDataArrays({});
+      c.setIntegerDataArrays({});
+    }
+  }
+
+} // namespace OpenMS
@@ -111,6 +111,18 @@ namespace OpenMS
       ofs_ << "\t\t<spectrumList count=\"" << spectra_expected_ << "\" defaultDataProcessingRef=\"dp_sp_0\">\n";
       writing_spectra_ = true;
     }
+    if (options_.getParallelWriting())
+    {
+      // collect spectra and encode them in parallel once a full batch is available
+      pending_spectra_.push_back(std::move(scpy));
+      ++spectra_written_;
+      if (pending_spectra_.size() >= options_.getMaxDataPoolSize())
+      {
+        writePendingSpectra_();
+      }
+      return;
+    }
+
     bool renew_native_ids = false;
     // TODO writeSpectrum assumes that dps_ has at least one value -> assert
     // this here ...
@@ -118,11 +130,41 @@ namespace OpenMS
             spectra_written_++, *validator_, renew_native_ids, dps_);
   }
 
+  void MSDataWritingConsumer::writePendingSpectra_()
+  {
+    if (pending_spectra_.empty()) return;
+
+    std::vector<const SpectrumType*> batch;
+    for (Size i = 0; i < pending_spectra_.size(); ++i)
+    {
+      batch.push_back(&pending_spectra_[i]);
+    }
+    bool renew_native_ids = false;
+    Internal::MzMLHandler::writeSpectra_(ofs_, batch, spectra_written_ - pending_spectra_.size(),
+            *validator_, renew_native_ids, dps_);
+    pending_spectra_.clear();
+  }
+
+  void MSDataWritingConsumer::writePendingChromatograms_()
+  {
+    if (pending_chromatograms_.empty()) return;
+
+    std::vector<const ChromatogramType*> batch;
+    for (Size i = 0; i < pending_chromatograms_.size(); ++i)
+    {
+      batch.push_back(&pending_chromatograms_[i]);
+    }
+    Internal::MzMLHandler::writeChromatograms_(ofs_, batch, chromatograms_written_ - pending_chromatograms_.size(),
+            *validator_);
+    pending_chromatograms_.clear();
+  }
+
    void MSDataWritingConsumer::consumeChromatogram(ChromatogramType & c)
   {
     // make sure to close an open List tag
     if (writing_spectra_)
     {
+      writePendingSpectra_();
       ofs_ << "\t\t</spectrumList>\n";
       writing_spectra_ = false;
     }
@@ -156,6 +198,18 @@ namespace OpenMS
       ofs_ << "\t\t<chromatogramList count=\"" << chromatograms_expected_ << "\" defaultDataProcessingRef=\"dp_sp_0\">\n";
       writing_chromatograms_ = true;
     }
+    if (options_.getParallelWriting())
+    {
+      // collect chromatograms and encode them in parallel once a full batch is available
+      pending_chromatograms_.push_back(std::move(ccpy));
+      ++chromatograms_written_;
+      if (pending_chromatograms_.size() >= options_.getMaxDataPoolSize())
+      {
+        writePendingChromatograms_();
+      }
+      return;
+    }
+
     Internal::MzMLHandler::writeChromatogram_(ofs_, ccpy,
             chromatograms_written_++, *validator_);
   }
@@ -178,10 +232,12 @@ namespace OpenMS
     // make sure to close an open List tag
     if (writing_spectra_)
     {
+      writePendingSpectra_();
       ofs_ << "\t\t</spectrumList>\n";
     }
     else if (writing_chromatograms_)
     {
+      writePendingChromatograms_();
       ofs_ << "\t\t</chromatogramList>\n";
     }
 
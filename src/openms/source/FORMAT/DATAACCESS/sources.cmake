@@ -8,6 +8,7 @@ set(sources_list
   MSDataTransformingConsumer.cpp
   MSDataAggregatingConsumer.cpp
   MSDataCachedConsumer.cpp
+  MSDataColumnarCachedConsumer.cpp
   MSDataChainingConsumer.cpp
   MSDataStoringConsumer.cpp
   MSDataSqlConsumer.cpp
@@ -0,0 +1,553 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/HANDLERS/ColumnarCachedMzMLHandler.h>
+
+#include <OpenMS/CONCEPT/LogStream.h>
+#include <OpenMS/CONCEPT/Macros.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+
+#include <QtCore/QFile>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace OpenMS
+{
+namespace Internal
+{
+
+  namespace
+  {
+    const char COLUMNAR_CACHE_MAGIC[8] = {'O', 'M', 'S', 'C', 'C', 'O', 'L', '\0'};
+    const UInt32 COLUMNAR_CACHE_VERSION = 1;
+    const UInt32 COLUMNAR_CACHE_BYTE_ORDER = 0x01020304;
+    const UInt64 COLUMN_ALIGNMENT = 64;
+
+    const UInt32 FLAG_SINGLE_PRECISION_MZ = 1;
+    const UInt32 FLAG_SINGLE_PRECISION_INTENSITY = 2;
+
+    struct FileHeader
+    {
+      char magic[8];
+      UInt32 version;
+      UInt32 flags;
+      UInt64 nr_spectra;
+      UInt64 nr_chromatograms;
+      UInt64 table_offset;
+      UInt64 id_offset;
+      UInt64 file_size;
+      UInt32 byte_order;
+      UInt32 reserved;
+    };
+
+    struct TableEntry
+    {
+      UInt64 x_offset;
+      UInt64 y_offset;
+      UInt64 size;
+      double rt;
+      Int32 ms_level;
+      UInt32 id_length;
+      UInt64 id_offset;
+    };
+
+    static_assert(sizeof(FileHeader) == 64, "Unexpected padding in columnar cache header");
+    static_assert(sizeof(TableEntry) == 48, "Unexpected padding in columnar cache table entry");
+
+    inline UInt64 alignOffset(UInt64 offset)
+    {
+      return (offset + COLUMN_ALIGNMENT - 1) / COLUMN_ALIGNMENT * COLUMN_ALIGNMENT;
+    }
+
+    inline TableEntry readEntry(const char* ptr)
+    {
+      TableEntry entry;
+      std::memcpy(&entry, ptr, sizeof(TableEntry));
+      return entry;
+    }
+
+    void writePadding(std::ofstream& ofs, UInt64& pos, UInt64 target)
+    {
+      static const char zeros[COLUMN_ALIGNMENT] = {};
+      while (pos < target)
+      {
+        UInt64 n = std::min(target - pos, COLUMN_ALIGNMENT);
+        ofs.write(zeros, n);
+        pos += n;
+      }
+    }
+
+    template <typename ValueType>
+    void writeValues(std::ofstream& ofs, UInt64& pos, const std::vector<ValueType>& values)
+    {
+      if (values.empty()) return;
+      ofs.write(reinterpret_cast<const char*>(&values[0]), values.size() * sizeof(ValueType));
+      pos += values.size() * sizeof(ValueType);
+    }
+
+    void writeColumn(std::ofstream& ofs, UInt64& pos, UInt64 offset, const std::vector<double>& values, bool single_precision)
+    {
+      writePadding(ofs, pos, offset);
+      if (single_precision)
+      {
+        std::vector<float> tmp(values.begin(), values.end());
+        writeValues(ofs, pos, tmp);
+      }
+      else
+      {
+        writeValues(ofs, pos, values);
+      }
+    }
+
+    template <typename ContainerType>
+    void writeItem(std::ofstream& ofs, UInt64& pos, const TableEntry& entry, const ContainerType& container,
+                   bool x_32bit, bool y_32bit)
+    {
+      std::vector<double> x, y;
+      x.reserve(container.size());
+      y.reserve(container.size());
+      for (typename ContainerType::const_iterator it = container.begin(); it != container.end(); ++it)
+      {
+        x.push_back(it->getPos());
+        y.push_back(it->getIntensity());
+      }
+      writeColumn(ofs, pos, entry.x_offset, x, x_32bit);
+      writeColumn(ofs, pos, entry.y_offset, y, y_32bit);
+    }
+  }
+
+  ColumnarCachedMzMLHandler::ColumnarCachedMzMLHandler() :
+    data_(nullptr),
+    data_size_(0),
+    table_offset_(0),
+    nr_spectra_(0),
+    nr_chromatograms_(0),
+    flags_(0)
+  {
+  }
+
+  ColumnarCachedMzMLHandler::ColumnarCachedMzMLHandler(const String& filename) :
+    data_(nullptr),
+    data_size_(0),
+    table_offset_(0),
+    nr_spectra_(0),
+    nr_chromatograms_(0),
+    flags_(0)
+  {
+    open(filename);
+  }
+
+  ColumnarCachedMzMLHandler::ColumnarCachedMzMLHandler(const ColumnarCachedMzMLHandler& rhs) :
+    filename_(rhs.filename_),
+    mapped_file_(rhs.mapped_file_),
+    buffer_(rhs.buffer_),
+    data_(rhs.data_),
+    data_size_(rhs.data_size_),
+    table_offset_(rhs.table_offset_),
+    nr_spectra_(rhs.nr_spectra_),
+    nr_chromatograms_(rhs.nr_chromatograms_),
+    flags_(rhs.flags_)
+  {
+  }
+
+  ColumnarCachedMzMLHandler& ColumnarCachedMzMLHandler::operator=(const ColumnarCachedMzMLHandler& rhs)
+  {
+    if (&rhs == this) return *this;
+
+    filename_ = rhs.filename_;
+    mapped_file_ = rhs.mapped_file_;
+    buffer_ = rhs.buffer_;
+    data_ = rhs.data_;
+    data_size_ = rhs.data_size_;
+    table_offset_ = rhs.table_offset_;
+    nr_spectra_ = rhs.nr_spectra_;
+    nr_chromatograms_ = rhs.nr_chromatograms_;
+    flags_ = rhs.flags_;
+    return *this;
+  }
+
+  ColumnarCachedMzMLHandler::~ColumnarCachedMzMLHandler()
+  {
+  }
+
+  struct ColumnarCachedMzMLHandler::Writer::Impl
+  {
+    String filename;
+    std::ofstream ofs;
+    UInt64 pos;
+    bool mz_32bit;
+    bool intensity_32bit;
+    bool closed;
+
+    /// offset table and native ids (spectra and chromatograms are stored separately, they may come in any order)
+    std::vector<TableEntry> spectrum_table;
+    std::vector<TableEntry> chromatogram_table;
+    std::vector<std::string> spectrum_ids;
+    std::vector<std::string> chromatogram_ids;
+
+    template <typename ContainerType>
+    TableEntry writeData(const ContainerType& container, double rt, int ms_level)
+    {
+      const UInt64 x_bytes = mz_32bit ? sizeof(float) : sizeof(double);
+
+      TableEntry entry;
+      std::memset(&entry, 0, sizeof(TableEntry));
+      entry.size = container.size();
+      entry.rt = rt;
+      entry.ms_level = ms_level;
+      entry.x_offset = alignOffset(pos);
+      entry.y_offset = alignOffset(entry.x_offset + entry.size * x_bytes);
+      writeItem(ofs, pos, entry, container, mz_32bit, intensity_32bit);
+      return entry;
+    }
+  };
+
+  ColumnarCachedMzMLHandler::Writer::Writer(const String& filename, bool mz_32bit, bool intensity_32bit) :
+    impl_(new Impl)
+  {
+    impl_->filename = filename;
+    impl_->pos = 0;
+    impl_->mz_32bit = mz_32bit;
+    impl_->intensity_32bit = intensity_32bit;
+    impl_->closed = false;
+    impl_->ofs.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!impl_->ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+
+    // placeholder for the header, which is written once the table offset is known
+    writePadding(impl_->ofs, impl_->pos, sizeof(FileHeader));
+  }
+
+  ColumnarCachedMzMLHandler::Writer::~Writer()
+  {
+    if (!impl_->closed)
+    {
+      try
+      {
+        close();
+      }
+      catch (Exception::BaseException& e)
+      {
+        LOG_ERROR << "Error while closing columnar cache: " << e.what() << std::endl;
+      }
+    }
+  }
+
+  void ColumnarCachedMzMLHandler::Writer::addSpectrum(const MSSpectrum& spectrum)
+  {
+    OPENMS_PRECONDITION(!impl_->closed, "Cannot add data after closing the file")
+    impl_->spectrum_table.push_back(impl_->writeData(spectrum, spectrum.getRT(), spectrum.getMSLevel()));
+    impl_->spectrum_ids.push_back(spectrum.getNativeID());
+  }
+
+  void ColumnarCachedMzMLHandler::Writer::addChromatogram(const MSChromatogram& chromatogram)
+  {
+    OPENMS_PRECONDITION(!impl_->closed, "Cannot add data after closing the file")
+    impl_->chromatogram_table.push_back(impl_->writeData(chromatogram, -1.0, 0));
+    impl_->chromatogram_ids.push_back(chromatogram.getNativeID());
+  }
+
+  void ColumnarCachedMzMLHandler::Writer::close()
+  {
+    if (impl_->closed) return;
+    impl_->closed = true;
+
+    std::ofstream& ofs = impl_->ofs;
+    UInt64& pos = impl_->pos;
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(FileHeader));
+    std::memcpy(header.magic, COLUMNAR_CACHE_MAGIC, sizeof(header.magic));
+    header.version = COLUMNAR_CACHE_VERSION;
+    header.flags = (impl_->mz_32bit ? FLAG_SINGLE_PRECISION_MZ : 0) | (impl_->intensity_32bit ? FLAG_SINGLE_PRECISION_INTENSITY : 0);
+    header.nr_spectra = impl_->spectrum_table.size();
+    header.nr_chromatograms = impl_->chromatogram_table.size();
+    header.byte_order = COLUMNAR_CACHE_BYTE_ORDER;
+
+    // native ids
+    header.id_offset = pos;
+    for (Size i = 0; i < impl_->spectrum_ids.size(); ++i)
+    {
+      impl_->spectrum_table[i].id_offset = pos;
+      impl_->spectrum_table[i].id_length = static_cast<UInt32>(impl_->spectrum_ids[i].size());
+      ofs.write(impl_->spectrum_ids[i].c_str(), impl_->spectrum_ids[i].size());
+      pos += impl_->spectrum_ids[i].size();
+    }
+    for (Size i = 0; i < impl_->chromatogram_ids.size(); ++i)
+    {
+      impl_->chromatogram_table[i].id_offset = pos;
+      impl_->chromatogram_table[i].id_length = static_cast<UInt32>(impl_->chromatogram_ids[i].size());
+      ofs.write(impl_->chromatogram_ids[i].c_str(), impl_->chromatogram_ids[i].size());
+      pos += impl_->chromatogram_ids[i].size();
+    }
+
+    // offset table: spectra first, then chromatograms
+    header.table_offset = pos;
+    writeValues(ofs, pos, impl_->spectrum_table);
+    writeValues(ofs, pos, impl_->chromatogram_table);
+    header.file_size = alignOffset(pos);
+    writePadding(ofs, pos, header.file_size);
+
+    ofs.seekp(0);
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+    ofs.close();
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, impl_->filename, "Error while writing columnar cache.");
+    }
+  }
+
+  void ColumnarCachedMzMLHandler::write(const PeakMap& exp, const String& filename, bool mz_32bit, bool intensity_32bit)
+  {
+    Writer writer(filename, mz_32bit, intensity_32bit);
+    for (Size i = 0; i < exp.size(); ++i)
+    {
+      writer.addSpectrum(exp[i]);
+    }
+    for (Size i = 0; i < exp.getChromatograms().size(); ++i)
+    {
+      writer.addChromatogram(exp.getChromatograms()[i]);
+    }
+    writer.close();
+  }
+
+  void ColumnarCachedMzMLHandler::open(const String& filename)
+  {
+    mapped_file_.reset();
+    buffer_.reset();
+    data_ = nullptr;
+    data_size_ = 0;
+    table_offset_ = 0;
+    nr_spectra_ = 0;
+    nr_chromatograms_ = 0;
+    flags_ = 0;
+    filename_ = filename;
+
+    boost::shared_ptr<QFile> file(new QFile(filename.toQString()));
+    if (!file->open(QIODevice::ReadOnly))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    const qint64 size = file->size();
+    if (size < static_cast<qint64>(sizeof(FileHeader)))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "File is too small to be a columnar cache.", filename);
+    }
+
+    uchar* mapped = file->map(0, size);
+    if (mapped != nullptr)
+    {
+      data_ = reinterpret_cast<const char*>(mapped);
+      // the mapping stays valid after closing the file handle, QFile unmaps it upon destruction
+      mapped_file_ = file;
+    }
+    else
+    {
+      LOG_WARN << "Could not memory-map '" << filename << "' (" << String(file->errorString()) << "), reading it into memory instead." << std::endl;
+      buffer_.reset(new std::vector<char>(size));
+      if (file->read(&(*buffer_)[0], size) != size)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Could not read columnar cache.", filename);
+      }
+      data_ = &(*buffer_)[0];
+    }
+    file->close();
+    data_size_ = size;
+
+    readHeader_();
+  }
+
+  void ColumnarCachedMzMLHandler::readHeader_()
+  {
+    FileHeader header;
+    std::memcpy(&header, data_, sizeof(FileHeader));
+
+    if (std::memcmp(header.magic, COLUMNAR_CACHE_MAGIC, sizeof(header.magic)) != 0)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "File is not a columnar cache.", filename_);
+    }
+    if (header.byte_order != COLUMNAR_CACHE_BYTE_ORDER)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Columnar cache was written on a machine with different byte order.", filename_);
+    }
+    if (header.version != COLUMNAR_CACHE_VERSION)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Unsupported columnar cache version " + String(header.version) + ".", filename_);
+    }
+    // compare each count separately so that neither the difference nor the sum can wrap around
+    const UInt64 max_entries = header.table_offset <= data_size_ ? (data_size_ - header.table_offset) / sizeof(TableEntry) : 0;
+    if (header.file_size != data_size_ || header.table_offset < sizeof(FileHeader) || header.table_offset > data_size_ ||
+        header.nr_spectra > max_entries || header.nr_chromatograms > max_entries - header.nr_spectra)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Columnar cache is truncated or corrupt.", filename_);
+    }
+
+    table_offset_ = header.table_offset;
+    nr_spectra_ = header.nr_spectra;
+    nr_chromatograms_ = header.nr_chromatograms;
+    flags_ = header.flags;
+
+    // validate all offsets once so that access does not need any bounds checks
+    const UInt64 x_bytes = hasSinglePrecisionMZ() ? sizeof(float) : sizeof(double);
+    const UInt64 y_bytes = hasSinglePrecisionIntensity() ? sizeof(float) : sizeof(double);
+    for (UInt64 i = 0; i < nr_spectra_ + nr_chromatograms_; ++i)
+    {
+      TableEntry entry = readEntry(data_ + table_offset_ + i * sizeof(TableEntry));
+      bool valid = entry.size <= data_size_ &&
+                   entry.id_offset <= data_size_ && entry.id_length <= data_size_ - entry.id_offset &&
+                   entry.x_offset % x_bytes == 0 && entry.x_offset <= data_size_ && entry.size * x_bytes <= data_size_ - entry.x_offset &&
+                   entry.y_offset % y_bytes == 0 && entry.y_offset <= data_size_ && entry.size * y_bytes <= data_size_ - entry.y_offset;
+      if (!valid)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Invalid offset table entry " + String(i) + " in columnar cache.", filename_);
+      }
+    }
+  }
+
+  const String& ColumnarCachedMzMLHandler::getFilename() const
+  {
+    return filename_;
+  }
+
+  Size ColumnarCachedMzMLHandler::getNrSpectra() const
+  {
+    return nr_spectra_;
+  }
+
+  Size ColumnarCachedMzMLHandler::getNrChromatograms() const
+  {
+    return nr_chromatograms_;
+  }
+
+  bool ColumnarCachedMzMLHandler::hasSinglePrecisionMZ() const
+  {
+    return (flags_ & FLAG_SINGLE_PRECISION_MZ) != 0;
+  }
+
+  bool ColumnarCachedMzMLHandler::hasSinglePrecisionIntensity() const
+  {
+    return (flags_ & FLAG_SINGLE_PRECISION_INTENSITY) != 0;
+  }
+
+  const char* ColumnarCachedMzMLHandler::entry_(Size id, bool chromatogram) const
+  {
+    OPENMS_PRECONDITION(chromatogram ? id < nr_chromatograms_ : id < nr_spectra_, "Id cannot be larger than number of items in the file");
+    return data_ + table_offset_ + (chromatogram ? nr_spectra_ + id : id) * sizeof(TableEntry);
+  }
+
+  Size ColumnarCachedMzMLHandler::getSpectrumSize(Size id) const
+  {
+    return readEntry(entry_(id, false)).size;
+  }
+
+  double ColumnarCachedMzMLHandler::getSpectrumRT(Size id) const
+  {
+    return readEntry(entry_(id, false)).rt;
+  }
+
+  int ColumnarCachedMzMLHandler::getSpectrumMSLevel(Size id) const
+  {
+    return readEntry(entry_(id, false)).ms_level;
+  }
+
+  std::string ColumnarCachedMzMLHandler::getSpectrumNativeID(Size id) const
+  {
+    TableEntry entry = readEntry(entry_(id, false));
+    return std::string(data_ + entry.id_offset, entry.id_length);
+  }
+
+  Size ColumnarCachedMzMLHandler::getChromatogramSize(Size id) const
+  {
+    return readEntry(entry_(id, true)).size;
+  }
+
+  std::string ColumnarCachedMzMLHandler::getChromatogramNativeID(Size id) const
+  {
+    TableEntry entry = readEntry(entry_(id, true));
+    return std::string(data_ + entry.id_offset, entry.id_length);
+  }
+
+  const char* ColumnarCachedMzMLHandler::column_(Size id, bool chromatogram, bool intensity, Size value_size) const
+  {
+    const bool single_precision = intensity ? hasSinglePrecisionIntensity() : hasSinglePrecisionMZ();
+    if (value_size != (single_precision ? sizeof(float) : sizeof(double)))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        String("Requested data type does not match the ") + (single_precision ? "single" : "double") +
+        " precision values stored in '" + filename_ + "'.");
+    }
+    TableEntry entry = readEntry(entry_(id, chromatogram));
+    return data_ + (intensity ? entry.y_offset : entry.x_offset);
+  }
+
+  void ColumnarCachedMzMLHandler::copyColumn_(Size id, bool chromatogram, bool intensity, std::vector<double>& out) const
+  {
+    const Size size = chromatogram ? getChromatogramSize(id) : getSpectrumSize(id);
+    if (intensity ? hasSinglePrecisionIntensity() : hasSinglePrecisionMZ())
+    {
+      const float* ptr = reinterpret_cast<const float*>(column_(id, chromatogram, intensity, sizeof(float)));
+      out.assign(ptr, ptr + size);
+    }
+    else
+    {
+      const double* ptr = reinterpret_cast<const double*>(column_(id, chromatogram, intensity, sizeof(double)));
+      out.assign(ptr, ptr + size);
+    }
+  }
+
+  void ColumnarCachedMzMLHandler::getSpectrumData(Size id, std::vector<double>& mz, std::vector<double>& intensity) const
+  {
+    copyColumn_(id, false, false, mz);
+    copyColumn_(id, false, true, intensity);
+  }
+
+  void ColumnarCachedMzMLHandler::getChromatogramData(Size id, std::vector<double>& rt, std::vector<double>& intensity) const
+  {
+    copyColumn_(id, true, false, rt);
+    copyColumn_(id, true, true, intensity);
+  }
+
+}
+}
@@ -36,6 +36,9 @@
 
 #include <OpenMS/FORMAT/HANDLERS/IndexedMzMLDecoder.h>
 #include <OpenMS/FORMAT/HANDLERS/MzMLSpectrumDecoder.h>
+#include <OpenMS/CONCEPT/LogStream.h>
+
+#include <QFile>
 
 // #define DEBUG_READER
 
@@ -71,14 +74,20 @@ namespace Internal
 
   IndexedMzMLHandler::IndexedMzMLHandler(const String& filename) :
     parsing_success_(false),
-    skip_xml_checks_(false) 
+    skip_xml_checks_(false),
+    use_memory_mapping_(false),
+    mapped_data_(nullptr),
+    mapped_size_(0)
   {
     openFile(filename);
   }
 
   IndexedMzMLHandler::IndexedMzMLHandler() :
     parsing_success_(false),
-    skip_xml_checks_(false) 
+    skip_xml_checks_(false),
+    use_memory_mapping_(false),
+    mapped_data_(nullptr),
+    mapped_size_(0)
   {}
 
   IndexedMzMLHandler::IndexedMzMLHandler(const IndexedMzMLHandler& source) :
@@ -87,12 +96,20 @@ namespace Internal
     chromatograms_offsets_(source.chromatograms_offsets_),
     index_offset_(source.index_offset_),
     spectra_before_chroms_(source.spectra_before_chroms_),
-    // do not copy the filestream itself but open a new filestream using the same file
-    // this is critical for parallel access to the same file!
-    filestream_(source.filename_.c_str()),
     parsing_success_(source.parsing_success_),
-    skip_xml_checks_(source.skip_xml_checks_)
+    skip_xml_checks_(source.skip_xml_checks_),
+    use_memory_mapping_(source.use_memory_mapping_),
+    // the (read-only) mapping can safely be shared
+    mapped_file_(source.mapped_file_),
+    mapped_data_(source.mapped_data_),
+    mapped_size_(source.mapped_size_)
   {
+    // do not copy the filestream itself but open a new filestream using the same file
+    // this is critical for parallel access to the same file!
+    if (mapped_data_ == nullptr)
+    {
+      filestream_.open(source.filename_.c_str());
+    }
   }
 
   IndexedMzMLHandler::~IndexedMzMLHandler()
@@ -105,11 +122,64 @@ namespace Internal
     {
       filestream_.close();
     }
+    mapped_file_.reset();
+    mapped_data_ = nullptr;
+    mapped_size_ = 0;
+
     filename_ = filename;
-    filestream_.open(filename.c_str());
+    if (!use_memory_mapping_ || !mapFile_())
+    {
+      filestream_.open(filename.c_str());
+    }
     parseFooter_(filename);
   }
 
+  bool IndexedMzMLHandler::mapFile_()
+  {
+    boost::shared_ptr<QFile> file(new QFile(filename_.toQString()));
+    if (!file->open(QIODevice::ReadOnly) || file->size() == 0)
+    {
+      return false;
+    }
+    uchar* data = file->map(0, file->size());
+    if (data == nullptr)
+    {
+      LOG_WARN << "Could not memory-map '" << filename_ << "' (" << String(file->errorString()) << "), using file stream access instead." << std::endl;
+      return false;
+    }
+    mapped_size_ = file->size();
+    mapped_data_ = reinterpret_cast<const char*>(data);
+    // the mapping stays valid after closing the file handle, QFile unmaps it upon destruction
+    file->close();
+    mapped_file_ = file;
+    return true;
+  }
+
+  std::string IndexedMzMLHandler::readText_(std::streampos startidx, std::streampos endidx)
+  {
+    if (mapped_data_ != nullptr)
+    {
+      std::streamoff start = startidx;
+      std::streamoff end = std::min(std::streamoff(endidx), mapped_size_);
+      if (start < 0 || start > end)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+            "Offset outside of the mapped file", filename_);
+      }
+      // the only copy: straight from the page cache
+      return std::string(mapped_data_ + start, mapped_data_ + end);
+    }
+
+    std::streampos readl = endidx - startidx;
+    char* buffer = new char[readl + std::streampos(1)];
+    filestream_.seekg(startidx, filestream_.beg);
+    filestream_.read(buffer, readl);
+    buffer[readl] = '\0';
+    std::string text(buffer);
+    delete[] buffer;
+    return text;
+  }
+
   bool IndexedMzMLHandler::getParsingSuccess() const
   {
     return parsing_success_;
@@ -169,13 +239,7 @@ namespace Internal
       endidx = chromatograms_offsets_[chromToGet + 1].second;
     }
 
-    std::streampos readl = endidx - startidx;
-    char* buffer = new char[readl + std::streampos(1)];
-    filestream_.seekg(startidx, filestream_.beg);
-    filestream_.read(buffer, readl);
-    buffer[readl] = '\0';
-    std::string text(buffer);
-    delete[] buffer;
+    std::string text = readText_(startidx, endidx);
 
 #ifdef DEBUG_READER
     // print the full text we just read
@@ -229,13 +293,7 @@ namespace Internal
       endidx = spectra_offsets_[spectrumToGet + 1].second;
     }
 
-    std::streampos readl = endidx - startidx;
-    char* buffer = new char[readl + std::streampos(1)];
-    filestream_.seekg(startidx, filestream_.beg);
-    filestream_.read(buffer, readl);
-    buffer[readl] = '\0';
-    std::string text(buffer);
-    delete[] buffer;
+    std::string text = readText_(startidx, endidx);
 
 #ifdef DEBUG_READER
     // print the full text we just read
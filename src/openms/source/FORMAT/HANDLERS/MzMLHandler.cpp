@@ -44,6 +44,9 @@
 #include <OpenMS/INTERFACES/IMSDataConsumer.h>
 #include <OpenMS/SYSTEM/File.h>
 
+#include <exception>
+#include <sstream>
+
 namespace OpenMS
 {
   namespace Internal
@@ -140,116 +143,209 @@ namespace OpenMS
 
     void MzMLHandler::populateSpectraWithData_()
     {
+      if (options_.getPipelinedProcessing())
+      {
+        // hand over the pool decoded in the meantime, then decode the current
+        // one in the background while the parser continues
+        flushPendingSpectra_();
+        if (spectrum_data_.empty()) return;
+
+        pending_spectrum_data_.swap(spectrum_data_);
+        pending_spectra_ = std::async(std::launch::async, [this]() { decodeSpectra_(pending_spectrum_data_); });
+        return;
+      }
+
+      decodeSpectra_(spectrum_data_);
+      reportDiagnostics_(spectrum_data_);
+      appendSpectra_(spectrum_data_);
+    }
 
+    void MzMLHandler::flushPendingSpectra_()
+    {
+      if (!pending_spectra_.valid()) return;
+
+      pending_spectra_.get();
+      reportDiagnostics_(pending_spectrum_data_);
+      appendSpectra_(pending_spectrum_data_);
+    }
+
+    void MzMLHandler::decodeSpectra_(std::vector<SpectrumData>& spectrum_data)
+    {
       // Whether spectrum should be populated with data
       if (options_.getFillData())
       {
+        // errors are stored with the spectrum and reported by reportDiagnostics_(),
+        // since this may run in a background thread
         size_t errCount = 0;
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
-        for (SignedSize i = 0; i < (SignedSize)spectrum_data_.size(); i++)
+        for (SignedSize i = 0; i < (SignedSize)spectrum_data.size(); i++)
         {
-          // parallel exception catching and re-throwing business
           if (!errCount) // no need to parse further if already an error was encountered
           {
             try
             {
-              populateSpectraWithData_(spectrum_data_[i].data,
-                                       spectrum_data_[i].default_array_length,
+              populateSpectraWithData_(spectrum_data[i].data,
+                                       spectrum_data[i].default_array_length,
                                        options_,
-                                       spectrum_data_[i].spectrum);
-              if (options_.getSortSpectraByMZ() && !spectrum_data_[i].spectrum.isSorted())
+                                       spectrum_data[i].spectrum,
+                                       spectrum_data[i].diagnostics);
+              if (options_.getSortSpectraByMZ() && !spectrum_data[i].spectrum.isSorted())
               {
-                spectrum_data_[i].spectrum.sortByPosition();
+                spectrum_data[i].spectrum.sortByPosition();
               }
             }
             catch (...)
             {
+              spectrum_data[i].diagnostics.error = "Error during parsing of binary data.";
+            }
+            if (!spectrum_data[i].diagnostics.error.empty())
+            {
 #pragma omp critical(HandleException)
               ++errCount;
             }
           }
         }
-        if (errCount != 0)
-        {
-          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, file_, "Error during parsing of binary data.");
-        }
       }
+    }
 
+    void MzMLHandler::appendSpectra_(std::vector<SpectrumData>& spectrum_data)
+    {
       // Append all spectra to experiment / consumer
-      for (Size i = 0; i < spectrum_data_.size(); i++)
+      for (Size i = 0; i < spectrum_data.size(); i++)
       {
         if (consumer_ != nullptr)
         {
-          consumer_->consumeSpectrum(spectrum_data_[i].spectrum);
+          consumer_->consumeSpectrum(spectrum_data[i].spectrum);
           if (options_.getAlwaysAppendData())
           {
-            exp_->addSpectrum(std::move(spectrum_data_[i].spectrum));
+            exp_->addSpectrum(std::move(spectrum_data[i].spectrum));
           }
         }
         else
         {
-          exp_->addSpectrum(std::move(spectrum_data_[i].spectrum));
+          exp_->addSpectrum(std::move(spectrum_data[i].spectrum));
         }
+        recycleBinaryData_(spectrum_data[i].data);
       }
 
       // Delete batch
-      spectrum_data_.clear();
+      spectrum_data.clear();
     }
 
     void MzMLHandler::populateChromatogramsWithData_()
+    {
+      if (options_.getPipelinedProcessing())
+      {
+        flushPendingChromatograms_();
+        if (chromatogram_data_.empty()) return;
+
+        pending_chromatogram_data_.swap(chromatogram_data_);
+        pending_chromatograms_ = std::async(std::launch::async, [this]() { decodeChromatograms_(pending_chromatogram_data_); });
+        return;
+      }
+
+      decodeChromatograms_(chromatogram_data_);
+      reportDiagnostics_(chromatogram_data_);
+      appendChromatograms_(chromatogram_data_);
+    }
+
+    void MzMLHandler::flushPendingChromatograms_()
+    {
+      if (!pending_chromatograms_.valid()) return;
+
+      pending_chromatograms_.get();
+      reportDiagnostics_(pending_chromatogram_data_);
+      appendChromatograms_(pending_chromatogram_data_);
+    }
+
+    void MzMLHandler::decodeChromatograms_(std::vector<ChromatogramData>& chromatogram_data)
     {
       // Whether chromatogram should be populated with data
       if (options_.getFillData())
       {
-        size_t errCount = 0;
+        // errors are stored with the chromatogram and reported by reportDiagnostics_(),
+        // since this may run in a background thread
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
-        for (SignedSize i = 0; i < (SignedSize)chromatogram_data_.size(); i++)
+        for (SignedSize i = 0; i < (SignedSize)chromatogram_data.size(); i++)
         {
-          // parallel exception catching and re-throwing business
           try
           {
-            populateChromatogramsWithData_(chromatogram_data_[i].data,
-                                           chromatogram_data_[i].default_array_length,
+            populateChromatogramsWithData_(chromatogram_data[i].data,
+                                           chromatogram_data[i].default_array_length,
                                            options_,
-                                           chromatogram_data_[i].chromatogram);
-            if (options_.getSortChromatogramsByRT() && !chromatogram_data_[i].chromatogram.isSorted())
+                                           chromatogram_data[i].chromatogram,
+                                           chromatogram_data[i].diagnostics);
+            if (options_.getSortChromatogramsByRT() && !chromatogram_data[i].chromatogram.isSorted())
             {
-              chromatogram_data_[i].chromatogram.sortByPosition();
+              chromatogram_data[i].chromatogram.sortByPosition();
             }
           }
           catch (...)
-          {++errCount; }
-        }
-        if (errCount != 0)
-        {
-          throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, file_, "Error during parsing of binary data.");
+          {
+            chromatogram_data[i].diagnostics.error = "Error during parsing of binary data.";
+          }
         }
-
       }
+    }
 
+    void MzMLHandler::appendChromatograms_(std::vector<ChromatogramData>& chromatogram_data)
+    {
       // Append all chromatograms to experiment / consumer
-      for (Size i = 0; i < chromatogram_data_.size(); i++)
+      for (Size i = 0; i < chromatogram_data.size(); i++)
       {
         if (consumer_ != nullptr)
         {
-          consumer_->consumeChromatogram(chromatogram_data_[i].chromatogram);
+          consumer_->consumeChromatogram(chromatogram_data[i].chromatogram);
           if (options_.getAlwaysAppendData())
           {
-            exp_->addChromatogram(std::move(chromatogram_data_[i].chromatogram));
+            exp_->addChromatogram(std::move(chromatogram_data[i].chromatogram));
           }
         }
         else
         {
-          exp_->addChromatogram(std::move(chromatogram_data_[i].chromatogram));
+          exp_->addChromatogram(std::move(chromatogram_data[i].chromatogram));
         }
+        recycleBinaryData_(chromatogram_data[i].data);
       }
 
       // Delete batch
-      chromatogram_data_.clear();
+      chromatogram_data.clear();
+    }
+
+    MzMLHandler::BinaryData MzMLHandler::acquireBinaryData_()
+    {
+      if (bin_data_pool_.empty()) return BinaryData();
+
+      BinaryData data = std::move(bin_data_pool_.back());
+      bin_data_pool_.pop_back();
+      return data;
+    }
+
+    void MzMLHandler::recycleBinaryData_(std::vector<BinaryData>& data)
+    {
+      for (BinaryData& bd : data)
+      {
+        // reset everything but keep the capacity of the buffers
+        bd.precision = BinaryData::PRE_NONE;
+        bd.data_type = BinaryData::DT_NONE;
+        bd.np_compression = MSNumpressCoder::NONE;
+        bd.compression = false;
+        bd.unit_multiplier = 1.0;
+        bd.base64.clear();
+        bd.size = 0;
+        bd.floats_32.clear();
+        bd.floats_64.clear();
+        bd.ints_32.clear();
+        bd.ints_64.clear();
+        bd.decoded_char.clear();
+        bd.meta = MetaInfoDescription();
+        bin_data_pool_.push_back(std::move(bd));
+      }
+      data.clear();
     }
 
     void MzMLHandler::addSpectrumMetaData_(const std::vector<MzMLHandlerHelper::BinaryData>& input_data, 
@@ -299,7 +395,8 @@ namespace OpenMS
     void MzMLHandler::populateSpectraWithData_(std::vector<MzMLHandlerHelper::BinaryData>& input_data,
                                                Size& default_arr_length,
                                                const PeakFileOptions& peak_file_options,
-                                               SpectrumType& spectrum)
+                                               SpectrumType& spectrum,
+                                               DecodingDiagnostics& diagnostics) const
     {
       typedef SpectrumType::PeakType PeakType;
 
@@ -320,7 +417,7 @@ namespace OpenMS
         //if defaultArrayLength > 0 : warn that no m/z or int arrays is present
         if (default_arr_length != 0)
         {
-          warning(LOAD, String("The m/z or intensity array of spectrum '") + spectrum.getNativeID() + "' is missing and default_arr_length is " + default_arr_length + ".");
+          diagnostics.warnings.push_back(String("The m/z or intensity array of spectrum '") + spectrum.getNativeID() + "' is missing and default_arr_length is " + default_arr_length + ".");
         }
         return;
       }
@@ -328,11 +425,13 @@ namespace OpenMS
       // Error if intensity or m/z is encoded as int32|64 - they should be float32|64!
       if ((input_data[mz_index].ints_32.size() > 0) || (input_data[mz_index].ints_64.size() > 0))
       {
-        fatalError(LOAD, "Encoding m/z array as integer is not allowed!");
+        diagnostics.error = "Encoding m/z array as integer is not allowed!";
+        return;
       }
       if ((input_data[int_index].ints_32.size() > 0) || (input_data[int_index].ints_64.size() > 0))
       {
-        fatalError(LOAD, "Encoding intensity array as integer is not allowed!");
+        diagnostics.error = "Encoding intensity array as integer is not allowed!";
+        return;
       }
 
       // Warn if the decoded data has a different size than the defaultArrayLength
@@ -341,23 +440,24 @@ namespace OpenMS
       // Check if int-size and mz-size are equal
       if (mz_size != int_size)
       {
-        fatalError(LOAD, String("The length of m/z and integer values of spectrum '") + spectrum.getNativeID() + "' differ (mz-size: " + mz_size + ", int-size: " + int_size + "! Not reading spectrum!");
+        diagnostics.error = String("The length of m/z and integer values of spectrum '") + spectrum.getNativeID() + "' differ (mz-size: " + mz_size + ", int-size: " + int_size + "! Not reading spectrum!";
+        return;
       }
       bool repair_array_length = false;
       if (default_arr_length != mz_size)
       {
-        warning(LOAD, String("The m/z array of spectrum '") + spectrum.getNativeID() + "' has the size " + mz_size + ", but it should have size " + default_arr_length + " (defaultArrayLength).");
+        diagnostics.warnings.push_back(String("The m/z array of spectrum '") + spectrum.getNativeID() + "' has the size " + mz_size + ", but it should have size " + default_arr_length + " (defaultArrayLength).");
         repair_array_length = true;
       }
       if (default_arr_length != int_size)
       {
-        warning(LOAD, String("The intensity array of spectrum '") + spectrum.getNativeID() + "' has the size " + int_size + ", but it should have size " + default_arr_length + " (defaultArrayLength).");
+        diagnostics.warnings.push_back(String("The intensity array of spectrum '") + spectrum.getNativeID() + "' has the size " + int_size + ", but it should have size " + default_arr_length + " (defaultArrayLength).");
         repair_array_length = true;
       }
       if (repair_array_length)
       {
         default_arr_length = int_size;
-        warning(LOAD, String("Fixing faulty defaultArrayLength to ") + default_arr_length + ".");
+        diagnostics.warnings.push_back(String("Fixing faulty defaultArrayLength to ") + default_arr_length + ".");
       }
 
       //create meta data arrays and reserve enough space for the content
@@ -468,7 +568,8 @@ namespace OpenMS
     void MzMLHandler::populateChromatogramsWithData_(std::vector<MzMLHandlerHelper::BinaryData>& input_data,
                                                      Size& default_arr_length,
                                                      const PeakFileOptions& peak_file_options,
-                                                     ChromatogramType& inp_chromatogram)
+                                                     ChromatogramType& inp_chromatogram,
+                                                     DecodingDiagnostics& diagnostics) const
     {
       typedef ChromatogramType::PeakType ChromatogramPeakType;
 
@@ -489,7 +590,7 @@ namespace OpenMS
         //if defaultArrayLength > 0 : warn that no time or int arrays is present
         if (default_arr_length != 0)
         {
-          warning(LOAD, String("The time or intensity array of chromatogram '") +
+          diagnostics.warnings.push_back(String("The time or intensity array of chromatogram '") +
               inp_chromatogram.getNativeID() + "' is missing and default_arr_length is " + default_arr_length + ".");
         }
         return;
@@ -501,24 +602,25 @@ namespace OpenMS
       // Check if int-size and rt-size are equal
       if (rt_size != int_size)
       {
-        fatalError(LOAD, String("The length of RT and intensity values of chromatogram '") + inp_chromatogram.getNativeID() + "' differ (rt-size: " + rt_size + ", int-size: " + int_size + "! Not reading chromatogram!");
+        diagnostics.error = String("The length of RT and intensity values of chromatogram '") + inp_chromatogram.getNativeID() + "' differ (rt-size: " + rt_size + ", int-size: " + int_size + "! Not reading chromatogram!";
+        return;
       }
       bool repair_array_length = false;
       if (default_arr_length != rt_size)
       {
-        warning(LOAD, String("The base64-decoded rt array of chromatogram '") + inp_chromatogram.getNativeID() + "' has the size " + rt_size + ", but it should have size " + default_arr_length + " (defaultArrayLength).");
+        diagnostics.warnings.push_back(String("The base64-decoded rt array of chromatogram '") + inp_chromatogram.getNativeID() + "' has the size " + rt_size + ", but it should have size " + default_arr_length + " (defaultArrayLength).");
         repair_array_length = true;
       }
       if (default_arr_length != int_size)
       {
-        warning(LOAD, String("The base64-decoded intensity array of chromatogram '") + inp_chromatogram.getNativeID() + "' has the size " + int_size + ", but it should have size " + default_arr_length + " (defaultArrayLength).");
+        diagnostics.warnings.push_back(String("The base64-decoded intensity array of chromatogram '") + inp_chromatogram.getNativeID() + "' has the size " + int_size + ", but it should have size " + default_arr_length + " (defaultArrayLength).");
         repair_array_length = true;
       }
       // repair size of array, accessing memory that is beyond int_size will lead to segfaults later
       if (repair_array_length)
       {
         default_arr_length = int_size; // set to length of actual data (int_size and rt_size are equal, s.a.)
-        warning(LOAD, String("Fixing faulty defaultArrayLength to ") + default_arr_length + ".");
+        diagnostics.warnings.push_back(String("Fixing faulty defaultArrayLength to ") + default_arr_length + ".");
       }
 
       // Create meta data arrays and reserve enough space for the content
@@ -831,7 +933,7 @@ namespace OpenMS
       }
       else if (tag == "binaryDataArray" /* && in_spectrum_list_*/)
       {
-        bin_data_.push_back(BinaryData());
+        bin_data_.push_back(acquireBinaryData_());
         bin_data_.back().np_compression = MSNumpressCoder::NONE; // ensure that numpress compression is initially set to none ...
         bin_data_.back().compression = false; // ensure that zlib compression is initially set to none ...
 
@@ -1225,7 +1327,7 @@ namespace OpenMS
 
         rt_set_ = false;
         logger_.nextProgress();
-        bin_data_.clear();
+        recycleBinaryData_(bin_data_);
         default_array_length_ = 0;
       }
       else if (equal_(qname, s_chromatogram))
@@ -1262,17 +1364,28 @@ namespace OpenMS
         }
 
         logger_.nextProgress();
-        bin_data_.clear();
+        recycleBinaryData_(bin_data_);
         default_array_length_ = 0;
       }
       else if (equal_(qname, s_spectrum_list))
       {
+        if (options_.getPipelinedProcessing())
+        {
+          // all spectra are passed on before the first chromatogram
+          populateSpectraWithData_();
+          flushPendingSpectra_();
+        }
         skip_spectrum_ = false; // no more spectra to come, so stop skipping (for the LD_RAWCOUNTS case)
         in_spectrum_list_ = false;
         logger_.endProgress();
       }
       else if (equal_(qname, s_chromatogram_list))
       {
+        if (options_.getPipelinedProcessing())
+        {
+          populateChromatogramsWithData_();
+          flushPendingChromatograms_();
+        }
         skip_chromatogram_ = false; // no more chromatograms to come, so stop skipping
         in_spectrum_list_ = false;
         logger_.endProgress();
@@ -1289,7 +1402,9 @@ namespace OpenMS
 
         // Flush the remaining data
         populateSpectraWithData_();
+        flushPendingSpectra_();
         populateChromatogramsWithData_();
+        flushPendingChromatograms_();
       }
     }
 
@@ -3758,7 +3873,10 @@ namespace OpenMS
             }
             else
             {
-              // assume milliseconds, but warn
+              // assume milliseconds, but warn (may be called from parallel writing)
+#ifdef _OPENMP
+#pragma omp critical (LOG_DEBUG_access)
+#endif
               warning(STORE, String("Precursor drift time unit not set, assume milliseconds"));
               os << "\t\t\t\t\t\t\t\t<cvParam cvRef=\"MS\" accession=\"MS:1002476\" name=\"ion mobility drift time\" value=\"" << precursor.getDriftTime()
                  << "\" unitAccession=\"UO:0000028\" unitName=\"millisecond\" unitCvRef=\"UO\" />\n";
@@ -3903,11 +4021,29 @@ namespace OpenMS
         }
 
         // write actual data
-        for (Size s_idx = 0; s_idx < exp.size(); ++s_idx)
+        if (options_.getParallelWriting())
+        {
+          const Size batch_size = std::max(options_.getMaxDataPoolSize(), Size(1));
+          for (Size s_idx = 0; s_idx < exp.size(); s_idx += batch_size)
+          {
+            std::vector<const SpectrumType*> batch;
+            for (Size i = s_idx; i < std::min(s_idx + batch_size, exp.size()); ++i)
+            {
+              batch.push_back(&exp[i]);
+            }
+            writeSpectra_(os, batch, s_idx, validator, renew_native_ids, dps);
+            progress += batch.size();
+            logger_.setProgress(progress);
+          }
+        }
+        else
         {
-          logger_.setProgress(progress++);
-          const SpectrumType& spec = exp[s_idx];
-          writeSpectrum_(os, spec, s_idx, validator, renew_native_ids, dps);
+          for (Size s_idx = 0; s_idx < exp.size(); ++s_idx)
+          {
+            logger_.setProgress(progress++);
+            const SpectrumType& spec = exp[s_idx];
+            writeSpectrum_(os, spec, s_idx, validator, renew_native_ids, dps);
+          }
         }
         os << "\t\t</spectrumList>\n";
       }
@@ -3922,11 +4058,30 @@ namespace OpenMS
         // meta information needs to be stored here but the actual data is
         // stored somewhere else).
         os << "\t\t<chromatogramList count=\"" << exp.getChromatograms().size() << "\" defaultDataProcessingRef=\"dp_sp_0\">\n";
-        for (Size c_idx = 0; c_idx != exp.getChromatograms().size(); ++c_idx)
+        if (options_.getParallelWriting())
         {
-          logger_.setProgress(progress++);
-          const ChromatogramType& chromatogram = exp.getChromatograms()[c_idx];
-          writeChromatogram_(os, chromatogram, c_idx, validator);
+          const Size batch_size = std::max(options_.getMaxDataPoolSize(), Size(1));
+          const std::vector<ChromatogramType>& chromatograms = exp.getChromatograms();
+          for (Size c_idx = 0; c_idx < chromatograms.size(); c_idx += batch_size)
+          {
+            std::vector<const ChromatogramType*> batch;
+            for (Size i = c_idx; i < std::min(c_idx + batch_size, chromatograms.size()); ++i)
+            {
+              batch.push_back(&chromatograms[i]);
+            }
+            writeChromatograms_(os, batch, c_idx, validator);
+            progress += batch.size();
+            logger_.setProgress(progress);
+          }
+        }
+        else
+        {
+          for (Size c_idx = 0; c_idx != exp.getChromatograms().size(); ++c_idx)
+          {
+            logger_.setProgress(progress++);
+            const ChromatogramType& chromatogram = exp.getChromatograms()[c_idx];
+            writeChromatogram_(os, chromatogram, c_idx, validator);
+          }
         }
         os << "\t\t</chromatogramList>" << "\n";
       }
@@ -4885,7 +5040,59 @@ namespace OpenMS
       long offset = os.tellp();
       spectra_offsets_.push_back(make_pair(native_id, offset + 3));
 
-      // IMPORTANT make sure the offset (above) corresponds to the start of the <spectrum tag
+      writeSpectrumElement_(os, spec, s, native_id, validator, dps);
+    }
+
+    void MzMLHandler::writeSpectra_(std::ostream& os,
+                                    const std::vector<const SpectrumType*>& spectra,
+                                    Size first_idx,
+                                    const Internal::MzMLValidator& validator,
+                                    bool renew_native_ids,
+                                    std::vector<std::vector< ConstDataProcessingPtr > >& dps)
+    {
+      std::vector<String> native_ids(spectra.size());
+      std::vector<std::string> buffers(spectra.size());
+      std::exception_ptr error;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for (SignedSize i = 0; i < (SignedSize)spectra.size(); ++i)
+      {
+        // parallel exception catching and re-throwing business
+        try
+        {
+          Size s = first_idx + i;
+          native_ids[i] = renew_native_ids ? String("spectrum=") + s : spectra[i]->getNativeID();
+          std::ostringstream buffer;
+          buffer.precision(os.precision());
+          writeSpectrumElement_(buffer, *spectra[i], s, native_ids[i], validator, dps);
+          buffers[i] = buffer.str();
+        }
+        catch (...)
+        {
+#pragma omp critical(HandleException)
+          if (!error) error = std::current_exception();
+        }
+      }
+      if (error) std::rethrow_exception(error);
+
+      // write in order (the offset has to correspond to the start of the <spectrum tag)
+      for (Size i = 0; i < buffers.size(); ++i)
+      {
+        long offset = os.tellp();
+        spectra_offsets_.push_back(make_pair(native_ids[i], offset + 3));
+        os << buffers[i];
+      }
+    }
+
+    void MzMLHandler::writeSpectrumElement_(std::ostream& os,
+                                            const SpectrumType& spec,
+                                            Size s,
+                                            const String& native_id,
+                                            const Internal::MzMLValidator& validator,
+                                            const std::vector<std::vector< ConstDataProcessingPtr > >& dps)
+    {
+      // IMPORTANT the <spectrum tag has to start after the 3 leading tabs (see offsets)
       os << "\t\t\t<spectrum id=\"" << writeXMLEscape(native_id) << "\" index=\"" << s << "\" defaultArrayLength=\"" << spec.size() << "\"";
       if (spec.getSourceFile() != SourceFile())
       {
@@ -5054,7 +5261,10 @@ namespace OpenMS
             }
             else
             {
-              // assume milliseconds, but warn
+              // assume milliseconds, but warn (may be called from parallel writing)
+#ifdef _OPENMP
+#pragma omp critical (LOG_DEBUG_access)
+#endif
               warning(STORE, String("Spectrum drift time unit not set, assume milliseconds"));
               os << "\t\t\t\t\t\t<cvParam cvRef=\"MS\" accession=\"MS:1002476\" name=\"ion mobility drift time\" value=\"" << spec.getDriftTime()
                  << "\" unitAccession=\"UO:0000028\" unitName=\"millisecond\" unitCvRef=\"UO\" />\n";
@@ -5442,8 +5652,53 @@ namespace OpenMS
       long offset = os.tellp();
       chromatograms_offsets_.push_back(make_pair(chromatogram.getNativeID(), offset + 3));
 
+      writeChromatogramElement_(os, chromatogram, c, validator);
+    }
+
+    void MzMLHandler::writeChromatograms_(std::ostream& os,
+                                          const std::vector<const ChromatogramType*>& chromatograms,
+                                          Size first_idx,
+                                          const Internal::MzMLValidator& validator)
+    {
+      std::vector<std::string> buffers(chromatograms.size());
+      std::exception_ptr error;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for (SignedSize i = 0; i < (SignedSize)chromatograms.size(); ++i)
+      {
+        // parallel exception catching and re-throwing business
+        try
+        {
+          std::ostringstream buffer;
+          buffer.precision(os.precision());
+          writeChromatogramElement_(buffer, *chromatograms[i], first_idx + i, validator);
+          buffers[i] = buffer.str();
+        }
+        catch (...)
+        {
+#pragma omp critical(HandleException)
+          if (!error) error = std::current_exception();
+        }
+      }
+      if (error) std::rethrow_exception(error);
+
+      // write in order (the offset has to correspond to the start of the <chromatogram tag)
+      for (Size i = 0; i < buffers.size(); ++i)
+      {
+        long offset = os.tellp();
+        chromatograms_offsets_.push_back(make_pair(chromatograms[i]->getNativeID(), offset + 3));
+        os << buffers[i];
+      }
+    }
+
+    void MzMLHandler::writeChromatogramElement_(std::ostream& os,
+                                                const ChromatogramType& chromatogram,
+                                                Size c,
+                                                const Internal::MzMLValidator& validator)
+    {
       // TODO native id with chromatogram=?? prefix?
-      // IMPORTANT make sure the offset (above) corresponds to the start of the <chromatogram tag
+      // IMPORTANT the <chromatogram tag has to start after the 3 leading tabs (see offsets)
       os << "\t\t\t<chromatogram id=\"" << writeXMLEscape(chromatogram.getNativeID()) << "\" index=\"" << c << "\" defaultArrayLength=\"" << chromatogram.size() << "\">" << "\n";
 
       // write cvParams (chromatogram type)
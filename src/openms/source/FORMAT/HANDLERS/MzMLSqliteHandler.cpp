@@ -47,6 +47,9 @@
 // #include <type_traits> // for template arg detection
 #include <boost/type_traits.hpp>
 
+#include <algorithm>
+#include <exception>
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -55,13 +58,36 @@ namespace OpenMS
 {
   namespace Internal
   {
+    namespace
+    {
 
     /*
-     *
-     * This function populates a set of empty data containers (MSSpectrum or
-     * MSChromatogram) with data which are read from an SQLite statement. It is
-     * used when reading sqMass files.  It parses all rows produced by an sql
-     * statement with the following columns:
+     * A single (still encoded) data array as read from the DATA table,
+     * together with the index of the container (spectrum or chromatogram) it
+     * belongs to.
+     */
+    struct SqlDataRow_
+    {
+      Size container;
+      int compression;
+      int data_type;
+      std::string native_id;
+      std::string blob;
+    };
+
+    /*
+     * Resets a prepared statement when going out of scope, ensuring that no
+     * read lock is held on the database after an exception.
+     */
+    struct StatementResetGuard_
+    {
+      explicit StatementResetGuard_(sqlite3_stmt* stmt) : stmt_(stmt) {}
+      ~StatementResetGuard_() { sqlite3_reset(stmt_); }
+      sqlite3_stmt* stmt_;
+    };
+
+    /*
+     * Reads all rows produced by an SQL statement with the following columns:
      *
      * id (integer)
      * native_id (string)
@@ -69,154 +95,354 @@ namespace OpenMS
      * data_type (int)
      * binary_Data (blob)
      *
-     * It is designed to work with containers of type MSSpectrum and
-     * MSChromatogram to provide a single function for both use-cases.
-     * 
+     * The blobs are copied so that they can be decoded after the statement
+     * has been stepped further (and in parallel). If fixed_container is
+     * negative, rows are assigned to containers in the order in which their
+     * id first appears (using sql_container_map), otherwise all rows are
+     * assigned to fixed_container.
      */
-    template<class ContainerT>
-    void populateContainer_sub_(sqlite3_stmt *stmt, std::vector<ContainerT >& containers)
+    void collectDataRows_(sqlite3_stmt* stmt, SignedSize fixed_container, std::map<Size, Size>& sql_container_map, std::vector<SqlDataRow_>& rows)
     {
-      // perform first step
-      sqlite3_step(stmt);
+      while (sqlite3_step(stmt) == SQLITE_ROW)
+      {
+        SqlDataRow_ row;
+        if (fixed_container >= 0)
+        {
+          row.container = fixed_container;
+        }
+        else
+        {
+          // map the sql table id to the index in the "containers" vector
+          Size id_orig = sqlite3_column_int(stmt, 0);
+          std::map<Size, Size>::iterator it = sql_container_map.find(id_orig);
+          if (it == sql_container_map.end())
+          {
+            Size tmp = sql_container_map.size();
+            it = sql_container_map.insert(std::make_pair(id_orig, tmp)).first;
+          }
+          row.container = it->second;
+        }
 
-      std::vector<int> cont_data; cont_data.resize(containers.size());
-      std::map<Size,Size> sql_container_map;
-      while (sqlite3_column_type( stmt, 0 ) != SQLITE_NULL)
+        const unsigned char * native_id = sqlite3_column_text(stmt, 1);
+        row.native_id = std::string(reinterpret_cast<const char*>(native_id), sqlite3_column_bytes(stmt, 1));
+        row.compression = sqlite3_column_int(stmt, 2);
+        row.data_type = sqlite3_column_int(stmt, 3);
+
+        const char * raw_text = static_cast<const char*>(sqlite3_column_blob(stmt, 4));
+        size_t blob_bytes = sqlite3_column_bytes(stmt, 4);
+        if (blob_bytes > 0) row.blob.assign(raw_text, blob_bytes);
+
+        rows.push_back(std::move(row));
+      }
+    }
+
+    /*
+     * Decodes a single data array.
+     *
+     * compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib
+     */
+    void decodeDataRow_(const SqlDataRow_& row, std::vector<double>& data)
+    {
+      data.clear();
+      if (row.compression == 1)
       {
-        Size id_orig = sqlite3_column_int( stmt, 0 );
+        std::string uncompressed;
+        OpenMS::ZlibCompression::uncompressString(row.blob.data(), row.blob.size(), uncompressed);
 
-        // map the sql table id to the index in the "containers" vector
-        if (sql_container_map.find(id_orig) == sql_container_map.end()) 
+        Size buffer_size = uncompressed.size();
+        if (buffer_size % sizeof(double) != 0)
         {
-          Size tmp = sql_container_map.size();
-          sql_container_map[id_orig] = tmp;
+          throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Bad BufferCount?");
         }
-        Size curr_id = sql_container_map[id_orig];
-
-        const unsigned char * native_id_ = sqlite3_column_text(stmt, 1);
-        std::string native_id(reinterpret_cast<const char*>(native_id_), sqlite3_column_bytes(stmt, 1));
+        const double * float_buffer = reinterpret_cast<const double *>(uncompressed.data());
+        Size float_count = buffer_size / sizeof(double);
+        // copy values
+        data.assign(float_buffer, float_buffer + float_count);
+      }
+      else if (row.compression == 5)
+      {
+        std::string uncompressed;
+        OpenMS::ZlibCompression::uncompressString(row.blob.data(), row.blob.size(), uncompressed);
+        MSNumpressCoder::NumpressConfig config;
+        config.setCompression("linear");
+        MSNumpressCoder().decodeNPRaw(uncompressed, data, config);
+      }
+      else if (row.compression == 6)
+      {
+        std::string uncompressed;
+        OpenMS::ZlibCompression::uncompressString(row.blob.data(), row.blob.size(), uncompressed);
+        MSNumpressCoder::NumpressConfig config;
+        config.setCompression("slof");
+        MSNumpressCoder().decodeNPRaw(uncompressed, data, config);
+      }
+      else
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+            "Compression not supported");
+      }
+    }
 
-        if (curr_id >= containers.size())
+    /*
+     * Decodes the data arrays of nr_containers containers in parallel. Each
+     * container is processed by a single thread which calls
+     * store(container, data_type, data) for each of its data arrays. Ensures
+     * that all containers have two data arrays (int and mz/rt).
+     */
+    template<class StoreFunctor>
+    void decodeDataRows_(const std::vector<SqlDataRow_>& rows, Size nr_containers, StoreFunctor store)
+    {
+      std::vector<std::vector<Size> > container_rows(nr_containers);
+      for (Size i = 0; i < rows.size(); ++i)
+      {
+        if (rows[i].container >= nr_containers)
         {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
               "Data for non-existent spectrum / chromatogram found");
         }
-        if (native_id != containers[curr_id].getNativeID())
+        container_rows[rows[i].container].push_back(i);
+      }
+
+      // ensure that all spectra/chromatograms have their data: we expect two data arrays per container (int and mz/rt)
+      for (Size k = 0; k < container_rows.size(); k++)
+      {
+        if (container_rows[k].size() < 2)
         {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-              "Native id for spectrum / chromatogram doesnt match");
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, String("Spectrum/Chromatogram ") + k + " does not have 2 data arrays.");
         }
+      }
 
-        int compression = sqlite3_column_int( stmt, 2 );
-        int data_type = sqlite3_column_int( stmt, 3 );
-
-        const void * raw_text = sqlite3_column_blob(stmt, 4);
-        size_t blob_bytes = sqlite3_column_bytes(stmt, 4);
-
-        // data_type is one of 0 = mz, 1 = int, 2 = rt
-        // compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib
-        std::vector<double> data;
-        if (compression == 1)
+      std::exception_ptr decoding_error;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for (SignedSize k = 0; k < (SignedSize)container_rows.size(); k++)
+      {
+        try
         {
-          std::string uncompressed;
-          OpenMS::ZlibCompression::uncompressString(raw_text, blob_bytes, uncompressed);
-
-          void* byte_buffer = reinterpret_cast<void *>(&uncompressed[0]);
-          Size buffer_size = uncompressed.size();
-          const double * float_buffer = reinterpret_cast<const double *>(byte_buffer);
-          if (buffer_size % sizeof(double) != 0)
+          std::vector<double> data;
+          for (Size r = 0; r < container_rows[k].size(); ++r)
           {
-            throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Bad BufferCount?");
+            const SqlDataRow_& row = rows[container_rows[k][r]];
+            decodeDataRow_(row, data);
+            store(k, row.data_type, data);
           }
-          Size float_count = buffer_size / sizeof(double);
-          // copy values
-          data.assign(float_buffer, float_buffer + float_count);
         }
-        else if (compression == 5)
+        catch (...)
+        {
+#ifdef _OPENMP
+#pragma omp critical (MzMLSqliteHandler_decodeDataRows)
+#endif
+          if (!decoding_error) decoding_error = std::current_exception();
+        }
+      }
+      if (decoding_error) std::rethrow_exception(decoding_error);
+    }
+
+    /*
+     *
+     * This function populates a set of empty data containers (MSSpectrum or
+     * MSChromatogram) with data which were read from the DATA table (see
+     * collectDataRows_). It is used when reading sqMass files.
+     *
+     * It is designed to work with containers of type MSSpectrum and
+     * MSChromatogram to provide a single function for both use-cases.
+     *
+     */
+    template<class ContainerT>
+    void populateContainer_sub_(const std::vector<SqlDataRow_>& rows, std::vector<ContainerT >& containers)
+    {
+      for (Size i = 0; i < rows.size(); ++i)
+      {
+        if (rows[i].container < containers.size() && rows[i].native_id != containers[rows[i].container].getNativeID())
+        {
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+              "Native id for spectrum / chromatogram doesnt match");
+        }
+      }
+
+      // data_type is one of 0 = mz, 1 = int, 2 = rt
+      decodeDataRows_(rows, containers.size(), [&containers](Size curr_id, int data_type, const std::vector<double>& data)
+      {
+        ContainerT& container = containers[curr_id];
+        if (data_type == 0 && boost::is_same<ContainerT, MSChromatogram>::value)
         {
-          std::string uncompressed;
-          OpenMS::ZlibCompression::uncompressString(raw_text, blob_bytes, uncompressed);
-          MSNumpressCoder::NumpressConfig config;
-          config.setCompression("linear");
-          MSNumpressCoder().decodeNPRaw(uncompressed, data, config);
+          // mz (should only occur in spectra)
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+              "Found m/z data type for chromatogram (instead of retention time)");
         }
-        else if (compression == 6)
+        if (data_type == 2 && boost::is_same<ContainerT, MSSpectrum >::value)
         {
-          std::string uncompressed;
-          OpenMS::ZlibCompression::uncompressString(raw_text, blob_bytes, uncompressed);
-          MSNumpressCoder::NumpressConfig config;
-          config.setCompression("slof");
-          MSNumpressCoder().decodeNPRaw(uncompressed, data, config);
+          // rt (should only occur in chromatograms)
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+              "Found retention time data type for spectrum (instead of m/z)");
         }
-        else
+        if (data_type < 0 || data_type > 2)
+        {
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+              "Found data type other than RT/Intensity for spectra");
+        }
+
+        if (container.empty()) container.resize(data.size());
+        if (container.size() != data.size())
         {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-              "Compression not supported");
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+              "Data arrays of spectrum / chromatogram " + container.getNativeID() + " differ in length");
         }
 
+        std::vector< double >::const_iterator data_it = data.begin();
         if (data_type == 1)
         {
           // intensity
-          if (containers[curr_id].empty()) containers[curr_id].resize(data.size());
-          std::vector< double >::iterator data_it = data.begin();
-          for (typename ContainerT::iterator it = containers[curr_id].begin(); it != containers[curr_id].end(); ++it, ++data_it)
+          for (typename ContainerT::iterator it = container.begin(); it != container.end(); ++it, ++data_it)
           {
             it->setIntensity(*data_it);
           }
-          cont_data[curr_id] += 1;
         }
-        else if (data_type == 0)
+        else
         {
-          // mz (should only occur in spectra)
-          if (boost::is_same<ContainerT, MSChromatogram>::value) 
-          {
-            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-                "Found m/z data type for chromatogram (instead of retention time)");
-          }
-
-          if (containers[curr_id].empty()) containers[curr_id].resize(data.size());
-          std::vector< double >::iterator data_it = data.begin();
-          for (typename ContainerT::iterator it = containers[curr_id].begin(); it != containers[curr_id].end(); ++it, ++data_it)
+          // mz or rt
+          for (typename ContainerT::iterator it = container.begin(); it != container.end(); ++it, ++data_it)
           {
             it->setMZ(*data_it);
           }
-          cont_data[curr_id] += 1;
-        }
-        else if (data_type == 2)
-        {
-          // rt (should only occur in chromatograms)
-          if (boost::is_same<ContainerT, MSSpectrum >::value) 
-          {
-            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-                "Found retention time data type for spectrum (instead of m/z)");
-          }
-          if (containers[curr_id].empty()) containers[curr_id].resize(data.size());
-          std::vector< double >::iterator data_it = data.begin();
-          for (typename ContainerT::iterator it = containers[curr_id].begin(); it != containers[curr_id].end(); ++it, ++data_it)
-          {
-            it->setMZ(*data_it);
-          }
-          cont_data[curr_id] += 1;
-        }
-        else
-        {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-              "Found data type other than RT/Intensity for spectra");
         }
+      });
+    }
 
-        sqlite3_step( stmt );
+    /*
+     * Sets the meta data of a spectrum from the current row of a statement
+     * with the columns selected in getSpectrumMetaSql_
+     */
+    void fillSpectrumMeta_(sqlite3_stmt* stmt, MSSpectrum& spec)
+    {
+      const unsigned char * native_id = sqlite3_column_text(stmt, 1);
+      spec.setNativeID( std::string(reinterpret_cast<const char*>(native_id), sqlite3_column_bytes(stmt, 1)));
+      String peptide_sequence;
+
+      if (sqlite3_column_type(stmt, 2) != SQLITE_NULL) spec.setMSLevel(sqlite3_column_int(stmt, 2));
+      if (sqlite3_column_type(stmt, 3) != SQLITE_NULL) spec.setRT(sqlite3_column_double(stmt, 3));
+
+      OpenMS::Precursor precursor;
+      OpenMS::Product product;
+      if (sqlite3_column_type(stmt, 4) != SQLITE_NULL) precursor.setCharge(sqlite3_column_int(stmt, 4));
+      if (sqlite3_column_type(stmt, 5) != SQLITE_NULL) precursor.setDriftTime(sqlite3_column_double(stmt, 5));
+      if (sqlite3_column_type(stmt, 6) != SQLITE_NULL) precursor.setMZ(sqlite3_column_double(stmt, 6));
+      if (sqlite3_column_type(stmt, 7) != SQLITE_NULL) precursor.setIsolationWindowLowerOffset(sqlite3_column_double(stmt, 7));
+      if (sqlite3_column_type(stmt, 8) != SQLITE_NULL) precursor.setIsolationWindowUpperOffset(sqlite3_column_double(stmt, 8));
+      if (sqlite3_column_type(stmt, 9) != SQLITE_NULL)
+      {
+        const unsigned char * pepseq = sqlite3_column_text(stmt, 9);
+        peptide_sequence = std::string(reinterpret_cast<const char*>(pepseq), sqlite3_column_bytes(stmt, 9));
+        precursor.setMetaValue("peptide_sequence", peptide_sequence);
       }
+      // if (sqlite3_column_type(stmt, 10) != SQLITE_NULL) product.setCharge(sqlite3_column_int(stmt, 10));
+      if (sqlite3_column_type(stmt, 11) != SQLITE_NULL) product.setMZ(sqlite3_column_double(stmt, 11));
+      if (sqlite3_column_type(stmt, 12) != SQLITE_NULL) product.setIsolationWindowLowerOffset(sqlite3_column_double(stmt, 12));
+      if (sqlite3_column_type(stmt, 13) != SQLITE_NULL) product.setIsolationWindowUpperOffset(sqlite3_column_double(stmt, 13));
+      if (sqlite3_column_type(stmt, 14) != SQLITE_NULL)
+      {
+        int pol = sqlite3_column_int(stmt, 14);
+        if (pol == 0) spec.getInstrumentSettings().setPolarity(IonSource::NEGATIVE);
+        else spec.getInstrumentSettings().setPolarity(IonSource::POSITIVE);
+      }
+      if (sqlite3_column_type(stmt, 15) != SQLITE_NULL && sqlite3_column_int(stmt, 15) != -1
+          && sqlite3_column_int(stmt, 15) < static_cast<int>(OpenMS::Precursor::SIZE_OF_ACTIVATIONMETHOD))
+      {
+        precursor.getActivationMethods().insert(static_cast<OpenMS::Precursor::ActivationMethod>(sqlite3_column_int(stmt, 15)));
+      }
+      if (sqlite3_column_type(stmt, 16) != SQLITE_NULL) precursor.setActivationEnergy(sqlite3_column_double(stmt, 16));
 
-      // ensure that all spectra/chromatograms have their data: we expect two data arrays per container (int and mz/rt)
-      for (Size k = 0; k < cont_data.size(); k++)
+      if (sqlite3_column_type(stmt, 6) != SQLITE_NULL) spec.getPrecursors().push_back(precursor);
+      if (sqlite3_column_type(stmt, 11) != SQLITE_NULL) spec.getProducts().push_back(product);
+    }
+
+    /*
+     * Sets the meta data of a chromatogram from the current row of a
+     * statement with the columns selected in getChromatogramMetaSql_
+     */
+    void fillChromatogramMeta_(sqlite3_stmt* stmt, MSChromatogram& chrom)
+    {
+      // int chrom_id = sqlite3_column_int(stmt, 0);
+      const unsigned char * native_id = sqlite3_column_text(stmt, 1);
+      chrom.setNativeID( std::string(reinterpret_cast<const char*>(native_id), sqlite3_column_bytes(stmt, 1)));
+      String peptide_sequence;
+
+      OpenMS::Precursor precursor;
+      OpenMS::Product product;
+      if (sqlite3_column_type(stmt, 2) != SQLITE_NULL) precursor.setCharge(sqlite3_column_int(stmt, 2));
+      if (sqlite3_column_type(stmt, 3) != SQLITE_NULL) precursor.setDriftTime(sqlite3_column_double(stmt, 3));
+      if (sqlite3_column_type(stmt, 4) != SQLITE_NULL) precursor.setMZ(sqlite3_column_double(stmt, 4));
+      if (sqlite3_column_type(stmt, 5) != SQLITE_NULL) precursor.setIsolationWindowLowerOffset(sqlite3_column_double(stmt, 5));
+      if (sqlite3_column_type(stmt, 6) != SQLITE_NULL) precursor.setIsolationWindowUpperOffset(sqlite3_column_double(stmt, 6));
+      if (sqlite3_column_type(stmt, 7) != SQLITE_NULL)
       {
-        if (cont_data[k] < 2)
-        {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, String("Spectrum/Chromatogram ") + k + " does not have 2 data arrays.");
-        }
+        const unsigned char * pepseq = sqlite3_column_text(stmt, 7);
+        peptide_sequence = std::string(reinterpret_cast<const char*>(pepseq), sqlite3_column_bytes(stmt, 7));
+        precursor.setMetaValue("peptide_sequence", peptide_sequence);
+      }
+      // if (sqlite3_column_type(stmt, 8) != SQLITE_NULL) product.setCharge(sqlite3_column_int(stmt, 8));
+      if (sqlite3_column_type(stmt, 9) != SQLITE_NULL) product.setMZ(sqlite3_column_double(stmt, 9));
+      if (sqlite3_column_type(stmt, 10) != SQLITE_NULL) product.setIsolationWindowLowerOffset(sqlite3_column_double(stmt, 10));
+      if (sqlite3_column_type(stmt, 11) != SQLITE_NULL) product.setIsolationWindowUpperOffset(sqlite3_column_double(stmt, 11));
+      if (sqlite3_column_type(stmt, 12) != SQLITE_NULL && sqlite3_column_int(stmt, 12) != -1
+          && sqlite3_column_int(stmt, 12) < static_cast<int>(OpenMS::Precursor::SIZE_OF_ACTIVATIONMETHOD))
+      {
+        precursor.getActivationMethods().insert(static_cast<OpenMS::Precursor::ActivationMethod>(sqlite3_column_int(stmt, 12)));
       }
+      if (sqlite3_column_type(stmt, 13) != SQLITE_NULL) precursor.setActivationEnergy(sqlite3_column_double(stmt, 13));
+
+      chrom.setPrecursor(precursor);
+      chrom.setProduct(product);
     }
 
+    std::string getSpectrumMetaSql_()
+    {
+      return "SELECT " \
+             "SPECTRUM.ID as spec_id," \
+             "SPECTRUM.NATIVE_ID as spec_native_id," \
+             "SPECTRUM.MSLEVEL as spec_mslevel," \
+             "SPECTRUM.RETENTION_TIME as spec_rt," \
+             "PRECURSOR.CHARGE as precursor_charge," \
+             "PRECURSOR.DRIFT_TIME as precursor_dt," \
+             "PRECURSOR.ISOLATION_TARGET as precursor_mz," \
+             "PRECURSOR.ISOLATION_LOWER as precursor_mz_lower," \
+             "PRECURSOR.ISOLATION_UPPER as precursor_mz_upper," \
+             "PRECURSOR.PEPTIDE_SEQUENCE as precursor_seq," \
+             "PRODUCT.CHARGE as product_charge," \
+             "PRODUCT.ISOLATION_TARGET as product_mz," \
+             "PRODUCT.ISOLATION_LOWER as product_mz_lower," \
+             "PRODUCT.ISOLATION_UPPER as product_mz_upper, " \
+             "SPECTRUM.SCAN_POLARITY as spec_polarity, " \
+             "PRECURSOR.ACTIVATION_METHOD as prec_activation, " \
+             "PRECURSOR.ACTIVATION_ENERGY as prec_activation_en " \
+             "FROM SPECTRUM " \
+             "LEFT JOIN PRECURSOR ON SPECTRUM.ID = PRECURSOR.SPECTRUM_ID " \
+             "LEFT JOIN PRODUCT ON SPECTRUM.ID = PRODUCT.SPECTRUM_ID ";
+    }
+
+    std::string getChromatogramMetaSql_()
+    {
+      return "SELECT " \
+             "CHROMATOGRAM.ID as chrom_id," \
+             "CHROMATOGRAM.NATIVE_ID as chrom_native_id," \
+             "PRECURSOR.CHARGE as precursor_charge," \
+             "PRECURSOR.DRIFT_TIME as precursor_dt," \
+             "PRECURSOR.ISOLATION_TARGET as precursor_mz," \
+             "PRECURSOR.ISOLATION_LOWER as precursor_mz_lower," \
+             "PRECURSOR.ISOLATION_UPPER as precursor_mz_upper," \
+             "PRECURSOR.PEPTIDE_SEQUENCE as precursor_seq," \
+             "PRODUCT.CHARGE as product_charge," \
+             "PRODUCT.ISOLATION_TARGET as product_mz," \
+             "PRODUCT.ISOLATION_LOWER as product_mz_lower," \
+             "PRODUCT.ISOLATION_UPPER as product_mz_upper, " \
+             "PRECURSOR.ACTIVATION_METHOD as prec_activation, " \
+             "PRECURSOR.ACTIVATION_ENERGY as prec_activation_en " \
+             "FROM CHROMATOGRAM " \
+             "INNER JOIN PRECURSOR ON CHROMATOGRAM.ID = PRECURSOR.CHROMATOGRAM_ID " \
+             "INNER JOIN PRODUCT ON CHROMATOGRAM.ID = PRODUCT.CHROMATOGRAM_ID ";
+    }
+    } // anonymous namespace
+
     static int callback(void * /* NotUsed */, int argc, char **argv, char **azColName)
     {
       int i;
@@ -238,8 +464,44 @@ namespace OpenMS
       run_id_(0),
       use_lossy_compression_(true),
       linear_abs_mass_acc_(0.0001), // set the desired mass accuracy = 1ppm at 100 m/z
-      write_full_meta_(true)
+      write_full_meta_(true),
+      sql_batch_size_(500),
+      read_db_(nullptr)
+    {
+    }
+
+    MzMLSqliteHandler::MzMLSqliteHandler(const MzMLSqliteHandler& rhs) :
+      filename_(rhs.filename_),
+      spec_id_(rhs.spec_id_),
+      chrom_id_(rhs.chrom_id_),
+      run_id_(rhs.run_id_),
+      use_lossy_compression_(rhs.use_lossy_compression_),
+      linear_abs_mass_acc_(rhs.linear_abs_mass_acc_),
+      write_full_meta_(rhs.write_full_meta_),
+      sql_batch_size_(rhs.sql_batch_size_),
+      read_db_(nullptr)
+    {
+    }
+
+    MzMLSqliteHandler& MzMLSqliteHandler::operator=(const MzMLSqliteHandler& rhs)
+    {
+      if (&rhs == this) return *this;
+
+      closeReadDB_();
+      filename_ = rhs.filename_;
+      spec_id_ = rhs.spec_id_;
+      chrom_id_ = rhs.chrom_id_;
+      run_id_ = rhs.run_id_;
+      use_lossy_compression_ = rhs.use_lossy_compression_;
+      linear_abs_mass_acc_ = rhs.linear_abs_mass_acc_;
+      write_full_meta_ = rhs.write_full_meta_;
+      sql_batch_size_ = rhs.sql_batch_size_;
+      return *this;
+    }
+
+    MzMLSqliteHandler::~MzMLSqliteHandler()
     {
+      closeReadDB_();
     }
 
     sqlite3* MzMLSqliteHandler::openDB() const
@@ -256,6 +518,53 @@ namespace OpenMS
       return db;
     }
 
+    sqlite3* MzMLSqliteHandler::getReadDB_() const
+    {
+      if (read_db_ == nullptr)
+      {
+        read_db_ = openDB();
+      }
+      return read_db_;
+    }
+
+    sqlite3_stmt* MzMLSqliteHandler::getCachedStatement_(const std::string& sql) const
+    {
+      std::map<std::string, sqlite3_stmt*>::iterator it = cached_statements_.find(sql);
+      if (it != cached_statements_.end())
+      {
+        sqlite3_reset(it->second);
+        sqlite3_clear_bindings(it->second);
+        return it->second;
+      }
+
+      sqlite3* db = getReadDB_();
+      sqlite3_stmt* stmt;
+      int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+      if (rc != SQLITE_OK)
+      {
+        std::cerr << "SQL error after sqlite3_prepare" << std::endl;
+        std::cerr << "Prepared statement " << sql << std::endl;
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, sqlite3_errmsg(db));
+      }
+      cached_statements_[sql] = stmt;
+      return stmt;
+    }
+
+    void MzMLSqliteHandler::closeReadDB_() const
+    {
+      for (std::map<std::string, sqlite3_stmt*>::iterator it = cached_statements_.begin(); it != cached_statements_.end(); ++it)
+      {
+        sqlite3_finalize(it->second);
+      }
+      cached_statements_.clear();
+
+      if (read_db_ != nullptr)
+      {
+        sqlite3_close(read_db_);
+        read_db_ = nullptr;
+      }
+    }
+
     void MzMLSqliteHandler::readExperiment(MSExperiment & exp, bool meta_only) const
     {
       sqlite3 *db = openDB();
@@ -325,7 +634,7 @@ namespace OpenMS
         exp.setSpectra(spectra);
       }
 
-      if (meta_only) 
+      if (meta_only)
       {
         // free up connection
         sqlite3_close(db);
@@ -343,69 +652,155 @@ namespace OpenMS
     {
       OPENMS_PRECONDITION(!indices.empty(), "Need to select at least one index")
 
-      sqlite3 *db = openDB();
-
       // creates the spectra but does not fill them with data (provides option to return meta-data only)
       std::vector<MSSpectrum> spectra;
-      prepareSpectra_(db, spectra);
+      prepareSpectra_(spectra, indices);
+
+      if (!meta_only)
+      {
+        populateSpectraWithData_(spectra, indices);
+      }
+
+      exp.reserve(exp.size() + spectra.size());
+      for (Size k = 0; k < spectra.size(); k++)
+      {
+        exp.push_back(std::move(spectra[k]));
+      }
+    }
+
+    void MzMLSqliteHandler::readSpectraData(const std::vector<int> & indices, std::vector<double> & mz, std::vector<double> & intensity, std::vector<Size> & offsets) const
+    {
+      std::vector<SqlDataRow_> rows;
+      std::map<Size, Size> sql_container_map;
+      {
+        sqlite3_stmt* stmt = getCachedStatement_(
+          "SELECT SPECTRUM_ID, '', COMPRESSION, DATA_TYPE, DATA FROM DATA WHERE SPECTRUM_ID = ?;");
+        StatementResetGuard_ guard(stmt);
+        for (Size k = 0; k < indices.size(); k++)
+        {
+          sqlite3_reset(stmt);
+          sqlite3_bind_int(stmt, 1, indices[k]);
+          collectDataRows_(stmt, k, sql_container_map, rows);
+        }
+      }
+
+      // decode into per-spectrum arrays first, then concatenate
+      std::vector<std::vector<double> > mz_arrays(indices.size());
+      std::vector<std::vector<double> > int_arrays(indices.size());
+      decodeDataRows_(rows, indices.size(), [&mz_arrays, &int_arrays](Size curr_id, int data_type, const std::vector<double>& data)
+      {
+        if (data_type == 0) mz_arrays[curr_id] = data;
+        else if (data_type == 1) int_arrays[curr_id] = data;
+        else
+        {
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+              "Found data type other than m/z or intensity for spectrum");
+        }
+      });
+      rows.clear();
+
+      offsets.assign(1, 0);
+      offsets.reserve(indices.size() + 1);
       for (Size k = 0; k < indices.size(); k++)
       {
-        exp.push_back(spectra[indices[k]]); // TODO make more efficient
+        if (mz_arrays[k].size() != int_arrays[k].size())
+        {
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+              String("Data arrays of spectrum ") + indices[k] + " differ in length");
+        }
+        offsets.push_back(offsets.back() + mz_arrays[k].size());
       }
 
-      if (meta_only) {return;}
+      mz.resize(offsets.back());
+      intensity.resize(offsets.back());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+      for (SignedSize k = 0; k < (SignedSize)indices.size(); k++)
+      {
+        std::copy(mz_arrays[k].begin(), mz_arrays[k].end(), mz.begin() + offsets[k]);
+        std::copy(int_arrays[k].begin(), int_arrays[k].end(), intensity.begin() + offsets[k]);
+      }
+    }
 
-      populateSpectraWithData_(db, exp, indices);
+    void MzMLSqliteHandler::readSpectrumIndex(std::vector<SpectrumIndexEntry> & index) const
+    {
+      index.clear();
+
+      sqlite3_stmt* stmt = getCachedStatement_(
+        "SELECT " \
+        "SPECTRUM.ID as spec_id," \
+        "SPECTRUM.NATIVE_ID as spec_native_id," \
+        "SPECTRUM.MSLEVEL as spec_mslevel," \
+        "SPECTRUM.RETENTION_TIME as spec_rt," \
+        "PRECURSOR.ISOLATION_TARGET as precursor_mz," \
+        "PRECURSOR.ISOLATION_LOWER as precursor_mz_lower," \
+        "PRECURSOR.ISOLATION_UPPER as precursor_mz_upper " \
+        "FROM SPECTRUM " \
+        "LEFT JOIN PRECURSOR ON SPECTRUM.ID = PRECURSOR.SPECTRUM_ID " \
+        "ORDER BY SPECTRUM.ID;");
+      StatementResetGuard_ guard(stmt);
+
+      while (sqlite3_step(stmt) == SQLITE_ROW)
+      {
+        Int id = sqlite3_column_int(stmt, 0);
+        // only the first precursor of each spectrum is stored
+        if (!index.empty() && index.back().id == id) continue;
 
-      // free up connection
-      sqlite3_close(db);
+        SpectrumIndexEntry entry;
+        entry.id = id;
+        const unsigned char * native_id = sqlite3_column_text(stmt, 1);
+        entry.native_id = std::string(reinterpret_cast<const char*>(native_id), sqlite3_column_bytes(stmt, 1));
+        entry.ms_level = sqlite3_column_type(stmt, 2) != SQLITE_NULL ? sqlite3_column_int(stmt, 2) : 1;
+        entry.rt = sqlite3_column_type(stmt, 3) != SQLITE_NULL ? sqlite3_column_double(stmt, 3) : -1.0;
+        entry.precursor_mz = 0.0;
+        entry.isolation_lower = 0.0;
+        entry.isolation_upper = 0.0;
+        if (sqlite3_column_type(stmt, 4) != SQLITE_NULL)
+        {
+          entry.precursor_mz = sqlite3_column_double(stmt, 4);
+          entry.isolation_lower = entry.precursor_mz;
+          entry.isolation_upper = entry.precursor_mz;
+          if (sqlite3_column_type(stmt, 5) != SQLITE_NULL) entry.isolation_lower -= sqlite3_column_double(stmt, 5);
+          if (sqlite3_column_type(stmt, 6) != SQLITE_NULL) entry.isolation_upper += sqlite3_column_double(stmt, 6);
+        }
+        index.push_back(entry);
+      }
     }
 
     void MzMLSqliteHandler::readChromatograms(std::vector<MSChromatogram> & exp, const std::vector<int> & indices, bool meta_only) const
     {
       OPENMS_PRECONDITION(!indices.empty(), "Need to select at least one index")
-      sqlite3 *db = openDB();
 
-      // creates the spectra but does not fill them with data (provides option to return meta-data only)
+      // creates the chromatograms but does not fill them with data (provides option to return meta-data only)
       std::vector<MSChromatogram> chroms;
-      prepareChroms_(db, chroms);
+      prepareChroms_(chroms, indices);
 
-      for (Size k = 0; k < indices.size(); k++)
+      if (!meta_only)
       {
-        exp.push_back(chroms[indices[k]]); // TODO make more efficient
+        populateChromatogramsWithData_(chroms, indices);
       }
-      if (meta_only) {return;}
 
-      populateChromatogramsWithData_(db, exp, indices);
-
-      // free up connection
-      sqlite3_close(db);
+      exp.reserve(exp.size() + chroms.size());
+      for (Size k = 0; k < chroms.size(); k++)
+      {
+        exp.push_back(std::move(chroms[k]));
+      }
     }
 
     Size MzMLSqliteHandler::getNrSpectra() const
     {
-      sqlite3 *db = openDB();
-      sqlite3_stmt * stmt;
+      sqlite3_stmt * stmt = getCachedStatement_("SELECT COUNT(*) FROM SPECTRUM;");
+      StatementResetGuard_ guard(stmt);
 
       Size ret(0);
-      std::string select_sql;
-      select_sql = "SELECT COUNT(*) FROM SPECTRUM;";
-      sqlite3_prepare(db, select_sql.c_str(), -1, &stmt, nullptr);
-      sqlite3_step(stmt);
-      if (sqlite3_column_type(stmt, 0) != SQLITE_NULL) ret = sqlite3_column_int(stmt, 0);
-
-      // free memory and free up connection
-      sqlite3_finalize(stmt);
-      sqlite3_close(db);
-
+      if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL) ret = sqlite3_column_int(stmt, 0);
       return ret;
     }
 
     std::vector<size_t> MzMLSqliteHandler::getSpectraIndicesbyRT(double RT, double deltaRT, const std::vector<int> & indices) const
     {
       // this is necessary for some applications such as the m/z correction
-      sqlite3 *db = openDB();
-
       std::vector<size_t> result;
       sqlite3_stmt * stmt;
       std::string select_sql;
@@ -416,13 +811,11 @@ namespace OpenMS
 
       if (deltaRT > 0.0)
       {
-        select_sql += "WHERE RETENTION_TIME BETWEEN ";
-        select_sql += String(RT - deltaRT) + " AND " + String(RT + deltaRT) + " ";
+        select_sql += "WHERE RETENTION_TIME BETWEEN ? AND ? ";
       }
       else
       {
-        select_sql += "WHERE RETENTION_TIME >= ";
-        select_sql += String(RT) + " ";
+        select_sql += "WHERE RETENTION_TIME >= ? ";
       }
 
       if (!indices.empty())
@@ -435,41 +828,50 @@ namespace OpenMS
         select_sql += String(indices[indices.size()-1]) + ") ";
       }
 
-      if (deltaRT <= 0.0) {select_sql += " LIMIT 1";} // only take the first spectrum larger than RT
+      // only take the first spectrum larger than RT
+      if (deltaRT <= 0.0) {select_sql += "ORDER BY RETENTION_TIME LIMIT 1";}
+      else {select_sql += "ORDER BY SPECTRUM.ID";}
       select_sql += ";";
 
-      sqlite3_prepare(db, select_sql.c_str(), -1, &stmt, nullptr);
-      sqlite3_step(stmt);
+      // statements without a list of indices are re-used across calls
+      sqlite3* db = getReadDB_();
+      if (indices.empty())
+      {
+        stmt = getCachedStatement_(select_sql);
+      }
+      else if (sqlite3_prepare_v2(db, select_sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK)
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, sqlite3_errmsg(db));
+      }
 
-      while (sqlite3_column_type( stmt, 0 ) != SQLITE_NULL)
+      if (deltaRT > 0.0)
+      {
+        sqlite3_bind_double(stmt, 1, RT - deltaRT);
+        sqlite3_bind_double(stmt, 2, RT + deltaRT);
+      }
+      else
+      {
+        sqlite3_bind_double(stmt, 1, RT);
+      }
+
+      while (sqlite3_step(stmt) == SQLITE_ROW)
       {
-        MSSpectrum spec;
         result.push_back( sqlite3_column_int(stmt, 0) );
-        sqlite3_step( stmt );
       }
 
-      // free memory and free up connection
-      sqlite3_finalize(stmt);
-      sqlite3_close(db);
+      // free memory (cached statements are only reset)
+      if (indices.empty()) sqlite3_reset(stmt);
+      else sqlite3_finalize(stmt);
       return result;
     }
 
     Size MzMLSqliteHandler::getNrChromatograms() const
     {
-      sqlite3 *db = openDB();
-      sqlite3_stmt * stmt;
+      sqlite3_stmt * stmt = getCachedStatement_("SELECT COUNT(*) FROM CHROMATOGRAM;");
+      StatementResetGuard_ guard(stmt);
 
       Size ret(0);
-      std::string select_sql;
-      select_sql = "SELECT COUNT(*) FROM CHROMATOGRAM;";
-      sqlite3_prepare(db, select_sql.c_str(), -1, &stmt, nullptr);
-      sqlite3_step( stmt );
-      if (sqlite3_column_type(stmt, 0) != SQLITE_NULL) ret = sqlite3_column_int(stmt, 0);
-
-      // free memory and free up connection
-      sqlite3_finalize(stmt);
-      sqlite3_close(db);
-
+      if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL) ret = sqlite3_column_int(stmt, 0);
       return ret;
     }
 
@@ -499,49 +901,43 @@ namespace OpenMS
         throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, sqlite3_errmsg(db));
       }
 
-      populateContainer_sub_< MSChromatogram > (stmt, chromatograms);
-
+      // read the raw data first, then decode in parallel
+      std::vector<SqlDataRow_> rows;
+      std::map<Size, Size> sql_container_map;
+      collectDataRows_(stmt, -1, sql_container_map, rows);
       sqlite3_finalize(stmt);
+
+      populateContainer_sub_< MSChromatogram > (rows, chromatograms);
     }
 
-    void MzMLSqliteHandler::populateChromatogramsWithData_(sqlite3 *db, std::vector<MSChromatogram>& chromatograms, const std::vector<int> & indices) const
+    void MzMLSqliteHandler::populateChromatogramsWithData_(std::vector<MSChromatogram>& chromatograms, const std::vector<int> & indices) const
     {
       OPENMS_PRECONDITION(!indices.empty(), "Need to select at least one index.")
       OPENMS_PRECONDITION(indices.size() == chromatograms.size(), "Chromatograms and indices need to have the same length.")
 
-      int rc;
-      sqlite3_stmt * stmt;
-      std::string select_sql;
-
-      select_sql = "SELECT " \
-                    "CHROMATOGRAM.ID as chrom_id," \
-                    "CHROMATOGRAM.NATIVE_ID as chrom_native_id," \
-                    "DATA.COMPRESSION as data_compression," \
-                    "DATA.DATA_TYPE as data_type," \
-                    "DATA.DATA as binary_data " \
-                    "FROM CHROMATOGRAM " \
-                    "INNER JOIN DATA ON CHROMATOGRAM.ID = DATA.CHROMATOGRAM_ID " \
-                    "WHERE CHROMATOGRAM.ID IN (";
-
-      for (Size k = 0; k < indices.size()-1; k++)
+      std::vector<SqlDataRow_> rows;
+      std::map<Size, Size> sql_container_map;
       {
-        select_sql += String(indices[k]) + ",";
-      }
-
-      select_sql += String(indices[indices.size()-1]) + ");";
-
-      // Execute SQL statement
-      rc = sqlite3_prepare(db, select_sql.c_str(), -1, &stmt, nullptr);
-      if (rc != SQLITE_OK)
-      {
-        std::cerr << "SQL error after sqlite3_prepare" << std::endl;
-        std::cerr << "Prepared statement " << select_sql << std::endl;
-        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, sqlite3_errmsg(db));
+        sqlite3_stmt* stmt = getCachedStatement_(
+          "SELECT " \
+          "CHROMATOGRAM.ID as chrom_id," \
+          "CHROMATOGRAM.NATIVE_ID as chrom_native_id," \
+          "DATA.COMPRESSION as data_compression," \
+          "DATA.DATA_TYPE as data_type," \
+          "DATA.DATA as binary_data " \
+          "FROM CHROMATOGRAM " \
+          "INNER JOIN DATA ON CHROMATOGRAM.ID = DATA.CHROMATOGRAM_ID " \
+          "WHERE CHROMATOGRAM.ID = ?;");
+        StatementResetGuard_ guard(stmt);
+        for (Size k = 0; k < indices.size(); k++)
+        {
+          sqlite3_reset(stmt);
+          sqlite3_bind_int(stmt, 1, indices[k]);
+          collectDataRows_(stmt, k, sql_container_map, rows);
+        }
       }
 
-      populateContainer_sub_< MSChromatogram > (stmt, chromatograms);
-
-      sqlite3_finalize(stmt);
+      populateContainer_sub_< MSChromatogram > (rows, chromatograms);
     }
 
     void MzMLSqliteHandler::populateSpectraWithData_(sqlite3 *db, std::vector<MSSpectrum>& spectra) const
@@ -570,81 +966,49 @@ namespace OpenMS
         throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, sqlite3_errmsg(db));
       }
 
-      populateContainer_sub_< MSSpectrum> (stmt, spectra);
-
+      // read the raw data first, then decode in parallel
+      std::vector<SqlDataRow_> rows;
+      std::map<Size, Size> sql_container_map;
+      collectDataRows_(stmt, -1, sql_container_map, rows);
       sqlite3_finalize(stmt);
+
+      populateContainer_sub_< MSSpectrum> (rows, spectra);
     }
 
-    void MzMLSqliteHandler::populateSpectraWithData_(sqlite3 *db, std::vector<MSSpectrum>& spectra, const std::vector<int> & indices) const
+    void MzMLSqliteHandler::populateSpectraWithData_(std::vector<MSSpectrum>& spectra, const std::vector<int> & indices) const
     {
       OPENMS_PRECONDITION(!indices.empty(), "Need to select at least one index.")
       OPENMS_PRECONDITION(indices.size() == spectra.size(), "Spectra and indices need to have the same length.")
 
-      sqlite3_stmt * stmt;
-      int rc;
-      std::string select_sql;
-
-      select_sql = "SELECT " \
-                    "SPECTRUM.ID as spec_id," \
-                    "SPECTRUM.NATIVE_ID as spec_native_id," \
-                    "DATA.COMPRESSION as data_compression," \
-                    "DATA.DATA_TYPE as data_type," \
-                    "DATA.DATA as binary_data " \
-                    "FROM SPECTRUM " \
-                    "INNER JOIN DATA ON SPECTRUM.ID = DATA.SPECTRUM_ID " \
-                    "WHERE SPECTRUM.ID IN (";
-
-      for (Size k = 0; k < indices.size()-1; k++)
-      {
-        select_sql += String(indices[k]) + ",";
-      }
-
-      select_sql += String(indices[indices.size()-1]) + ");";
-
-      // Execute SQL statement
-      rc = sqlite3_prepare(db, select_sql.c_str(), -1, &stmt, nullptr);
-      if (rc != SQLITE_OK)
+      std::vector<SqlDataRow_> rows;
+      std::map<Size, Size> sql_container_map;
       {
-        std::cerr << "SQL error after sqlite3_prepare" << std::endl;
-        std::cerr << "Prepared statement " << select_sql << std::endl;
-        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, sqlite3_errmsg(db));
+        sqlite3_stmt* stmt = getCachedStatement_(
+          "SELECT " \
+          "SPECTRUM.ID as spec_id," \
+          "SPECTRUM.NATIVE_ID as spec_native_id," \
+          "DATA.COMPRESSION as data_compression," \
+          "DATA.DATA_TYPE as data_type," \
+          "DATA.DATA as binary_data " \
+          "FROM SPECTRUM " \
+          "INNER JOIN DATA ON SPECTRUM.ID = DATA.SPECTRUM_ID " \
+          "WHERE SPECTRUM.ID = ?;");
+        StatementResetGuard_ guard(stmt);
+        for (Size k = 0; k < indices.size(); k++)
+        {
+          sqlite3_reset(stmt);
+          sqlite3_bind_int(stmt, 1, indices[k]);
+          collectDataRows_(stmt, k, sql_container_map, rows);
+        }
       }
 
-      populateContainer_sub_< MSSpectrum > (stmt, spectra);
-
-      sqlite3_finalize(stmt);
+      populateContainer_sub_< MSSpectrum > (rows, spectra);
     }
 
     void MzMLSqliteHandler::prepareChroms_(sqlite3 *db, std::vector<MSChromatogram>& chromatograms) const
     {
       sqlite3_stmt * stmt;
-      std::string select_sql;
-      select_sql = "SELECT " \
-                    "CHROMATOGRAM.ID as chrom_id," \
-                    "CHROMATOGRAM.NATIVE_ID as chrom_native_id," \
-                    "PRECURSOR.CHARGE as precursor_charge," \
-                    "PRECURSOR.DRIFT_TIME as precursor_dt," \
-                    "PRECURSOR.ISOLATION_TARGET as precursor_mz," \
-                    "PRECURSOR.ISOLATION_LOWER as precursor_mz_lower," \
-                    "PRECURSOR.ISOLATION_UPPER as precursor_mz_upper," \
-                    "PRECURSOR.PEPTIDE_SEQUENCE as precursor_seq," \
-                    "PRODUCT.CHARGE as product_charge," \
-                    "PRODUCT.ISOLATION_TARGET as product_mz," \
-                    "PRODUCT.ISOLATION_LOWER as product_mz_lower," \
-                    "PRODUCT.ISOLATION_UPPER as product_mz_upper, " \
-                    "PRECURSOR.ACTIVATION_METHOD as prec_activation, " \
-                    "PRECURSOR.ACTIVATION_ENERGY as prec_activation_en " \
-                    "FROM CHROMATOGRAM " \
-                    "INNER JOIN PRECURSOR ON CHROMATOGRAM.ID = PRECURSOR.CHROMATOGRAM_ID " \
-                    "INNER JOIN PRODUCT ON CHROMATOGRAM.ID = PRODUCT.CHROMATOGRAM_ID " \
-                    ";";
-
-      /// TODO : do we want to support reading a subset of the data (e.g. only chromatograms xx - yy)
-      ///   readChromatograms_(db, stmt, chromatograms);
-      /// }
-
-      /// void readChromatograms_(sqlite3 *db, sqlite3_stmt* stmt, std::vector<MSChromatogram >& chromatograms)
-      /// {
+      std::string select_sql = getChromatogramMetaSql_() + ";";
 
       // See https://www.sqlite.org/c3ref/column_blob.html
       // The pointers returned are valid until a type conversion occurs as
@@ -655,78 +1019,43 @@ namespace OpenMS
       // sqlite3_free().
 
       sqlite3_prepare(db, select_sql.c_str(), -1, &stmt, nullptr);
-      sqlite3_step( stmt );
 
-      while (sqlite3_column_type( stmt, 0 ) != SQLITE_NULL)
+      while (sqlite3_step(stmt) == SQLITE_ROW)
       {
         MSChromatogram chrom;
-
-        // int chrom_id = sqlite3_column_int(stmt, 0);
-        const unsigned char * native_id = sqlite3_column_text(stmt, 1);
-        chrom.setNativeID( std::string(reinterpret_cast<const char*>(native_id), sqlite3_column_bytes(stmt, 1)));
-        String peptide_sequence;
-
-        OpenMS::Precursor precursor;
-        OpenMS::Product product;
-        if (sqlite3_column_type(stmt, 2) != SQLITE_NULL) precursor.setCharge(sqlite3_column_int(stmt, 2));
-        if (sqlite3_column_type(stmt, 3) != SQLITE_NULL) precursor.setDriftTime(sqlite3_column_double(stmt, 3));
-        if (sqlite3_column_type(stmt, 4) != SQLITE_NULL) precursor.setMZ(sqlite3_column_double(stmt, 4));
-        if (sqlite3_column_type(stmt, 5) != SQLITE_NULL) precursor.setIsolationWindowLowerOffset(sqlite3_column_double(stmt, 5));
-        if (sqlite3_column_type(stmt, 6) != SQLITE_NULL) precursor.setIsolationWindowUpperOffset(sqlite3_column_double(stmt, 6));
-        if (sqlite3_column_type(stmt, 7) != SQLITE_NULL) 
-        {
-          const unsigned char * pepseq = sqlite3_column_text(stmt, 7);
-          peptide_sequence = std::string(reinterpret_cast<const char*>(pepseq), sqlite3_column_bytes(stmt, 7));
-          precursor.setMetaValue("peptide_sequence", peptide_sequence);
-        }
-        // if (sqlite3_column_type(stmt, 8) != SQLITE_NULL) product.setCharge(sqlite3_column_int(stmt, 8));
-        if (sqlite3_column_type(stmt, 9) != SQLITE_NULL) product.setMZ(sqlite3_column_double(stmt, 9));
-        if (sqlite3_column_type(stmt, 10) != SQLITE_NULL) product.setIsolationWindowLowerOffset(sqlite3_column_double(stmt, 10));
-        if (sqlite3_column_type(stmt, 11) != SQLITE_NULL) product.setIsolationWindowUpperOffset(sqlite3_column_double(stmt, 11));
-        if (sqlite3_column_type(stmt, 12) != SQLITE_NULL && sqlite3_column_int(stmt, 12) != -1
-            && sqlite3_column_int(stmt, 12) < static_cast<int>(OpenMS::Precursor::SIZE_OF_ACTIVATIONMETHOD))
-        {
-          precursor.getActivationMethods().insert(static_cast<OpenMS::Precursor::ActivationMethod>(sqlite3_column_int(stmt, 12)));
-        }
-        if (sqlite3_column_type(stmt, 13) != SQLITE_NULL) precursor.setActivationEnergy(sqlite3_column_double(stmt, 13));
-
-        chrom.setPrecursor(precursor);
-        chrom.setProduct(product);
+        fillChromatogramMeta_(stmt, chrom);
         chromatograms.push_back(chrom);
-
-        sqlite3_step( stmt );
       }
 
       // free memory
       sqlite3_finalize(stmt);
-  }
+    }
+
+    void MzMLSqliteHandler::prepareChroms_(std::vector<MSChromatogram>& chromatograms, const std::vector<int> & indices) const
+    {
+      sqlite3_stmt* stmt = getCachedStatement_(getChromatogramMetaSql_() + "WHERE CHROMATOGRAM.ID = ?;");
+      StatementResetGuard_ guard(stmt);
+
+      chromatograms.reserve(chromatograms.size() + indices.size());
+      for (Size k = 0; k < indices.size(); k++)
+      {
+        sqlite3_reset(stmt);
+        sqlite3_bind_int(stmt, 1, indices[k]);
+        if (sqlite3_step(stmt) != SQLITE_ROW)
+        {
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+              String("Chromatogram ") + indices[k] + " does not exist");
+        }
+        MSChromatogram chrom;
+        fillChromatogramMeta_(stmt, chrom);
+        chromatograms.push_back(chrom);
+      }
+    }
 
     void MzMLSqliteHandler::prepareSpectra_(sqlite3 *db, std::vector<MSSpectrum>& spectra) const
     {
       sqlite3_stmt * stmt;
-      std::string select_sql;
-      select_sql = "SELECT " \
-                    "SPECTRUM.ID as spec_id," \
-                    "SPECTRUM.NATIVE_ID as spec_native_id," \
-                    "SPECTRUM.MSLEVEL as spec_mslevel," \
-                    "SPECTRUM.RETENTION_TIME as spec_rt," \
-                    "PRECURSOR.CHARGE as precursor_charge," \
-                    "PRECURSOR.DRIFT_TIME as precursor_dt," \
-                    "PRECURSOR.ISOLATION_TARGET as precursor_mz," \
-                    "PRECURSOR.ISOLATION_LOWER as precursor_mz_lower," \
-                    "PRECURSOR.ISOLATION_UPPER as precursor_mz_upper," \
-                    "PRECURSOR.PEPTIDE_SEQUENCE as precursor_seq," \
-                    "PRODUCT.CHARGE as product_charge," \
-                    "PRODUCT.ISOLATION_TARGET as product_mz," \
-                    "PRODUCT.ISOLATION_LOWER as product_mz_lower," \
-                    "PRODUCT.ISOLATION_UPPER as product_mz_upper, " \
-                    "SPECTRUM.SCAN_POLARITY as spec_polarity, " \
-                    "PRECURSOR.ACTIVATION_METHOD as prec_activation, " \
-                    "PRECURSOR.ACTIVATION_ENERGY as prec_activation_en " \
-                    "FROM SPECTRUM " \
-                    "LEFT JOIN PRECURSOR ON SPECTRUM.ID = PRECURSOR.SPECTRUM_ID " \
-                    "LEFT JOIN PRODUCT ON SPECTRUM.ID = PRODUCT.SPECTRUM_ID " \
-                    ";";
+      std::string select_sql = getSpectrumMetaSql_() + ";";
 
       // See https://www.sqlite.org/c3ref/column_blob.html
       // The pointers returned are valid until a type conversion occurs as
@@ -737,60 +1066,39 @@ namespace OpenMS
       // sqlite3_free().
 
       sqlite3_prepare(db, select_sql.c_str(), -1, &stmt, nullptr);
-      sqlite3_step( stmt );
 
-      while (sqlite3_column_type( stmt, 0 ) != SQLITE_NULL)
+      while (sqlite3_step(stmt) == SQLITE_ROW)
       {
         MSSpectrum spec;
-
-        const unsigned char * native_id = sqlite3_column_text(stmt, 1);
-        spec.setNativeID( std::string(reinterpret_cast<const char*>(native_id), sqlite3_column_bytes(stmt, 1)));
-        String peptide_sequence;
-
-        if (sqlite3_column_type(stmt, 2) != SQLITE_NULL) spec.setMSLevel(sqlite3_column_int(stmt, 2));
-        if (sqlite3_column_type(stmt, 3) != SQLITE_NULL) spec.setRT(sqlite3_column_double(stmt, 3));
-
-        OpenMS::Precursor precursor;
-        OpenMS::Product product;
-        if (sqlite3_column_type(stmt, 4) != SQLITE_NULL) precursor.setCharge(sqlite3_column_int(stmt, 4));
-        if (sqlite3_column_type(stmt, 5) != SQLITE_NULL) precursor.setDriftTime(sqlite3_column_double(stmt, 5));
-        if (sqlite3_column_type(stmt, 6) != SQLITE_NULL) precursor.setMZ(sqlite3_column_double(stmt, 6));
-        if (sqlite3_column_type(stmt, 7) != SQLITE_NULL) precursor.setIsolationWindowLowerOffset(sqlite3_column_double(stmt, 7));
-        if (sqlite3_column_type(stmt, 8) != SQLITE_NULL) precursor.setIsolationWindowUpperOffset(sqlite3_column_double(stmt, 8));
-        if (sqlite3_column_type(stmt, 9) != SQLITE_NULL) 
-        {
-          const unsigned char * pepseq = sqlite3_column_text(stmt, 9);
-          peptide_sequence = std::string(reinterpret_cast<const char*>(pepseq), sqlite3_column_bytes(stmt, 9));
-          precursor.setMetaValue("peptide_sequence", peptide_sequence);
-        }
-        // if (sqlite3_column_type(stmt, 10) != SQLITE_NULL) product.setCharge(sqlite3_column_int(stmt, 10));
-        if (sqlite3_column_type(stmt, 11) != SQLITE_NULL) product.setMZ(sqlite3_column_double(stmt, 11));
-        if (sqlite3_column_type(stmt, 12) != SQLITE_NULL) product.setIsolationWindowLowerOffset(sqlite3_column_double(stmt, 12));
-        if (sqlite3_column_type(stmt, 13) != SQLITE_NULL) product.setIsolationWindowUpperOffset(sqlite3_column_double(stmt, 13));
-        if (sqlite3_column_type(stmt, 14) != SQLITE_NULL) 
-        {
-          int pol = sqlite3_column_int(stmt, 14);
-          if (pol == 0) spec.getInstrumentSettings().setPolarity(IonSource::NEGATIVE);
-          else spec.getInstrumentSettings().setPolarity(IonSource::POSITIVE);
-        }
-        if (sqlite3_column_type(stmt, 15) != SQLITE_NULL && sqlite3_column_int(stmt, 15) != -1
-            && sqlite3_column_int(stmt, 15) < static_cast<int>(OpenMS::Precursor::SIZE_OF_ACTIVATIONMETHOD))
-        {
-          precursor.getActivationMethods().insert(static_cast<OpenMS::Precursor::ActivationMethod>(sqlite3_column_int(stmt, 15)));
-        }
-        if (sqlite3_column_type(stmt, 16) != SQLITE_NULL) precursor.setActivationEnergy(sqlite3_column_double(stmt, 16));
-
-        if (sqlite3_column_type(stmt, 6) != SQLITE_NULL) spec.getPrecursors().push_back(precursor);
-        if (sqlite3_column_type(stmt, 11) != SQLITE_NULL) spec.getProducts().push_back(product);
+        fillSpectrumMeta_(stmt, spec);
         spectra.push_back(spec);
-
-        sqlite3_step( stmt );
       }
 
       // free memory
       sqlite3_finalize(stmt);
     }
 
+    void MzMLSqliteHandler::prepareSpectra_(std::vector<MSSpectrum>& spectra, const std::vector<int> & indices) const
+    {
+      sqlite3_stmt* stmt = getCachedStatement_(getSpectrumMetaSql_() + "WHERE SPECTRUM.ID = ?;");
+      StatementResetGuard_ guard(stmt);
+
+      spectra.reserve(spectra.size() + indices.size());
+      for (Size k = 0; k < indices.size(); k++)
+      {
+        sqlite3_reset(stmt);
+        sqlite3_bind_int(stmt, 1, indices[k]);
+        if (sqlite3_step(stmt) != SQLITE_ROW)
+        {
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+              String("Spectrum ") + indices[k] + " does not exist");
+        }
+        MSSpectrum spec;
+        fillSpectrumMeta_(stmt, spec);
+        spectra.push_back(spec);
+      }
+    }
+
     void MzMLSqliteHandler::writeExperiment(const MSExperiment & exp)
     {
 
@@ -858,6 +1166,9 @@ namespace OpenMS
 
     void MzMLSqliteHandler::createTables()
     {
+      // release the read connection before deleting the file
+      closeReadDB_();
+
       // delete file if present
       QFile file (filename_.toQString());
       file.remove();
@@ -967,11 +1278,14 @@ namespace OpenMS
 
         "CREATE INDEX chrom_run_idx ON CHROMATOGRAM(RUN_ID);" \
 
-        "CREATE INDEX product_chr_idx ON DATA(CHROMATOGRAM_ID);" \
-        "CREATE INDEX product_sp_idx ON DATA(SPECTRUM_ID);" \
+        "CREATE INDEX product_chr_idx ON PRODUCT(CHROMATOGRAM_ID);" \
+        "CREATE INDEX product_sp_idx ON PRODUCT(SPECTRUM_ID);" \
+
+        "CREATE INDEX precursor_chr_idx ON PRECURSOR(CHROMATOGRAM_ID);" \
+        "CREATE INDEX precursor_sp_idx ON PRECURSOR(SPECTRUM_ID);" \
 
-        "CREATE INDEX precursor_chr_idx ON DATA(CHROMATOGRAM_ID);" \
-        "CREATE INDEX precursor_sp_idx ON DATA(SPECTRUM_ID);";
+        // precursor isolation window (used to select the spectra of a SWATH window)
+        "CREATE INDEX precursor_target_idx ON PRECURSOR(ISOLATION_TARGET);";
 
       // Execute SQL statement
       char *zErrMsg = nullptr;
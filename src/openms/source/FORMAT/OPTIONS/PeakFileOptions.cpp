@@ -59,10 +59,12 @@ namespace OpenMS
     sort_chromatograms_by_rt_(true),
     fill_data_(true),
     write_index_(true),
+    parallel_writing_(false),
     np_config_mz_(),
     np_config_int_(),
     np_config_fda_(),
-    maximal_data_pool_size_(100)
+    maximal_data_pool_size_(100),
+    pipelined_processing_(false)
   {
   }
 
@@ -87,10 +89,12 @@ namespace OpenMS
     sort_chromatograms_by_rt_(options.sort_chromatograms_by_rt_),
     fill_data_(options.fill_data_),
     write_index_(options.write_index_),
+    parallel_writing_(options.parallel_writing_),
     np_config_mz_(options.np_config_mz_),
     np_config_int_(options.np_config_int_),
     np_config_fda_(options.np_config_fda_),
-    maximal_data_pool_size_(options.maximal_data_pool_size_)
+    maximal_data_pool_size_(options.maximal_data_pool_size_),
+    pipelined_processing_(options.pipelined_processing_)
   {
   }
 
@@ -306,6 +310,16 @@ namespace OpenMS
     write_index_ = write_index;
   }
 
+  bool PeakFileOptions::getParallelWriting() const
+  {
+    return parallel_writing_;
+  }
+
+  void PeakFileOptions::setParallelWriting(bool parallel)
+  {
+    parallel_writing_ = parallel;
+  }
+
   MSNumpressCoder::NumpressConfig PeakFileOptions::getNumpressConfigurationMassTime() const
   {
     return np_config_mz_;
@@ -350,6 +364,16 @@ namespace OpenMS
     maximal_data_pool_size_ = size;
   }
 
+  bool PeakFileOptions::getPipelinedProcessing() const
+  {
+    return pipelined_processing_;
+  }
+
+  void PeakFileOptions::setPipelinedProcessing(bool pipelined)
+  {
+    pipelined_processing_ = pipelined;
+  }
+
   bool PeakFileOptions::hasFilters()
   {
     return (has_rt_range_ || hasMSLevels());
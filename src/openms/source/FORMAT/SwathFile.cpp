@@ -35,8 +35,10 @@
 #include <OpenMS/FORMAT/SwathFile.h>
 
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessSqMass.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCachedColumnar.h>
 #include <OpenMS/OPENSWATHALGO/DATAACCESS/DataStructures.h>
 #include <OpenMS/FORMAT/DATAACCESS/MSDataChainingConsumer.h>
+#include <OpenMS/FORMAT/DATAACCESS/MSDataColumnarCachedConsumer.h>
 #include <OpenMS/FORMAT/DATAACCESS/SwathFileConsumer.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
 #include <OpenMS/FORMAT/MzXMLFile.h>
@@ -97,6 +99,10 @@ namespace OpenMS
         // Cache and load the exp (metadata only) file again
         spectra_ptr = doCacheFile_(file_list[i], tmp, tmp_fname, exp);
       }
+      else if (readoptions == "cacheColumnar")
+      {
+        spectra_ptr = doCacheFileColumnar_(file_list[i], tmp, tmp_fname, exp);
+      }
       else
       {
         throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
@@ -174,6 +180,10 @@ namespace OpenMS
     {
       dataConsumer = std::make_shared<CachedSwathFileConsumer>(known_window_boundaries, tmp, tmp_fname, nr_ms1_spectra, swath_counter);
     }
+    else if (readoptions == "cacheColumnar")
+    {
+      dataConsumer = std::make_shared<ColumnarCachedSwathFileConsumer>(known_window_boundaries, tmp, tmp_fname);
+    }
     else if (readoptions == "split")
     {
       // WARNING: swath_maps will be empty when querying retrieveSwathMaps()
@@ -197,7 +207,9 @@ namespace OpenMS
     }
     consumer_list.push_back(dataConsumer.get());
     MSDataChainingConsumer chaining_consumer(consumer_list);
-    MzMLFile().transform(file, &chaining_consumer);
+    MzMLFile f;
+    f.getOptions().setPipelinedProcessing(true); // overlap parsing with decoding
+    f.transform(file, &chaining_consumer);
 
     LOG_DEBUG << "Finished parsing Swath file " << std::endl;
     std::vector<OpenSwath::SwathMap> swath_maps;
@@ -245,6 +257,11 @@ namespace OpenMS
       dataConsumer = new CachedSwathFileConsumer(known_window_boundaries, tmp, tmp_fname, nr_ms1_spectra, swath_counter);
       MzXMLFile().transform(file, dataConsumer);
     }
+    else if (readoptions == "cacheColumnar")
+    {
+      dataConsumer = new ColumnarCachedSwathFileConsumer(known_window_boundaries, tmp, tmp_fname);
+      MzXMLFile().transform(file, dataConsumer);
+    }
     else if (readoptions == "split")
     {
       dataConsumer = new MzMLSwathFileConsumer(known_window_boundaries, tmp, tmp_fname, nr_ms1_spectra, swath_counter);
@@ -271,19 +288,21 @@ namespace OpenMS
 
     OpenMS::Internal::MzMLSqliteSwathHandler sql_mass_reader(file);
     std::vector<OpenSwath::SwathMap> swath_maps = sql_mass_reader.readSwathWindows();
+
+    // read the spectrum index only once and derive the per-window access objects from it
+    OpenMS::Internal::MzMLSqliteHandler handler(file);
+    OpenMS::SpectrumAccessSqMass full_access(handler);
     for (Size k = 0; k < swath_maps.size(); k++)
     {
       std::vector<int> indices = sql_mass_reader.readSpectraForWindow(swath_maps[k]);
-      OpenMS::Internal::MzMLSqliteHandler handler(file);
-      OpenSwath::SpectrumAccessPtr sptr(new OpenMS::SpectrumAccessSqMass(handler, indices));
+      OpenSwath::SpectrumAccessPtr sptr(new OpenMS::SpectrumAccessSqMass(full_access, indices));
       swath_maps[k].sptr = sptr;
     }
 
     // also store the MS1 map
     OpenSwath::SwathMap ms1_map;
     std::vector<int> indices = sql_mass_reader.readMS1Spectra();
-    OpenMS::Internal::MzMLSqliteHandler handler(file);
-    OpenSwath::SpectrumAccessPtr sptr(new OpenMS::SpectrumAccessSqMass(handler, indices));
+    OpenSwath::SpectrumAccessPtr sptr(new OpenMS::SpectrumAccessSqMass(full_access, indices));
     ms1_map.sptr = sptr;
     ms1_map.ms1 = true;
     swath_maps.push_back(ms1_map);
@@ -306,7 +325,9 @@ namespace OpenMS
     // Create new consumer, transform infile, write out metadata
     {
       MSDataCachedConsumer cachedConsumer(cached_file, true);
-      MzMLFile().transform(in, &cachedConsumer, *experiment_metadata.get());
+      MzMLFile f;
+      f.getOptions().setPipelinedProcessing(true); // overlap parsing with decoding
+      f.transform(in, &cachedConsumer, *experiment_metadata.get());
       Internal::CachedMzMLHandler().writeMetadata(*experiment_metadata.get(), meta_file, true);
     } // ensure that filestream gets closed
 
@@ -315,6 +336,23 @@ namespace OpenMS
     return SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp);
   }
 
+  /// Cache a file to disk in the columnar format
+  OpenSwath::SpectrumAccessPtr SwathFile::doCacheFileColumnar_(const String& in, const String& tmp, const String& tmp_fname,
+    boost::shared_ptr<PeakMap > experiment_metadata)
+  {
+    String cached_file = tmp + tmp_fname + ".columnar.cached";
+
+    // Create new consumer, transform infile (experiment_metadata only keeps the meta data)
+    {
+      MSDataColumnarCachedConsumer cachedConsumer(cached_file, true);
+      MzMLFile f;
+      f.getOptions().setPipelinedProcessing(true); // overlap parsing with decoding
+      f.transform(in, &cachedConsumer, *experiment_metadata.get());
+    } // ensure that the offset table gets written and the file closed
+
+    return OpenSwath::SpectrumAccessPtr(new SpectrumAccessOpenMSCachedColumnar(cached_file));
+  }
+
   /// Only read the meta data from a file and use it to populate exp_meta
   boost::shared_ptr< PeakMap > SwathFile::populateMetaData_(const String& file)
   {
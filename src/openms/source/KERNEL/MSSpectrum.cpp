@@ -254,6 +254,93 @@ namespace OpenMS
     }
   }
 
+  void MSSpectrum::MZBegin(const std::vector<MSSpectrum::CoordinateType>& mz_queries, std::vector<Size>& result) const
+  {
+    result.resize(mz_queries.size());
+
+    const ConstIterator first = ContainerType::begin();
+    const ConstIterator last = ContainerType::end();
+    ConstIterator lo = first;
+
+    for (Size q = 0; q < mz_queries.size(); ++q)
+    {
+      const CoordinateType mz = mz_queries[q];
+
+      // queries are sorted, so the lower bound can only move to the right:
+      // gallop from the previous hit (cheap for dense queries) and finish
+      // with a binary search within the bracketed range
+      if (lo != last && lo->getMZ() < mz)
+      {
+        std::ptrdiff_t step = 1;
+        std::ptrdiff_t remaining = last - lo;
+        while (step < remaining && (lo + step)->getMZ() < mz)
+        {
+          lo += step;
+          remaining -= step;
+          step *= 2;
+        }
+        // here lo->getMZ() < mz and the lower bound is in (lo, hi]
+        ConstIterator hi = step < remaining ? lo + step : last;
+        lo = MZBegin(lo + 1, mz, hi);
+      }
+      result[q] = Size(lo - first);
+    }
+  }
+
+  void MSSpectrum::findNearest(const std::vector<MSSpectrum::CoordinateType>& mz_queries, std::vector<Size>& result) const
+  {
+    if (mz_queries.empty())
+    {
+      result.clear();
+      return;
+    }
+    // no peak => no search
+    if (ContainerType::size() == 0) throw Exception::Precondition(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "There must be at least one peak to determine the nearest peak!");
+
+    MZBegin(mz_queries, result);
+
+    const Size n = ContainerType::size();
+    for (Size q = 0; q < result.size(); ++q)
+    {
+      Size& i = result[q];
+      // border cases
+      if (i == 0) continue;
+      if (i == n)
+      {
+        i = n - 1;
+        continue;
+      }
+      // the peak before or the current peak are closest (ties resolved to the left as in findNearest(mz))
+      const CoordinateType mz = mz_queries[q];
+      if (!(std::fabs(ContainerType::operator[](i).getMZ() - mz) < std::fabs(ContainerType::operator[](i - 1).getMZ() - mz)))
+      {
+        --i;
+      }
+    }
+  }
+
+  void MSSpectrum::findNearest(const std::vector<MSSpectrum::CoordinateType>& mz_queries, MSSpectrum::CoordinateType tolerance,
+                               bool tolerance_ppm, std::vector<Int>& result) const
+  {
+    if (ContainerType::empty())
+    {
+      result.assign(mz_queries.size(), -1);
+      return;
+    }
+
+    std::vector<Size> nearest;
+    findNearest(mz_queries, nearest);
+
+    result.resize(mz_queries.size());
+    for (Size q = 0; q < mz_queries.size(); ++q)
+    {
+      const CoordinateType mz = mz_queries[q];
+      const CoordinateType tol = tolerance_ppm ? mz * tolerance * 1e-6 : tolerance;
+      const CoordinateType found_mz = ContainerType::operator[](nearest[q]).getMZ();
+      result[q] = (found_mz >= mz - tol && found_mz <= mz + tol) ? static_cast<Int>(nearest[q]) : -1;
+    }
+  }
+
   void MSSpectrum::sortByPosition()
   {
     if (float_data_arrays_.empty() && string_data_arrays_.empty() && integer_data_arrays_.empty())
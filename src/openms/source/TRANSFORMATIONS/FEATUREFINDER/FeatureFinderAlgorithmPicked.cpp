@@ -49,6 +49,10 @@
 
 #include <QtCore/QDir>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #ifdef _OPENMP
 #endif
 
@@ -269,15 +273,20 @@ namespace OpenMS
       intensity_rt_step_ = (map_.getMaxRT() - rt_start) / (double)intensity_bins_;
       intensity_mz_step_ = (map_.getMaxMZ() - mz_start) / (double)intensity_bins_;
       intensity_thresholds_.resize(intensity_bins_);
-      for (Size rt = 0; rt < intensity_bins_; ++rt)
+      // the RT bins are independent of each other
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+      for (SignedSize signed_rt = 0; signed_rt < (SignedSize)intensity_bins_; ++signed_rt)
       {
+        const Size rt = signed_rt;
         intensity_thresholds_[rt].resize(intensity_bins_);
         double min_rt = rt_start + rt * intensity_rt_step_;
         double max_rt = rt_start + (rt + 1) * intensity_rt_step_;
         std::vector<double> tmp;
         for (Size mz = 0; mz < intensity_bins_; ++mz)
         {
-          ff_->setProgress(rt * intensity_bins_ + mz);
+          IF_MASTERTHREAD ff_->setProgress(rt * intensity_bins_ + mz);
           double min_mz = mz_start + mz * intensity_mz_step_;
           double max_mz = mz_start + (mz + 1) * intensity_mz_step_;
           //std::cout << "rt range: " << min_rt << " - " << max_rt << std::endl;
@@ -303,7 +312,10 @@ namespace OpenMS
       }
 
       //store intensity score in PeakInfo
-      for (Size s = 0; s < map_.size(); ++s)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+      for (SignedSize s = 0; s < (SignedSize)map_.size(); ++s)
       {
         for (Size p = 0; p < map_[s].size(); ++p)
         {
@@ -322,9 +334,14 @@ namespace OpenMS
       Size end_iteration = map_.size() - std::min((Size) min_spectra_, map_.size());
       ff_->startProgress(min_spectra_, end_iteration, "Precalculating mass trace scores");
       // skip first and last scans since we cannot extend the mass traces there
-      for (Size s = min_spectra_; s < end_iteration; ++s)
+      // (each spectrum only stores scores for its own peaks)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+      for (SignedSize signed_s = min_spectra_; signed_s < (SignedSize)end_iteration; ++signed_s)
       {
-        ff_->setProgress(s);
+        const Size s = signed_s;
+        IF_MASTERTHREAD ff_->setProgress(s);
         const SpectrumType& spectrum = map_[s];
         //iterate over all peaks of the scan
         for (Size p = 0; p < spectrum.size(); ++p)
@@ -468,38 +485,50 @@ namespace OpenMS
       //Step 3.1: Precalculate IsotopePattern score
       //-----------------------------------------------------------
       ff_->startProgress(0, map_.size(), String("Calculating isotope pattern scores for charge ") + String(c));
-      for (Size s = 0; s < map_.size(); ++s)
+      // The patterns of spectrum s contain peaks of the spectra s - 1, s and
+      // s + 1 only. Spectra that are three apart thus update disjoint scores
+      // and are processed in parallel, one residue class (mod 3) after the
+      // other. As only the maximum score is kept, the result does not depend
+      // on the order. (The debug log requires a single thread.)
+      for (Size phase = 0; phase < 3; ++phase)
       {
-        ff_->setProgress(s);
-        const SpectrumType& spectrum = map_[s];
-        for (Size p = 0; p < spectrum.size(); ++p)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 10) if (!debug_)
+#endif
+        for (SignedSize signed_s = phase; signed_s < (SignedSize)map_.size(); signed_s += 3)
         {
-          double mz = spectrum[p].getMZ();
+          const Size s = signed_s;
+          IF_MASTERTHREAD ff_->setProgress(s);
+          const SpectrumType& spectrum = map_[s];
+          for (Size p = 0; p < spectrum.size(); ++p)
+          {
+            double mz = spectrum[p].getMZ();
 
-          //get isotope distribution for this mass
-          const TheoreticalIsotopePattern& isotopes = getIsotopeDistribution_(mz * c);
-          //determine highest peak in isotope distribution
-          Size max_isotope = std::max_element(isotopes.intensity.begin(), isotopes.intensity.end()) - isotopes.intensity.begin();
-          //Look up expected isotopic peaks (in the current spectrum or adjacent spectra)
-          Size peak_index = spectrum.findNearest(mz - ((double)(isotopes.size() + 1) / c));
-          IsotopePattern pattern(isotopes.size());
+            //get isotope distribution for this mass
+            const TheoreticalIsotopePattern& isotopes = getIsotopeDistribution_(mz * c);
+            //determine highest peak in isotope distribution
+            Size max_isotope = std::max_element(isotopes.intensity.begin(), isotopes.intensity.end()) - isotopes.intensity.begin();
+            //Look up expected isotopic peaks (in the current spectrum or adjacent spectra)
+            Size peak_index = spectrum.findNearest(mz - ((double)(isotopes.size() + 1) / c));
+            IsotopePattern pattern(isotopes.size());
 
-          for (Size i = 0; i < isotopes.size(); ++i)
-          {
-            double isotope_pos = mz + ((double)i - max_isotope) / c;
-            findIsotope_(isotope_pos, s, pattern, i, peak_index);
-          }
+            for (Size i = 0; i < isotopes.size(); ++i)
+            {
+              double isotope_pos = mz + ((double)i - max_isotope) / c;
+              findIsotope_(isotope_pos, s, pattern, i, peak_index);
+            }
 
-          double pattern_score = isotopeScore_(isotopes, pattern, true);
+            double pattern_score = isotopeScore_(isotopes, pattern, true);
 
-          //update pattern scores of all contained peaks (if necessary)
-          if (pattern_score > 0.0)
-          {
-            for (Size i = 0; i < pattern.peak.size(); ++i)
+            //update pattern scores of all contained peaks (if necessary)
+            if (pattern_score > 0.0)
             {
-              if (pattern.peak[i] >= 0 && pattern_score > map_[pattern.spectrum[i]].getFloatDataArrays()[meta_index_isotope][pattern.peak[i]])
+              for (Size i = 0; i < pattern.peak.size(); ++i)
               {
-                map_[pattern.spectrum[i]].getFloatDataArrays()[meta_index_isotope][pattern.peak[i]] = pattern_score;
+                if (pattern.peak[i] >= 0 && pattern_score > map_[pattern.spectrum[i]].getFloatDataArrays()[meta_index_isotope][pattern.peak[i]])
+                {
+                  map_[pattern.spectrum[i]].getFloatDataArrays()[meta_index_isotope][pattern.peak[i]] = pattern_score;
+                }
               }
             }
           }
@@ -514,10 +543,17 @@ namespace OpenMS
       ff_->startProgress(min_spectra_, end_of_iteration, String("Finding seeds for charge ") + String(c));
 
       double min_seed_score = param_.getValue("seed:min_score");
+      // seeds of each spectrum (collected in parallel, concatenated in spectrum order)
+      std::vector<std::vector<Seed> > seeds_per_spectrum(map_.size());
       //do nothing for the first few and last few spectra as the scans required to search for traces are missing
-      for (Size s = min_spectra_; s < end_of_iteration; ++s)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+      for (SignedSize signed_s = min_spectra_; signed_s < (SignedSize)end_of_iteration; ++signed_s)
       {
-        ff_->setProgress(s);
+        const Size s = signed_s;
+        IF_MASTERTHREAD ff_->setProgress(s);
+        std::vector<Seed>& spectrum_seeds = seeds_per_spectrum[s];
 
         //iterate over peaks
         for (Size p = 0; p < map_[s].size(); ++p)
@@ -536,7 +572,7 @@ namespace OpenMS
               seed.spectrum = s;
               seed.peak = p;
               seed.intensity = map_[s][p].getIntensity();
-              seeds.push_back(seed);
+              spectrum_seeds.push_back(seed);
             }
             //user-specified seeds: overall score greater than USER min seed score
             else if (user_seeds && overall_score >= user_seed_score)
@@ -557,7 +593,7 @@ namespace OpenMS
                   seed.spectrum = s;
                   seed.peak = p;
                   seed.intensity = map_[s][p].getIntensity();
-                  seeds.push_back(seed);
+                  spectrum_seeds.push_back(seed);
                   break;
                 }
               }
@@ -565,6 +601,10 @@ namespace OpenMS
           }
         }
       }
+      for (Size s = 0; s < seeds_per_spectrum.size(); ++s)
+      {
+        seeds.insert(seeds.end(), seeds_per_spectrum[s].begin(), seeds_per_spectrum[s].end());
+      }
       //sort seeds according to intensity
       std::sort(seeds.rbegin(), seeds.rend());
       //create and store seeds map and selected peak map
@@ -610,13 +650,31 @@ namespace OpenMS
       std::map<Size, std::vector<Size> > seeds_in_features;
       typedef std::map<Size, Feature> FeatureMapType;
       FeatureMapType tmp_feature_map;
+
+      // Every thread stores its results (features, contained seeds, abort
+      // reasons) in its own buffers, which are merged (by seed index)
+      // after all seeds were processed.
+      Size num_threads = 1;
+#ifdef _OPENMP
+      num_threads = omp_get_max_threads();
+#endif
+      std::vector<FeatureMapType> thread_feature_maps(num_threads);
+      std::vector<std::map<Size, std::vector<Size> > > thread_seeds_in_features(num_threads);
+      std::vector<std::vector<std::pair<Size, String> > > thread_aborts(num_threads);
+
       int gl_progress = 0;
       ff_->startProgress(0, seeds.size(), String("Extending seeds for charge ") + String(c));
 #ifdef _OPENMP
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic, 1)
 #endif
       for (SignedSize i = 0; i < (SignedSize)seeds.size(); ++i)
       {
+        Size thread_num = 0;
+#ifdef _OPENMP
+        thread_num = omp_get_thread_num();
+#endif
+        std::vector<std::pair<Size, String> >& aborts = thread_aborts[thread_num];
+
         //------------------------------------------------------------------
         //Step 3.3.1:
         //Extend all mass traces
@@ -646,7 +704,7 @@ namespace OpenMS
 
         if (isotope_fit_quality < min_isotope_fit_)
         {
-          abort_(seeds[i], "Could not find good enough isotope pattern containing the seed");
+          aborts.push_back(std::make_pair(i, "Could not find good enough isotope pattern containing the seed"));
           //continue;
         }
         else
@@ -662,7 +720,7 @@ namespace OpenMS
 
           if (!traces.isValid(seed_mz, trace_tolerance_))
           {
-            abort_(seeds[i], "Could not extend seed");
+            aborts.push_back(std::make_pair(i, "Could not extend seed"));
             //continue;
           }
           else
@@ -672,14 +730,8 @@ namespace OpenMS
             //Step 3.3.2:
             //Gauss/EGH fit (first fit to find the feature boundaries)
             //------------------------------------------------------------------
-            Int plot_nr = -1;
-
-#ifdef _OPENMP
-#pragma omp critical (FeatureFinderAlgorithmPicked_PLOTNR)
-#endif
-            {
-              plot_nr = ++plot_nr_global;
-            }
+            // numbered by seed (independent of the thread scheduling)
+            Int plot_nr = plot_nr_global + 1 + (Int)i;
 
             //------------------------------------------------------------------
 
@@ -734,15 +786,13 @@ namespace OpenMS
             double final_score = 0.0;
 
             bool feature_ok = checkFeatureQuality_(fitter, new_traces, seed_mz, min_feature_score, error_msg, fit_score, correlation, final_score);
+            //write debug output of feature
+            if (debug_)
+            {
 #ifdef _OPENMP
 #pragma omp critical (FeatureFinderAlgorithmPicked_DEBUG)
 #endif
-            {
-              //write debug output of feature
-              if (debug_)
-              {
-                writeFeatureDebugInfo_(fitter, traces, new_traces, feature_ok, error_msg, final_score, plot_nr, peak);
-              }
+              writeFeatureDebugInfo_(fitter, traces, new_traces, feature_ok, error_msg, final_score, plot_nr, peak);
             }
             traces = new_traces;
 
@@ -750,7 +800,7 @@ namespace OpenMS
             //validity output
             if (!feature_ok)
             {
-              abort_(seeds[i], error_msg);
+              aborts.push_back(std::make_pair(i, error_msg));
               //continue;
             }
             else
@@ -820,12 +870,7 @@ namespace OpenMS
                 f.getConvexHulls().push_back(traces[j].getConvexhull());
               }
 
-#ifdef _OPENMP
-#pragma omp critical (FeatureFinderAlgorithmPicked_TMPFEATUREMAP)
-#endif
-              {
-                tmp_feature_map[i] = f;
-              }
+              thread_feature_maps[thread_num][i] = f;
 
               //----------------------------------------------------------------
               //Remember all seeds that lie inside the convex hull of the new feature
@@ -836,18 +881,33 @@ namespace OpenMS
                 double mz = map_[seeds[j].spectrum][seeds[j].peak].getMZ();
                 if (bb.encloses(rt, mz) && f.encloses(rt, mz))
                 {
-#ifdef _OPENMP
-#pragma omp critical (FeatureFinderAlgorithmPicked_SEEDSINFEATURES)
-#endif
-                  {
-                    seeds_in_features[i].push_back(j);
-                  }
+                  thread_seeds_in_features[thread_num][i].push_back(j);
                 }
               }
             }
           }
         } // three if/else statements instead of continue (disallowed in OpenMP)
       } // end of OPENMP over seeds
+      plot_nr_global += seeds.size();
+
+      // merge the results of all threads (each seed was processed by exactly one thread)
+      std::vector<String> abort_reasons(seeds.size());
+      for (Size t = 0; t < num_threads; ++t)
+      {
+        tmp_feature_map.insert(thread_feature_maps[t].begin(), thread_feature_maps[t].end());
+        seeds_in_features.insert(thread_seeds_in_features[t].begin(), thread_seeds_in_features[t].end());
+        for (Size k = 0; k < thread_aborts[t].size(); ++k)
+        {
+          abort_reasons[thread_aborts[t][k].first] = thread_aborts[t][k].second;
+        }
+      }
+      for (Size i = 0; i < seeds.size(); ++i)
+      {
+        if (!abort_reasons[i].empty())
+        {
+          abort_(seeds[i], abort_reasons[i]);
+        }
+      }
 
       // Here we have to evaluate which seeds are already contained in
       // features of seeds with higher intensities. Only if the seed is not
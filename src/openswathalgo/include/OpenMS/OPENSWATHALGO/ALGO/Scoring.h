@@ -119,6 +119,15 @@ public:
     OPENSWATHALGO_DLLAPI XCorrArrayType normalizedCrossCorrelation(std::vector<double>& data1,
                                                                    std::vector<double>& data2, const int& maxdelay, const int& lag);
 
+    /** @brief Calculate crosscorrelation on std::vector data that is already standardized (see standardize_data)
+
+        Same as normalizedCrossCorrelation, but the input is not modified.
+        This allows to standardize each data vector only once when computing
+        the crosscorrelation of many pairs.
+    */
+    OPENSWATHALGO_DLLAPI XCorrArrayType normalizedCrossCorrelationPost(const std::vector<double>& normalized_data1,
+                                                                       const std::vector<double>& normalized_data2, const int maxdelay, const int lag);
+
     /// Calculate crosscorrelation on std::vector data without normalization
     OPENSWATHALGO_DLLAPI XCorrArrayType calculateCrossCorrelation(const std::vector<double>& data1,
                                                                   const std::vector<double>& data2, const int& maxdelay, const int& lag);
@@ -64,132 +64,151 @@ namespace OpenSwath
     return xcorr_precursor_combined_matrix_;
   }
 
-  void MRMScoring::initializeXCorrMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<String>& native_ids)
+  namespace
   {
-    std::vector<double> intensityi, intensityj;
-    xcorr_matrix_.resize(native_ids.size());
-    for (std::size_t i = 0; i < native_ids.size(); i++)
+    // Retrieve the intensities of all features and standardize them (each feature only once)
+    void getStandardizedIntensities(const std::vector<MRMScoring::FeatureType>& features,
+                                    std::vector<std::vector<double> >& intensities)
     {
-      String native_id = native_ids[i];
-      FeatureType fi = mrmfeature->getFeature(native_id);
-      xcorr_matrix_[i].resize(native_ids.size());
-      intensityi.clear();
-      fi->getIntensity(intensityi);
-      for (std::size_t j = i; j < native_ids.size(); j++)
+      intensities.resize(features.size());
+      for (std::size_t i = 0; i < features.size(); i++)
       {
-        String native_id2 = native_ids[j];
-        FeatureType fj = mrmfeature->getFeature(native_id2);
-        intensityj.clear();
-        fj->getIntensity(intensityj);
-        // compute normalized cross correlation
-        xcorr_matrix_[i][j] = Scoring::normalizedCrossCorrelation(intensityi, intensityj, boost::numeric_cast<int>(intensityi.size()), 1);
+        intensities[i].clear();
+        features[i]->getIntensity(intensities[i]);
+        Scoring::standardize_data(intensities[i]);
+      }
+    }
+
+    // Compute the normalized cross correlation of all pairs (i, j) with j >= i
+    // (or all pairs if full is true; the lower triangle is the mirror image
+    // of the upper triangle and is not computed again)
+    void computeXCorrMatrix(const std::vector<std::vector<double> >& intensities,
+                            MRMScoring::XCorrMatrixType& xcorr_matrix, bool full)
+    {
+      xcorr_matrix.resize(intensities.size());
+      for (std::size_t i = 0; i < intensities.size(); i++)
+      {
+        xcorr_matrix[i].resize(intensities.size());
+        for (std::size_t j = i; j < intensities.size(); j++)
+        {
+          xcorr_matrix[i][j] = Scoring::normalizedCrossCorrelationPost(intensities[i], intensities[j],
+                                                                       boost::numeric_cast<int>(intensities[i].size()), 1);
+        }
+      }
+      if (!full) return;
+
+      for (std::size_t i = 0; i < intensities.size(); i++)
+      {
+        for (std::size_t j = 0; j < i; j++)
+        {
+          // xcorr(j, i) at delay d is xcorr(i, j) at delay -d
+          const MRMScoring::XCorrArrayType& upper = xcorr_matrix[j][i];
+          MRMScoring::XCorrArrayType& lower = xcorr_matrix[i][j];
+          lower.data.resize(upper.data.size());
+          for (std::size_t k = 0; k < upper.data.size(); k++)
+          {
+            const Scoring::XCorrEntry& e = upper.data[upper.data.size() - 1 - k];
+            lower.data[k] = std::make_pair(-e.first, e.second);
+          }
+        }
+      }
+    }
+
+    // Compute the normalized cross correlation of all pairs of set 1 and set 2
+    void computeXCorrContrastMatrix(const std::vector<std::vector<double> >& intensities1,
+                                    const std::vector<std::vector<double> >& intensities2,
+                                    MRMScoring::XCorrMatrixType& xcorr_matrix)
+    {
+      xcorr_matrix.resize(intensities1.size());
+      for (std::size_t i = 0; i < intensities1.size(); i++)
+      {
+        xcorr_matrix[i].resize(intensities2.size());
+        for (std::size_t j = 0; j < intensities2.size(); j++)
+        {
+          xcorr_matrix[i][j] = Scoring::normalizedCrossCorrelationPost(intensities1[i], intensities2[j],
+                                                                       boost::numeric_cast<int>(intensities1[i].size()), 1);
+        }
       }
     }
   }
 
+  void MRMScoring::initializeXCorrMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<String>& native_ids)
+  {
+    std::vector<FeatureType> features;
+    for (std::size_t i = 0; i < native_ids.size(); i++)
+    {
+      features.push_back(mrmfeature->getFeature(native_ids[i]));
+    }
+
+    std::vector<std::vector<double> > intensities;
+    getStandardizedIntensities(features, intensities);
+    computeXCorrMatrix(intensities, xcorr_matrix_, false);
+  }
+
   void MRMScoring::initializeXCorrContrastMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<String>& native_ids_set1, const std::vector<String>& native_ids_set2)
   {
-    std::vector<double> intensityi, intensityj;
-    xcorr_contrast_matrix_.resize(native_ids_set1.size());
+    std::vector<FeatureType> features1, features2;
     for (std::size_t i = 0; i < native_ids_set1.size(); i++)
-    { 
-      String native_id = native_ids_set1[i];
-      FeatureType fi = mrmfeature->getFeature(native_id);
-      xcorr_contrast_matrix_[i].resize(native_ids_set2.size());
-      intensityi.clear();
-      fi->getIntensity(intensityi);
-      for (std::size_t j = 0; j < native_ids_set2.size(); j++)
-      {
-        String native_id2 = native_ids_set2[j];
-        FeatureType fj = mrmfeature->getFeature(native_id2);
-        intensityj.clear();
-        fj->getIntensity(intensityj);
-        // compute normalized cross correlation
-        xcorr_contrast_matrix_[i][j] = Scoring::normalizedCrossCorrelation(intensityi, intensityj, boost::numeric_cast<int>(intensityi.size()), 1);
-      }
+    {
+      features1.push_back(mrmfeature->getFeature(native_ids_set1[i]));
+    }
+    for (std::size_t j = 0; j < native_ids_set2.size(); j++)
+    {
+      features2.push_back(mrmfeature->getFeature(native_ids_set2[j]));
     }
+
+    std::vector<std::vector<double> > intensities1, intensities2;
+    getStandardizedIntensities(features1, intensities1);
+    getStandardizedIntensities(features2, intensities2);
+    computeXCorrContrastMatrix(intensities1, intensities2, xcorr_contrast_matrix_);
   }
 
   void MRMScoring::initializeXCorrPrecursorMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<String>& precursor_ids)
   {
-    std::vector<double> intensityi, intensityj;
-    xcorr_precursor_matrix_.resize(precursor_ids.size());
+    std::vector<FeatureType> features;
     for (std::size_t i = 0; i < precursor_ids.size(); i++)
     {
-      String precursor_id = precursor_ids[i];
-      FeatureType fi = mrmfeature->getPrecursorFeature(precursor_id);
-      xcorr_precursor_matrix_[i].resize(precursor_ids.size());
-      intensityi.clear();
-      fi->getIntensity(intensityi);
-      for (std::size_t j = i; j < precursor_ids.size(); j++)
-      {
-        String precursor_id2 = precursor_ids[j];
-        FeatureType fj = mrmfeature->getPrecursorFeature(precursor_id2);
-        intensityj.clear();
-        fj->getIntensity(intensityj);
-        // compute normalized cross correlation
-        xcorr_precursor_matrix_[i][j] = Scoring::normalizedCrossCorrelation(intensityi, intensityj, boost::numeric_cast<int>(intensityi.size()), 1);
-      }
+      features.push_back(mrmfeature->getPrecursorFeature(precursor_ids[i]));
     }
+
+    std::vector<std::vector<double> > intensities;
+    getStandardizedIntensities(features, intensities);
+    computeXCorrMatrix(intensities, xcorr_precursor_matrix_, false);
   }
 
   void MRMScoring::initializeXCorrPrecursorContrastMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<String>& precursor_ids, const std::vector<String>& native_ids)
   {
-    std::vector<double> intensityi, intensityj;
-    xcorr_precursor_contrast_matrix_.resize(precursor_ids.size());
+    std::vector<FeatureType> features1, features2;
     for (std::size_t i = 0; i < precursor_ids.size(); i++)
-    { 
-      String precursor_id = precursor_ids[i];
-      FeatureType fi = mrmfeature->getPrecursorFeature(precursor_id);
-      xcorr_precursor_contrast_matrix_[i].resize(native_ids.size());
-      intensityi.clear();
-      fi->getIntensity(intensityi);
-      for (std::size_t j = 0; j < native_ids.size(); j++)
-      {
-        String native_id = native_ids[j];
-        FeatureType fj = mrmfeature->getFeature(native_id);
-        intensityj.clear();
-        fj->getIntensity(intensityj);
-        // compute normalized cross correlation
-        xcorr_precursor_contrast_matrix_[i][j] = Scoring::normalizedCrossCorrelation(intensityi, intensityj, boost::numeric_cast<int>(intensityi.size()), 1);
-      }
+    {
+      features1.push_back(mrmfeature->getPrecursorFeature(precursor_ids[i]));
     }
+    for (std::size_t j = 0; j < native_ids.size(); j++)
+    {
+      features2.push_back(mrmfeature->getFeature(native_ids[j]));
+    }
+
+    std::vector<std::vector<double> > intensities1, intensities2;
+    getStandardizedIntensities(features1, intensities1);
+    getStandardizedIntensities(features2, intensities2);
+    computeXCorrContrastMatrix(intensities1, intensities2, xcorr_precursor_contrast_matrix_);
   }
 
   void MRMScoring::initializeXCorrPrecursorCombinedMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<String>& precursor_ids, const std::vector<String>& native_ids)
   {
-    std::vector<double> intensityi, intensityj;
     std::vector<FeatureType> features;
-
     for (std::size_t i = 0; i < precursor_ids.size(); i++)
-    { 
-      String precursor_id = precursor_ids[i];
-      FeatureType fi = mrmfeature->getPrecursorFeature(precursor_id);
-      features.push_back(fi);
+    {
+      features.push_back(mrmfeature->getPrecursorFeature(precursor_ids[i]));
     }
     for (std::size_t j = 0; j < native_ids.size(); j++)
     {
-      String native_id = native_ids[j];
-      FeatureType fj = mrmfeature->getFeature(native_id);
-      features.push_back(fj);
+      features.push_back(mrmfeature->getFeature(native_ids[j]));
     }
 
-    xcorr_precursor_combined_matrix_.resize(features.size());
-    for (std::size_t i = 0; i < features.size(); i++)
-    { 
-      FeatureType fi = features[i];
-      xcorr_precursor_combined_matrix_[i].resize(features.size());
-      intensityi.clear();
-      fi->getIntensity(intensityi);
-      for (std::size_t j = 0; j < features.size(); j++)
-      {
-        FeatureType fj = features[j];
-        intensityj.clear();
-        fj->getIntensity(intensityj);
-        // compute normalized cross correlation
-        xcorr_precursor_combined_matrix_[i][j] = Scoring::normalizedCrossCorrelation(intensityi, intensityj, boost::numeric_cast<int>(intensityi.size()), 1);
-      }
-    }
+    std::vector<std::vector<double> > intensities;
+    getStandardizedIntensities(features, intensities);
+    computeXCorrMatrix(intensities, xcorr_precursor_combined_matrix_, true);
   }
 
   // see /IMSB/users/reiterl/bin/code/biognosys/trunk/libs/mrm_libs/MRM_pgroup.pm
@@ -35,6 +35,7 @@
 #include <OpenMS/OPENSWATHALGO/ALGO/Scoring.h>
 #include <OpenMS/OPENSWATHALGO/Macros.h>
 #include <cmath>
+#include <algorithm>
 
 #include <boost/numeric/conversion/cast.hpp>
 
@@ -163,6 +164,17 @@ namespace OpenSwath
       return result;
     }
 
+    XCorrArrayType normalizedCrossCorrelationPost(const std::vector<double>& normalized_data1,
+                                                  const std::vector<double>& normalized_data2, const int maxdelay, const int lag)
+    {
+      XCorrArrayType result = calculateCrossCorrelation(normalized_data1, normalized_data2, maxdelay, lag);
+      for (XCorrArrayType::iterator it = result.begin(); it != result.end(); ++it)
+      {
+        it->second = it->second / normalized_data1.size();
+      }
+      return result;
+    }
+
     XCorrArrayType calculateCrossCorrelation(const std::vector<double>& data1,
                                              const std::vector<double>& data2, const int& maxdelay, const int& lag)
     {
@@ -171,19 +183,18 @@ namespace OpenSwath
       XCorrArrayType result;
       result.data.reserve( (size_t)std::ceil((2*maxdelay + 1) / lag));
       int datasize = boost::numeric_cast<int>(data1.size());
-      int i, j, delay;
+      const double* x = data1.data();
+      const double* y = data2.data();
 
-      for (delay = -maxdelay; delay <= maxdelay; delay = delay + lag)
+      for (int delay = -maxdelay; delay <= maxdelay; delay = delay + lag)
       {
+        // only sum over the overlapping region (0 <= i < datasize and 0 <= i + delay < datasize)
+        int start = std::max(0, -delay);
+        int end = std::min(datasize, datasize - delay);
         double sxy = 0;
-        for (i = 0; i < datasize; ++i)
+        for (int i = start; i < end; ++i)
         {
-          j = i + delay;
-          if (j < 0 || j >= datasize)
-          {
-            continue;
-          }
-          sxy += (data1[i]) * (data2[j]);
+          sxy += x[i] * y[i + delay];
         }
         result.data.push_back(std::make_pair(delay, sxy));
       }
@@ -28,4 +28,6 @@ cdef extern from "<OpenMS/FORMAT/HANDLERS/IndexedMzMLHandler.h>" namespace "Open
         MSChromatogram getMSChromatogramById(int id_) nogil except +
 
         void setSkipXMLChecks(bool skip) nogil except +
+        void setMemoryMapped(bool memory_mapped) nogil except +
+        bool isMemoryMapped() nogil except +
 
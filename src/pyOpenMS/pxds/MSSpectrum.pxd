@@ -50,6 +50,8 @@ cdef extern from "<OpenMS/KERNEL/MSSpectrum.h>" namespace "OpenMS":
         int findNearest(double) nogil except+
         int findNearest(double, double) nogil except+
         int findNearest(double, double, double) nogil except+
+        void findNearest(libcpp_vector[double] & mz_queries, libcpp_vector[size_t] & result) nogil except+
+        void findNearest(libcpp_vector[double] & mz_queries, double tolerance, bool tolerance_ppm, libcpp_vector[int] & result) nogil except+
 
         MSSpectrum select(libcpp_vector[ size_t ] & indices) nogil except +
 
@@ -23,6 +23,8 @@ cdef extern from "<OpenMS/FORMAT/HANDLERS/MzMLSqliteHandler.h>" namespace "OpenM
   
         void readSpectra(libcpp_vector[MSSpectrum] & exp, libcpp_vector[int] indices, bool meta_only ) nogil except +
 
+        void readSpectraData(libcpp_vector[int] indices, libcpp_vector[double] & mz, libcpp_vector[double] & intensity, libcpp_vector[size_t] & offsets) nogil except +
+
         void readChromatograms(libcpp_vector[MSChromatogram] & exp, libcpp_vector[int] indices, bool meta_only ) nogil except +
   
         Size getNrSpectra() nogil except +
@@ -13,6 +13,8 @@ cdef extern from "<OpenMS/KERNEL/OnDiscMSExperiment.h>" namespace "OpenMS":
         OnDiscMSExperiment(OnDiscMSExperiment &) nogil except +
 
         bool openFile(String filename) nogil except +
+        bool openFile(String filename, bool skipMetaData) nogil except +
+        bool openFile(String filename, bool skipMetaData, bool memory_mapped) nogil except +
         Size getNrSpectra() nogil except +
         Size getNrChromatograms() nogil except +
 
@@ -45,6 +45,12 @@ cdef extern from "<OpenMS/FORMAT/OPTIONS/PeakFileOptions.h>" namespace "OpenMS":
         Size getMaxDataPoolSize() nogil except +
         void setMaxDataPoolSize(Size s) nogil except +
 
+        bool getPipelinedProcessing() nogil except +
+        void setPipelinedProcessing(bool pipelined) nogil except +
+
+        bool getParallelWriting() nogil except +
+        void setParallelWriting(bool parallel) nogil except +
+
         void setSortSpectraByMZ(bool doSort) nogil except +
         bool getSortSpectraByMZ() nogil except +
         void setSortChromatogramsByRT(bool doSort) nogil except +
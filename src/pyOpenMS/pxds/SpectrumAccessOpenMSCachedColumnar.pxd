@@ -0,0 +1,16 @@
+from Types cimport *
+from String cimport *
+from OpenSwathDataStructures cimport *
+from ISpectrumAccess cimport *
+
+cdef extern from "<OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCachedColumnar.h>" namespace "OpenMS":
+
+  cdef cppclass SpectrumAccessOpenMSCachedColumnar(ISpectrumAccess):
+        # wrap-inherits:
+        #  ISpectrumAccess
+
+        SpectrumAccessOpenMSCachedColumnar() # wrap-pass-constructor
+
+        SpectrumAccessOpenMSCachedColumnar(String filename) nogil except +
+        SpectrumAccessOpenMSCachedColumnar(SpectrumAccessOpenMSCachedColumnar q) nogil except + # wrap-ignore
+
@@ -53,6 +53,7 @@ set(datastructures_executables_list
   Param_test
   QTCluster_test
   RangeManager_test
+  StaticKDTree2D_test
   StringListUtils_test
   StringUtils_test
   String_test
@@ -136,6 +137,7 @@ set(kernel_executables_list
   MSExperiment_test
   OnDiscMSExperiment_test
   MSSpectrum_test
+  ColumnarSpectrum_test
   Peak1D_test
   Peak2D_test
   PeakIndex_test
@@ -220,6 +222,7 @@ set(format_executables_list
   SequestOutfile_test
   SpecArrayFile_test
   SqMassFile_test
+  MzMLSqliteHandler_test
   SwathMapMassCorrection_test
   SwathFile_test
   SwathFileConsumer_test
@@ -238,10 +241,12 @@ set(format_executables_list
   ZlibCompression_test
   # DATAACCESS
   MSDataCachedConsumer_test
+  MSDataColumnarCachedConsumer_test
   MSDataTransformingConsumer_test
   MSDataChainingConsumer_test
   MSDataStoringConsumer_test
   MSDataAggregatingConsumer_test
+  SpectrumAccessPrefetching_test
   SpectrumAccessQuadMZTransforming_test
   SpectrumAccessSqMass_test
   SiriusFragmentAnnotation_test
@@ -364,6 +369,7 @@ set(comparison_executables_list
 set(chemistry_executables_list
   AAIndex_test
   AASequence_test
+  AveragineIsotopeTable_test
   CoarseIsotopeDistribution_test
   FineIsotopeDistribution_test
   IsoSpec_test
@@ -436,6 +442,7 @@ set(analysis_executables_list
   DeNovoIonScoring_test
   DeNovoPostScoring_test
   FalseDiscoveryRate_test
+  FragmentIndex_test
   FeatureDeconvolution_test
   FeatureDistance_test
   FeatureGroupingAlgorithmKD_test
@@ -499,6 +506,7 @@ set(analysis_executables_list
   PrecursorIonSelectionPreprocessing_test
   PrecursorIonSelection_test
   ProteinInference_test
+  PrecursorMassIndex_test
   PrecursorPurity_test
   ProtonDistributionModel_test
   ProteinResolver_test
@@ -511,6 +519,7 @@ set(analysis_executables_list
   SVMWrapper_test
   SimplePairFinder_test
   SimpleSVM_test
+  SpectralLibraryIndex_test
   StablePairFinder_test
   PercolatorFeatureSetHelper_test
   TransformationDescription_test
@@ -636,8 +645,12 @@ if(NOT DISABLE_OPENSWATH)
     SpectrumHelpers_test
     StatsHelpers_test
     SwathQC_test
+    SwathTaskQueue_test
+    OrderedTaskOutput_test
     CachedMzML_test
     CachedMzMLHandler_test
+    ColumnarCachedMzMLHandler_test
+    SpectrumAccessOpenMSCachedColumnar_test
   )
 endif(NOT DISABLE_OPENSWATH)
 
@@ -180,6 +180,54 @@ START_SECTION((void queryByMZ(const double& observed_mz, const Int& observed_cha
 }
 END_SECTION
 
+START_SECTION((void queryByMZ(const std::vector<double>& observed_mzs, const std::vector<Int>& observed_charges, const String& ion_mode, std::vector<std::vector<AccurateMassSearchResult> >& results) const))
+{
+  std::vector<double> mzs;
+  mzs.push_back(EmpiricalFormula("C17H11N5").getMonoWeight() + EmpiricalFormula("Na").getMonoWeight() - Constants::ELECTRON_MASS_U);
+  mzs.push_back(399.33486);
+  mzs.push_back(123.456); // nothing here
+  mzs.push_back(EmpiricalFormula("C17H20N2S").getMonoWeight() / 3 - Constants::PROTON_MASS_U);
+  mzs.push_back(399.33486);
+  std::vector<Int> charges;
+  charges.push_back(1);
+  charges.push_back(0);
+  charges.push_back(1);
+  charges.push_back(3);
+  charges.push_back(1);
+
+  std::vector<std::vector<AccurateMassSearchResult> > results;
+  TEST_EXCEPTION(Exception::InvalidSize, ams.queryByMZ(mzs, std::vector<Int>(1, 1), "positive", results));
+  TEST_EXCEPTION(Exception::InvalidParameter, ams.queryByMZ(mzs, charges, "this_is_an_invalid_ionmode", results));
+
+  // same results as one query at a time
+  const String modes[] = {"positive", "negative"};
+  for (Size m = 0; m < 2; ++m)
+  {
+    ams.queryByMZ(mzs, charges, modes[m], results);
+    TEST_EQUAL(results.size(), mzs.size())
+    ABORT_IF(results.size() != mzs.size())
+    for (Size i = 0; i < mzs.size(); ++i)
+    {
+      std::vector<AccurateMassSearchResult> single;
+      ams.queryByMZ(mzs[i], charges[i], modes[m], single);
+      TEST_EQUAL(results[i].size(), single.size())
+      ABORT_IF(results[i].size() != single.size())
+      for (Size j = 0; j < single.size(); ++j)
+      {
+        TEST_STRING_EQUAL(results[i][j].getFormulaString(), single[j].getFormulaString())
+        TEST_STRING_EQUAL(results[i][j].getFoundAdduct(), single[j].getFoundAdduct())
+        TEST_EQUAL(results[i][j].getMatchingIndex(), single[j].getMatchingIndex())
+        TEST_EQUAL(results[i][j].getMatchingHMDBids() == single[j].getMatchingHMDBids(), true)
+      }
+    }
+  }
+  // 'not-found' dummy for the empty query
+  ams.queryByMZ(mzs, charges, "positive", results);
+  ABORT_IF(results[2].size() != 1)
+  TEST_EQUAL(results[2][0].getMatchingIndex(), (Size)-1)
+}
+END_SECTION
+
 AccurateMassSearchEngine ams_feat_test;
 ams_feat_test.setParameters(ams_param);
 ams_feat_test.init();
@@ -0,0 +1,147 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/AveragineIsotopeTable.h>
+///////////////////////////
+
+#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/CoarseIsotopePatternGenerator.h>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(AveragineIsotopeTable, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+AveragineIsotopeTable* ptr = nullptr;
+AveragineIsotopeTable* nullPointer = nullptr;
+
+START_SECTION(explicit AveragineIsotopeTable(Size max_isotope, double max_mass = 10000.0, double bin_width = 0.02))
+{
+  ptr = new AveragineIsotopeTable(5);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->getMaxIsotope(), 5)
+  TEST_REAL_SIMILAR(ptr->getMaxMass(), 10000.0)
+  TEST_REAL_SIMILAR(ptr->getBinWidth(), 0.02)
+
+  TEST_EXCEPTION(Exception::InvalidValue, AveragineIsotopeTable(5, 1000.0, 0.0))
+  TEST_EXCEPTION(Exception::InvalidValue, AveragineIsotopeTable(5, -1.0, 0.02))
+}
+END_SECTION
+
+START_SECTION(~AveragineIsotopeTable())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(IsotopeDistribution estimateFromPeptideWeight(double average_weight) const)
+{
+  // results need to be identical to the ones computed directly, also for
+  // weights close to the bin borders and outside of the table
+  AveragineIsotopeTable table(4, 3000.0, 0.05);
+  CoarseIsotopePatternGenerator solver(4);
+  Size nr_differences = 0;
+  for (double weight = 0.0; weight < 3200.0; weight += 0.731)
+  {
+    if (!(table.estimateFromPeptideWeight(weight) == solver.estimateFromPeptideWeight(weight))) ++nr_differences;
+  }
+  for (Size bin = 1000; bin < 1200; ++bin)
+  {
+    double border = bin * 0.05;
+    if (!(table.estimateFromPeptideWeight(border) == solver.estimateFromPeptideWeight(border))) ++nr_differences;
+    if (!(table.estimateFromPeptideWeight(border - 1e-9) == solver.estimateFromPeptideWeight(border - 1e-9))) ++nr_differences;
+  }
+  TEST_EQUAL(nr_differences, 0)
+
+  IsotopeDistribution d = table.estimateFromPeptideWeight(1234.5);
+  TEST_EQUAL(d.size(), 4)
+  TEST_EQUAL(d == solver.estimateFromPeptideWeight(1234.5), true)
+  // repeated lookups return the same result
+  TEST_EQUAL(d == table.estimateFromPeptideWeight(1234.5), true)
+}
+END_SECTION
+
+START_SECTION(static const AveragineIsotopeTable& getInstance(Size max_isotope))
+{
+  const AveragineIsotopeTable& t1 = AveragineIsotopeTable::getInstance(3);
+  const AveragineIsotopeTable& t2 = AveragineIsotopeTable::getInstance(3);
+  const AveragineIsotopeTable& t3 = AveragineIsotopeTable::getInstance(4);
+  TEST_EQUAL(&t1 == &t2, true)
+  TEST_EQUAL(&t1 == &t3, false)
+  TEST_EQUAL(t1.getMaxIsotope(), 3)
+  TEST_EQUAL(t3.getMaxIsotope(), 4)
+
+  TEST_EXCEPTION(Exception::InvalidValue, AveragineIsotopeTable::getInstance(AveragineIsotopeTable::MAX_SHARED_ISOTOPES + 1))
+}
+END_SECTION
+
+START_SECTION(static IsotopeDistribution estimateFromPeptideWeight(double average_weight, Size max_isotope))
+{
+  CoarseIsotopePatternGenerator solver(3);
+  TEST_EQUAL(AveragineIsotopeTable::estimateFromPeptideWeight(800.0, 3) == solver.estimateFromPeptideWeight(800.0), true)
+
+  // more isotopes than supported by the shared tables are computed directly
+  Size many = AveragineIsotopeTable::MAX_SHARED_ISOTOPES + 1;
+  CoarseIsotopePatternGenerator solver_many(many);
+  TEST_EQUAL(AveragineIsotopeTable::estimateFromPeptideWeight(800.0, many) == solver_many.estimateFromPeptideWeight(800.0), true)
+}
+END_SECTION
+
+START_SECTION(Size getMaxIsotope() const)
+{
+  TEST_EQUAL(AveragineIsotopeTable(7).getMaxIsotope(), 7)
+}
+END_SECTION
+
+START_SECTION(double getMaxMass() const)
+{
+  TEST_REAL_SIMILAR(AveragineIsotopeTable(7, 500.0).getMaxMass(), 500.0)
+}
+END_SECTION
+
+START_SECTION(double getBinWidth() const)
+{
+  TEST_REAL_SIMILAR(AveragineIsotopeTable(7, 500.0, 0.1).getBinWidth(), 0.1)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
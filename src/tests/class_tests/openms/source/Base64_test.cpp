@@ -42,6 +42,9 @@
 ///////////////////////////
 
 #include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/SYSTEM/StopWatch.h>
+
+#include <QByteArray>
 
 using namespace std;
 
@@ -264,6 +267,88 @@ START_SECTION([EXTRA] zlib functionality)
 }
 END_SECTION
 
+START_SECTION([EXTRA] decoding of realistic peak arrays (vectorized decoder and direct inflate))
+{
+  // profile-like data: 50k sorted m/z values and intensities with a wide dynamic range
+  std::vector<double> mz;
+  std::vector<float> intensity;
+  for (Size i = 0; i < 50000; ++i)
+  {
+    mz.push_back(350.0 + i * 0.0237 + (i % 7) * 1e-5);
+    intensity.push_back(static_cast<float>((i % 113) * (i % 17) * 37.5 + 1.0));
+  }
+
+  for (Size k = 0; k < 2; ++k)
+  {
+    bool zlib = (k == 1);
+    String mz_str, int_str;
+    std::vector<double> mz_copy = mz;
+    std::vector<float> int_copy = intensity;
+    Base64::encode(mz_copy, Base64::BYTEORDER_LITTLEENDIAN, mz_str, zlib);
+    Base64::encode(int_copy, Base64::BYTEORDER_LITTLEENDIAN, int_str, zlib);
+
+    std::vector<double> mz_res;
+    std::vector<float> int_res;
+    Base64::decode(mz_str, Base64::BYTEORDER_LITTLEENDIAN, mz_res, zlib);
+    Base64::decode(int_str, Base64::BYTEORDER_LITTLEENDIAN, int_res, zlib);
+    TEST_EQUAL(mz_res.size(), mz.size())
+    TEST_EQUAL(int_res.size(), intensity.size())
+    TEST_EQUAL(mz_res == mz, true)
+    TEST_EQUAL(int_res == intensity, true)
+
+    // byte-wise identical to the Qt decoder used previously
+    QByteArray reference = QByteArray::fromBase64(QByteArray::fromRawData(mz_str.c_str(), (int) mz_str.size()));
+    QByteArray decoded;
+    Base64::decodeSingleString(mz_str, decoded, false);
+    TEST_EQUAL(decoded == reference, true)
+
+    // microbenchmark against the Qt decoder (not a test, timings go to the log)
+    StopWatch sw;
+    sw.start();
+    for (Size i = 0; i < 20; ++i)
+    {
+      Base64::decode(mz_str, Base64::BYTEORDER_LITTLEENDIAN, mz_res, zlib);
+    }
+    sw.stop();
+    double t_new = sw.getClockTime();
+    sw.reset();
+    sw.start();
+    for (Size i = 0; i < 20; ++i)
+    {
+      reference = QByteArray::fromBase64(QByteArray::fromRawData(mz_str.c_str(), (int) mz_str.size()));
+      if (zlib)
+      {
+        QByteArray czip;
+        czip.resize(4);
+        czip[0] = (reference.size() & 0xff000000) >> 24;
+        czip[1] = (reference.size() & 0x00ff0000) >> 16;
+        czip[2] = (reference.size() & 0x0000ff00) >> 8;
+        czip[3] = (reference.size() & 0x000000ff);
+        czip += reference;
+        reference = qUncompress(czip);
+      }
+      const double* p = reinterpret_cast<const double*>(reference.constData());
+      mz_res.assign(p, p + reference.size() / sizeof(double));
+    }
+    sw.stop();
+    STATUS("decode " << (zlib ? "zlib" : "uncompressed") << ": " << t_new << "s vs. Qt " << sw.getClockTime() << "s")
+  }
+
+  // line breaks (as written by some converters) and big endian data
+  String src = "QHLCZmZmZmZA\r\ncv/3ztkWh0Bz\r\nCZmZmZma";
+  std::vector<double> res_double;
+  Base64::decode(src, Base64::BYTEORDER_BIGENDIAN, res_double);
+  TEST_EQUAL(res_double.size(), 3)
+  TEST_REAL_SIMILAR(res_double[0], 300.15)
+  TEST_REAL_SIMILAR(res_double[1], 303.998)
+  TEST_REAL_SIMILAR(res_double[2], 304.6)
+
+  // corrupt compressed data
+  std::vector<float> res;
+  TEST_EXCEPTION(Exception::ConversionError, Base64::decode(String("QvAAAELIAA=="), Base64::BYTEORDER_BIGENDIAN, res, true))
+}
+END_SECTION
+
 START_SECTION(( void encodeStrings(const std::vector<String> & in, String & out, bool zlib_compression = false, bool append_zero_byte = true)))
 {
   Base64 b64;
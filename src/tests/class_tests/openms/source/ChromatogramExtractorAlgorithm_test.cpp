@@ -380,8 +380,8 @@ START_SECTION(void extract_value_tophat(const std::vector< double >::const_itera
   // print(sum([0 + i*100.0 for i in range(10)] + 8) )
   TEST_REAL_SIMILAR( integrated_intensity, 4508.0);
   extractor.extract_value_tophat(mz_start, mz_it, mz_it_end, int_it, 400.05,  integrated_intensity, extract_window, false);
-  //print(sum([0 + i*100.0 for i in range(10)]) + sum([900 - i*100.0 for i in range(6)])  )
-  TEST_REAL_SIMILAR( integrated_intensity, 8400.0);
+  //print(sum([0 + i*100.0 for i in range(10)]) + sum([900 - i*100.0 for i in range(6)]) + 8 )
+  TEST_REAL_SIMILAR( integrated_intensity, 8408.0); // includes the very first data point (400.0)
   extractor.extract_value_tophat(mz_start, mz_it, mz_it_end, int_it, 400.1, integrated_intensity, extract_window, false);
   //print(sum([0 + i*100.0 for i in range(10)]) + sum([900 - i*100.0 for i in range(10)])  )
   TEST_REAL_SIMILAR( integrated_intensity, 9000.0);
@@ -415,9 +415,9 @@ START_SECTION(void extract_value_tophat(const std::vector< double >::const_itera
   extractor.extract_value_tophat(mz_start, mz_it, mz_it_end, int_it, 400.0, integrated_intensity, extract_window, true);
   TEST_REAL_SIMILAR( integrated_intensity,4508.0);
   extractor.extract_value_tophat(mz_start, mz_it, mz_it_end, int_it, 400.05, integrated_intensity, extract_window, true);
-  TEST_REAL_SIMILAR( integrated_intensity,8400.0);
+  TEST_REAL_SIMILAR( integrated_intensity,8408.0);
   extractor.extract_value_tophat(mz_start, mz_it, mz_it_end, int_it, 400.1, integrated_intensity, extract_window, true);
-  TEST_REAL_SIMILAR( integrated_intensity,9000.0);
+  TEST_REAL_SIMILAR( integrated_intensity,9008.0); // 500 ppm at 400.1 is slightly wider than 0.2 Da and includes 400.0
 
 }
 END_SECTION
@@ -462,8 +462,8 @@ START_SECTION([EXTRA IM]void extract_value_tophat(const std::vector< double >::c
   // sum([i for m,i,im in zip_a if im < 100.15 and m < 400.1]) + 8
   TEST_REAL_SIMILAR( integrated_intensity, 2008.0);
   extractor.extract_value_tophat(mz_start, mz_it, mz_it_end, int_it, im_it, 400.05,  100, integrated_intensity, extract_window, im_extract_window, false);
-  // sum([i for m,i,im in zip_a if im < 100.15 and m < 400.15])
-  TEST_REAL_SIMILAR( integrated_intensity, 4100.0);
+  // sum([i for m,i,im in zip_a if im < 100.15 and m < 400.15]) + 8
+  TEST_REAL_SIMILAR( integrated_intensity, 4108.0);
   extractor.extract_value_tophat(mz_start, mz_it, mz_it_end, int_it, im_it, 400.1, 100, integrated_intensity, extract_window, im_extract_window, false);
   // sum([i for m,i,im in zip_a if im < 100.15 and m < 400.2])
   TEST_REAL_SIMILAR( integrated_intensity, 4100.0);
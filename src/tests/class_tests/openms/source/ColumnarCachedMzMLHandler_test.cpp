@@ -0,0 +1,349 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/FORMAT/HANDLERS/ColumnarCachedMzMLHandler.h>
+///////////////////////////
+
+#include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+using namespace OpenMS;
+using namespace OpenMS::Internal;
+using namespace std;
+
+START_TEST(ColumnarCachedMzMLHandler, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+ColumnarCachedMzMLHandler* ptr = nullptr;
+ColumnarCachedMzMLHandler* nullPointer = nullptr;
+
+PeakMap exp;
+MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+
+START_SECTION(ColumnarCachedMzMLHandler())
+{
+  ptr = new ColumnarCachedMzMLHandler();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->getNrSpectra(), 0)
+  TEST_EQUAL(ptr->getNrChromatograms(), 0)
+}
+END_SECTION
+
+START_SECTION(~ColumnarCachedMzMLHandler())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(static void write(const PeakMap& exp, const String& filename, bool mz_32bit = false, bool intensity_32bit = false))
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  ColumnarCachedMzMLHandler::write(exp, tmp_filename);
+
+  ColumnarCachedMzMLHandler handler(tmp_filename);
+  TEST_EQUAL(handler.getNrSpectra(), 4)
+  TEST_EQUAL(handler.getNrChromatograms(), 2)
+  TEST_EQUAL(handler.hasSinglePrecisionMZ(), false)
+  TEST_EQUAL(handler.hasSinglePrecisionIntensity(), false)
+
+  // all data columns start at 64 byte aligned offsets
+  ColumnarCachedMzMLHandler::ColumnView<double> mz = handler.getSpectrumMZ<double>(1);
+  ColumnarCachedMzMLHandler::ColumnView<double> rt = handler.getChromatogramRT<double>(1);
+  TEST_EQUAL((mz.data - handler.getSpectrumMZ<double>(0).data) * sizeof(double) % 64, 0)
+  TEST_EQUAL((rt.data - handler.getSpectrumMZ<double>(0).data) * sizeof(double) % 64, 0)
+
+  TEST_EXCEPTION(Exception::UnableToCreateFile, ColumnarCachedMzMLHandler::write(exp, "/does/not/exist/file.cached"))
+}
+END_SECTION
+
+START_SECTION([EXTRA] Writer)
+{
+  // spectra and chromatograms can be streamed in any order
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  {
+    ColumnarCachedMzMLHandler::Writer writer(tmp_filename);
+    writer.addChromatogram(exp.getChromatograms()[0]);
+    writer.addSpectrum(exp[0]);
+    writer.addSpectrum(exp[1]);
+    writer.addChromatogram(exp.getChromatograms()[1]);
+    writer.addSpectrum(exp[2]);
+    writer.addSpectrum(exp[3]);
+    writer.close();
+    writer.close(); // closing twice is fine
+  }
+
+  ColumnarCachedMzMLHandler handler(tmp_filename);
+  TEST_EQUAL(handler.getNrSpectra(), 4)
+  TEST_EQUAL(handler.getNrChromatograms(), 2)
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    TEST_EQUAL(handler.getSpectrumSize(i), exp[i].size())
+    TEST_EQUAL(handler.getSpectrumNativeID(i), exp[i].getNativeID())
+    ColumnarCachedMzMLHandler::ColumnView<double> mz = handler.getSpectrumMZ<double>(i);
+    for (Size k = 0; k < mz.size; ++k)
+    {
+      TEST_REAL_SIMILAR(mz[k], exp[i][k].getMZ())
+    }
+  }
+  for (Size i = 0; i < exp.getChromatograms().size(); ++i)
+  {
+    TEST_EQUAL(handler.getChromatogramSize(i), exp.getChromatograms()[i].size())
+    TEST_EQUAL(handler.getChromatogramNativeID(i), exp.getChromatograms()[i].getNativeID())
+  }
+
+  // the destructor closes the file as well
+  std::string tmp_filename2;
+  NEW_TMP_FILE(tmp_filename2);
+  {
+    ColumnarCachedMzMLHandler::Writer writer(tmp_filename2, true, true);
+    writer.addSpectrum(exp[1]);
+  }
+  ColumnarCachedMzMLHandler handler2(tmp_filename2);
+  TEST_EQUAL(handler2.getNrSpectra(), 1)
+  TEST_EQUAL(handler2.getNrChromatograms(), 0)
+  TEST_EQUAL(handler2.hasSinglePrecisionMZ(), true)
+  TEST_EQUAL(handler2.getSpectrumSize(0), exp[1].size())
+
+  TEST_EXCEPTION(Exception::UnableToCreateFile, ColumnarCachedMzMLHandler::Writer("/does/not/exist/file.cached"))
+}
+END_SECTION
+
+START_SECTION(void open(const String& filename))
+{
+  ColumnarCachedMzMLHandler handler;
+  TEST_EXCEPTION(Exception::FileNotFound, handler.open(OPENMS_GET_TEST_DATA_PATH("this_file_does_not_exist.cached")))
+  TEST_EXCEPTION(Exception::ParseError, handler.open(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML")))
+
+  // a truncated file is rejected
+  std::string tmp_filename, truncated_filename;
+  NEW_TMP_FILE(tmp_filename);
+  NEW_TMP_FILE(truncated_filename);
+  ColumnarCachedMzMLHandler::write(exp, tmp_filename);
+  {
+    std::ifstream ifs(tmp_filename.c_str(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    std::ofstream ofs(truncated_filename.c_str(), std::ios::binary);
+    ofs.write(content.c_str(), content.size() - 100);
+  }
+  TEST_EXCEPTION(Exception::ParseError, handler.open(truncated_filename))
+
+  // corrupt header fields (table offset beyond the file, entry counts whose sum wraps around) are rejected
+  {
+    std::ifstream ifs(tmp_filename.c_str(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    // header layout: magic (8 bytes), version, flags, nr_spectra, nr_chromatograms, table_offset
+    const UInt64 huge_offset = std::numeric_limits<UInt64>::max() - 7;
+    const UInt64 wrapping_count = std::numeric_limits<UInt64>::max();
+    const UInt64 one = 1;
+
+    std::string corrupt = content;
+    std::memcpy(&corrupt[32], &huge_offset, sizeof(UInt64));
+    std::string corrupt_filename;
+    NEW_TMP_FILE(corrupt_filename);
+    {
+      std::ofstream ofs(corrupt_filename.c_str(), std::ios::binary);
+      ofs.write(corrupt.c_str(), corrupt.size());
+    }
+    TEST_EXCEPTION(Exception::ParseError, handler.open(corrupt_filename))
+
+    corrupt = content;
+    std::memcpy(&corrupt[16], &wrapping_count, sizeof(UInt64));
+    std::memcpy(&corrupt[24], &one, sizeof(UInt64));
+    NEW_TMP_FILE(corrupt_filename);
+    {
+      std::ofstream ofs(corrupt_filename.c_str(), std::ios::binary);
+      ofs.write(corrupt.c_str(), corrupt.size());
+    }
+    TEST_EXCEPTION(Exception::ParseError, handler.open(corrupt_filename))
+  }
+
+  handler.open(tmp_filename);
+  TEST_EQUAL(handler.getFilename(), tmp_filename)
+  TEST_EQUAL(handler.getNrSpectra(), 4)
+}
+END_SECTION
+
+START_SECTION(Size getSpectrumSize(Size id) const)
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  ColumnarCachedMzMLHandler::write(exp, tmp_filename);
+  ColumnarCachedMzMLHandler handler(tmp_filename);
+
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    TEST_EQUAL(handler.getSpectrumSize(i), exp[i].size())
+    TEST_REAL_SIMILAR(handler.getSpectrumRT(i), exp[i].getRT())
+    TEST_EQUAL(handler.getSpectrumMSLevel(i), exp[i].getMSLevel())
+    TEST_EQUAL(handler.getSpectrumNativeID(i), exp[i].getNativeID())
+  }
+  for (Size i = 0; i < exp.getChromatograms().size(); ++i)
+  {
+    TEST_EQUAL(handler.getChromatogramSize(i), exp.getChromatograms()[i].size())
+    TEST_EQUAL(handler.getChromatogramNativeID(i), exp.getChromatograms()[i].getNativeID())
+  }
+}
+END_SECTION
+
+START_SECTION(template <typename DataType> ColumnView<DataType> getSpectrumMZ(Size id) const)
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  ColumnarCachedMzMLHandler::write(exp, tmp_filename);
+  ColumnarCachedMzMLHandler handler(tmp_filename);
+
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    ColumnarCachedMzMLHandler::ColumnView<double> mz = handler.getSpectrumMZ<double>(i);
+    ColumnarCachedMzMLHandler::ColumnView<double> intensity = handler.getSpectrumIntensity<double>(i);
+    TEST_EQUAL(mz.size, exp[i].size())
+    TEST_EQUAL(intensity.size, exp[i].size())
+    for (Size k = 0; k < exp[i].size(); ++k)
+    {
+      TEST_REAL_SIMILAR(mz[k], exp[i][k].getMZ())
+      TEST_REAL_SIMILAR(intensity[k], exp[i][k].getIntensity())
+    }
+  }
+  for (Size i = 0; i < exp.getChromatograms().size(); ++i)
+  {
+    ColumnarCachedMzMLHandler::ColumnView<double> rt = handler.getChromatogramRT<double>(i);
+    ColumnarCachedMzMLHandler::ColumnView<double> intensity = handler.getChromatogramIntensity<double>(i);
+    TEST_EQUAL(rt.size, exp.getChromatograms()[i].size())
+    for (Size k = 0; k < rt.size; ++k)
+    {
+      TEST_REAL_SIMILAR(rt[k], exp.getChromatograms()[i][k].getRT())
+      TEST_REAL_SIMILAR(intensity[k], exp.getChromatograms()[i][k].getIntensity())
+    }
+  }
+
+  // the requested type has to match the stored precision
+  TEST_EXCEPTION(Exception::IllegalArgument, handler.getSpectrumMZ<float>(0))
+}
+END_SECTION
+
+START_SECTION([EXTRA] single precision columns)
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  ColumnarCachedMzMLHandler::write(exp, tmp_filename, true, true);
+  ColumnarCachedMzMLHandler handler(tmp_filename);
+  TEST_EQUAL(handler.hasSinglePrecisionMZ(), true)
+  TEST_EQUAL(handler.hasSinglePrecisionIntensity(), true)
+  TEST_EXCEPTION(Exception::IllegalArgument, handler.getSpectrumMZ<double>(0))
+
+  ColumnarCachedMzMLHandler::ColumnView<float> mz = handler.getSpectrumMZ<float>(0);
+  ColumnarCachedMzMLHandler::ColumnView<float> intensity = handler.getSpectrumIntensity<float>(0);
+  TEST_EQUAL(mz.size, exp[0].size())
+  for (Size k = 0; k < mz.size; ++k)
+  {
+    TEST_REAL_SIMILAR(mz[k], exp[0][k].getMZ())
+    TEST_REAL_SIMILAR(intensity[k], exp[0][k].getIntensity())
+  }
+}
+END_SECTION
+
+START_SECTION(void getSpectrumData(Size id, std::vector<double>& mz, std::vector<double>& intensity) const)
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  ColumnarCachedMzMLHandler::write(exp, tmp_filename, true, false);
+  ColumnarCachedMzMLHandler handler(tmp_filename);
+
+  std::vector<double> mz, intensity;
+  handler.getSpectrumData(1, mz, intensity);
+  TEST_EQUAL(mz.size(), exp[1].size())
+  TEST_EQUAL(intensity.size(), exp[1].size())
+  TEST_REAL_SIMILAR(mz[5], exp[1][5].getMZ())
+  TEST_REAL_SIMILAR(intensity[5], exp[1][5].getIntensity())
+
+  handler.getSpectrumData(3, mz, intensity);
+  TEST_EQUAL(mz.size(), 0)
+  TEST_EQUAL(intensity.size(), 0)
+}
+END_SECTION
+
+START_SECTION(void getChromatogramData(Size id, std::vector<double>& rt, std::vector<double>& intensity) const)
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  ColumnarCachedMzMLHandler::write(exp, tmp_filename, false, true);
+  ColumnarCachedMzMLHandler handler(tmp_filename);
+
+  std::vector<double> rt, intensity;
+  handler.getChromatogramData(0, rt, intensity);
+  TEST_EQUAL(rt.size(), exp.getChromatograms()[0].size())
+  TEST_REAL_SIMILAR(rt[3], exp.getChromatograms()[0][3].getRT())
+  TEST_REAL_SIMILAR(intensity[3], exp.getChromatograms()[0][3].getIntensity())
+}
+END_SECTION
+
+START_SECTION(ColumnarCachedMzMLHandler(const ColumnarCachedMzMLHandler& rhs))
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  ColumnarCachedMzMLHandler::write(exp, tmp_filename);
+
+  ColumnarCachedMzMLHandler::ColumnView<double> mz;
+  {
+    ColumnarCachedMzMLHandler* handler = new ColumnarCachedMzMLHandler(tmp_filename);
+    ColumnarCachedMzMLHandler copy(*handler);
+    delete handler;
+    // the copy keeps the mapping alive
+    mz = copy.getSpectrumMZ<double>(0);
+    TEST_EQUAL(copy.getNrSpectra(), 4)
+    TEST_REAL_SIMILAR(mz[0], exp[0][0].getMZ())
+
+    ColumnarCachedMzMLHandler assigned;
+    assigned = copy;
+    TEST_EQUAL(assigned.getNrChromatograms(), 2)
+    TEST_EQUAL(assigned.getSpectrumMZ<double>(0).data, mz.data)
+  }
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
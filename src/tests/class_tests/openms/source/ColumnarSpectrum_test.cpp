@@ -0,0 +1,455 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg$
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/KERNEL/ColumnarSpectrum.h>
+///////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(ColumnarSpectrum, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+ColumnarSpectrum<>* ptr = nullptr;
+ColumnarSpectrum<>* nullPointer = nullptr;
+START_SECTION((ColumnarSpectrum()))
+{
+  ptr = new ColumnarSpectrum<>();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->empty(), true)
+  TEST_EQUAL(ptr->getMSLevel(), 1)
+  TEST_REAL_SIMILAR(ptr->getRT(), -1.0)
+}
+END_SECTION
+
+START_SECTION((~ColumnarSpectrum()))
+{
+  delete ptr;
+}
+END_SECTION
+
+// unsorted test spectrum
+MSSpectrum spec;
+spec.setRT(12.5);
+spec.setMSLevel(2);
+{
+  Peak1D p;
+  p.setMZ(500.0); p.setIntensity(1.0f); spec.push_back(p);
+  p.setMZ(412.0); p.setIntensity(3.0f); spec.push_back(p);
+  p.setMZ(423.5); p.setIntensity(2.0f); spec.push_back(p);
+  p.setMZ(800.0); p.setIntensity(5.0f); spec.push_back(p);
+  p.setMZ(407.0); p.setIntensity(4.0f); spec.push_back(p);
+}
+
+START_SECTION((explicit ColumnarSpectrum(const MSSpectrum& spectrum)))
+{
+  ColumnarSpectrum<> s(spec);
+  TEST_EQUAL(s.size(), 5)
+  TEST_REAL_SIMILAR(s.getRT(), 12.5)
+  TEST_EQUAL(s.getMSLevel(), 2)
+  TEST_REAL_SIMILAR(s.getMZ(1), 412.0)
+  TEST_REAL_SIMILAR(s.getIntensity(1), 3.0)
+
+  ColumnarSpectrum<float, float> sf(spec);
+  TEST_EQUAL(sf.size(), 5)
+  TEST_REAL_SIMILAR(sf.getMZ(3), 800.0)
+}
+END_SECTION
+
+START_SECTION((ColumnarSpectrum(const ColumnarSpectrum&)))
+{
+  ColumnarSpectrum<> s(spec);
+  ColumnarSpectrum<> s2(s);
+  TEST_EQUAL(s2 == s, true)
+}
+END_SECTION
+
+START_SECTION((ColumnarSpectrum& operator=(const ColumnarSpectrum&)))
+{
+  ColumnarSpectrum<> s(spec);
+  ColumnarSpectrum<> s2;
+  s2 = s;
+  TEST_EQUAL(s2 == s, true)
+}
+END_SECTION
+
+START_SECTION((bool operator==(const ColumnarSpectrum& rhs) const))
+{
+  ColumnarSpectrum<> s(spec);
+  ColumnarSpectrum<> s2(spec);
+  TEST_EQUAL(s == s2, true)
+  s2.setIntensity(0, 7.0f);
+  TEST_EQUAL(s == s2, false)
+  s2 = s;
+  s2.setRT(1.0);
+  TEST_EQUAL(s == s2, false)
+}
+END_SECTION
+
+START_SECTION((bool operator!=(const ColumnarSpectrum& rhs) const))
+{
+  ColumnarSpectrum<> s(spec);
+  ColumnarSpectrum<> s2(spec);
+  TEST_EQUAL(s != s2, false)
+  s2.setMSLevel(1);
+  TEST_EQUAL(s != s2, true)
+}
+END_SECTION
+
+START_SECTION((void assign(const MSSpectrum& spectrum)))
+{
+  ColumnarSpectrum<> s;
+  s.push_back(1.0, 1.0f);
+  s.assign(spec);
+  TEST_EQUAL(s.size(), 5)
+  TEST_REAL_SIMILAR(s.getMZ(0), 500.0)
+  TEST_REAL_SIMILAR(s.getRT(), 12.5)
+}
+END_SECTION
+
+START_SECTION((void copyTo(MSSpectrum& spectrum) const))
+{
+  ColumnarSpectrum<> s(spec);
+  MSSpectrum out;
+  s.copyTo(out);
+  TEST_EQUAL(out.size(), 5)
+  TEST_EQUAL(out == spec, true)
+}
+END_SECTION
+
+START_SECTION((Size size() const))
+{
+  ColumnarSpectrum<> s(spec);
+  TEST_EQUAL(s.size(), 5)
+}
+END_SECTION
+
+START_SECTION((bool empty() const))
+{
+  ColumnarSpectrum<> s;
+  TEST_EQUAL(s.empty(), true)
+  s.push_back(1.0, 1.0f);
+  TEST_EQUAL(s.empty(), false)
+}
+END_SECTION
+
+START_SECTION((void clear()))
+{
+  ColumnarSpectrum<> s(spec);
+  s.clear();
+  TEST_EQUAL(s.size(), 0)
+  TEST_EQUAL(s.getIntensityArray().size(), 0)
+  TEST_REAL_SIMILAR(s.getRT(), 12.5)
+}
+END_SECTION
+
+START_SECTION((void reserve(Size n)))
+{
+  ColumnarSpectrum<> s;
+  s.reserve(10);
+  TEST_EQUAL(s.size(), 0)
+  TEST_EQUAL(s.getMZArray().capacity() >= 10, true)
+  TEST_EQUAL(s.getIntensityArray().capacity() >= 10, true)
+}
+END_SECTION
+
+START_SECTION((void resize(Size n)))
+{
+  ColumnarSpectrum<> s;
+  s.resize(3);
+  TEST_EQUAL(s.size(), 3)
+  TEST_EQUAL(s.getIntensityArray().size(), 3)
+}
+END_SECTION
+
+START_SECTION((void push_back(MZType mz, IntensityType intensity)))
+{
+  ColumnarSpectrum<> s;
+  s.push_back(100.0, 2.0f);
+  s.push_back(200.0, 4.0f);
+  TEST_EQUAL(s.size(), 2)
+  TEST_REAL_SIMILAR(s.getMZ(1), 200.0)
+  TEST_REAL_SIMILAR(s.getIntensity(1), 4.0)
+}
+END_SECTION
+
+START_SECTION((MZType getMZ(Size i) const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((IntensityType getIntensity(Size i) const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((void setMZ(Size i, MZType mz)))
+{
+  ColumnarSpectrum<> s(spec);
+  s.setMZ(0, 501.0);
+  TEST_REAL_SIMILAR(s.getMZ(0), 501.0)
+}
+END_SECTION
+
+START_SECTION((void setIntensity(Size i, IntensityType intensity)))
+{
+  ColumnarSpectrum<> s(spec);
+  s.setIntensity(0, 9.0f);
+  TEST_REAL_SIMILAR(s.getIntensity(0), 9.0)
+}
+END_SECTION
+
+START_SECTION((const MZArrayType& getMZArray() const))
+{
+  ColumnarSpectrum<> s(spec);
+  const ColumnarSpectrum<>& cs = s;
+  TEST_EQUAL(cs.getMZArray().size(), 5)
+  TEST_REAL_SIMILAR(cs.getMZArray()[4], 407.0)
+}
+END_SECTION
+
+START_SECTION((const IntensityArrayType& getIntensityArray() const))
+{
+  ColumnarSpectrum<> s(spec);
+  const ColumnarSpectrum<>& cs = s;
+  TEST_EQUAL(cs.getIntensityArray().size(), 5)
+  TEST_REAL_SIMILAR(cs.getIntensityArray()[4], 4.0)
+}
+END_SECTION
+
+START_SECTION((MZArrayType& getMZArray()))
+{
+  ColumnarSpectrum<> s(spec);
+  for (double& mz : s.getMZArray()) mz += 1.0;
+  TEST_REAL_SIMILAR(s.getMZ(0), 501.0)
+}
+END_SECTION
+
+START_SECTION((IntensityArrayType& getIntensityArray()))
+{
+  ColumnarSpectrum<> s(spec);
+  for (float& intensity : s.getIntensityArray()) intensity *= 2.0f;
+  TEST_REAL_SIMILAR(s.getIntensity(3), 10.0)
+}
+END_SECTION
+
+START_SECTION((void swapArrays(MZArrayType& mz, IntensityArrayType& intensity)))
+{
+  ColumnarSpectrum<double, double> s;
+  std::vector<double> mz(3, 100.0), intensity(3, 5.0);
+  const double* data = &mz[0];
+  s.swapArrays(mz, intensity);
+  TEST_EQUAL(s.size(), 3)
+  TEST_EQUAL(mz.size(), 0)
+  TEST_EQUAL(intensity.size(), 0)
+  TEST_EQUAL(&s.getMZArray()[0] == data, true) // no copy
+
+  std::vector<double> wrong(2, 1.0);
+  TEST_EXCEPTION(Exception::IllegalArgument, s.swapArrays(mz, wrong))
+  TEST_EQUAL(s.size(), 3)
+}
+END_SECTION
+
+START_SECTION((double getRT() const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((void setRT(double rt)))
+{
+  ColumnarSpectrum<> s;
+  s.setRT(3.5);
+  TEST_REAL_SIMILAR(s.getRT(), 3.5)
+}
+END_SECTION
+
+START_SECTION((UInt getMSLevel() const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((void setMSLevel(UInt ms_level)))
+{
+  ColumnarSpectrum<> s;
+  s.setMSLevel(3);
+  TEST_EQUAL(s.getMSLevel(), 3)
+}
+END_SECTION
+
+START_SECTION((bool isSorted() const))
+{
+  ColumnarSpectrum<> s(spec);
+  TEST_EQUAL(s.isSorted(), false)
+  s.sortByPosition();
+  TEST_EQUAL(s.isSorted(), true)
+  TEST_EQUAL(ColumnarSpectrum<>().isSorted(), true)
+}
+END_SECTION
+
+START_SECTION((void sortByPosition()))
+{
+  ColumnarSpectrum<> s(spec);
+  s.sortByPosition();
+  TEST_REAL_SIMILAR(s.getMZ(0), 407.0)
+  TEST_REAL_SIMILAR(s.getMZ(1), 412.0)
+  TEST_REAL_SIMILAR(s.getMZ(2), 423.5)
+  TEST_REAL_SIMILAR(s.getMZ(3), 500.0)
+  TEST_REAL_SIMILAR(s.getMZ(4), 800.0)
+  // intensities are reordered with the m/z values
+  TEST_REAL_SIMILAR(s.getIntensity(0), 4.0)
+  TEST_REAL_SIMILAR(s.getIntensity(1), 3.0)
+  TEST_REAL_SIMILAR(s.getIntensity(2), 2.0)
+  TEST_REAL_SIMILAR(s.getIntensity(3), 1.0)
+  TEST_REAL_SIMILAR(s.getIntensity(4), 5.0)
+
+  // same result as MSSpectrum
+  MSSpectrum sorted = spec;
+  sorted.sortByPosition();
+  MSSpectrum out;
+  s.copyTo(out);
+  TEST_EQUAL(out == sorted, true)
+}
+END_SECTION
+
+START_SECTION((void sortByIntensity(bool reverse = false)))
+{
+  ColumnarSpectrum<> s(spec);
+  s.sortByIntensity();
+  TEST_REAL_SIMILAR(s.getIntensity(0), 1.0)
+  TEST_REAL_SIMILAR(s.getIntensity(4), 5.0)
+  TEST_REAL_SIMILAR(s.getMZ(0), 500.0)
+  TEST_REAL_SIMILAR(s.getMZ(4), 800.0)
+
+  s.sortByIntensity(true);
+  TEST_REAL_SIMILAR(s.getIntensity(0), 5.0)
+  TEST_REAL_SIMILAR(s.getIntensity(1), 4.0)
+  TEST_REAL_SIMILAR(s.getMZ(1), 407.0)
+}
+END_SECTION
+
+// sorted spectrum for searching
+ColumnarSpectrum<> sorted(spec);
+sorted.sortByPosition(); // 407.0 412.0 423.5 500.0 800.0
+
+START_SECTION((Size MZBegin(double mz) const))
+{
+  TEST_EQUAL(sorted.MZBegin(400.0), 0)
+  TEST_EQUAL(sorted.MZBegin(412.0), 1)
+  TEST_EQUAL(sorted.MZBegin(413.0), 2)
+  TEST_EQUAL(sorted.MZBegin(900.0), 5)
+
+  ColumnarSpectrum<float, float> sf(spec);
+  sf.sortByPosition();
+  TEST_EQUAL(sf.MZBegin(412.0), 1)
+  TEST_EQUAL(sf.MZBegin(423.5), 2)
+}
+END_SECTION
+
+START_SECTION((Size MZBegin(Size begin, double mz, Size end) const))
+{
+  TEST_EQUAL(sorted.MZBegin(2, 400.0, 5), 2)
+  TEST_EQUAL(sorted.MZBegin(0, 600.0, 3), 3)
+  TEST_EQUAL(sorted.MZBegin(1, 450.0, 5), 3)
+}
+END_SECTION
+
+START_SECTION((Size MZEnd(double mz) const))
+{
+  TEST_EQUAL(sorted.MZEnd(400.0), 0)
+  TEST_EQUAL(sorted.MZEnd(412.0), 2)
+  TEST_EQUAL(sorted.MZEnd(900.0), 5)
+}
+END_SECTION
+
+START_SECTION((Size MZEnd(Size begin, double mz, Size end) const))
+{
+  TEST_EQUAL(sorted.MZEnd(2, 400.0, 5), 2)
+  TEST_EQUAL(sorted.MZEnd(0, 900.0, 3), 3)
+  TEST_EQUAL(sorted.MZEnd(1, 500.0, 5), 4)
+}
+END_SECTION
+
+START_SECTION((Size findNearest(double mz) const))
+{
+  TEST_EQUAL(sorted.findNearest(300.0), 0)
+  TEST_EQUAL(sorted.findNearest(409.0), 0)
+  TEST_EQUAL(sorted.findNearest(410.0), 1)
+  TEST_EQUAL(sorted.findNearest(600.0), 3)
+  TEST_EQUAL(sorted.findNearest(1000.0), 4)
+
+  // same result as MSSpectrum
+  MSSpectrum s = spec;
+  s.sortByPosition();
+  for (double mz = 350.0; mz < 850.0; mz += 3.7)
+  {
+    TEST_EQUAL(sorted.findNearest(mz), s.findNearest(mz))
+  }
+
+  TEST_EXCEPTION(Exception::Precondition, ColumnarSpectrum<>().findNearest(500.0))
+}
+END_SECTION
+
+START_SECTION((Int findNearest(double mz, double tolerance) const))
+{
+  TEST_EQUAL(sorted.findNearest(409.0, 1.0), -1)
+  TEST_EQUAL(sorted.findNearest(409.0, 3.0), 0)
+  TEST_EQUAL(sorted.findNearest(501.0, 1.0), 3)
+  TEST_EQUAL(ColumnarSpectrum<>().findNearest(500.0, 1.0), -1)
+}
+END_SECTION
+
+START_SECTION((Int findNearest(double mz, double tolerance_left, double tolerance_right) const))
+{
+  TEST_EQUAL(sorted.findNearest(409.0, 0.5, 3.0), 1)
+  TEST_EQUAL(sorted.findNearest(409.0, 2.5, 0.5), 0)
+  TEST_EQUAL(sorted.findNearest(409.0, 0.5, 0.5), -1)
+  TEST_EQUAL(sorted.findNearest(900.0, 200.0, 0.0), 4)
+  TEST_EQUAL(ColumnarSpectrum<>().findNearest(500.0, 1.0, 1.0), -1)
+
+  // same result as MSSpectrum
+  MSSpectrum s = spec;
+  s.sortByPosition();
+  for (double mz = 350.0; mz < 850.0; mz += 3.7)
+  {
+    TEST_EQUAL(sorted.findNearest(mz, 5.0, 10.0), s.findNearest(mz, 5.0, 10.0))
+  }
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -0,0 +1,178 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/ID/FragmentIndex.h>
+#include <OpenMS/KERNEL/MSSpectrum.h>
+///////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+PeakSpectrum makeSpectrum(const vector<double>& mzs)
+{
+  PeakSpectrum s;
+  for (double mz : mzs)
+  {
+    Peak1D p;
+    p.setMZ(mz);
+    p.setIntensity(1.0);
+    s.push_back(p);
+  }
+  return s;
+}
+
+START_TEST(FragmentIndex, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+FragmentIndex* ptr = nullptr;
+FragmentIndex* null_ptr = nullptr;
+START_SECTION(FragmentIndex(double fragment_mass_tolerance = 10.0, bool fragment_mass_tolerance_unit_ppm = true))
+{
+  ptr = new FragmentIndex();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->isBuilt(), false)
+}
+END_SECTION
+
+START_SECTION(~FragmentIndex())
+{
+  delete ptr;
+}
+END_SECTION
+
+// candidates are added in non-sorted precursor mass order
+FragmentIndex index(0.05, false);
+PeakSpectrum c0 = makeSpectrum({100.0, 200.0, 300.0, 400.0});
+PeakSpectrum c1 = makeSpectrum({100.0, 250.0, 300.0});
+PeakSpectrum c2 = makeSpectrum({150.0, 200.0, 300.0, 400.0});
+
+START_SECTION(Size addCandidate(double precursor_mass, const PeakSpectrum& theo_spectrum))
+{
+  TEST_EQUAL(index.addCandidate(1000.0, c0), 0)
+  TEST_EQUAL(index.addCandidate(900.0, c1), 1)
+  TEST_EQUAL(index.addCandidate(1100.0, c2), 2)
+  TEST_EQUAL(index.size(), 3)
+}
+END_SECTION
+
+START_SECTION(Size getNumberOfFragments() const)
+{
+  TEST_EQUAL(index.getNumberOfFragments(), 11)
+}
+END_SECTION
+
+START_SECTION(void build())
+{
+  vector<pair<Size, Size> > hits;
+  TEST_EXCEPTION(Exception::Precondition, index.query(c0, 0.0, 2000.0, 1, hits))
+  index.build();
+  TEST_EQUAL(index.isBuilt(), true)
+  TEST_EQUAL(index.size(), 3)
+  TEST_EXCEPTION(Exception::Precondition, index.addCandidate(1200.0, c0))
+}
+END_SECTION
+
+START_SECTION(bool isBuilt() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(Size size() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(void query(const PeakSpectrum& spectrum, double precursor_mass_low, double precursor_mass_high, Size min_shared_peaks, std::vector<std::pair<Size, Size> >& hits) const)
+{
+  PeakSpectrum exp = makeSpectrum({100.02, 200.0, 299.99, 400.1});
+  vector<pair<Size, Size> > hits;
+
+  // all candidates (reported in order of precursor mass)
+  index.query(exp, 0.0, 2000.0, 1, hits);
+  TEST_EQUAL(hits.size(), 3)
+  ABORT_IF(hits.size() != 3)
+  TEST_EQUAL(hits[0].first, 1)
+  TEST_EQUAL(hits[0].second, 2) // 100, 300
+  TEST_EQUAL(hits[1].first, 0)
+  TEST_EQUAL(hits[1].second, 3) // 100, 200, 300 (400 is out of tolerance)
+  TEST_EQUAL(hits[2].first, 2)
+  TEST_EQUAL(hits[2].second, 2) // 200, 300
+
+  // minimum number of shared peaks
+  index.query(exp, 0.0, 2000.0, 3, hits);
+  TEST_EQUAL(hits.size(), 1)
+  TEST_EQUAL(hits[0].first, 0)
+
+  // precursor window
+  index.query(exp, 950.0, 1100.0, 1, hits);
+  TEST_EQUAL(hits.size(), 2)
+  TEST_EQUAL(hits[0].first, 0)
+  TEST_EQUAL(hits[1].first, 2)
+
+  index.query(exp, 1100.5, 2000.0, 1, hits);
+  TEST_EQUAL(hits.size(), 0)
+
+  // ppm tolerance
+  FragmentIndex ppm_index(10.0, true);
+  ppm_index.addCandidate(1000.0, c0);
+  ppm_index.build();
+  ppm_index.query(makeSpectrum({100.0005, 200.01}), 0.0, 2000.0, 1, hits);
+  TEST_EQUAL(hits.size(), 1)
+  TEST_EQUAL(hits[0].second, 1)
+}
+END_SECTION
+
+START_SECTION(void clear())
+{
+  index.clear();
+  TEST_EQUAL(index.size(), 0)
+  TEST_EQUAL(index.getNumberOfFragments(), 0)
+  TEST_EQUAL(index.isBuilt(), false)
+  TEST_EQUAL(index.addCandidate(1000.0, c0), 0)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
+
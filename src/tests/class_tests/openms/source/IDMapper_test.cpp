@@ -60,6 +60,7 @@ class IDMapper2 : public IDMapper
       return isMatch_(rt_distance, mz_theoretical, mz_observed);
     }
 
+    typedef IDMapper::BoxIndex BoxIndex2;
 };
 
 START_TEST(IDMapper, "$Id$")
@@ -401,6 +402,46 @@ START_SECTION((template < typename FeatureType > void annotate(FeatureMap< Featu
   TEST_EQUAL(fm_ppm.getUnassignedPeptideIdentifications()[0].getHits()[1].getSequence(), AASequence::fromString("DEADA"))
   TEST_EQUAL(fm_ppm.getUnassignedPeptideIdentifications()[1].getHits()[0].getSequence(), AASequence::fromString("DEADAA"))
   TEST_EQUAL(fm_ppm.getUnassignedPeptideIdentifications()[1].getHits()[1].getSequence(), AASequence::fromString("DEADAAA"))
+
+  // ******* unidentified precursors *******
+  // a precursor inside the mass traces of two overlapping features is only mapped to the first one
+  FeatureMap fm_overlap;
+  for (Size i = 0; i < 2; ++i)
+  {
+    Feature f;
+    f.setRT(100.0 + i);
+    f.setMZ(500.0);
+    ConvexHull2D hull;
+    hull.addPoint(DPosition<2>(90.0 + i, 499.9));
+    hull.addPoint(DPosition<2>(110.0 + i, 499.9));
+    hull.addPoint(DPosition<2>(110.0 + i, 500.1));
+    hull.addPoint(DPosition<2>(90.0 + i, 500.1));
+    f.getConvexHulls().push_back(hull);
+    fm_overlap.push_back(f);
+  }
+
+  PeakMap spectra;
+  MSSpectrum ms2;
+  ms2.setMSLevel(2);
+  ms2.setRT(100.5);
+  ms2.setNativeID("spectrum=1");
+  Precursor prec;
+  prec.setMZ(500.0);
+  ms2.getPrecursors().push_back(prec);
+  spectra.addSpectrum(ms2);
+
+  p.setValue("rt_tolerance", 0.0);
+  p.setValue("mz_tolerance", 0.0);
+  p.setValue("mz_measure", "Da");
+  p.setValue("ignore_charge", "true");
+  mapper.setParameters(p);
+
+  mapper.annotate(fm_overlap, vector<PeptideIdentification>(), vector<ProteinIdentification>(), false, false, spectra);
+
+  TEST_EQUAL(fm_overlap[0].getPeptideIdentifications().size(), 1)
+  TEST_EQUAL(fm_overlap[0].getPeptideIdentifications()[0].getHits().empty(), true)
+  TEST_REAL_SIMILAR(fm_overlap[0].getPeptideIdentifications()[0].getRT(), 100.5)
+  TEST_EQUAL(fm_overlap[1].getPeptideIdentifications().size(), 0)
 }
 END_SECTION
 
@@ -620,6 +661,35 @@ START_SECTION([EXTRA] bool isMatch_(const double rt_distance, const double mz_th
   TEST_EQUAL(mapper.isMatch2_(5, 999, 1002.1), false)
 END_SECTION
 
+START_SECTION([EXTRA] BoxIndex)
+  std::vector<DBoundingBox<2> > boxes;
+  boxes.push_back(DBoundingBox<2>(DPosition<2>(10.0, 500.0), DPosition<2>(30.0, 501.0)));
+  boxes.push_back(DBoundingBox<2>(DPosition<2>(12.5, 500.5), DPosition<2>(12.5, 500.5))); // a point
+  boxes.push_back(DBoundingBox<2>(DPosition<2>(25.0, 600.0), DPosition<2>(40.0, 602.0)));
+  boxes.push_back(DBoundingBox<2>()); // empty, never reported
+  IDMapper2::BoxIndex2 index(boxes);
+  TEST_EQUAL(index.size(), 4)
+
+  std::vector<Size> result;
+  index.query(12.5, 12.5, 500.5, 500.5, result);
+  TEST_EQUAL(result.size(), 2)
+  ABORT_IF(result.size() != 2)
+  TEST_EQUAL(result[0], 0)
+  TEST_EQUAL(result[1], 1)
+
+  // closed intervals
+  index.query(30.0, 35.0, 501.0, 600.0, result);
+  TEST_EQUAL(result.size(), 2)
+  ABORT_IF(result.size() != 2)
+  TEST_EQUAL(result[0], 0)
+  TEST_EQUAL(result[1], 2)
+
+  index.query(0.0, 9.9, 0.0, 1000.0, result);
+  TEST_EQUAL(result.size(), 0)
+  index.query(0.0, 100.0, 501.1, 599.9, result);
+  TEST_EQUAL(result.size(), 0)
+END_SECTION
+
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
@@ -187,6 +187,61 @@ START_SECTION(( OpenMS::Interfaces::ChromatogramPtr getChromatogramById(int id)
 }
 END_SECTION
 
+START_SECTION(( void setMemoryMapped(bool memory_mapped) ))
+{
+  IndexedMzMLHandler stream_file(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
+  TEST_EQUAL(stream_file.isMemoryMapped(), false)
+
+  IndexedMzMLHandler file;
+  file.setMemoryMapped(true);
+  file.openFile(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
+  TEST_EQUAL(file.getParsingSuccess(), true)
+  TEST_EQUAL(file.isMemoryMapped(), true)
+  TEST_EQUAL(file.getNrSpectra(), stream_file.getNrSpectra())
+  TEST_EQUAL(file.getNrChromatograms(), stream_file.getNrChromatograms())
+
+  // identical data as with stream access
+  for (int i = 0; i < (int)file.getNrSpectra(); ++i)
+  {
+    TEST_EQUAL(file.getMSSpectrumById(i) == stream_file.getMSSpectrumById(i), true)
+  }
+  TEST_EQUAL(file.getMSChromatogramById(0) == stream_file.getMSChromatogramById(0), true)
+
+  // copies share the mapping
+  IndexedMzMLHandler copy(file);
+  TEST_EQUAL(copy.isMemoryMapped(), true)
+  TEST_EQUAL(copy.getMSSpectrumById(1) == stream_file.getMSSpectrumById(1), true)
+
+  // concurrent access through a single instance
+  std::vector<Size> sizes(file.getNrSpectra() * 10);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (SignedSize i = 0; i < (SignedSize)sizes.size(); ++i)
+  {
+    sizes[i] = file.getSpectrumById(int(i % file.getNrSpectra()))->getMZArray()->data.size();
+  }
+  for (Size i = 0; i < sizes.size(); ++i)
+  {
+    TEST_EQUAL(sizes[i], stream_file.getSpectrumById(int(i % file.getNrSpectra()))->getMZArray()->data.size())
+  }
+
+  TEST_EXCEPTION(Exception::IllegalArgument, file.getSpectrumById(-1));
+
+  // missing file: same behavior as with stream access
+  IndexedMzMLHandler missing;
+  missing.setMemoryMapped(true);
+  TEST_EXCEPTION(Exception::FileNotFound, missing.openFile(OPENMS_GET_TEST_DATA_PATH("fileDoesNotExist")));
+  TEST_EQUAL(missing.isMemoryMapped(), false)
+}
+END_SECTION
+
+START_SECTION(( bool isMemoryMapped() const ))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
 START_SECTION(([EXTRA] load broken file))
 {
 
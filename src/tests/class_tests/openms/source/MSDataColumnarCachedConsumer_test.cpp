@@ -0,0 +1,209 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/FORMAT/DATAACCESS/MSDataColumnarCachedConsumer.h>
+///////////////////////////
+
+#include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/HANDLERS/ColumnarCachedMzMLHandler.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCachedColumnar.h>
+
+START_TEST(MSDataColumnarCachedConsumer, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+using namespace OpenMS;
+
+MSDataColumnarCachedConsumer* cached_consumer_ptr = nullptr;
+MSDataColumnarCachedConsumer* cached_consumer_nullPointer = nullptr;
+
+START_SECTION((MSDataColumnarCachedConsumer(const String& filename, bool clearData = true, bool mz_32bit = false, bool intensity_32bit = false)))
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  cached_consumer_ptr = new MSDataColumnarCachedConsumer(tmp_filename);
+  TEST_NOT_EQUAL(cached_consumer_ptr, cached_consumer_nullPointer)
+
+  TEST_EXCEPTION(Exception::UnableToCreateFile, MSDataColumnarCachedConsumer("/does/not/exist/file.cached"))
+}
+END_SECTION
+
+START_SECTION((~MSDataColumnarCachedConsumer()))
+{
+  delete cached_consumer_ptr;
+}
+END_SECTION
+
+START_SECTION((void consumeSpectrum(SpectrumType & s)))
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  MSDataColumnarCachedConsumer* cached_consumer = new MSDataColumnarCachedConsumer(tmp_filename, false);
+
+  PeakMap exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+  TEST_EQUAL(exp.getNrSpectra() > 0, true)
+
+  cached_consumer->setExpectedSize(2, 0);
+  cached_consumer->consumeSpectrum(exp.getSpectrum(0));
+  cached_consumer->consumeSpectrum(exp.getSpectrum(1));
+  delete cached_consumer;
+
+  // check whether it was written to disk correctly
+  Internal::ColumnarCachedMzMLHandler handler(tmp_filename);
+  TEST_EQUAL(handler.getNrSpectra(), 2)
+  TEST_EQUAL(handler.getNrChromatograms(), 0)
+  for (Size i = 0; i < 2; ++i)
+  {
+    std::vector<double> mz, intensity;
+    handler.getSpectrumData(i, mz, intensity);
+    TEST_EQUAL(mz.size(), exp.getSpectrum(i).size())
+    TEST_EQUAL(intensity.size(), exp.getSpectrum(i).size())
+    TEST_REAL_SIMILAR(handler.getSpectrumRT(i), exp.getSpectrum(i).getRT())
+    TEST_EQUAL(handler.getSpectrumMSLevel(i), exp.getSpectrum(i).getMSLevel())
+  }
+}
+END_SECTION
+
+START_SECTION((void consumeChromatogram(ChromatogramType & c)))
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  MSDataColumnarCachedConsumer* cached_consumer = new MSDataColumnarCachedConsumer(tmp_filename, false);
+
+  PeakMap exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+  TEST_EQUAL(exp.getNrChromatograms() > 0, true)
+
+  cached_consumer->setExpectedSize(0, 1);
+  cached_consumer->consumeChromatogram(exp.getChromatogram(0));
+  delete cached_consumer;
+
+  Internal::ColumnarCachedMzMLHandler handler(tmp_filename);
+  TEST_EQUAL(handler.getNrSpectra(), 0)
+  TEST_EQUAL(handler.getNrChromatograms(), 1)
+  std::vector<double> rt, intensity;
+  handler.getChromatogramData(0, rt, intensity);
+  TEST_EQUAL(rt.size(), exp.getChromatogram(0).size())
+  TEST_EQUAL(intensity.size(), exp.getChromatogram(0).size())
+  TEST_EQUAL(handler.getChromatogramNativeID(0), exp.getChromatogram(0).getNativeID())
+}
+END_SECTION
+
+START_SECTION((void close()))
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  MSDataColumnarCachedConsumer cached_consumer(tmp_filename, false);
+
+  PeakMap exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    cached_consumer.consumeSpectrum(exp.getSpectrum(i));
+  }
+  for (Size i = 0; i < exp.getChromatograms().size(); ++i)
+  {
+    cached_consumer.consumeChromatogram(exp.getChromatogram(i));
+  }
+  // the file is readable before the consumer is destroyed
+  cached_consumer.close();
+
+  SpectrumAccessOpenMSCachedColumnar access(tmp_filename);
+  TEST_EQUAL(access.getNrSpectra(), exp.size())
+  TEST_EQUAL(access.getNrChromatograms(), exp.getChromatograms().size())
+  OpenSwath::SpectrumPtr sptr = access.getSpectrumById(1);
+  TEST_EQUAL(sptr->getMZArray()->data.size(), exp.getSpectrum(1).size())
+  TEST_REAL_SIMILAR(sptr->getMZArray()->data[5], exp.getSpectrum(1)[5].getMZ())
+  TEST_REAL_SIMILAR(sptr->getIntensityArray()->data[5], exp.getSpectrum(1)[5].getIntensity())
+}
+END_SECTION
+
+START_SECTION([EXTRA] clearData)
+{
+  {
+    std::string tmp_filename;
+    NEW_TMP_FILE(tmp_filename);
+    MSDataColumnarCachedConsumer* cached_consumer = new MSDataColumnarCachedConsumer(tmp_filename, true);
+
+    PeakMap exp;
+    MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+    MSSpectrum first_spectrum = exp.getSpectrum(0);
+    TEST_EQUAL(exp.getSpectrum(0).size() > 0, true)
+
+    cached_consumer->consumeSpectrum(exp.getSpectrum(0));
+
+    TEST_EQUAL(exp.getSpectrum(0).size(), 0)
+    TEST_EQUAL(exp.getSpectrum(0) == first_spectrum, false)
+    delete cached_consumer;
+  }
+  {
+    std::string tmp_filename;
+    NEW_TMP_FILE(tmp_filename);
+    MSDataColumnarCachedConsumer* cached_consumer = new MSDataColumnarCachedConsumer(tmp_filename, false);
+
+    PeakMap exp;
+    MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+    MSSpectrum first_spectrum = exp.getSpectrum(0);
+
+    cached_consumer->consumeSpectrum(exp.getSpectrum(0));
+
+    TEST_EQUAL(exp.getSpectrum(0).size() > 0, true)
+    TEST_EQUAL(exp.getSpectrum(0) == first_spectrum, true)
+    delete cached_consumer;
+  }
+}
+END_SECTION
+
+START_SECTION((void setExpectedSize(Size expectedSpectra, Size expectedChromatograms)))
+{
+  NOT_TESTABLE // no-op
+}
+END_SECTION
+
+START_SECTION((void setExperimentalSettings(const ExperimentalSettings& exp)))
+{
+  NOT_TESTABLE // no-op
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -1166,6 +1166,157 @@ START_SECTION((Size findNearest(CoordinateType mz, CoordinateType left_tolerance
   TEST_EQUAL(tmp2.findNearest(427.3, 1.0, 1.0), -1);
 END_SECTION
 
+START_SECTION((void MZBegin(const std::vector<CoordinateType>& mz_queries, std::vector<Size>& result) const))
+  MSSpectrum tmp;
+  Peak1D p;
+  p.setIntensity(29.0f); p.setMZ(412.321); tmp.push_back(p); //0
+  p.setIntensity(60.0f); p.setMZ(412.824); tmp.push_back(p); //1
+  p.setIntensity(34.0f); p.setMZ(413.8); tmp.push_back(p); //2
+  p.setIntensity(29.0f); p.setMZ(414.301); tmp.push_back(p); //3
+  p.setIntensity(37.0f); p.setMZ(415.287); tmp.push_back(p); //4
+  p.setIntensity(31.0f); p.setMZ(416.293); tmp.push_back(p); //5
+  p.setIntensity(31.0f); p.setMZ(418.232); tmp.push_back(p); //6
+  p.setIntensity(31.0f); p.setMZ(419.113); tmp.push_back(p); //7
+  p.setIntensity(201.0f); p.setMZ(420.13); tmp.push_back(p); //8
+  p.setIntensity(56.0f); p.setMZ(423.269); tmp.push_back(p); //9
+  p.setIntensity(34.0f); p.setMZ(426.292); tmp.push_back(p); //10
+  p.setIntensity(82.0f); p.setMZ(427.28); tmp.push_back(p); //11
+  p.setIntensity(87.0f); p.setMZ(428.322); tmp.push_back(p); //12
+  p.setIntensity(30.0f); p.setMZ(430.269); tmp.push_back(p); //13
+  p.setIntensity(29.0f); p.setMZ(431.246); tmp.push_back(p); //14
+  p.setIntensity(42.0f); p.setMZ(432.289); tmp.push_back(p); //15
+  p.setIntensity(32.0f); p.setMZ(436.161); tmp.push_back(p); //16
+  p.setIntensity(54.0f); p.setMZ(437.219); tmp.push_back(p); //17
+  p.setIntensity(40.0f); p.setMZ(439.186); tmp.push_back(p); //18
+  p.setIntensity(40); p.setMZ(440.27); tmp.push_back(p); //19
+  p.setIntensity(23.0f); p.setMZ(441.224); tmp.push_back(p); //20
+
+  std::vector<double> queries = {400.0, 412.321, 412.5, 420.13, 420.2, 420.3, 441.224, 500.0};
+  std::vector<Size> result;
+  tmp.MZBegin(queries, result);
+  TEST_EQUAL(result.size(), queries.size())
+  for (Size i = 0; i < queries.size(); ++i)
+  {
+    TEST_EQUAL(result[i], Size(tmp.MZBegin(queries[i]) - tmp.begin()))
+  }
+  TEST_EQUAL(result.back(), tmp.size())
+
+  // empty spectrum
+  MSSpectrum tmp2;
+  tmp2.MZBegin(queries, result);
+  TEST_EQUAL(result.size(), queries.size())
+  TEST_EQUAL(result[0], 0)
+  TEST_EQUAL(result.back(), 0)
+END_SECTION
+
+START_SECTION((void findNearest(const std::vector<CoordinateType>& mz_queries, std::vector<Size>& result) const))
+  MSSpectrum tmp;
+  Peak1D p;
+  p.setIntensity(29.0f); p.setMZ(412.321); tmp.push_back(p); //0
+  p.setIntensity(60.0f); p.setMZ(412.824); tmp.push_back(p); //1
+  p.setIntensity(34.0f); p.setMZ(413.8); tmp.push_back(p); //2
+  p.setIntensity(29.0f); p.setMZ(414.301); tmp.push_back(p); //3
+  p.setIntensity(37.0f); p.setMZ(415.287); tmp.push_back(p); //4
+  p.setIntensity(31.0f); p.setMZ(416.293); tmp.push_back(p); //5
+  p.setIntensity(31.0f); p.setMZ(418.232); tmp.push_back(p); //6
+  p.setIntensity(31.0f); p.setMZ(419.113); tmp.push_back(p); //7
+  p.setIntensity(201.0f); p.setMZ(420.13); tmp.push_back(p); //8
+  p.setIntensity(56.0f); p.setMZ(423.269); tmp.push_back(p); //9
+  p.setIntensity(34.0f); p.setMZ(426.292); tmp.push_back(p); //10
+  p.setIntensity(82.0f); p.setMZ(427.28); tmp.push_back(p); //11
+  p.setIntensity(87.0f); p.setMZ(428.322); tmp.push_back(p); //12
+  p.setIntensity(30.0f); p.setMZ(430.269); tmp.push_back(p); //13
+  p.setIntensity(29.0f); p.setMZ(431.246); tmp.push_back(p); //14
+  p.setIntensity(42.0f); p.setMZ(432.289); tmp.push_back(p); //15
+  p.setIntensity(32.0f); p.setMZ(436.161); tmp.push_back(p); //16
+  p.setIntensity(54.0f); p.setMZ(437.219); tmp.push_back(p); //17
+  p.setIntensity(40.0f); p.setMZ(439.186); tmp.push_back(p); //18
+  p.setIntensity(40); p.setMZ(440.27); tmp.push_back(p); //19
+  p.setIntensity(23.0f); p.setMZ(441.224); tmp.push_back(p); //20
+
+  // duplicate queries and queries exactly between two peaks are included
+  std::vector<double> queries = {400.0, 412.4, 412.5725, 426.29, 426.3, 427.2, 427.2, 427.3, 441.224, 500.0};
+  std::vector<Size> result;
+  tmp.findNearest(queries, result);
+  TEST_EQUAL(result.size(), queries.size())
+  for (Size i = 0; i < queries.size(); ++i)
+  {
+    TEST_EQUAL(result[i], tmp.findNearest(queries[i]))
+  }
+  TEST_EQUAL(result[0], 0)
+  TEST_EQUAL(result[3], 10)
+  TEST_EQUAL(result[7], 11)
+  TEST_EQUAL(result.back(), 20)
+
+  // no queries
+  std::vector<double> no_queries;
+  tmp.findNearest(no_queries, result);
+  TEST_EQUAL(result.size(), 0)
+
+  //empty spectrum
+  MSSpectrum tmp2;
+  TEST_PRECONDITION_VIOLATED(tmp2.findNearest(queries, result));
+END_SECTION
+
+START_SECTION((void findNearest(const std::vector<CoordinateType>& mz_queries, CoordinateType tolerance, bool tolerance_ppm, std::vector<Int>& result) const))
+  MSSpectrum tmp;
+  Peak1D p;
+  p.setIntensity(29.0f); p.setMZ(412.321); tmp.push_back(p); //0
+  p.setIntensity(60.0f); p.setMZ(412.824); tmp.push_back(p); //1
+  p.setIntensity(34.0f); p.setMZ(413.8); tmp.push_back(p); //2
+  p.setIntensity(29.0f); p.setMZ(414.301); tmp.push_back(p); //3
+  p.setIntensity(37.0f); p.setMZ(415.287); tmp.push_back(p); //4
+  p.setIntensity(31.0f); p.setMZ(416.293); tmp.push_back(p); //5
+  p.setIntensity(31.0f); p.setMZ(418.232); tmp.push_back(p); //6
+  p.setIntensity(31.0f); p.setMZ(419.113); tmp.push_back(p); //7
+  p.setIntensity(201.0f); p.setMZ(420.13); tmp.push_back(p); //8
+  p.setIntensity(56.0f); p.setMZ(423.269); tmp.push_back(p); //9
+  p.setIntensity(34.0f); p.setMZ(426.292); tmp.push_back(p); //10
+  p.setIntensity(82.0f); p.setMZ(427.28); tmp.push_back(p); //11
+  p.setIntensity(87.0f); p.setMZ(428.322); tmp.push_back(p); //12
+  p.setIntensity(30.0f); p.setMZ(430.269); tmp.push_back(p); //13
+  p.setIntensity(29.0f); p.setMZ(431.246); tmp.push_back(p); //14
+  p.setIntensity(42.0f); p.setMZ(432.289); tmp.push_back(p); //15
+  p.setIntensity(32.0f); p.setMZ(436.161); tmp.push_back(p); //16
+  p.setIntensity(54.0f); p.setMZ(437.219); tmp.push_back(p); //17
+  p.setIntensity(40.0f); p.setMZ(439.186); tmp.push_back(p); //18
+  p.setIntensity(40); p.setMZ(440.27); tmp.push_back(p); //19
+  p.setIntensity(23.0f); p.setMZ(441.224); tmp.push_back(p); //20
+
+  std::vector<double> queries = {400.0, 412.4, 426.25, 426.3, 427.2, 441.3, 500.0};
+  std::vector<Int> result;
+
+  // tolerance in Th
+  tmp.findNearest(queries, 0.1, false, result);
+  TEST_EQUAL(result.size(), queries.size())
+  for (Size i = 0; i < queries.size(); ++i)
+  {
+    TEST_EQUAL(result[i], tmp.findNearest(queries[i], 0.1))
+  }
+  TEST_EQUAL(result[0], -1)
+  TEST_EQUAL(result[1], 0)
+  TEST_EQUAL(result[5], 20)
+  TEST_EQUAL(result[6], -1)
+
+  // tolerance in ppm (100 ppm at 426 m/z is ~0.0426 Th)
+  tmp.findNearest(queries, 100.0, true, result);
+  TEST_EQUAL(result[1], -1)
+  TEST_EQUAL(result[2], 10)
+  TEST_EQUAL(result[3], 10)
+  TEST_EQUAL(result[4], -1)
+  for (Size i = 0; i < queries.size(); ++i)
+  {
+    TEST_EQUAL(result[i], tmp.findNearest(queries[i], queries[i] * 100.0 * 1e-6))
+  }
+
+  //empty spectrum
+  MSSpectrum tmp2;
+  tmp2.findNearest(queries, 0.1, false, result);
+  TEST_EQUAL(result.size(), queries.size())
+  TEST_EQUAL(result[0], -1)
+  TEST_EQUAL(result.back(), -1)
+END_SECTION
+
 START_SECTION( SpectrumSettings::SpectrumType MSSpectrum::getType(const bool query_data) const)
   
   // test empty spectrum
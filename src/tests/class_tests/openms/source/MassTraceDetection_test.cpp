@@ -35,6 +35,7 @@
 #include <OpenMS/CONCEPT/ClassTest.h>
 #include <OpenMS/test_config.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/KERNEL/OnDiscMSExperiment.h>
 
 ///////////////////////////
 #include <OpenMS/FILTERING/DATAREDUCTION/MassTraceDetection.h>
@@ -175,6 +176,122 @@ START_SECTION((void run(const PeakMap &, std::vector< MassTrace > &)))
 }
 END_SECTION
 
+START_SECTION((void run(OnDiscMSExperiment &, std::vector< MassTrace > &)))
+{
+    // no meta data available
+    OnDiscMSExperiment on_disc;
+    TEST_EXCEPTION(Exception::Precondition, test_mtd.run(on_disc, output_mt))
+}
+END_SECTION
+
+START_SECTION((MassTraceDetection::Consumer))
+{
+    std::vector<MassTrace> in_memory_mt;
+    test_mtd.run(input, in_memory_mt);
+
+    // the whole map fits into one block -> identical to the in-memory run
+    std::vector<MassTrace> streamed_mt;
+    {
+      MassTraceDetection::Consumer consumer(test_mtd, streamed_mt);
+      for (Size i = 0; i < input.size(); ++i)
+      {
+        MSSpectrum s = input[i];
+        consumer.consumeSpectrum(s);
+      }
+      consumer.finish();
+    }
+    TEST_EQUAL(streamed_mt.size(), in_memory_mt.size());
+    ABORT_IF(streamed_mt.size() != in_memory_mt.size());
+    for (Size i = 0; i < streamed_mt.size(); ++i)
+    {
+        TEST_EQUAL(streamed_mt[i].getSize(), in_memory_mt[i].getSize());
+        TEST_EQUAL(streamed_mt[i].getLabel(), in_memory_mt[i].getLabel());
+        TEST_REAL_SIMILAR(streamed_mt[i].getCentroidRT(), in_memory_mt[i].getCentroidRT());
+        TEST_REAL_SIMILAR(streamed_mt[i].getCentroidMZ(), in_memory_mt[i].getCentroidMZ());
+        TEST_REAL_SIMILAR(streamed_mt[i].computePeakArea(), in_memory_mt[i].computePeakArea());
+    }
+
+    // too few MS1 spectra
+    streamed_mt.clear();
+    MassTraceDetection::Consumer consumer(test_mtd, streamed_mt);
+    MSSpectrum s = input[0];
+    consumer.consumeSpectrum(s);
+    TEST_EXCEPTION(Exception::InvalidValue, consumer.finish())
+}
+END_SECTION
+
+START_SECTION([EXTRA] streaming with traces crossing block borders)
+{
+    // 60 MS1 spectra, processed in blocks of 20 with an overlap of 5 spectra
+    MassTraceDetection block_mtd;
+    Param p_block = block_mtd.getDefaults();
+    p_block.setValue("streaming_block_size", 20);
+    p_block.setValue("streaming_block_overlap", 5);
+    block_mtd.setParameters(p_block);
+
+    // synthetic traces spanning 5 scans (apex +/- 2, i.e. shorter than the overlap),
+    // most of them crossing a block border
+    double trace_mzs[6] = {300.0, 350.0, 400.0, 450.0, 500.0, 550.0};
+    Size trace_apices[6] = {19, 20, 21, 39, 41, 2};
+    double trace_heights[6] = {1000.0, 2000.0, 1500.0, 3000.0, 2500.0, 1200.0};
+
+    PeakMap synthetic;
+    for (Size scan = 0; scan < 60; ++scan)
+    {
+      MSSpectrum s;
+      s.setMSLevel(1);
+      s.setRT(100.0 + 2.0 * scan);
+      for (Size t = 0; t < 6; ++t)
+      {
+        double d = (double)scan - (double)trace_apices[t];
+        if (std::fabs(d) > 2.0) continue;
+        Peak1D p;
+        p.setMZ(trace_mzs[t]);
+        p.setIntensity(trace_heights[t] * std::exp(-0.5 * d * d));
+        s.push_back(p);
+      }
+      synthetic.addSpectrum(s);
+    }
+
+    std::vector<MassTrace> in_memory_mt;
+    block_mtd.run(synthetic, in_memory_mt);
+
+    std::vector<MassTrace> streamed_mt;
+    {
+      MassTraceDetection::Consumer consumer(block_mtd, streamed_mt);
+      for (Size i = 0; i < synthetic.size(); ++i)
+      {
+        MSSpectrum s = synthetic[i];
+        consumer.consumeSpectrum(s);
+      }
+      consumer.finish();
+    }
+
+    // traces are reported block by block, so compare them in m/z order
+    struct LessByMZ
+    {
+      bool operator()(const MassTrace& a, const MassTrace& b) const { return a.getCentroidMZ() < b.getCentroidMZ(); }
+    };
+    std::sort(in_memory_mt.begin(), in_memory_mt.end(), LessByMZ());
+    std::sort(streamed_mt.begin(), streamed_mt.end(), LessByMZ());
+
+    // every trace found exactly once and with all of its peaks
+    TEST_EQUAL(in_memory_mt.size(), 6);
+    TEST_EQUAL(streamed_mt.size(), in_memory_mt.size());
+    ABORT_IF(streamed_mt.size() != in_memory_mt.size());
+    for (Size i = 0; i < streamed_mt.size(); ++i)
+    {
+        TEST_EQUAL(in_memory_mt[i].getSize(), 5);
+        TEST_EQUAL(streamed_mt[i].getSize(), in_memory_mt[i].getSize());
+        TEST_REAL_SIMILAR(streamed_mt[i].getCentroidMZ(), trace_mzs[i]);
+        TEST_REAL_SIMILAR(streamed_mt[i].getCentroidRT(), in_memory_mt[i].getCentroidRT());
+        TEST_REAL_SIMILAR(streamed_mt[i].begin()->getRT(), in_memory_mt[i].begin()->getRT());
+        TEST_REAL_SIMILAR(streamed_mt[i].rbegin()->getRT(), in_memory_mt[i].rbegin()->getRT());
+        TEST_REAL_SIMILAR(streamed_mt[i].computePeakArea(), in_memory_mt[i].computePeakArea());
+    }
+}
+END_SECTION
+
 std::vector<MassTrace> filt;
 
 //START_SECTION((void filterByPeakWidth(std::vector< MassTrace > &, std::vector< MassTrace > &)))
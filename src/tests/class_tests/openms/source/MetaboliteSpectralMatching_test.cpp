@@ -33,6 +33,7 @@
 // --------------------------------------------------------------------------
 
 #include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
 
 ///////////////////////////
 #include <OpenMS/ANALYSIS/ID/MetaboliteSpectralMatching.h>
@@ -67,15 +68,104 @@ START_SECTION((virtual ~MetaboliteSpectralMatching()))
 }
 END_SECTION
 
+// small synthetic library: spectra with shifted fragment ladders, in random precursor order
+PeakMap spec_db;
+for (Size i = 0; i < 200; ++i)
+{
+  MSSpectrum spec;
+  Precursor prec;
+  prec.setMZ(100.0 + ((i * 37) % 200) * 0.35);
+  prec.setCharge(i % 5 == 0 ? -1 : 1);
+  spec.getPrecursors().push_back(prec);
+  for (Size p = 0; p < 10; ++p)
+  {
+    spec.push_back(Peak1D(50.0 + p * 7.0 + (i % 7) * 0.001, 100.0f + p + i));
+  }
+  spec.setMetaValue("Massbank_Accession_ID", String("MB") + i);
+  spec.setMetaValue("HMDB_ID", String("HMDB") + i);
+  spec.setMetaValue("Sum_Formula", "C6H12O6");
+  spec.setMetaValue("Metabolite_Name", String("metabolite ") + i);
+  spec.setMetaValue("Inchi_String", "");
+  spec.setMetaValue("SMILES_String", "");
+  spec.setMetaValue("Precursor_Ion", "M+H");
+  spec_db.addSpectrum(spec);
+}
+
 START_SECTION((double computeHyperScore(MSSpectrum, MSSpectrum, const double &, const double &)))
 {
-  // TODO
+  MetaboliteSpectralMatching msm;
+  MSSpectrum exp_spec = spec_db[3];
+  // identical spectra: all 10 peaks match
+  double dot(0.0);
+  for (Size p = 0; p < exp_spec.size(); ++p)
+  {
+    dot += exp_spec[p].getIntensity() * exp_spec[p].getIntensity();
+  }
+  TEST_REAL_SIMILAR(msm.computeHyperScore(exp_spec, spec_db[3], 10.0, 0.0), std::log(dot) + std::log(3628800.0))
+  // fragments above the lower bound only: 2 matches are too few
+  TEST_REAL_SIMILAR(msm.computeHyperScore(exp_spec, spec_db[3], 10.0, 105.0), 0.0)
+  // no fragment within tolerance
+  TEST_REAL_SIMILAR(msm.computeHyperScore(exp_spec, spec_db[4], 1.0, 0.0), 0.0)
 }
 END_SECTION
 
 START_SECTION((void run(PeakMap &, MzTab &)))
 {
-  // TODO
+  NOT_TESTABLE // tested below
+}
+END_SECTION
+
+START_SECTION((void run(PeakMap & msexp, const PeakMap & spec_db, const SpectralLibraryIndex & index, MzTab & mztab_out)))
+{
+  // query: slightly perturbed copies of some library spectra
+  PeakMap exp;
+  for (Size i = 0; i < 200; i += 9)
+  {
+    MSSpectrum spec = spec_db[i];
+    spec.clearMetaInfo();
+    spec.setRT(10.0 * i);
+    spec.getPrecursors()[0].setMZ(spec.getPrecursors()[0].getMZ() + 0.001);
+    exp.addSpectrum(spec);
+  }
+
+  MetaboliteSpectralMatching msm;
+  SpectralLibraryIndex index;
+  index.build(spec_db);
+
+  PeakMap exp_copy(exp);
+  MzTab mztab_indexed;
+  msm.run(exp_copy, spec_db, index, mztab_indexed);
+
+  PeakMap spec_db_copy(spec_db);
+  exp_copy = exp;
+  MzTab mztab;
+  msm.run(exp_copy, spec_db_copy, mztab);
+
+  const MzTabSmallMoleculeSectionRows& rows_indexed = mztab_indexed.getSmallMoleculeSectionRows();
+  const MzTabSmallMoleculeSectionRows& rows = mztab.getSmallMoleculeSectionRows();
+  TEST_EQUAL(rows_indexed.size() > 0, true)
+  TEST_EQUAL(rows_indexed.size(), rows.size())
+  ABORT_IF(rows_indexed.size() != rows.size())
+  for (Size i = 0; i < rows.size(); ++i)
+  {
+    TEST_STRING_EQUAL(rows_indexed[i].identifier.toCellString(), rows[i].identifier.toCellString())
+    TEST_REAL_SIMILAR(rows_indexed[i].exp_mass_to_charge.get(), rows[i].exp_mass_to_charge.get())
+  }
+
+  // index of another library
+  PeakMap other_db(spec_db);
+  other_db.getSpectra().pop_back();
+  exp_copy = exp;
+  TEST_EXCEPTION(Exception::IllegalArgument, msm.run(exp_copy, other_db, index, mztab_indexed))
+
+  // a missing meta value of a matching library spectrum is reported as exception (also when searching in parallel)
+  PeakMap incomplete_db(spec_db);
+  for (Size i = 0; i < incomplete_db.size(); ++i)
+  {
+    incomplete_db[i].removeMetaValue("SMILES_String");
+  }
+  exp_copy = exp;
+  TEST_EXCEPTION(Exception::ConversionError, msm.run(exp_copy, incomplete_db, index, mztab_indexed))
 }
 END_SECTION
 
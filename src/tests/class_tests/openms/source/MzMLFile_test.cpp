@@ -40,8 +40,11 @@
 ///////////////////////////
 
 #include <OpenMS/FORMAT/FileTypes.h>
+#include <OpenMS/FORMAT/DATAACCESS/MSDataWritingConsumer.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 
+#include <fstream>
+
 using namespace OpenMS;
 using namespace std;
 
@@ -1232,6 +1235,140 @@ START_SECTION(void transform(const String& filename_in, Interfaces::IMSDataConsu
 }
 END_SECTION
 
+START_SECTION([EXTRA] pipelined decoding of data pools)
+{
+  TICConsumer consumer;
+  MzMLFile mzml;
+  PeakMap map;
+  String in = OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML");
+
+  // small pools, so several pools are decoded in the background
+  PeakFileOptions opt = mzml.getOptions();
+  opt.setMaxDataPoolSize(1);
+  opt.setPipelinedProcessing(true);
+  mzml.setOptions(opt);
+  mzml.transform(in, &consumer, map, true, true);
+
+  TEST_EQUAL(consumer.nr_spectra, 4)
+  TEST_EQUAL(consumer.nr_peaks, 40)
+  TEST_REAL_SIMILAR(consumer.TIC, 350)
+
+  // same result (and order) as loading without pipelining
+  PeakMap reference;
+  MzMLFile().load(in, reference);
+  PeakMap pipelined;
+  mzml.load(in, pipelined);
+  TEST_EQUAL(pipelined.size(), reference.size())
+  TEST_EQUAL(pipelined.getChromatograms().size(), reference.getChromatograms().size())
+  TEST_EQUAL(pipelined == reference, true)
+  for (Size i = 0; i < map.size(); ++i)
+  {
+    TEST_EQUAL(map[i].getNativeID(), reference[i].getNativeID())
+  }
+
+  // faulty defaultArrayLength: the warnings of the background decoder are
+  // reported by the parser and the spectrum is repaired as without pipelining
+  {
+    std::ifstream ifs(in.c_str());
+    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    const std::string correct = "spotID=\"M0\" defaultArrayLength=\"15\"";
+    content.replace(content.find(correct), correct.size(), "spotID=\"M0\" defaultArrayLength=\"99\"");
+    String faulty;
+    NEW_TMP_FILE(faulty);
+    std::ofstream ofs(faulty.c_str());
+    ofs << content;
+    ofs.close();
+
+    PeakMap faulty_reference, faulty_pipelined;
+    MzMLFile().load(faulty, faulty_reference);
+    mzml.load(faulty, faulty_pipelined);
+    TEST_EQUAL(faulty_pipelined.size(), faulty_reference.size())
+    TEST_EQUAL(faulty_pipelined[0].size(), 15)
+    TEST_EQUAL(faulty_pipelined == faulty_reference, true)
+  }
+}
+END_SECTION
+
+START_SECTION([EXTRA] parallel writing)
+{
+  PeakMap exp_original;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp_original);
+
+  MzMLFile file;
+  std::string sequential;
+  file.storeBuffer(sequential, exp_original);
+
+  // small batches so that several batches are encoded, with and without compression
+  for (Size pool_size = 1; pool_size <= 3; ++pool_size)
+  {
+    MzMLFile parallel_file;
+    parallel_file.getOptions().setParallelWriting(true);
+    parallel_file.getOptions().setMaxDataPoolSize(pool_size);
+    std::string parallel;
+    parallel_file.storeBuffer(parallel, exp_original);
+    // identical output including the index offsets
+    TEST_EQUAL(parallel == sequential, true)
+
+    file.getOptions().setCompression(true);
+    parallel_file.getOptions().setCompression(true);
+    file.storeBuffer(sequential, exp_original);
+    parallel_file.storeBuffer(parallel, exp_original);
+    TEST_EQUAL(parallel == sequential, true)
+    file.getOptions().setCompression(false);
+    file.storeBuffer(sequential, exp_original);
+  }
+
+  // the stored index allows random access to all spectra and chromatograms
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  MzMLFile parallel_file;
+  parallel_file.getOptions().setParallelWriting(true);
+  parallel_file.getOptions().setMaxDataPoolSize(2);
+  parallel_file.store(tmp_filename, exp_original);
+
+  PeakMap exp_reloaded;
+  MzMLFile().load(tmp_filename, exp_reloaded);
+  TEST_EQUAL(exp_reloaded.size(), exp_original.size())
+  TEST_EQUAL(exp_reloaded.getChromatograms().size(), exp_original.getChromatograms().size())
+  for (Size i = 0; i < exp_original.size(); ++i)
+  {
+    TEST_EQUAL(exp_reloaded[i].size(), exp_original[i].size())
+    TEST_EQUAL(exp_reloaded[i].getNativeID(), exp_original[i].getNativeID())
+  }
+
+  // writing consumer
+  std::string sequential_filename, parallel_filename;
+  NEW_TMP_FILE(sequential_filename);
+  NEW_TMP_FILE(parallel_filename);
+  for (Size k = 0; k < 2; ++k)
+  {
+    PlainMSDataWritingConsumer consumer(k == 0 ? sequential_filename : parallel_filename);
+    consumer.getOptions().setParallelWriting(k == 1);
+    consumer.getOptions().setMaxDataPoolSize(3);
+    consumer.setExpectedSize(exp_original.size(), exp_original.getChromatograms().size());
+    consumer.setExperimentalSettings(exp_original);
+    for (Size i = 0; i < exp_original.size(); ++i)
+    {
+      MSSpectrum s = exp_original[i];
+      consumer.consumeSpectrum(s);
+    }
+    for (Size i = 0; i < exp_original.getChromatograms().size(); ++i)
+    {
+      MSChromatogram c = exp_original.getChromatograms()[i];
+      consumer.consumeChromatogram(c);
+    }
+    TEST_EQUAL(consumer.getNrSpectraWritten(), 4)
+    TEST_EQUAL(consumer.getNrChromatogramsWritten(), 2)
+  }
+  std::ifstream sequential_ifs(sequential_filename.c_str(), std::ios::binary);
+  std::ifstream parallel_ifs(parallel_filename.c_str(), std::ios::binary);
+  std::string sequential_content((std::istreambuf_iterator<char>(sequential_ifs)), std::istreambuf_iterator<char>());
+  std::string parallel_content((std::istreambuf_iterator<char>(parallel_ifs)), std::istreambuf_iterator<char>());
+  TEST_EQUAL(parallel_content.empty(), false)
+  TEST_EQUAL(parallel_content == sequential_content, true)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -0,0 +1,258 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/FORMAT/HANDLERS/MzMLSqliteHandler.h>
+///////////////////////////
+
+using namespace OpenMS;
+using namespace OpenMS::Internal;
+using namespace std;
+
+START_TEST(MzMLSqliteHandler, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+MzMLSqliteHandler* ptr = nullptr;
+MzMLSqliteHandler* nullPointer = nullptr;
+
+START_SECTION(MzMLSqliteHandler(String filename))
+{
+  ptr = new MzMLSqliteHandler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"));
+  TEST_NOT_EQUAL(ptr, nullPointer)
+}
+END_SECTION
+
+START_SECTION(~MzMLSqliteHandler())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(MzMLSqliteHandler(const MzMLSqliteHandler& rhs))
+{
+  MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"));
+  TEST_EQUAL(handler.getNrSpectra(), 2)
+
+  // the copy uses its own connection
+  MzMLSqliteHandler copy(handler);
+  TEST_EQUAL(copy.getNrSpectra(), 2)
+  TEST_EQUAL(handler.getNrSpectra(), 2)
+}
+END_SECTION
+
+START_SECTION(MzMLSqliteHandler& operator=(const MzMLSqliteHandler& rhs))
+{
+  MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"));
+  MzMLSqliteHandler other(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"));
+  TEST_EQUAL(other.getNrChromatograms(), 1)
+  other = handler;
+  TEST_EQUAL(other.getNrSpectra(), 2)
+  TEST_EQUAL(other.getNrChromatograms(), 1)
+}
+END_SECTION
+
+START_SECTION(Size getNrSpectra() const)
+{
+  MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"));
+  TEST_EQUAL(handler.getNrSpectra(), 2)
+  TEST_EQUAL(handler.getNrSpectra(), 2) // re-uses the prepared statement
+}
+END_SECTION
+
+START_SECTION(Size getNrChromatograms() const)
+{
+  MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"));
+  TEST_EQUAL(handler.getNrChromatograms(), 1)
+}
+END_SECTION
+
+START_SECTION(void readSpectra(std::vector<MSSpectrum> & exp, const std::vector<int> & indices, bool meta_only = false) const)
+{
+  MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"));
+
+  MSExperiment exp;
+  handler.readExperiment(exp);
+
+  // indices do not need to be sorted
+  std::vector<int> indices;
+  indices.push_back(1);
+  indices.push_back(0);
+
+  std::vector<MSSpectrum> spectra;
+  handler.readSpectra(spectra, indices, false);
+  TEST_EQUAL(spectra.size(), 2)
+  TEST_EQUAL(spectra[0].getNativeID(), "controllerType=0 controllerNumber=1 scan=2")
+  TEST_EQUAL(spectra[1].getNativeID(), "controllerType=0 controllerNumber=1 scan=1")
+  TEST_EQUAL(spectra[0].size(), 19800)
+  TEST_EQUAL(spectra[1].size(), 19914)
+  TEST_REAL_SIMILAR(spectra[0].getRT(), 0.4738)
+  TEST_REAL_SIMILAR(spectra[1].getRT(), 0.2961)
+  TEST_EQUAL(spectra[0][100].getMZ(), exp.getSpectra()[1][100].getMZ())
+  TEST_EQUAL(spectra[1][100].getIntensity(), exp.getSpectra()[0][100].getIntensity())
+
+  // repeated reads append to the result
+  handler.readSpectra(spectra, std::vector<int>(1, 1), false);
+  TEST_EQUAL(spectra.size(), 3)
+  TEST_EQUAL(spectra[2] == spectra[0], true)
+
+  // meta data only
+  spectra.clear();
+  handler.readSpectra(spectra, indices, true);
+  TEST_EQUAL(spectra.size(), 2)
+  TEST_EQUAL(spectra[0].getNativeID(), "controllerType=0 controllerNumber=1 scan=2")
+  TEST_EQUAL(spectra[0].size(), 0)
+
+  // non-existing spectrum
+  TEST_EXCEPTION(Exception::IllegalArgument, handler.readSpectra(spectra, std::vector<int>(1, 5), false))
+}
+END_SECTION
+
+START_SECTION(void readSpectraData(const std::vector<int> & indices, std::vector<double> & mz, std::vector<double> & intensity, std::vector<Size> & offsets) const)
+{
+  MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"));
+
+  std::vector<int> indices;
+  indices.push_back(1);
+  indices.push_back(0);
+
+  std::vector<MSSpectrum> spectra;
+  handler.readSpectra(spectra, indices, false);
+
+  std::vector<double> mz, intensity;
+  std::vector<Size> offsets;
+  handler.readSpectraData(indices, mz, intensity, offsets);
+
+  TEST_EQUAL(offsets.size(), 3)
+  TEST_EQUAL(offsets[0], 0)
+  TEST_EQUAL(offsets[1], 19800)
+  TEST_EQUAL(offsets[2], 19800 + 19914)
+  TEST_EQUAL(mz.size(), 19800 + 19914)
+  TEST_EQUAL(intensity.size(), 19800 + 19914)
+
+  for (Size k = 0; k < indices.size(); k++)
+  {
+    for (Size i = 0; i < spectra[k].size(); i += 1000)
+    {
+      TEST_EQUAL(mz[offsets[k] + i], spectra[k][i].getMZ())
+      TEST_REAL_SIMILAR(intensity[offsets[k] + i], spectra[k][i].getIntensity())
+    }
+  }
+
+  // single spectrum
+  handler.readSpectraData(std::vector<int>(1, 0), mz, intensity, offsets);
+  TEST_EQUAL(offsets.size(), 2)
+  TEST_EQUAL(mz.size(), 19914)
+  TEST_EQUAL(mz[0], spectra[1][0].getMZ())
+}
+END_SECTION
+
+START_SECTION(void readSpectrumIndex(std::vector<SpectrumIndexEntry> & index) const)
+{
+  MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"));
+
+  std::vector<MzMLSqliteHandler::SpectrumIndexEntry> index;
+  handler.readSpectrumIndex(index);
+  TEST_EQUAL(index.size(), 2)
+  TEST_EQUAL(index[0].id, 0)
+  TEST_EQUAL(index[1].id, 1)
+  TEST_EQUAL(index[0].native_id, "controllerType=0 controllerNumber=1 scan=1")
+  TEST_EQUAL(index[1].native_id, "controllerType=0 controllerNumber=1 scan=2")
+  TEST_EQUAL(index[0].ms_level, 1)
+  TEST_REAL_SIMILAR(index[0].rt, 0.2961)
+  TEST_REAL_SIMILAR(index[1].rt, 0.4738)
+  TEST_REAL_SIMILAR(index[0].precursor_mz, 0.0)
+}
+END_SECTION
+
+START_SECTION(std::vector<size_t> getSpectraIndicesbyRT(double RT, double deltaRT, const std::vector<int> & indices) const)
+{
+  MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"));
+  std::vector<int> indices;
+
+  std::vector<size_t> result = handler.getSpectraIndicesbyRT(0.3, 0.1, indices);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 0)
+
+  result = handler.getSpectraIndicesbyRT(0.4, 0.1, indices);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 1)
+
+  result = handler.getSpectraIndicesbyRT(0.4, 0.2, indices);
+  TEST_EQUAL(result.size(), 2)
+
+  // first spectrum after RT
+  result = handler.getSpectraIndicesbyRT(0.3, 0.0, indices);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 1)
+
+  result = handler.getSpectraIndicesbyRT(0.5, 0.0, indices);
+  TEST_EQUAL(result.size(), 0)
+
+  // restricted to a subset of spectra
+  indices.push_back(0);
+  result = handler.getSpectraIndicesbyRT(0.4, 0.2, indices);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 0)
+
+  result = handler.getSpectraIndicesbyRT(0.3, 0.0, indices);
+  TEST_EQUAL(result.size(), 0)
+}
+END_SECTION
+
+START_SECTION(void readChromatograms(std::vector<MSChromatogram> & exp, const std::vector<int> & indices, bool meta_only = false) const)
+{
+  MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"));
+
+  MSExperiment exp;
+  handler.readExperiment(exp);
+
+  std::vector<MSChromatogram> chromatograms;
+  handler.readChromatograms(chromatograms, std::vector<int>(1, 0), false);
+  TEST_EQUAL(chromatograms.size(), 1)
+  TEST_EQUAL(chromatograms[0].getNativeID(), "TIC")
+  TEST_EQUAL(chromatograms[0].size(), exp.getChromatograms()[0].size())
+  TEST_EQUAL(chromatograms[0].empty(), false)
+
+  TEST_EXCEPTION(Exception::IllegalArgument, handler.readChromatograms(chromatograms, std::vector<int>(1, 3), false))
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
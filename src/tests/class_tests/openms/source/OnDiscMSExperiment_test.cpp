@@ -125,6 +125,33 @@ START_SECTION((bool openFile(const String& source)))
 }
 END_SECTION
 
+START_SECTION([EXTRA] bool openFile(const String& filename, bool skipMetaData, bool memory_mapped))
+{
+  OnDiscPeakMap stream_map;
+  stream_map.openFile(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
+
+  OnDiscPeakMap mapped;
+  bool res = mapped.openFile(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"), false, true);
+  TEST_EQUAL(res, true)
+  TEST_EQUAL(mapped.getNrSpectra(), stream_map.getNrSpectra())
+  TEST_EQUAL(mapped == stream_map, true)
+
+  // shared instance, accessed from all threads
+  std::vector<Size> sizes(mapped.getNrSpectra());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (SignedSize i = 0; i < (SignedSize)sizes.size(); ++i)
+  {
+    sizes[i] = mapped.getSpectrum(i).size();
+  }
+  for (Size i = 0; i < sizes.size(); ++i)
+  {
+    TEST_EQUAL(sizes[i], stream_map.getSpectrum(i).size())
+  }
+}
+END_SECTION
+
 START_SECTION((bool isSortedByRT() const))
 {
   OnDiscPeakMap tmp; tmp.openFile(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
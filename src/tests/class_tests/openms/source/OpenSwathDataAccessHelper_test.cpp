@@ -154,6 +154,76 @@ START_SECTION(convertToOpenMSSpectrum(spectrum,sptr))
 }
 END_SECTION
 
+START_SECTION((static void convertToColumnarSpectrum(const OpenSwath::SpectrumPtr sptr, ColumnarSpectrum<double, double> & spectrum)))
+{
+  OpenSwath::SpectrumPtr cptr(new OpenSwath::Spectrum());
+  cptr->getMZArray()->data.push_back(1.0);
+  cptr->getMZArray()->data.push_back(2.0);
+  cptr->getMZArray()->data.push_back(3.0);
+
+  cptr->getIntensityArray()->data.push_back(4.0);
+  cptr->getIntensityArray()->data.push_back(3.0);
+  cptr->getIntensityArray()->data.push_back(2.0);
+
+  ColumnarSpectrum<double, double> spectrum;
+  OpenSwathDataAccessHelper::convertToColumnarSpectrum(cptr, spectrum);
+
+  TEST_EQUAL(spectrum.size(), 3)
+  TEST_REAL_SIMILAR(spectrum.getMZ(0), 1.0)
+  TEST_REAL_SIMILAR(spectrum.getIntensity(0), 4.0)
+  TEST_REAL_SIMILAR(spectrum.getMZ(2), 3.0)
+  TEST_REAL_SIMILAR(spectrum.getIntensity(2), 2.0)
+  // input is not changed
+  TEST_EQUAL(cptr->getMZArray()->data.size(), 3)
+}
+END_SECTION
+
+START_SECTION((static OpenSwath::SpectrumPtr convertToSpectrumPtr(ColumnarSpectrum<double, double> && spectrum)))
+{
+  ColumnarSpectrum<double, double> spectrum;
+  spectrum.push_back(2.0, 1.0);
+  spectrum.push_back(10.0, 2.0);
+  spectrum.push_back(30.0, 3.0);
+  const double* mz_data = &spectrum.getMZArray()[0];
+
+  OpenSwath::SpectrumPtr p = OpenSwathDataAccessHelper::convertToSpectrumPtr(std::move(spectrum));
+  TEST_EQUAL(p->getMZArray()->data.size(), 3)
+  TEST_EQUAL(p->getIntensityArray()->data.size(), 3)
+  TEST_REAL_SIMILAR(p->getMZArray()->data[1], 10.0)
+  TEST_REAL_SIMILAR(p->getIntensityArray()->data[2], 3.0)
+  TEST_EQUAL(&p->getMZArray()->data[0] == mz_data, true) // no copy
+  TEST_EQUAL(spectrum.size(), 0)
+}
+END_SECTION
+
+START_SECTION((static void swapArrays(OpenSwath::SpectrumPtr sptr, ColumnarSpectrum<double, double> & spectrum)))
+{
+  OpenSwath::SpectrumPtr cptr(new OpenSwath::Spectrum());
+  cptr->getMZArray()->data.push_back(3.0);
+  cptr->getMZArray()->data.push_back(1.0);
+  cptr->getIntensityArray()->data.push_back(30.0);
+  cptr->getIntensityArray()->data.push_back(10.0);
+
+  // use the search and sort functions on the OpenSwath data
+  ColumnarSpectrum<double, double> spectrum;
+  OpenSwathDataAccessHelper::swapArrays(cptr, spectrum);
+  TEST_EQUAL(cptr->getMZArray()->data.size(), 0)
+  TEST_EQUAL(spectrum.size(), 2)
+  spectrum.sortByPosition();
+  TEST_EQUAL(spectrum.findNearest(1.2), 0)
+
+  // and swap back
+  OpenSwathDataAccessHelper::swapArrays(cptr, spectrum);
+  TEST_EQUAL(spectrum.size(), 0)
+  TEST_EQUAL(cptr->getMZArray()->data.size(), 2)
+  TEST_REAL_SIMILAR(cptr->getMZArray()->data[0], 1.0)
+  TEST_REAL_SIMILAR(cptr->getIntensityArray()->data[0], 10.0)
+
+  cptr->getMZArray()->data.push_back(5.0);
+  TEST_EXCEPTION(Exception::IllegalArgument, OpenSwathDataAccessHelper::swapArrays(cptr, spectrum))
+}
+END_SECTION
+
 START_SECTION((void OpenSwathDataAccessHelper::convertTargetedExp(const OpenMS::TargetedExperiment & transition_exp_, OpenSwath::LightTargetedExperiment & transition_exp)))
 {
   OpenMS::TargetedExperiment transition_exp_;
@@ -0,0 +1,212 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/OrderedTaskOutput.h>
+///////////////////////////
+
+#include <OpenMS/ANALYSIS/OPENSWATH/SwathTaskQueue.h>
+
+#include <chrono>
+#include <thread>
+
+using namespace OpenMS;
+using namespace std;
+
+typedef std::pair<Size, Size> Task;
+typedef std::vector<Task> TaskResult;
+
+START_TEST(OrderedTaskOutput, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+OrderedTaskOutput<TaskResult>* ptr = nullptr;
+OrderedTaskOutput<TaskResult>* nullPointer = nullptr;
+
+START_SECTION(OrderedTaskOutput(Size nr_maps, int max_pending, const std::function<void (ResultT&)>& write))
+{
+  ptr = new OrderedTaskOutput<TaskResult>(2, 0, [](TaskResult&) {});
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->getNrPending(), 0)
+}
+END_SECTION
+
+START_SECTION(~OrderedTaskOutput())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(void push(Size map_idx, Size batch_idx, ResultT& result))
+{
+  // batches are pushed out of order and interleaved across maps
+  std::vector<Task> written;
+  OrderedTaskOutput<TaskResult> output(3, 0, [&written](TaskResult& result)
+    {
+      written.insert(written.end(), result.begin(), result.end());
+    });
+  output.setNrBatches(0, 2);
+  output.setNrBatches(2, 3);
+
+  TaskResult result(1, Task(2, 1));
+  output.push(2, 1, result);
+  TEST_EQUAL(result.empty(), true) // the result was handed over
+  result.assign(1, Task(0, 1));
+  output.push(0, 1, result);
+  result.assign(1, Task(2, 0));
+  output.push(2, 0, result);
+  TEST_EQUAL(written.size(), 0)
+  TEST_EQUAL(output.getNrPending(), 3)
+
+  // map 0 can be written completely, map 1 is not known yet
+  result.assign(1, Task(0, 0));
+  output.push(0, 0, result);
+  TEST_EQUAL(written.size(), 2)
+  TEST_EQUAL(output.getNrPending(), 2)
+
+  // map 1 has no batches, so map 2 is written up to the missing batch
+  output.setNrBatches(1, 0);
+  TEST_EQUAL(written.size(), 4)
+  TEST_EQUAL(output.getNrPending(), 0)
+
+  result.assign(1, Task(2, 2));
+  output.push(2, 2, result);
+  TEST_EQUAL(output.getNrPending(), 0)
+
+  std::vector<Task> expected = {Task(0, 0), Task(0, 1), Task(2, 0), Task(2, 1), Task(2, 2)};
+  TEST_EQUAL(written.size(), expected.size())
+  ABORT_IF(written.size() != expected.size())
+  for (Size k = 0; k < expected.size(); ++k)
+  {
+    TEST_EQUAL(written[k].first, expected[k].first)
+    TEST_EQUAL(written[k].second, expected[k].second)
+  }
+}
+END_SECTION
+
+START_SECTION(void setNrBatches(Size map_idx, Size nr_batches))
+{
+  std::vector<Task> written;
+  OrderedTaskOutput<TaskResult> output(2, 1, [&written](TaskResult& result)
+    {
+      written.insert(written.end(), result.begin(), result.end());
+    });
+
+  // a result of map 1 is kept until map 0 is known to be empty
+  output.setNrBatches(1, 1);
+  TaskResult result(1, Task(1, 0));
+  output.push(1, 0, result);
+  TEST_EQUAL(written.size(), 0)
+  output.setNrBatches(0, 0);
+  TEST_EQUAL(written.size(), 1)
+  TEST_EQUAL(output.getNrPending(), 0)
+}
+END_SECTION
+
+START_SECTION(Size getNrPending())
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION([EXTRA] bounded number of pending results with several threads)
+{
+  // run SwathTaskQueue and OrderedTaskOutput as in OpenSwathWorkflow: every
+  // result has to be written exactly once and in (map, batch) order, and no
+  // more than max_pending results (plus the next one) are kept at any time
+  const std::vector<Size> nr_batches = {3, 0, 5, 1, 4, 7, 2};
+  const int max_pending = 3;
+  const Size nr_threads = 4;
+
+  SwathTaskQueue queue(nr_batches.size(), 2);
+  std::vector<Task> written;
+  Size max_seen_pending = 0;
+  OrderedTaskOutput<TaskResult>* output_ptr = nullptr;
+  OrderedTaskOutput<TaskResult> output(nr_batches.size(), max_pending, [&](TaskResult& result)
+    {
+      // only one thread writes at a time
+      max_seen_pending = std::max(max_seen_pending, output_ptr->getNrPending());
+      written.insert(written.end(), result.begin(), result.end());
+    });
+  output_ptr = &output;
+
+  std::vector<std::thread> threads;
+  for (Size t = 0; t < nr_threads; ++t)
+  {
+    threads.push_back(std::thread([&, t]()
+      {
+        Size map_idx, batch_idx;
+        SwathTaskQueue::Action action;
+        while ((action = queue.next(map_idx, batch_idx)) != SwathTaskQueue::DONE)
+        {
+          if (action == SwathTaskQueue::OPEN_MAP)
+          {
+            output.setNrBatches(map_idx, nr_batches[map_idx]);
+            queue.opened(map_idx, nr_batches[map_idx]);
+            continue;
+          }
+          // tasks take different amounts of time so that they finish out of order
+          std::this_thread::sleep_for(std::chrono::milliseconds((map_idx * 7 + batch_idx * 3 + t) % 5));
+          TaskResult result(1, Task(map_idx, batch_idx));
+          output.push(map_idx, batch_idx, result);
+          queue.finished(map_idx);
+        }
+      }));
+  }
+  for (Size t = 0; t < threads.size(); ++t) threads[t].join();
+
+  std::vector<Task> expected;
+  for (Size i = 0; i < nr_batches.size(); ++i)
+  {
+    for (Size b = 0; b < nr_batches[i]; ++b) expected.push_back(Task(i, b));
+  }
+  TEST_EQUAL(written.size(), expected.size())
+  ABORT_IF(written.size() != expected.size())
+  for (Size k = 0; k < expected.size(); ++k)
+  {
+    TEST_EQUAL(written[k].first, expected[k].first)
+    TEST_EQUAL(written[k].second, expected[k].second)
+  }
+  TEST_EQUAL(max_seen_pending <= (Size)max_pending + 1, true)
+  TEST_EQUAL(output.getNrPending(), 0)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -246,6 +246,40 @@ START_SECTION(void setMaxDataPoolSize(Size size))
 }
 END_SECTION
 
+START_SECTION(bool getPipelinedProcessing() const)
+{
+	PeakFileOptions tmp;
+	TEST_EQUAL(tmp.getPipelinedProcessing(), false);
+}
+END_SECTION
+
+START_SECTION(void setPipelinedProcessing(bool pipelined))
+{
+	PeakFileOptions tmp;
+	tmp.setPipelinedProcessing(true);
+	TEST_EQUAL(tmp.getPipelinedProcessing(), true);
+	PeakFileOptions copy(tmp);
+	TEST_EQUAL(copy.getPipelinedProcessing(), true);
+}
+END_SECTION
+
+START_SECTION(bool getParallelWriting() const)
+{
+	PeakFileOptions tmp;
+	TEST_EQUAL(tmp.getParallelWriting(), false);
+}
+END_SECTION
+
+START_SECTION(void setParallelWriting(bool parallel))
+{
+	PeakFileOptions tmp;
+	tmp.setParallelWriting(true);
+	TEST_EQUAL(tmp.getParallelWriting(), true);
+	PeakFileOptions copy(tmp);
+	TEST_EQUAL(copy.getParallelWriting(), true);
+}
+END_SECTION
+
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
@@ -338,6 +338,104 @@ START_SECTION(([EXTRA]virtual void run(const std::vector<Peak2D> & map_model, co
 }
 END_SECTION
 
+START_SECTION((static void selectByIntensityRank(std::vector<Peak2D> & map, const Size num_used_points, const Size stride)))
+{
+  // the RT encodes the input position, two points share the highest intensity
+  double intensities[] = {5, 9, 1, 9, 7, 3, 8, 2, 6, 4};
+  std::vector<Peak2D> map;
+  for (Size i = 0; i < 10; i++)
+  {
+    Peak2D p;
+    p.setRT(i);
+    p.setIntensity(intensities[i]);
+    map.push_back(p);
+  }
+
+  // stride 1: the most intense points (in any order)
+  std::vector<Peak2D> selected(map);
+  PoseClusteringAffineSuperimposer::selectByIntensityRank(selected, 4, 1);
+  TEST_EQUAL(selected.size(), 4)
+  std::sort(selected.begin(), selected.end(), Peak2D::RTLess());
+  TEST_REAL_SIMILAR(selected[0].getRT(), 1.0)
+  TEST_REAL_SIMILAR(selected[1].getRT(), 3.0)
+  TEST_REAL_SIMILAR(selected[2].getRT(), 4.0)
+  TEST_REAL_SIMILAR(selected[3].getRT(), 6.0)
+
+  // ranking: 1, 3 (tie kept in input order), 6, 4, 8, 0 | 9, 5, 7, 2
+  selected = map;
+  PoseClusteringAffineSuperimposer::selectByIntensityRank(selected, 6, 2);
+  TEST_EQUAL(selected.size(), 3)
+  TEST_REAL_SIMILAR(selected[0].getRT(), 1.0)
+  TEST_REAL_SIMILAR(selected[1].getRT(), 6.0)
+  TEST_REAL_SIMILAR(selected[2].getRT(), 8.0)
+
+  selected = map;
+  PoseClusteringAffineSuperimposer::selectByIntensityRank(selected, 10, 3);
+  TEST_EQUAL(selected.size(), 4)
+  TEST_REAL_SIMILAR(selected[0].getRT(), 1.0)
+  TEST_REAL_SIMILAR(selected[1].getRT(), 4.0)
+  TEST_REAL_SIMILAR(selected[2].getRT(), 9.0)
+  TEST_REAL_SIMILAR(selected[3].getRT(), 2.0)
+
+  // stride larger than the number of points: only the most intense one
+  selected = map;
+  PoseClusteringAffineSuperimposer::selectByIntensityRank(selected, 10, 20);
+  TEST_EQUAL(selected.size(), 1)
+  TEST_REAL_SIMILAR(selected[0].getRT(), 1.0)
+}
+END_SECTION
+
+START_SECTION(([EXTRA] subsample_stride))
+{
+  std::vector<Peak2D> map_model, map_scene;
+
+  // the two true pairs are ranked 1st and 3rd by intensity, chaff in between
+  double map1_rt[] = {1.0, 1.3, 5.0, 2.2};
+  double map2_rt[] = {1.4, 4.4, 5.4, 4.4};
+
+  double map1_mz[] = {1.0 , 800, 5.0 , 900};
+  double map2_mz[] = {1.02, 800, 5.02, 900};
+
+  double map1_int[] = {100, 90, 80, 70};
+  double map2_int[] = {100, 90, 80, 70};
+
+  for (Size i = 0; i < 4; i++)
+  {
+    Peak2D p;
+    p.setRT(map1_rt[i]);
+    p.setMZ(map1_mz[i]);
+    p.setIntensity(map1_int[i]);
+    map_model.push_back(p);
+  }
+  for (Size i = 0; i < 4; i++)
+  {
+    Peak2D p;
+    p.setRT(map2_rt[i]);
+    p.setMZ(map2_mz[i]);
+    p.setIntensity(map2_int[i]);
+    map_scene.push_back(p);
+  }
+
+  // every 2nd point skips the chaff -> same results as with the two true pairs only
+  Param parameters;
+  parameters.setValue(String("scaling_bucket_size"), 0.01);
+  parameters.setValue(String("shift_bucket_size"), 0.1);
+  parameters.setValue(String("subsample_stride"), 2);
+
+  TransformationDescription transformation;
+  PoseClusteringAffineSuperimposer pcat;
+  pcat.setParameters(parameters);
+
+  pcat.run(map_model, map_scene, transformation);
+
+  TEST_STRING_EQUAL(transformation.getModelType(), "linear")
+  parameters = transformation.getModelParameters();
+  TEST_EQUAL(parameters.size(), 2)
+  TEST_REAL_SIMILAR(parameters.getValue("slope"), 1.0)
+  TEST_REAL_SIMILAR(parameters.getValue("intercept"), -0.4)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
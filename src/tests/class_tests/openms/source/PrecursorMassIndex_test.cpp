@@ -0,0 +1,247 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/ID/PrecursorMassIndex.h>
+#include <OpenMS/CONCEPT/Constants.h>
+///////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(PrecursorMassIndex, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+PrecursorMassIndex* ptr = nullptr;
+PrecursorMassIndex* null_ptr = nullptr;
+START_SECTION(PrecursorMassIndex())
+{
+  ptr = new PrecursorMassIndex();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->empty(), true)
+  TEST_EQUAL(ptr->isBuilt(), false)
+}
+END_SECTION
+
+START_SECTION(~PrecursorMassIndex())
+{
+  delete ptr;
+}
+END_SECTION
+
+PrecursorMassIndex index;
+
+START_SECTION(void add(double mass, Size spectrum_index, int isotope_error = 0))
+{
+  index.add(1000.0, 0);
+  index.add(800.0, 1);
+  index.add(1000.0, 2);
+  index.add(1200.0, 3, 1);
+  TEST_EQUAL(index.size(), 4)
+  TEST_EQUAL(index.empty(), false)
+}
+END_SECTION
+
+START_SECTION(void addPrecursor(double precursor_mass, Size spectrum_index, const IntList& isotope_errors))
+{
+  index.addPrecursor(1500.0, 4, ListUtils::create<Int>("0,1"));
+  TEST_EQUAL(index.size(), 6)
+}
+END_SECTION
+
+START_SECTION(void build())
+{
+  TEST_EXCEPTION(Exception::Precondition, index.find(1000.0, 10.0, true))
+  index.build();
+  TEST_EQUAL(index.isBuilt(), true)
+
+  // sorted by mass, equal masses in order of insertion
+  TEST_REAL_SIMILAR(index[0].mass, 800.0)
+  TEST_EQUAL(index[1].spectrum_index, 0)
+  TEST_EQUAL(index[2].spectrum_index, 2)
+  TEST_EQUAL(index[3].isotope_error, 1)
+  TEST_REAL_SIMILAR(index[4].mass, 1500.0 - Constants::C13C12_MASSDIFF_U)
+  TEST_EQUAL(index[4].isotope_error, 1)
+  TEST_EQUAL(index[5].isotope_error, 0)
+
+  // adding entries requires a rebuild
+  PrecursorMassIndex tmp;
+  tmp.add(1.0, 0);
+  tmp.build();
+  tmp.add(2.0, 1);
+  TEST_EQUAL(tmp.isBuilt(), false)
+}
+END_SECTION
+
+START_SECTION(bool isBuilt() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(Size size() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(bool empty() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(const Entry& operator[](Size index) const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(ConstIterator begin() const)
+{
+  TEST_REAL_SIMILAR(index.begin()->mass, 800.0)
+}
+END_SECTION
+
+START_SECTION(ConstIterator end() const)
+{
+  TEST_EQUAL(index.end() - index.begin(), 6)
+}
+END_SECTION
+
+START_SECTION(Range findByMass(double mass_low, double mass_high) const)
+{
+  PrecursorMassIndex::Range r = index.findByMass(1000.0, 1200.0);
+  TEST_EQUAL(r.first - index.begin(), 1)
+  TEST_EQUAL(r.second - index.begin(), 4)
+
+  r = index.findByMass(0.0, 100.0);
+  TEST_EQUAL(r.first == r.second, true)
+
+  r = index.findByMass(2000.0, 3000.0);
+  TEST_EQUAL(r.first == index.end(), true)
+  TEST_EQUAL(r.second == index.end(), true)
+
+  r = index.findByMass(0.0, 3000.0);
+  TEST_EQUAL(r.second - r.first, 6)
+}
+END_SECTION
+
+START_SECTION(Range find(double mass, double tolerance, bool tolerance_unit_ppm) const)
+{
+  // 10 ppm of 1000.005 are 0.01 Da
+  PrecursorMassIndex::Range r = index.find(1000.005, 10.0, true);
+  TEST_EQUAL(r.second - r.first, 2)
+  TEST_EQUAL(r.first->spectrum_index, 0)
+  r = index.find(1000.02, 10.0, true);
+  TEST_EQUAL(r.second - r.first, 0)
+
+  r = index.find(1499.5, 1.0, false);
+  TEST_EQUAL(r.second - r.first, 2)
+  TEST_EQUAL(r.first->spectrum_index, 4)
+  TEST_EQUAL((r.first + 1)->spectrum_index, 4)
+}
+END_SECTION
+
+START_SECTION(void find(const std::vector<double>& masses, double tolerance, bool tolerance_unit_ppm, std::vector<Range>& ranges) const)
+{
+  vector<PrecursorMassIndex::Range> ranges;
+  vector<double> sorted = {800.0, 1000.0, 1100.0, 1200.0};
+  index.find(sorted, 1.0, false, ranges);
+  TEST_EQUAL(ranges.size(), 4)
+  for (Size i = 0; i != sorted.size(); ++i)
+  {
+    TEST_EQUAL(ranges[i] == index.find(sorted[i], 1.0, false), true)
+  }
+  TEST_EQUAL(ranges[1].second - ranges[1].first, 2)
+  TEST_EQUAL(ranges[2].second - ranges[2].first, 0)
+
+  vector<double> unsorted = {1200.0, 800.0, 1000.0};
+  index.find(unsorted, 5.0, true, ranges);
+  TEST_EQUAL(ranges.size(), 3)
+  for (Size i = 0; i != unsorted.size(); ++i)
+  {
+    TEST_EQUAL(ranges[i] == index.find(unsorted[i], 5.0, true), true)
+  }
+
+  // larger index (with repeated masses): batched and single lookups agree
+  PrecursorMassIndex large;
+  for (Size i = 0; i != 1000; ++i)
+  {
+    large.add(500.0 + (i % 700) * 0.37, i);
+  }
+  large.build();
+
+  vector<double> single = {612.3};
+  large.find(single, 10.0, true, ranges);
+  TEST_EQUAL(ranges.size(), 1)
+  TEST_EQUAL(ranges[0] == large.find(612.3, 10.0, true), true)
+  TEST_EQUAL(ranges[0].second - ranges[0].first > 0, true)
+
+  // overlapping windows, equal masses and masses outside of the index
+  vector<double> many = {100.0, 500.0, 500.1, 500.1, 555.55, 556.0, 640.0, 758.63, 758.63, 900.0, 2000.0};
+  for (double tolerance : {0.05, 0.5, 3.0})
+  {
+    large.find(many, tolerance, false, ranges);
+    TEST_EQUAL(ranges.size(), many.size())
+    for (Size i = 0; i != many.size(); ++i)
+    {
+      TEST_EQUAL(ranges[i] == large.find(many[i], tolerance, false), true)
+    }
+  }
+  large.find(many, 500.0, true, ranges);
+  for (Size i = 0; i != many.size(); ++i)
+  {
+    TEST_EQUAL(ranges[i] == large.find(many[i], 500.0, true), true)
+  }
+}
+END_SECTION
+
+START_SECTION(void clear())
+{
+  index.clear();
+  TEST_EQUAL(index.empty(), true)
+  TEST_EQUAL(index.isBuilt(), false)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
+
@@ -0,0 +1,315 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/ID/SpectralLibraryIndex.h>
+///////////////////////////
+
+#include <OpenMS/KERNEL/MSExperiment.h>
+
+#include <cstring>
+#include <fstream>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(SpectralLibraryIndex, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+// small synthetic library: spectra with shifted fragment ladders, in random precursor order
+PeakMap spec_db;
+for (Size i = 0; i < 200; ++i)
+{
+  MSSpectrum spec;
+  Precursor prec;
+  prec.setMZ(100.0 + ((i * 37) % 200) * 0.35);
+  prec.setCharge(i % 5 == 0 ? -1 : 1);
+  spec.getPrecursors().push_back(prec);
+  for (Size p = 0; p < 10; ++p)
+  {
+    spec.push_back(Peak1D(50.0 + p * 7.0 + (i % 7) * 0.001, 100.0f + p + i));
+  }
+  spec_db.addSpectrum(spec);
+}
+
+SpectralLibraryIndex* ptr = nullptr;
+SpectralLibraryIndex* null_ptr = nullptr;
+START_SECTION(SpectralLibraryIndex())
+{
+  ptr = new SpectralLibraryIndex();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->findPrecursorRange(0.0, 1000.0).first, ptr->findPrecursorRange(0.0, 1000.0).second)
+  TEST_EQUAL(ptr->matches(PeakMap()), true)
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(void build(const PeakMap& spec_db, double bin_width = 1.0))
+{
+  SpectralLibraryIndex index;
+  PeakMap no_prec(spec_db);
+  no_prec[17].getPrecursors().clear();
+  TEST_EXCEPTION(Exception::MissingInformation, index.build(no_prec))
+  TEST_EXCEPTION(Exception::InvalidValue, index.build(spec_db, 0.0))
+
+  index.build(spec_db, 0.5);
+  TEST_EQUAL(index.size(), spec_db.size())
+
+  // entries sorted by precursor, referring to their library spectrum
+  bool sorted(true), consistent(true);
+  for (Size i = 0; i < index.size(); ++i)
+  {
+    if (i > 0 && index.getPrecursorMZ(i - 1) > index.getPrecursorMZ(i)) sorted = false;
+    const MSSpectrum& spec = spec_db[index.getLibraryIndex(i)];
+    if (spec.getPrecursors()[0].getMZ() != index.getPrecursorMZ(i) ||
+        spec.getPrecursors()[0].getCharge() != index.getPrecursorCharge(i) ||
+        spec.size() != index.getPeakCount(i) ||
+        spec[9].getMZ() != index.getPeakMZ(i)[9] ||
+        spec[9].getIntensity() != index.getPeakIntensity(i)[9])
+    {
+      consistent = false;
+    }
+  }
+  TEST_EQUAL(sorted, true)
+  TEST_EQUAL(consistent, true)
+}
+END_SECTION
+
+START_SECTION((std::pair<Size, Size> findPrecursorRange(double mz_lower, double mz_upper) const))
+{
+  SpectralLibraryIndex index;
+  index.build(spec_db, 0.5);
+
+  // precursor ranges agree with a brute-force scan
+  bool ranges_ok(true);
+  for (Size q = 0; q < 500; ++q)
+  {
+    double lower = 95.0 + q * 0.163;
+    double upper = lower + (q % 4) * 0.3;
+    std::pair<Size, Size> range = index.findPrecursorRange(lower, upper);
+    for (Size i = 0; i < index.size(); ++i)
+    {
+      bool inside = (index.getPrecursorMZ(i) >= lower && index.getPrecursorMZ(i) <= upper);
+      if (inside != (i >= range.first && i < range.second)) ranges_ok = false;
+    }
+  }
+  TEST_EQUAL(ranges_ok, true)
+  TEST_EQUAL(index.findPrecursorRange(160.0, 150.0).first, index.findPrecursorRange(160.0, 150.0).second)
+}
+END_SECTION
+
+START_SECTION(bool matches(const PeakMap& spec_db) const)
+{
+  SpectralLibraryIndex index;
+  index.build(spec_db);
+  TEST_EQUAL(index.matches(spec_db), true)
+
+  PeakMap no_prec(spec_db);
+  no_prec[17].getPrecursors().clear();
+  TEST_EQUAL(index.matches(no_prec), false)
+
+  PeakMap shorter(spec_db);
+  shorter.getSpectra().pop_back();
+  TEST_EQUAL(index.matches(shorter), false)
+
+  // same precursors and peak counts, but different fragment peaks
+  PeakMap changed_peaks(spec_db);
+  changed_peaks[42][3].setIntensity(1.0f);
+  TEST_EQUAL(index.matches(changed_peaks), false)
+  changed_peaks = spec_db;
+  changed_peaks[42][3].setMZ(changed_peaks[42][3].getMZ() + 0.01);
+  TEST_EQUAL(index.matches(changed_peaks), false)
+
+  PeakMap changed_charge(spec_db);
+  changed_charge[5].getPrecursors()[0].setCharge(2);
+  TEST_EQUAL(index.matches(changed_charge), false)
+}
+END_SECTION
+
+START_SECTION(UInt64 getChecksum() const)
+{
+  SpectralLibraryIndex index, other;
+  index.build(spec_db);
+  other.build(spec_db, 2.0);
+  TEST_EQUAL(index.getChecksum(), other.getChecksum()) // independent of the binning
+
+  PeakMap changed_peaks(spec_db);
+  changed_peaks[42][3].setIntensity(1.0f);
+  other.build(changed_peaks);
+  TEST_NOT_EQUAL(index.getChecksum(), other.getChecksum())
+}
+END_SECTION
+
+START_SECTION(void store(const String& filename) const)
+{
+  SpectralLibraryIndex index;
+  index.build(spec_db);
+  TEST_EXCEPTION(Exception::UnableToCreateFile, index.store("/does/not/exist/index.idx"))
+}
+END_SECTION
+
+START_SECTION(void load(const String& filename))
+{
+  SpectralLibraryIndex index;
+  index.build(spec_db, 0.5);
+
+  String filename;
+  NEW_TMP_FILE(filename)
+  index.store(filename);
+  SpectralLibraryIndex loaded;
+  loaded.load(filename);
+  TEST_EQUAL(loaded.size(), index.size())
+  TEST_EQUAL(loaded.getChecksum(), index.getChecksum())
+  TEST_EQUAL(loaded.matches(spec_db), true)
+  TEST_EQUAL(loaded.findPrecursorRange(150.0, 160.0) == index.findPrecursorRange(150.0, 160.0), true)
+
+  TEST_EXCEPTION(Exception::FileNotFound, loaded.load("this_file_does_not_exist.idx"))
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(OPENMS_GET_TEST_DATA_PATH("AbsoluteQuantitationMethodFile_in_1.csv")))
+  TEST_EQUAL(loaded.size(), 0) // reset after a failed load
+
+  std::string content;
+  {
+    std::ifstream ifs(filename.c_str(), std::ios::binary);
+    content.assign((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+  }
+
+  // truncated file
+  String corrupt_filename;
+  NEW_TMP_FILE(corrupt_filename)
+  {
+    std::ofstream ofs(corrupt_filename.c_str(), std::ios::binary);
+    ofs.write(content.c_str(), content.size() - 10);
+  }
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(corrupt_filename))
+
+  // changed peak intensity (the last value in the file): the checksum does not match
+  {
+    std::string changed(content);
+    changed[changed.size() - 2] ^= 0x01;
+    std::ofstream ofs(corrupt_filename.c_str(), std::ios::binary);
+    ofs.write(changed.c_str(), changed.size());
+  }
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(corrupt_filename))
+
+  // other format version (stored after the magic number)
+  {
+    std::string changed(content);
+    int version = 99;
+    changed.replace(sizeof(int), sizeof(int), (const char*)&version, sizeof(int));
+    std::ofstream ofs(corrupt_filename.c_str(), std::ios::binary);
+    ofs.write(changed.c_str(), changed.size());
+  }
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(corrupt_filename))
+
+  // library index out of bounds (offsets of the index are consistent otherwise)
+  {
+    // header: magic number, version, checksum, bin width, minimum m/z
+    Size pos = 2 * sizeof(int) + sizeof(UInt64) + 2 * sizeof(double);
+    Size nr_bins(0), nr_entries(0);
+    std::memcpy(&nr_bins, content.c_str() + pos, sizeof(Size));
+    pos += sizeof(Size) + nr_bins * sizeof(Size); // bin offsets
+    std::memcpy(&nr_entries, content.c_str() + pos, sizeof(Size));
+    pos += sizeof(Size) + nr_entries * sizeof(double); // precursor m/z
+    pos += sizeof(Size) + nr_entries * sizeof(Int); // precursor charges
+    pos += sizeof(Size); // size of the library indices
+    TEST_EQUAL(nr_entries, spec_db.size())
+
+    std::string changed(content);
+    Size library_index = spec_db.size();
+    changed.replace(pos, sizeof(Size), (const char*)&library_index, sizeof(Size));
+    std::ofstream ofs(corrupt_filename.c_str(), std::ios::binary);
+    ofs.write(changed.c_str(), changed.size());
+  }
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(corrupt_filename))
+
+  // an empty index
+  SpectralLibraryIndex empty;
+  empty.store(filename);
+  loaded.load(filename);
+  TEST_EQUAL(loaded.size(), 0)
+  TEST_EQUAL(loaded.matches(PeakMap()), true)
+}
+END_SECTION
+
+START_SECTION(Size size() const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(double getPrecursorMZ(Size i) const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(Int getPrecursorCharge(Size i) const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(Size getLibraryIndex(Size i) const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(Size getPeakCount(Size i) const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(const double* getPeakMZ(Size i) const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION(const float* getPeakIntensity(Size i) const)
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -0,0 +1,151 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCachedColumnar.h>
+///////////////////////////
+
+#include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(SpectrumAccessOpenMSCachedColumnar, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+SpectrumAccessOpenMSCachedColumnar* ptr = nullptr;
+SpectrumAccessOpenMSCachedColumnar* nullPointer = nullptr;
+
+PeakMap exp;
+MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+std::string tmp_filename;
+NEW_TMP_FILE(tmp_filename);
+Internal::ColumnarCachedMzMLHandler::write(exp, tmp_filename);
+
+START_SECTION(explicit SpectrumAccessOpenMSCachedColumnar(const String& filename))
+{
+  ptr = new SpectrumAccessOpenMSCachedColumnar(tmp_filename);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EXCEPTION(Exception::FileNotFound, SpectrumAccessOpenMSCachedColumnar(OPENMS_GET_TEST_DATA_PATH("this_file_does_not_exist.cached")))
+}
+END_SECTION
+
+START_SECTION(~SpectrumAccessOpenMSCachedColumnar())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(explicit SpectrumAccessOpenMSCachedColumnar(const Internal::ColumnarCachedMzMLHandler& handler))
+{
+  Internal::ColumnarCachedMzMLHandler handler(tmp_filename);
+  SpectrumAccessOpenMSCachedColumnar access(handler);
+  TEST_EQUAL(access.getNrSpectra(), 4)
+  TEST_EQUAL(access.getHandler().getSpectrumMZ<double>(0).data, handler.getSpectrumMZ<double>(0).data)
+}
+END_SECTION
+
+START_SECTION(size_t getNrSpectra() const)
+{
+  SpectrumAccessOpenMSCachedColumnar access(tmp_filename);
+  TEST_EQUAL(access.getNrSpectra(), 4)
+  TEST_EQUAL(access.getNrChromatograms(), 2)
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumPtr getSpectrumById(int id))
+{
+  SpectrumAccessOpenMSCachedColumnar access(tmp_filename);
+  OpenSwath::SpectrumPtr spectrum = access.getSpectrumById(1);
+  TEST_EQUAL(spectrum->getMZArray()->data.size(), exp[1].size())
+  TEST_EQUAL(spectrum->getIntensityArray()->data.size(), exp[1].size())
+  TEST_REAL_SIMILAR(spectrum->getMZArray()->data[2], exp[1][2].getMZ())
+  TEST_REAL_SIMILAR(spectrum->getIntensityArray()->data[2], exp[1][2].getIntensity())
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const)
+{
+  SpectrumAccessOpenMSCachedColumnar access(tmp_filename);
+  OpenSwath::SpectrumMeta meta = access.getSpectrumMetaById(2);
+  TEST_REAL_SIMILAR(meta.RT, exp[2].getRT())
+  TEST_EQUAL(meta.ms_level, exp[2].getMSLevel())
+  TEST_EQUAL(meta.id, exp[2].getNativeID())
+  TEST_EQUAL(meta.index, 2)
+}
+END_SECTION
+
+START_SECTION(std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const)
+{
+  // spectra at 5.1, 5.2, 5.3 and 5.4 seconds
+  SpectrumAccessOpenMSCachedColumnar access(tmp_filename);
+  std::vector<std::size_t> result = access.getSpectraByRT(5.25, 0.1);
+  TEST_EQUAL(result.size(), 2)
+  TEST_EQUAL(result[0], 1)
+  TEST_EQUAL(result[1], 2)
+
+  TEST_EQUAL(access.getSpectraByRT(10.0, 0.1).size(), 0)
+  TEST_EQUAL(access.getSpectraByRT(5.25, 1.0).size(), 4)
+}
+END_SECTION
+
+START_SECTION(OpenSwath::ChromatogramPtr getChromatogramById(int id))
+{
+  SpectrumAccessOpenMSCachedColumnar access(tmp_filename);
+  OpenSwath::ChromatogramPtr chromatogram = access.getChromatogramById(1);
+  TEST_EQUAL(chromatogram->getTimeArray()->data.size(), exp.getChromatograms()[1].size())
+  TEST_REAL_SIMILAR(chromatogram->getTimeArray()->data[4], exp.getChromatograms()[1][4].getRT())
+  TEST_REAL_SIMILAR(chromatogram->getIntensityArray()->data[4], exp.getChromatograms()[1][4].getIntensity())
+  TEST_EQUAL(access.getChromatogramNativeID(1), exp.getChromatograms()[1].getNativeID())
+}
+END_SECTION
+
+START_SECTION(boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const)
+{
+  SpectrumAccessOpenMSCachedColumnar access(tmp_filename);
+  boost::shared_ptr<OpenSwath::ISpectrumAccess> clone = access.lightClone();
+  TEST_EQUAL(clone->getNrSpectra(), 4)
+  TEST_EQUAL(clone->getSpectrumById(0)->getMZArray()->data.size(), exp[0].size())
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
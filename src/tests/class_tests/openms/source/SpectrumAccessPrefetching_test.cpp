@@ -0,0 +1,167 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessPrefetching.h>
+///////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+boost::shared_ptr<PeakMap > getData()
+{
+  // spectrum i has RT i and i+1 peaks with m/z 100, 101, ...
+  boost::shared_ptr<PeakMap > exp2(new PeakMap);
+  for (Size i = 0; i < 50; ++i)
+  {
+    MSSpectrum spec;
+    spec.setRT(i);
+    for (Size k = 0; k <= i; ++k)
+    {
+      Peak1D p;
+      p.setMZ(100 + k);
+      p.setIntensity(i);
+      spec.push_back(p);
+    }
+    exp2->addSpectrum(spec);
+  }
+  return exp2;
+}
+
+START_TEST(SpectrumAccessPrefetching, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+SpectrumAccessPrefetching* ptr = nullptr;
+SpectrumAccessPrefetching* nullPointer = nullptr;
+
+boost::shared_ptr<PeakMap > exp(new PeakMap);
+OpenSwath::SpectrumAccessPtr expptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp);
+
+START_SECTION(SpectrumAccessPrefetching(OpenSwath::SpectrumAccessPtr sptr, Size prefetch_size = 16, Size memory_budget = 0))
+{
+  ptr = new SpectrumAccessPrefetching(expptr);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->getPrefetchSize(), 16)
+  TEST_EQUAL(ptr->getMemoryBudget(), 0)
+
+  TEST_EXCEPTION(Exception::IllegalArgument, SpectrumAccessPrefetching(expptr, 0))
+}
+END_SECTION
+
+START_SECTION(~SpectrumAccessPrefetching())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(size_t getNrSpectra() const)
+{
+  SpectrumAccessPrefetching prefetch(expptr);
+  TEST_EQUAL(prefetch.getNrSpectra(), 0)
+
+  OpenSwath::SpectrumAccessPtr expptr2 = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(getData());
+  SpectrumAccessPrefetching prefetch2(expptr2);
+  TEST_EQUAL(prefetch2.getNrSpectra(), 50)
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumPtr getSpectrumById(int id))
+{
+  OpenSwath::SpectrumAccessPtr expptr2 = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(getData());
+
+  // sequential access
+  {
+    SpectrumAccessPrefetching prefetch(expptr2, 4);
+    for (int i = 0; i < 50; ++i)
+    {
+      OpenSwath::SpectrumPtr s = prefetch.getSpectrumById(i);
+      TEST_EQUAL(s->getMZArray()->data.size(), i + 1)
+      TEST_REAL_SIMILAR(s->getIntensityArray()->data[0], i)
+    }
+  }
+
+  // skipping, going backwards and repeating spectra
+  {
+    SpectrumAccessPrefetching prefetch(expptr2, 4);
+    int ids[] = {0, 1, 5, 6, 7, 3, 3, 30, 31, 49, 0, 20};
+    for (Size i = 0; i < sizeof(ids) / sizeof(ids[0]); ++i)
+    {
+      OpenSwath::SpectrumPtr s = prefetch.getSpectrumById(ids[i]);
+      TEST_EQUAL(s->getMZArray()->data.size(), ids[i] + 1)
+      TEST_REAL_SIMILAR(s->getIntensityArray()->data[0], ids[i])
+    }
+  }
+
+  // a memory budget smaller than a single spectrum still reads ahead one spectrum at a time
+  {
+    SpectrumAccessPrefetching prefetch(expptr2, 16, 1);
+    for (int i = 10; i < 50; ++i)
+    {
+      OpenSwath::SpectrumPtr s = prefetch.getSpectrumById(i);
+      TEST_EQUAL(s->getMZArray()->data.size(), i + 1)
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const)
+{
+  OpenSwath::SpectrumAccessPtr expptr2 = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(getData());
+  SpectrumAccessPrefetching prefetch(expptr2);
+  TEST_REAL_SIMILAR(prefetch.getSpectrumMetaById(7).RT, 7)
+  TEST_EQUAL(prefetch.getSpectraByRT(7.0, 1.5).size(), 3)
+}
+END_SECTION
+
+START_SECTION(boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const)
+{
+  OpenSwath::SpectrumAccessPtr expptr2 = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(getData());
+  SpectrumAccessPrefetching prefetch(expptr2, 8);
+  boost::shared_ptr<OpenSwath::ISpectrumAccess> clone = prefetch.lightClone();
+  TEST_EQUAL(clone->getNrSpectra(), 50)
+  TEST_EQUAL(prefetch.getSpectrumById(3)->getMZArray()->data.size(), clone->getSpectrumById(3)->getMZArray()->data.size())
+  TEST_EQUAL(boost::dynamic_pointer_cast<SpectrumAccessPrefetching>(clone)->getPrefetchSize(), 8)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
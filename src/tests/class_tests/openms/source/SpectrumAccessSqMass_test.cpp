@@ -249,6 +249,81 @@ START_SECTION(void getAllSpectra(std::vector< OpenSwath::SpectrumPtr > & spectra
 }
 END_SECTION
 
+START_SECTION(OpenSwath::SpectrumPtr getSpectrumById(int id))
+{
+  OpenMS::Internal::MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"));
+
+  ptr = new SpectrumAccessSqMass(handler);
+  OpenSwath::SpectrumPtr s0 = ptr->getSpectrumById(0);
+  OpenSwath::SpectrumPtr s1 = ptr->getSpectrumById(1);
+  TEST_EQUAL(s0->getMZArray()->data.size(), 19914)
+  TEST_EQUAL(s0->getIntensityArray()->data.size(), 19914)
+  TEST_EQUAL(s1->getMZArray()->data.size(), 19800)
+
+  // access through a subset refers to the positions within the subset
+  std::vector<int> indices;
+  indices.push_back(1);
+  SpectrumAccessSqMass subset(handler, indices);
+  OpenSwath::SpectrumPtr s = subset.getSpectrumById(0);
+  TEST_EQUAL(s->getMZArray()->data.size(), 19800)
+  TEST_EQUAL(s->getMZArray()->data[100], s1->getMZArray()->data[100])
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const)
+{
+  OpenMS::Internal::MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"));
+
+  ptr = new SpectrumAccessSqMass(handler);
+  OpenSwath::SpectrumMeta m = ptr->getSpectrumMetaById(1);
+  TEST_EQUAL(m.index, 1)
+  TEST_EQUAL(m.id, "controllerType=0 controllerNumber=1 scan=2")
+  TEST_REAL_SIMILAR(m.RT, 0.4738)
+  TEST_EQUAL(m.ms_level, 1)
+
+  std::vector<int> indices;
+  indices.push_back(1);
+  SpectrumAccessSqMass subset(handler, indices);
+  m = subset.getSpectrumMetaById(0);
+  TEST_EQUAL(m.index, 1)
+  TEST_EQUAL(m.id, "controllerType=0 controllerNumber=1 scan=2")
+}
+END_SECTION
+
+START_SECTION(std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const)
+{
+  OpenMS::Internal::MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"));
+
+  ptr = new SpectrumAccessSqMass(handler);
+  std::vector<std::size_t> result = ptr->getSpectraByRT(0.3, 0.1);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 0)
+
+  result = ptr->getSpectraByRT(0.4, 0.2);
+  TEST_EQUAL(result.size(), 2)
+  TEST_EQUAL(result[0], 0)
+  TEST_EQUAL(result[1], 1)
+
+  // first spectrum after RT
+  result = ptr->getSpectraByRT(0.3, 0.0);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 1)
+  result = ptr->getSpectraByRT(0.5, 0.0);
+  TEST_EQUAL(result.size(), 0)
+
+  // results are positions within the subset
+  std::vector<int> indices;
+  indices.push_back(1);
+  SpectrumAccessSqMass subset(handler, indices);
+  result = subset.getSpectraByRT(0.4, 0.2);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 0)
+  result = subset.getSpectraByRT(0.2, 0.0);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 0)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -0,0 +1,181 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/DATASTRUCTURES/StaticKDTree2D.h>
+///////////////////////////
+
+#include <algorithm>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(StaticKDTree2D, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+StaticKDTree2D* ptr = nullptr;
+StaticKDTree2D* null_ptr = nullptr;
+START_SECTION(StaticKDTree2D())
+{
+  ptr = new StaticKDTree2D();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->empty(), true)
+  TEST_EQUAL(ptr->size(), 0)
+}
+END_SECTION
+
+START_SECTION(~StaticKDTree2D())
+{
+  delete ptr;
+}
+END_SECTION
+
+// points on a 20 x 20 grid (x = 0..19, y = 0..9.5), index = 20 * x + 2 * y
+vector<double> xs, ys;
+for (Size x = 0; x < 20; ++x)
+{
+  for (Size y = 0; y < 20; ++y)
+  {
+    xs.push_back(x);
+    ys.push_back(y * 0.5);
+  }
+}
+
+START_SECTION(void build(const std::vector<double>& x, const std::vector<double>& y))
+{
+  StaticKDTree2D tree;
+  tree.build(xs, ys);
+  TEST_EQUAL(tree.size(), 400)
+  TEST_EQUAL(tree.empty(), false)
+
+  // rebuilding replaces the content
+  tree.build(vector<double>(3, 1.0), vector<double>(3, 2.0));
+  TEST_EQUAL(tree.size(), 3)
+
+  TEST_EXCEPTION(Exception::InvalidSize, tree.build(vector<double>(3, 1.0), vector<double>(2, 2.0)))
+}
+END_SECTION
+
+START_SECTION(void clear())
+{
+  StaticKDTree2D tree;
+  tree.build(xs, ys);
+  tree.clear();
+  TEST_EQUAL(tree.size(), 0)
+  TEST_EQUAL(tree.empty(), true)
+
+  vector<Size> result;
+  tree.queryRegion(0.0, 100.0, 0.0, 100.0, result);
+  TEST_EQUAL(result.size(), 0)
+}
+END_SECTION
+
+START_SECTION(void queryRegion(double x_low, double x_high, double y_low, double y_high, std::vector<Size>& result) const)
+{
+  StaticKDTree2D tree;
+  tree.build(xs, ys);
+
+  vector<Size> result;
+  tree.queryRegion(-1.0, 100.0, -1.0, 100.0, result);
+  TEST_EQUAL(result.size(), 400)
+
+  // closed intervals
+  result.clear();
+  tree.queryRegion(3.0, 4.0, 1.0, 1.5, result);
+  sort(result.begin(), result.end());
+  TEST_EQUAL(result.size(), 4)
+  ABORT_IF(result.size() != 4)
+  TEST_EQUAL(result[0], 62)
+  TEST_EQUAL(result[1], 63)
+  TEST_EQUAL(result[2], 82)
+  TEST_EQUAL(result[3], 83)
+
+  // single point
+  result.clear();
+  tree.queryRegion(7.0, 7.0, 4.5, 4.5, result);
+  TEST_EQUAL(result.size(), 1)
+  ABORT_IF(result.size() != 1)
+  TEST_EQUAL(result[0], 149)
+
+  // empty region, results are appended
+  tree.queryRegion(7.2, 7.8, 0.0, 10.0, result);
+  TEST_EQUAL(result.size(), 1)
+  tree.queryRegion(19.0, 25.0, 9.5, 20.0, result);
+  TEST_EQUAL(result.size(), 2)
+  TEST_EQUAL(result[1], 399)
+
+  // duplicate points are all reported
+  StaticKDTree2D duplicates;
+  duplicates.build(vector<double>(100, 1.0), vector<double>(100, 2.0));
+  result.clear();
+  duplicates.queryRegion(1.0, 1.0, 2.0, 2.0, result);
+  TEST_EQUAL(result.size(), 100)
+}
+END_SECTION
+
+START_SECTION(void queryRegions(const std::vector<Region>& regions, std::vector<std::vector<Size> >& results) const)
+{
+  StaticKDTree2D tree;
+  tree.build(xs, ys);
+
+  vector<StaticKDTree2D::Region> regions;
+  for (Size i = 0; i < 20; ++i)
+  {
+    StaticKDTree2D::Region region = {double(i), double(i), 0.0, 0.5 * i};
+    regions.push_back(region);
+  }
+
+  vector<vector<Size> > results(1, vector<Size>(5, 0));
+  tree.queryRegions(regions, results);
+  TEST_EQUAL(results.size(), 20)
+  for (Size i = 0; i < results.size(); ++i)
+  {
+    TEST_EQUAL(results[i].size(), i + 1)
+    vector<Size> expected;
+    tree.queryRegion(regions[i].x_low, regions[i].x_high, regions[i].y_low, regions[i].y_high, expected);
+    sort(results[i].begin(), results[i].end());
+    sort(expected.begin(), expected.end());
+    TEST_EQUAL(results[i] == expected, true)
+  }
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
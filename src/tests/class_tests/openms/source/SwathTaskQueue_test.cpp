@@ -0,0 +1,164 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2018.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/SwathTaskQueue.h>
+///////////////////////////
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(SwathTaskQueue, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+SwathTaskQueue* ptr = nullptr;
+SwathTaskQueue* nullPointer = nullptr;
+
+START_SECTION(SwathTaskQueue(Size nr_maps, int max_open))
+{
+  ptr = new SwathTaskQueue(3, 0);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+}
+END_SECTION
+
+START_SECTION(~SwathTaskQueue())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(Action next(Size& map_idx, Size& batch_idx))
+{
+  SwathTaskQueue queue(3, 0);
+  Size map_idx = 99, batch_idx = 99;
+
+  TEST_EQUAL(queue.next(map_idx, batch_idx), SwathTaskQueue::OPEN_MAP)
+  TEST_EQUAL(map_idx, 0)
+  TEST_EQUAL(queue.opened(0, 2), false)
+  TEST_EQUAL(queue.getNrBatches(0), 2)
+
+  TEST_EQUAL(queue.next(map_idx, batch_idx), SwathTaskQueue::BATCH)
+  TEST_EQUAL(map_idx, 0)
+  TEST_EQUAL(batch_idx, 0)
+  TEST_EQUAL(queue.next(map_idx, batch_idx), SwathTaskQueue::BATCH)
+  TEST_EQUAL(map_idx, 0)
+  TEST_EQUAL(batch_idx, 1)
+
+  // no pending batches: the next map is opened (without a limit on open maps)
+  TEST_EQUAL(queue.next(map_idx, batch_idx), SwathTaskQueue::OPEN_MAP)
+  TEST_EQUAL(map_idx, 1)
+  TEST_EQUAL(queue.opened(1, 0), true) // no batches
+
+  TEST_EQUAL(queue.next(map_idx, batch_idx), SwathTaskQueue::OPEN_MAP)
+  TEST_EQUAL(map_idx, 2)
+  TEST_EQUAL(queue.opened(2, 1), false)
+  TEST_EQUAL(queue.next(map_idx, batch_idx), SwathTaskQueue::BATCH)
+  TEST_EQUAL(map_idx, 2)
+  TEST_EQUAL(batch_idx, 0)
+
+  // all tasks are handed out
+  TEST_EQUAL(queue.next(map_idx, batch_idx), SwathTaskQueue::DONE)
+
+  TEST_EQUAL(queue.finished(2), true)
+  TEST_EQUAL(queue.finished(0), false)
+  TEST_EQUAL(queue.finished(0), true)
+  TEST_EQUAL(queue.next(map_idx, batch_idx), SwathTaskQueue::DONE)
+}
+END_SECTION
+
+START_SECTION(bool opened(Size map_idx, Size nr_batches))
+{
+  // batches of a map that is opened later are handed out while an earlier map is still opening
+  SwathTaskQueue queue(2, 0);
+  Size map_idx, batch_idx;
+  TEST_EQUAL(queue.next(map_idx, batch_idx), SwathTaskQueue::OPEN_MAP)
+  TEST_EQUAL(map_idx, 0)
+  TEST_EQUAL(queue.next(map_idx, batch_idx), SwathTaskQueue::OPEN_MAP)
+  TEST_EQUAL(map_idx, 1)
+  TEST_EQUAL(queue.opened(1, 1), false)
+  TEST_EQUAL(queue.next(map_idx, batch_idx), SwathTaskQueue::BATCH)
+  TEST_EQUAL(map_idx, 1)
+  TEST_EQUAL(queue.opened(0, 1), false)
+  TEST_EQUAL(queue.next(map_idx, batch_idx), SwathTaskQueue::BATCH)
+  TEST_EQUAL(map_idx, 0)
+  TEST_EQUAL(queue.next(map_idx, batch_idx), SwathTaskQueue::DONE)
+}
+END_SECTION
+
+START_SECTION(bool finished(Size map_idx))
+{
+  // with max_open = 1 the next map is only opened once the open map is finished
+  SwathTaskQueue queue(2, 1);
+  Size map_idx, batch_idx;
+  TEST_EQUAL(queue.next(map_idx, batch_idx), SwathTaskQueue::OPEN_MAP)
+  queue.opened(0, 1);
+  TEST_EQUAL(queue.next(map_idx, batch_idx), SwathTaskQueue::BATCH)
+
+  std::atomic<bool> returned(false);
+  Size waiting_map_idx = 99, waiting_batch_idx;
+  SwathTaskQueue::Action waiting_action = SwathTaskQueue::DONE;
+  std::thread waiting([&]()
+    {
+      waiting_action = queue.next(waiting_map_idx, waiting_batch_idx);
+      returned = true;
+    });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  TEST_EQUAL(returned, false)
+
+  TEST_EQUAL(queue.finished(0), true)
+  waiting.join();
+  TEST_EQUAL(returned, true)
+  TEST_EQUAL(waiting_action, SwathTaskQueue::OPEN_MAP)
+  TEST_EQUAL(waiting_map_idx, 1)
+}
+END_SECTION
+
+START_SECTION(Size getNrBatches(Size map_idx))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -532,6 +532,7 @@ protected:
         // Prepare the consumer
         PlainMSDataWritingConsumer consumer(out);
         consumer.getOptions().setWriteIndex(write_scan_index);
+        consumer.getOptions().setParallelWriting(true);
         bool skip_full_count = false;
         // numpress compression
         if (lossy_compression)
@@ -548,6 +549,8 @@ protected:
         {
           MzMLFile mzmlfile;
           mzmlfile.setLogType(log_type_);
+          // decode the next spectra while the consumer writes the previous ones
+          mzmlfile.getOptions().setPipelinedProcessing(true);
           mzmlfile.transform(in, &consumer, skip_full_count);
           return EXECUTION_OK;
         }
@@ -601,6 +604,7 @@ protected:
       f.setLogType(log_type_);
       f.getOptions().setWriteIndex(write_scan_index);
       f.getOptions().setForceTPPCompatability(force_TPP_compatibility);
+      f.getOptions().setParallelWriting(true);
       // numpress compression
       if (lossy_compression)
       {
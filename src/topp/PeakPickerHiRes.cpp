@@ -186,6 +186,7 @@ protected:
     ///////////////////////////////////
     PPHiResMzMLConsumer pp_consumer(out, pp);
     pp_consumer.addDataProcessing(getProcessingInfo_(DataProcessing::PEAK_PICKING));
+    pp_consumer.getOptions().setParallelWriting(true);
 
     ///////////////////////////////////
     // Create new MSDataReader and set our consumer
@@ -266,6 +267,7 @@ protected:
     //-------------------------------------------------------------
     //annotate output with data processing info
     addDataProcessing_(ms_exp_peaks, getProcessingInfo_(DataProcessing::PEAK_PICKING));
+    mz_data_file.getOptions().setParallelWriting(true);
     mz_data_file.store(out, ms_exp_peaks);
 
     return EXECUTION_OK;
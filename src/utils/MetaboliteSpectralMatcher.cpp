@@ -104,6 +104,7 @@ protected:
     setValidFormats_("in", ListUtils::create<String>("mzML"));
     registerInputFile_("database", "<file>", "CHEMISTRY/MetaboliteSpectralDB.mzML", "Default spectral database.", false);
     setValidFormats_("database", ListUtils::create<String>("mzML"));
+    registerStringOption_("database_index", "<file>", "", "Binary index of the spectral database. Built from 'database' and stored here if the file does not exist, otherwise loaded (saves rebuilding it for large databases).", false, true);
     registerOutputFile_("out", "<file>", "", "mzTab file");
     setValidFormats_("out", ListUtils::create<String>("mzTab"));
 
@@ -180,7 +181,31 @@ protected:
     //-------------------------------------------------------------
     MetaboliteSpectralMatching ams;
     ams.setParameters(ams_param);
-    ams.run(ms_peakmap, spec_db, mztab_output);
+
+    String database_index = getStringOption_("database_index");
+    if (database_index.empty())
+    {
+      ams.run(ms_peakmap, spec_db, mztab_output);
+    }
+    else
+    {
+      SpectralLibraryIndex index;
+      if (File::exists(database_index))
+      {
+        index.load(database_index);
+        if (!index.matches(spec_db))
+        {
+          writeLog_("Error: The database index '" + database_index + "' does not belong to the spectral database. Remove it to rebuild the index.");
+          return INCOMPATIBLE_INPUT_DATA;
+        }
+      }
+      else
+      {
+        index.build(spec_db);
+        index.store(database_index);
+      }
+      ams.run(ms_peakmap, spec_db, index, mztab_output);
+    }
 
     //-------------------------------------------------------------
     // store results
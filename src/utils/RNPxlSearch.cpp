@@ -61,6 +61,7 @@
 #include <OpenMS/CHEMISTRY/ResidueModification.h>
 
 // preprocessing and filtering
+#include <OpenMS/ANALYSIS/ID/PrecursorMassIndex.h>
 #include <OpenMS/ANALYSIS/ID/PrecursorPurity.h>
 #include <OpenMS/FILTERING/TRANSFORMERS/ThresholdMower.h>
 #include <OpenMS/FILTERING/TRANSFORMERS/NLargest.h>
@@ -1426,7 +1427,7 @@ protected:
                                  const double small_peptide_mass_filter_threshold,
                                  const Size peptide_min_size,
                                  const PeakMap & spectra,
-                                 multimap<double, pair<Size, int>> & multimap_mass_2_scan_index) const
+                                 PrecursorMassIndex & precursor_mass_index) const
   {
     Size fractional_mass_filtered(0), small_peptide_mass_filtered(0);
 
@@ -1472,10 +1473,11 @@ protected:
             continue;
           }
 
-          multimap_mass_2_scan_index.insert(make_pair(precursor_mass, make_pair(scan_index, i)));
+          precursor_mass_index.add(precursor_mass, scan_index, i);
         }
       }
     }
+    precursor_mass_index.build();
   }
 
   void initializeSpectrumGenerators(TheoreticalSpectrumGenerator &total_loss_spectrum_generator,
@@ -1689,16 +1691,15 @@ protected:
     preprocessSpectra_(spectra, fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm, convert_to_single_charge, annotate_charge);
     progresslogger.endProgress();
 
-    // build multimap of precursor mass to scan index (and perform some mass and length based filtering)
-    using MassToScanMultiMap = multimap<double, pair<Size, int>>;
-    MassToScanMultiMap multimap_mass_2_scan_index;  // map precursor mass to scan index and (potential) isotopic missassignment
+    // build index of precursor mass to scan index (and perform some mass and length based filtering)
+    PrecursorMassIndex precursor_mass_index;  // map precursor mass to scan index and (potential) isotopic missassignment
     mapPrecursorMassesToScans(min_precursor_charge,
                               max_precursor_charge,
                               precursor_isotopes,
                               small_peptide_mass_filter_threshold,
                               peptide_min_size,
                               spectra,
-                              multimap_mass_2_scan_index);
+                              precursor_mass_index);
 
     // initialize spectrum generators (generated ions, etc.)
     TheoreticalSpectrumGenerator total_loss_spectrum_generator;
@@ -1853,18 +1854,9 @@ protected:
             // TODO: const char xl_nucleotide; // can be none
 
             // determine MS2 precursors that match to the current peptide mass
-            MassToScanMultiMap::const_iterator low_it, up_it;
-
-            if (precursor_mass_tolerance_unit_ppm) // ppm
-            {
-              low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - current_peptide_mass * precursor_mass_tolerance * 1e-6);
-              up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + current_peptide_mass * precursor_mass_tolerance * 1e-6);
-            }
-            else // Dalton
-            {
-              low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - precursor_mass_tolerance);
-              up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + precursor_mass_tolerance);
-            }
+            const PrecursorMassIndex::Range matching_precursors = precursor_mass_index.find(current_peptide_mass, precursor_mass_tolerance, precursor_mass_tolerance_unit_ppm);
+            PrecursorMassIndex::ConstIterator low_it = matching_precursors.first;
+            PrecursorMassIndex::ConstIterator up_it = matching_precursors.second;
 
             if (low_it == up_it) { continue; } // no matching precursor in data
 
@@ -1902,9 +1894,9 @@ protected:
                 // score peptide without RNA (same method as fast scoring)
                 for (auto l = low_it; l != up_it; ++l)
                 {
-                  //const double exp_pc_mass = l->first;
-                  const Size & scan_index = l->second.first;
-                  const int & isotope_error = l->second.second;
+                  //const double exp_pc_mass = l->mass;
+                  const Size & scan_index = l->spectrum_index;
+                  const int & isotope_error = l->isotope_error;
                   const PeakSpectrum & exp_spectrum = spectra[scan_index];
                   const int & exp_pc_charge = exp_spectrum.getPrecursors()[0].getCharge();
                   PeakSpectrum & total_loss_spectrum = (exp_pc_charge < 3) ? total_loss_spectrum_z1 : total_loss_spectrum_z2;
@@ -2036,9 +2028,9 @@ protected:
 
                   for (auto l = low_it; l != up_it; ++l)
                   {
-                    //const double exp_pc_mass = l->first;
-                    const Size& scan_index = l->second.first;
-                    const int& isotope_error = l->second.second;
+                    //const double exp_pc_mass = l->mass;
+                    const Size& scan_index = l->spectrum_index;
+                    const int& isotope_error = l->isotope_error;
                     const PeakSpectrum& exp_spectrum = spectra[scan_index];
                     float tlss_MIC(0), tlss_err(0), tlss_Morph(0),
                       immonium_sub_score(0), precursor_sub_score(0),
@@ -2126,9 +2118,9 @@ protected:
             {
               for (auto l = low_it; l != up_it; ++l)
               {
-                //const double exp_pc_mass = l->first;
-                const Size &scan_index = l->second.first;
-                const int &isotope_error = l->second.second;
+                //const double exp_pc_mass = l->mass;
+                const Size &scan_index = l->spectrum_index;
+                const int &isotope_error = l->isotope_error;
                 const PeakSpectrum &exp_spectrum = spectra[scan_index];
                 float total_loss_score;
                 float immonium_sub_score;
@@ -34,7 +34,9 @@
 
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
 
+#include <OpenMS/ANALYSIS/ID/FragmentIndex.h>
 #include <OpenMS/ANALYSIS/ID/PeptideIndexing.h>
+#include <OpenMS/ANALYSIS/ID/PrecursorMassIndex.h>
 #include <OpenMS/ANALYSIS/RNPXL/ModifiedPeptideGenerator.h>
 #include <OpenMS/ANALYSIS/RNPXL/HyperScore.h>
 
@@ -97,6 +99,14 @@ class SimpleSearchEngine :
     }
   };
 
+  /// Candidate of the current fragment index chunk (modified peptide kept for HyperScore refinement)
+  struct IndexedCandidate
+  {
+    StringView sequence;
+    SignedSize peptide_mod_index; // enumeration index of the peptide modification
+    AASequence peptide;
+  };
+
   public:
     SimpleSearchEngine() :
       TOPPBase("SimpleSearchEngine", 
@@ -166,6 +176,15 @@ class SimpleSearchEngine :
 
       registerTOPPSubsection_("report", "Reporting Options");
       registerIntOption_("report:top_hits", "<num>", 1, "Maximum number of top scoring hits per spectrum that are reported.", false, true);
+
+      registerTOPPSubsection_("fragment_index", "Fragment Ion Index Options");
+      registerFlag_("fragment_index:enable", "Pre-select candidates by counting peaks shared with a fragment ion index before HyperScore scoring. Recommended for wide precursor mass tolerances (e.g. open modification searches).", false);
+      registerIntOption_("fragment_index:max_fragments", "<num>", 50000000, "Maximum number of fragments per index chunk (approx. 8 bytes each). Larger databases are searched in several chunks.", false, true);
+      setMinInt_("fragment_index:max_fragments", 1);
+      registerIntOption_("fragment_index:min_shared_peaks", "<num>", 2, "Minimum number of peaks a candidate must share with a spectrum to be scored.", false, true);
+      setMinInt_("fragment_index:min_shared_peaks", 1);
+      registerIntOption_("fragment_index:max_candidates", "<num>", 100, "Maximum number of candidates per spectrum (those with most shared peaks) that are scored with the HyperScore (0 = all).", false, true);
+      setMinInt_("fragment_index:max_candidates", 0);
     }
 
     vector<ResidueModification> getModifications_(StringList modNames)
@@ -324,6 +343,330 @@ class SimpleSearchEngine :
     protein_ids[0].setSearchParameters(search_parameters);
   }
 
+    /// Query the fragment index with all spectra and score the best candidates with the HyperScore
+    void scoreFragmentIndexChunk_(const PeakMap& spectra,
+      const vector<vector<double> >& scan_precursor_masses,
+      const FragmentIndex& fragment_index,
+      const vector<IndexedCandidate>& candidates,
+      const TheoreticalSpectrumGenerator& spectrum_generator,
+      double precursor_mass_tolerance,
+      bool precursor_mass_tolerance_unit_ppm,
+      double fragment_mass_tolerance,
+      bool fragment_mass_tolerance_unit_ppm,
+      Size min_shared_peaks,
+      Size max_candidates,
+      Size top_hits,
+      vector<vector<AnnotatedHit> >& annotated_hits)
+    {
+      // shortlist the best candidates of each spectrum
+      vector<vector<Size> > scan_candidates(spectra.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+      for (SignedSize scan_index = 0; scan_index < (SignedSize)spectra.size(); ++scan_index)
+      {
+        const vector<double>& precursor_masses = scan_precursor_masses[scan_index];
+        if (precursor_masses.empty()) { continue; }
+
+        const PeakSpectrum& exp_spectrum = spectra[scan_index];
+
+        // collect candidates matching any of the (isotope corrected) precursor masses
+        vector<pair<Size, Size> > hits, shared_peaks;
+        for (double precursor_mass : precursor_masses)
+        {
+          double tolerance = precursor_mass_tolerance_unit_ppm ? 0.5 * precursor_mass * precursor_mass_tolerance * 1e-6 : 0.5 * precursor_mass_tolerance;
+          fragment_index.query(exp_spectrum, precursor_mass - tolerance, precursor_mass + tolerance, min_shared_peaks, hits);
+          shared_peaks.insert(shared_peaks.end(), hits.begin(), hits.end());
+        }
+        if (shared_peaks.empty()) { continue; }
+
+        // candidates found for several precursor masses: keep them once
+        std::sort(shared_peaks.begin(), shared_peaks.end());
+        shared_peaks.erase(std::unique(shared_peaks.begin(), shared_peaks.end(),
+          [](const pair<Size, Size>& a, const pair<Size, Size>& b) { return a.first == b.first; }), shared_peaks.end());
+
+        // keep candidates with most shared peaks (ties broken by candidate index)
+        if (max_candidates != 0 && shared_peaks.size() > max_candidates)
+        {
+          std::partial_sort(shared_peaks.begin(), shared_peaks.begin() + max_candidates, shared_peaks.end(),
+            [](const pair<Size, Size>& a, const pair<Size, Size>& b) { return a.second > b.second || (a.second == b.second && a.first < b.first); });
+          shared_peaks.resize(max_candidates);
+        }
+
+        vector<Size>& shortlist = scan_candidates[scan_index];
+        shortlist.reserve(shared_peaks.size());
+        for (const pair<Size, Size>& sp : shared_peaks) { shortlist.push_back(sp.first); }
+      }
+
+      // generate the theoretical spectrum of each shortlisted candidate only once per chunk
+      // (only shortlisted candidates are cached as full spectra are much larger than their index entries)
+      const Size not_cached = candidates.size();
+      vector<Size> cache_slot(candidates.size(), not_cached);
+      vector<Size> cached_candidates;
+      for (const vector<Size>& shortlist : scan_candidates)
+      {
+        for (Size c : shortlist)
+        {
+          if (cache_slot[c] != not_cached) { continue; }
+          cache_slot[c] = cached_candidates.size();
+          cached_candidates.push_back(c);
+        }
+      }
+
+      vector<PeakSpectrum> theo_spectra(cached_candidates.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+      for (SignedSize i = 0; i < (SignedSize)cached_candidates.size(); ++i)
+      {
+        spectrum_generator.getSpectrum(theo_spectra[i], candidates[cached_candidates[i]].peptide, 1, 1);
+        theo_spectra[i].sortByPosition();
+      }
+
+      // each thread processes whole spectra, so no locking of annotated_hits is needed
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+      for (SignedSize scan_index = 0; scan_index < (SignedSize)spectra.size(); ++scan_index)
+      {
+        const PeakSpectrum& exp_spectrum = spectra[scan_index];
+
+        vector<AnnotatedHit>& scan_hits = annotated_hits[scan_index];
+        for (Size c : scan_candidates[scan_index])
+        {
+          const IndexedCandidate& candidate = candidates[c];
+          const PeakSpectrum& theo_spectrum = theo_spectra[cache_slot[c]];
+
+          const double score = HyperScore::compute(fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_spectrum);
+
+          if (score == 0) { continue; } // no hit?
+
+          AnnotatedHit ah;
+          ah.sequence = candidate.sequence;
+          ah.peptide_mod_index = candidate.peptide_mod_index;
+          ah.score = score;
+          scan_hits.push_back(ah);
+
+          // prevent vector from growing indefinitly (memory) but don't shrink the vector every time
+          if (scan_hits.size() >= 2 * top_hits)
+          {
+            std::partial_sort(scan_hits.begin(), scan_hits.begin() + top_hits, scan_hits.end(), AnnotatedHit::hasBetterScore);
+            scan_hits.resize(top_hits);
+          }
+        }
+      }
+    }
+
+    /**
+      Search using a fragment ion index: the database is digested, all candidates
+      (including modified variants) are added to the index until it holds
+      fragment_index:max_fragments fragments. Then all spectra are queried
+      against this chunk and the index is cleared for the next chunk.
+    */
+    void searchFragmentIndex_(const PeakMap& spectra,
+      const PrecursorMassIndex& precursor_mass_index,
+      const vector<FASTAFile::FASTAEntry>& fasta_db,
+      const ProteaseDigestion& digestor,
+      const TheoreticalSpectrumGenerator& spectrum_generator,
+      const vector<ResidueModification>& fixed_modifications,
+      const vector<ResidueModification>& variable_modifications,
+      Size max_variable_mods_per_peptide,
+      Size top_hits,
+      vector<vector<AnnotatedHit> >& annotated_hits,
+      set<StringView>& processed_peptides,
+      Size& count_proteins,
+      Size& count_peptides)
+    {
+      double precursor_mass_tolerance = getDoubleOption_("precursor:mass_tolerance");
+      bool precursor_mass_tolerance_unit_ppm = (getStringOption_("precursor:mass_tolerance_unit") == "ppm");
+      double fragment_mass_tolerance = getDoubleOption_("fragment:mass_tolerance");
+      bool fragment_mass_tolerance_unit_ppm = (getStringOption_("fragment:mass_tolerance_unit") == "ppm");
+      Size min_peptide_length = getIntOption_("peptide:min_size");
+      Size max_peptide_length = getIntOption_("peptide:max_size");
+      const String peptide_motif = getStringOption_("peptide:motif");
+      boost::regex peptide_motif_regex(peptide_motif);
+      Size max_fragments = getIntOption_("fragment_index:max_fragments");
+      Size min_shared_peaks = getIntOption_("fragment_index:min_shared_peaks");
+      Size max_candidates = getIntOption_("fragment_index:max_candidates");
+
+      // all precursor masses (one per considered isotope) of a spectrum
+      vector<vector<double> > scan_precursor_masses(spectra.size());
+      for (const PrecursorMassIndex::Entry& e : precursor_mass_index)
+      {
+        scan_precursor_masses[e.spectrum_index].push_back(e.mass);
+      }
+
+      // unique unmodified peptides of the database
+      for (const FASTAFile::FASTAEntry& entry : fasta_db)
+      {
+        ++count_proteins;
+        vector<StringView> current_digest;
+        digestor.digestUnmodified(entry.sequence, current_digest, min_peptide_length, max_peptide_length);
+
+        for (auto const & c : current_digest)
+        {
+          const String current_peptide = c.getString();
+          if (current_peptide.find_first_of("XBZ") != std::string::npos) { continue; }
+
+          // if a peptide motif is provided skip all peptides without match
+          if (!peptide_motif.empty() && !boost::regex_match(current_peptide, peptide_motif_regex)) { continue; }
+
+          processed_peptides.insert(c);
+        }
+      }
+      const vector<StringView> peptides(processed_peptides.begin(), processed_peptides.end());
+      count_peptides = peptides.size();
+
+      ProgressLogger progresslogger;
+      progresslogger.setLogType(log_type_);
+      progresslogger.startProgress(0, peptides.size(), "Scoring peptide models against spectra using a fragment index...");
+
+      FragmentIndex fragment_index(fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm);
+      vector<IndexedCandidate> candidates;
+      Size chunk_count(0);
+
+      // theoretical spectra are generated in parallel for blocks of peptides and then added to the index
+      const SignedSize block_size = 1000;
+      for (SignedSize block_begin = 0; block_begin < (SignedSize)peptides.size(); block_begin += block_size)
+      {
+        const SignedSize block_end = std::min(block_begin + block_size, (SignedSize)peptides.size());
+        vector<vector<AASequence> > block_peptides(block_end - block_begin);
+        vector<vector<PeakSpectrum> > block_spectra(block_end - block_begin);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (SignedSize i = block_begin; i < block_end; ++i)
+        {
+          vector<AASequence>& all_modified_peptides = block_peptides[i - block_begin];
+
+          // this critial section is because ResidueDB is not thread safe and new residues are created based on the PTMs
+#ifdef _OPENMP
+#pragma omp critical (residuedb_access)
+#endif
+          {
+            AASequence aas = AASequence::fromString(peptides[i].getString());
+            ModifiedPeptideGenerator::applyFixedModifications(fixed_modifications.begin(), fixed_modifications.end(), aas);
+            ModifiedPeptideGenerator::applyVariableModifications(variable_modifications.begin(), variable_modifications.end(), aas, max_variable_mods_per_peptide, all_modified_peptides);
+          }
+
+          vector<PeakSpectrum>& theo_spectra = block_spectra[i - block_begin];
+          theo_spectra.resize(all_modified_peptides.size());
+          for (Size mod_pep_idx = 0; mod_pep_idx < all_modified_peptides.size(); ++mod_pep_idx)
+          {
+            // add peaks for b and y ions with charge 1
+            spectrum_generator.getSpectrum(theo_spectra[mod_pep_idx], all_modified_peptides[mod_pep_idx], 1, 1);
+          }
+        }
+
+        for (SignedSize i = block_begin; i < block_end; ++i)
+        {
+          const vector<AASequence>& all_modified_peptides = block_peptides[i - block_begin];
+          for (Size mod_pep_idx = 0; mod_pep_idx < all_modified_peptides.size(); ++mod_pep_idx)
+          {
+            IndexedCandidate candidate;
+            candidate.sequence = peptides[i];
+            candidate.peptide_mod_index = mod_pep_idx;
+            candidate.peptide = all_modified_peptides[mod_pep_idx];
+            fragment_index.addCandidate(candidate.peptide.getMonoWeight(), block_spectra[i - block_begin][mod_pep_idx]);
+            candidates.push_back(candidate);
+          }
+        }
+        progresslogger.setProgress(block_end);
+
+        // search full chunk (or the last one)
+        if (fragment_index.getNumberOfFragments() >= max_fragments || block_end == (SignedSize)peptides.size())
+        {
+          fragment_index.build();
+          scoreFragmentIndexChunk_(spectra, scan_precursor_masses, fragment_index, candidates, spectrum_generator,
+            precursor_mass_tolerance, precursor_mass_tolerance_unit_ppm,
+            fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm,
+            min_shared_peaks, max_candidates, top_hits, annotated_hits);
+          ++chunk_count;
+          fragment_index.clear();
+          candidates.clear();
+        }
+      }
+      progresslogger.endProgress();
+
+      LOG_INFO << "Fragment index chunks: " << chunk_count << endl;
+    }
+
+    /// Post-process the hits of all spectra, map them to proteins and store them to @p out_idxml
+    ExitCodes storeResults_(const PeakMap& spectra,
+      vector<vector<AnnotatedHit> >& annotated_hits,
+      vector<FASTAFile::FASTAEntry>& fasta_db,
+      Size top_hits,
+      const vector<ResidueModification>& fixed_modifications,
+      const vector<ResidueModification>& variable_modifications,
+      Size max_variable_mods_per_peptide,
+      Size count_proteins,
+      Size count_peptides,
+      Size count_processed_peptides,
+      const String& out_idxml)
+    {
+      ProgressLogger progresslogger;
+      progresslogger.setLogType(log_type_);
+
+      LOG_INFO << "Proteins: " << count_proteins << endl;
+      LOG_INFO << "Peptides: " << count_peptides << endl;
+      LOG_INFO << "Processed peptides: " << count_processed_peptides << endl;
+
+      vector<PeptideIdentification> peptide_ids;
+      vector<ProteinIdentification> protein_ids;
+
+      progresslogger.startProgress(0, 1, "Post-processing PSMs...");
+      postProcessHits_(spectra, 
+        annotated_hits, 
+        protein_ids, 
+        peptide_ids, 
+        top_hits,
+        fixed_modifications, 
+        variable_modifications, 
+        max_variable_mods_per_peptide
+        );
+      progresslogger.endProgress();
+
+      // add meta data on spectra file
+      StringList ms_runs;
+      spectra.getPrimaryMSRunPath(ms_runs);
+      protein_ids[0].setPrimaryMSRunPath(ms_runs);
+
+      // reindex peptides to proteins
+      PeptideIndexing indexer;
+      Param param_pi = indexer.getParameters();
+      param_pi.setValue("decoy_string", "DECOY_");
+      param_pi.setValue("decoy_string_position", "prefix");
+      param_pi.setValue("enzyme:name", getStringOption_("enzyme"));
+      param_pi.setValue("enzyme:specificity", "full");
+      param_pi.setValue("missing_decoy_action", "silent");
+      indexer.setParameters(param_pi);
+
+      PeptideIndexing::ExitCodes indexer_exit = indexer.run(fasta_db, protein_ids, peptide_ids);
+
+      if ((indexer_exit != PeptideIndexing::EXECUTION_OK) &&
+          (indexer_exit != PeptideIndexing::PEPTIDE_IDS_EMPTY))
+      {
+        if (indexer_exit == PeptideIndexing::DATABASE_EMPTY)
+        {
+          return INPUT_FILE_EMPTY;       
+        }
+        else if (indexer_exit == PeptideIndexing::UNEXPECTED_RESULT)
+        {
+          return UNEXPECTED_RESULT;
+        }
+        else
+        {
+          return UNKNOWN_ERROR;
+        }
+      } 
+
+      // write ProteinIdentifications and PeptideIdentifications to IdXML
+      IdXMLFile().store(out_idxml, protein_ids, peptide_ids);
+
+      return EXECUTION_OK;
+    }
+
     ExitCodes main_(int, const char**) override
     {
       ProgressLogger progresslogger;
@@ -384,8 +727,8 @@ class SimpleSearchEngine :
       preprocessSpectra_(spectra, fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm);
       progresslogger.endProgress();
 
-      // build multimap of precursor mass to scan index
-      multimap<double, Size> multimap_mass_2_scan_index;
+      // build index of precursor mass to scan index
+      PrecursorMassIndex precursor_mass_index;
       for (PeakMap::ConstIterator s_it = spectra.begin(); s_it != spectra.end(); ++s_it)
       {
         int scan_index = s_it - spectra.begin();
@@ -403,18 +746,12 @@ class SimpleSearchEngine :
 
           double precursor_mz = precursor[0].getMZ();
 
-          // calculate precursor mass (optionally corrected for misassignment) and map it to MS scan index
-          for (int isotope_number : precursor_isotopes)
-          {
-            double precursor_mass = (double) precursor_charge * precursor_mz - (double) precursor_charge * Constants::PROTON_MASS_U;
-
-            // correct for monoisotopic misassignments of the precursor annotation
-            if (isotope_number != 0) { precursor_mass -= isotope_number * Constants::C13C12_MASSDIFF_U; }
-
-            multimap_mass_2_scan_index.insert(make_pair(precursor_mass, scan_index));
-          }
+          // calculate precursor mass and map it (optionally corrected for misassignment) to MS scan index
+          double precursor_mass = (double) precursor_charge * precursor_mz - (double) precursor_charge * Constants::PROTON_MASS_U;
+          precursor_mass_index.addPrecursor(precursor_mass, scan_index, precursor_isotopes);
         }
       }
+      precursor_mass_index.build();
 
       // create spectrum generator
       TheoreticalSpectrumGenerator spectrum_generator;
@@ -427,12 +764,6 @@ class SimpleSearchEngine :
       vector<vector<AnnotatedHit> > annotated_hits(spectra.size(), vector<AnnotatedHit>());
       for (auto & a : annotated_hits) { a.reserve(2 * top_hits); }
 
-#ifdef _OPENMP
-      // we want to do locking at the spectrum level so we get good parallelisation 
-      vector<omp_lock_t> annotated_hits_lock(annotated_hits.size());
-      for (size_t i = 0; i != annotated_hits_lock.size(); i++) { omp_init_lock(&(annotated_hits_lock[i])); }
-#endif
-
       progresslogger.startProgress(0, 1, "Load database from FASTA file...");
       FASTAFile fastaFile;
       vector<FASTAFile::FASTAEntry> fasta_db;
@@ -444,8 +775,6 @@ class SimpleSearchEngine :
       digestor.setEnzyme(getStringOption_("enzyme"));
       digestor.setMissedCleavages(missed_cleavages);
 
-      progresslogger.startProgress(0, (Size)(fasta_db.end() - fasta_db.begin()), "Scoring peptide models against spectra...");
-
       // lookup for processed peptides. must be defined outside of omp section and synchronized
       set<StringView> processed_petides;
 
@@ -454,6 +783,24 @@ class SimpleSearchEngine :
       Size max_peptide_length = getIntOption_("peptide:max_size");
       Size count_proteins(0), count_peptides(0);
 
+      if (getFlag_("fragment_index:enable"))
+      {
+        searchFragmentIndex_(spectra, precursor_mass_index, fasta_db, digestor, spectrum_generator,
+          fixed_modifications, variable_modifications, max_variable_mods_per_peptide, top_hits,
+          annotated_hits, processed_petides, count_proteins, count_peptides);
+
+        return storeResults_(spectra, annotated_hits, fasta_db, top_hits, fixed_modifications, variable_modifications,
+          max_variable_mods_per_peptide, count_proteins, count_peptides, processed_petides.size(), out_idxml);
+      }
+
+#ifdef _OPENMP
+      // we want to do locking at the spectrum level so we get good parallelisation 
+      vector<omp_lock_t> annotated_hits_lock(annotated_hits.size());
+      for (size_t i = 0; i != annotated_hits_lock.size(); i++) { omp_init_lock(&(annotated_hits_lock[i])); }
+#endif
+
+      progresslogger.startProgress(0, (Size)(fasta_db.end() - fasta_db.begin()), "Scoring peptide models against spectra...");
+
 #ifdef _OPENMP
 #pragma omp parallel for schedule(static)
 #endif
@@ -519,25 +866,20 @@ class SimpleSearchEngine :
             ModifiedPeptideGenerator::applyVariableModifications(variable_modifications.begin(), variable_modifications.end(), aas, max_variable_mods_per_peptide, all_modified_peptides);
           }
 
+          // determine MS2 precursors that match to the masses of all modified variants
+          vector<double> current_peptide_masses;
+          for (const AASequence& candidate : all_modified_peptides)
+          {
+            current_peptide_masses.push_back(candidate.getMonoWeight());
+          }
+          vector<PrecursorMassIndex::Range> matching_precursors;
+          precursor_mass_index.find(current_peptide_masses, 0.5 * precursor_mass_tolerance, precursor_mass_tolerance_unit_ppm, matching_precursors);
+
           for (SignedSize mod_pep_idx = 0; mod_pep_idx < (SignedSize)all_modified_peptides.size(); ++mod_pep_idx)
           {
             const AASequence& candidate = all_modified_peptides[mod_pep_idx];
-            double current_peptide_mass = candidate.getMonoWeight();
-
-            // determine MS2 precursors that match to the current peptide mass
-            multimap<double, Size>::const_iterator low_it;
-            multimap<double, Size>::const_iterator up_it;
-
-            if (precursor_mass_tolerance_unit_ppm) // ppm
-            {
-              low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - 0.5 * current_peptide_mass * precursor_mass_tolerance * 1e-6);
-              up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + 0.5 * current_peptide_mass * precursor_mass_tolerance * 1e-6);
-            }
-            else // Dalton
-            {
-              low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - 0.5 * precursor_mass_tolerance);
-              up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + 0.5 * precursor_mass_tolerance);
-            }
+            PrecursorMassIndex::ConstIterator low_it = matching_precursors[mod_pep_idx].first;
+            PrecursorMassIndex::ConstIterator up_it = matching_precursors[mod_pep_idx].second;
 
             // no matching precursor in data
             if (low_it == up_it) { continue; }
@@ -553,7 +895,7 @@ class SimpleSearchEngine :
 
             for (; low_it != up_it; ++low_it)
             {
-              const Size& scan_index = low_it->second;
+              const Size& scan_index = low_it->spectrum_index;
               const PeakSpectrum& exp_spectrum = spectra[scan_index];
               // const int& charge = exp_spectrum.getPrecursors()[0].getCharge();
               const double& score = HyperScore::compute(fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_spectrum);
@@ -588,68 +930,13 @@ class SimpleSearchEngine :
       }
       progresslogger.endProgress();
 
-      LOG_INFO << "Proteins: " << count_proteins << endl;
-      LOG_INFO << "Peptides: " << count_peptides << endl;
-      LOG_INFO << "Processed peptides: " << processed_petides.size() << endl;
-
-      vector<PeptideIdentification> peptide_ids;
-      vector<ProteinIdentification> protein_ids;
-
-      progresslogger.startProgress(0, 1, "Post-processing PSMs...");
-      postProcessHits_(spectra, 
-        annotated_hits, 
-        protein_ids, 
-        peptide_ids, 
-        top_hits,
-        fixed_modifications, 
-        variable_modifications, 
-        max_variable_mods_per_peptide
-        );
-      progresslogger.endProgress();
-
-      // add meta data on spectra file
-      StringList ms_runs;
-      spectra.getPrimaryMSRunPath(ms_runs);
-      protein_ids[0].setPrimaryMSRunPath(ms_runs);
-
-      // reindex peptides to proteins
-      PeptideIndexing indexer;
-      Param param_pi = indexer.getParameters();
-      param_pi.setValue("decoy_string", "DECOY_");
-      param_pi.setValue("decoy_string_position", "prefix");
-      param_pi.setValue("enzyme:name", getStringOption_("enzyme"));
-      param_pi.setValue("enzyme:specificity", "full");
-      param_pi.setValue("missing_decoy_action", "silent");
-      indexer.setParameters(param_pi);
-
-      PeptideIndexing::ExitCodes indexer_exit = indexer.run(fasta_db, protein_ids, peptide_ids);
-
-      if ((indexer_exit != PeptideIndexing::EXECUTION_OK) &&
-          (indexer_exit != PeptideIndexing::PEPTIDE_IDS_EMPTY))
-      {
-        if (indexer_exit == PeptideIndexing::DATABASE_EMPTY)
-        {
-          return INPUT_FILE_EMPTY;       
-        }
-        else if (indexer_exit == PeptideIndexing::UNEXPECTED_RESULT)
-        {
-          return UNEXPECTED_RESULT;
-        }
-        else
-        {
-          return UNKNOWN_ERROR;
-        }
-      } 
-
-      // write ProteinIdentifications and PeptideIdentifications to IdXML
-      IdXMLFile().store(out_idxml, protein_ids, peptide_ids);
-
 #ifdef _OPENMP
       // free locks
       for (size_t i = 0; i != annotated_hits_lock.size(); i++) { omp_destroy_lock(&(annotated_hits_lock[i])); }
 #endif
 
-      return EXECUTION_OK;
+      return storeResults_(spectra, annotated_hits, fasta_db, top_hits, fixed_modifications, variable_modifications,
+        max_variable_mods_per_peptide, count_proteins, count_peptides, processed_petides.size(), out_idxml);
     }
 
 };
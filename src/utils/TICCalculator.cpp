@@ -50,6 +50,7 @@
 #include <OpenMS/SYSTEM/SysInfo.h>
 #include <OpenMS/INTERFACES/IMSDataConsumer.h>
 
+#include <memory>
 #include <numeric>
 
 using namespace OpenMS;
@@ -281,7 +282,7 @@ protected:
 
       // load data from an indexed MzML file
       OnDiscPeakMap map;
-      map.openFile(in, true);
+      map.openFile(in, true, true);
       map.setSkipXMLChecks(true);
 
       double TIC = 0.0;
@@ -290,22 +291,36 @@ protected:
       if (load_data)
       {
 
-        // firstprivate means that each thread has its own instance of the
-        // variable, each copy initialized with the initial value 
+        // if the file is memory-mapped, all threads can share a single
+        // instance; otherwise each thread needs its own copy (with its own
+        // file stream)
+        const bool shared_map = map.isMemoryMapped();
 #ifdef _OPENMP
-#pragma omp parallel for firstprivate(map) 
+#pragma omp parallel
 #endif
-        for (SignedSize i =0; i < (SignedSize)map.getNrSpectra(); i++)
         {
-          OpenMS::Interfaces::SpectrumPtr sptr = map.getSpectrumById(i);
-          double nr_peaks_l = sptr->getIntensityArray()->data.size();
-          double TIC_l = std::accumulate(sptr->getIntensityArray()->data.begin(), sptr->getIntensityArray()->data.end(), 0.0);
+          std::unique_ptr<OnDiscPeakMap> thread_map;
+          if (!shared_map)
+          {
+            thread_map.reset(new OnDiscPeakMap(map));
+          }
+          OnDiscPeakMap& local_map = shared_map ? map : *thread_map;
+
 #ifdef _OPENMP
-#pragma omp critical (indexed)
+#pragma omp for
 #endif
+          for (SignedSize i =0; i < (SignedSize)map.getNrSpectra(); i++)
           {
-            TIC += TIC_l;
-            nr_peaks += nr_peaks_l;
+            OpenMS::Interfaces::SpectrumPtr sptr = local_map.getSpectrumById(i);
+            double nr_peaks_l = sptr->getIntensityArray()->data.size();
+            double TIC_l = std::accumulate(sptr->getIntensityArray()->data.begin(), sptr->getIntensityArray()->data.end(), 0.0);
+#ifdef _OPENMP
+#pragma omp critical (indexed)
+#endif
+            {
+              TIC += TIC_l;
+              nr_peaks += nr_peaks_l;
+            }
           }
         }
 